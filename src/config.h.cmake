@@ -46,6 +46,9 @@
 /* Define if JACK library is available. */
 #cmakedefine CONFIG_LIBJACK @CONFIG_LIBJACK@
 
+/* Define if JACK server control library is available. */
+#cmakedefine CONFIG_LIBJACKSERVER @CONFIG_LIBJACKSERVER@
+
 /* Define if ALSA library is available. */
 #cmakedefine CONFIG_LIBASOUND @CONFIG_LIBASOUND@
 
@@ -220,6 +223,12 @@
 /* Define if unique/single instance is enabled. */
 #cmakedefine CONFIG_XUNIQUE @CONFIG_XUNIQUE@
 
+/* Define if per-track/plugin DSP load statistics are enabled. */
+#cmakedefine CONFIG_DSP_LOAD @CONFIG_DSP_LOAD@
+
+/* Define if the offline render benchmark tool is enabled. */
+#cmakedefine CONFIG_BENCHMARK @CONFIG_BENCHMARK@
+
 /* Define if gradient eye-candy is enabled. */
 #cmakedefine CONFIG_GRADIENT @CONFIG_GRADIENT@
 
@@ -22,6 +22,8 @@
 #include "qtractorAbout.h"
 #include "qtractorAudioBuffer.h"
 #include "qtractorAudioPeak.h"
+#include "qtractorAudioCache.h"
+#include "qtractorAudioStretch.h"
 
 #include "qtractorTimeStretcher.h"
 
@@ -35,21 +37,257 @@
 #define QTRACTOR_RAMP_LENGTH	32
 
 
+#if defined(__SSE__)
+
+#include <xmmintrin.h>
+
+// SSE detection.
+static inline bool sse_enabled (void)
+{
+#if defined(__GNUC__)
+	unsigned int eax, ebx, ecx, edx;
+#if defined(__x86_64__) || (!defined(PIC) && !defined(__PIC__))
+	__asm__ __volatile__ (
+		"cpuid\n\t" \
+		: "=a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx) \
+		: "a" (1) : "cc");
+#else
+	__asm__ __volatile__ (
+		"push %%ebx\n\t" \
+		"cpuid\n\t" \
+		"movl %%ebx,%1\n\t" \
+		"pop %%ebx\n\t" \
+		: "=a" (eax), "=r" (ebx), "=c" (ecx), "=d" (edx) \
+		: "a" (1) : "cc");
+#endif
+	return (edx & (1 << 25));
+#else
+	return false;
+#endif
+}
+
+
+// SSE enabled gain-ramp mix processor version.
+static void sse_gain_ramp_add ( float *pFrames, const float *pBuffer,
+	unsigned int iFrames, float fGain, float fGainStep )
+{
+	unsigned int nframes = iFrames;
+	for (; (long(pFrames) & 15) && (nframes > 0); --nframes) {
+		*pFrames++ += fGain * *pBuffer++;
+		fGain += fGainStep;
+	}
+	if (nframes >= 4) {
+		__m128 vGain = _mm_setr_ps(fGain,
+			fGain + fGainStep,
+			fGain + 2.0f * fGainStep,
+			fGain + 3.0f * fGainStep);
+		const __m128 vStep = _mm_set1_ps(4.0f * fGainStep);
+		for (; nframes >= 4; nframes -= 4) {
+			_mm_store_ps(pFrames,
+				_mm_add_ps(
+					_mm_load_ps(pFrames),
+					_mm_mul_ps(vGain, _mm_loadu_ps(pBuffer))));
+			vGain = _mm_add_ps(vGain, vStep);
+			pFrames += 4;
+			pBuffer += 4;
+		}
+		_mm_store_ss(&fGain, vGain);
+	}
+	for (; nframes > 0; --nframes) {
+		*pFrames++ += fGain * *pBuffer++;
+		fGain += fGainStep;
+	}
+}
+
+
+// SSE enabled gain-curve mix processor version.
+static void sse_gain_curve_add ( float *pFrames, const float *pBuffer,
+	const float *pCurve, unsigned int iFrames, float fGain )
+{
+	unsigned int nframes = iFrames;
+	for (; (long(pFrames) & 15) && (nframes > 0); --nframes)
+		*pFrames++ += fGain * *pCurve++ * *pBuffer++;
+	const __m128 vGain = _mm_set1_ps(fGain);
+	for (; nframes >= 4; nframes -= 4) {
+		_mm_store_ps(pFrames,
+			_mm_add_ps(
+				_mm_load_ps(pFrames),
+				_mm_mul_ps(
+					_mm_mul_ps(vGain, _mm_loadu_ps(pCurve)),
+					_mm_loadu_ps(pBuffer))));
+		pFrames += 4;
+		pCurve  += 4;
+		pBuffer += 4;
+	}
+	for (; nframes > 0; --nframes)
+		*pFrames++ += fGain * *pCurve++ * *pBuffer++;
+}
+
+#endif // __SSE__
+
+
+#if defined(__ARM_NEON__)
+
+#include "arm_neon.h"
+
+// NEON enabled gain-ramp mix processor version.
+static void neon_gain_ramp_add ( float *pFrames, const float *pBuffer,
+	unsigned int iFrames, float fGain, float fGainStep )
+{
+	unsigned int nframes = iFrames;
+	for (; (long(pFrames) & 15) && (nframes > 0); --nframes) {
+		*pFrames++ += fGain * *pBuffer++;
+		fGain += fGainStep;
+	}
+	if (nframes >= 4) {
+		const float afGain[4] = { fGain,
+			fGain + fGainStep,
+			fGain + 2.0f * fGainStep,
+			fGain + 3.0f * fGainStep };
+		float32x4_t vGain = vld1q_f32(afGain);
+		const float32x4_t vStep = vdupq_n_f32(4.0f * fGainStep);
+		for (; nframes >= 4; nframes -= 4) {
+			vst1q_f32(pFrames,
+				vmlaq_f32(vld1q_f32(pFrames), vGain, vld1q_f32(pBuffer)));
+			vGain = vaddq_f32(vGain, vStep);
+			pFrames += 4;
+			pBuffer += 4;
+		}
+		fGain = vgetq_lane_f32(vGain, 0);
+	}
+	for (; nframes > 0; --nframes) {
+		*pFrames++ += fGain * *pBuffer++;
+		fGain += fGainStep;
+	}
+}
+
+
+// NEON enabled gain-curve mix processor version.
+static void neon_gain_curve_add ( float *pFrames, const float *pBuffer,
+	const float *pCurve, unsigned int iFrames, float fGain )
+{
+	unsigned int nframes = iFrames;
+	for (; (long(pFrames) & 15) && (nframes > 0); --nframes)
+		*pFrames++ += fGain * *pCurve++ * *pBuffer++;
+	const float32x4_t vGain = vdupq_n_f32(fGain);
+	for (; nframes >= 4; nframes -= 4) {
+		vst1q_f32(pFrames,
+			vmlaq_f32(vld1q_f32(pFrames),
+				vmulq_f32(vGain, vld1q_f32(pCurve)), vld1q_f32(pBuffer)));
+		pFrames += 4;
+		pCurve  += 4;
+		pBuffer += 4;
+	}
+	for (; nframes > 0; --nframes)
+		*pFrames++ += fGain * *pCurve++ * *pBuffer++;
+}
+
+#endif // __ARM_NEON__
+
+
+// Standard gain-ramp mix processor version.
+static void std_gain_ramp_add ( float *pFrames, const float *pBuffer,
+	unsigned int iFrames, float fGain, float fGainStep )
+{
+	for (unsigned int n = 0; n < iFrames; ++n, fGain += fGainStep)
+		*pFrames++ += fGain * *pBuffer++;
+}
+
+
+// Standard gain-curve mix processor version.
+static void std_gain_curve_add ( float *pFrames, const float *pBuffer,
+	const float *pCurve, unsigned int iFrames, float fGain )
+{
+	for (unsigned int n = 0; n < iFrames; ++n)
+		*pFrames++ += fGain * *pCurve++ * *pBuffer++;
+}
+
+
+// Equal-power crossfade curve: sin(t*pi/2) fading in, cos(t*pi/2)
+// fading out, for t = (n - iStart) / iLength clamped to [0, 1];
+// the sine/cosine pair is advanced by plain rotation.
+static void xfade_curve ( float *pCurve, unsigned int iFrames,
+	long iStart, unsigned long iLength, bool bFadeIn )
+{
+	const float fHead = (bFadeIn ? 0.0f : 1.0f);
+	const float fTail = (bFadeIn ? 1.0f : 0.0f);
+
+	unsigned int n = 0;
+	for (; n < iFrames && long(n) < iStart; ++n)
+		*pCurve++ = fHead;
+
+	if (n < iFrames && iLength > 0) {
+		const float fStep = float(M_PI_2) / float(iLength);
+		const float fCosStep = ::cosf(fStep);
+		const float fSinStep = ::sinf(fStep);
+		unsigned long x = (unsigned long) (long(n) - iStart);
+		float fCos = ::cosf(float(x) * fStep);
+		float fSin = ::sinf(float(x) * fStep);
+		for (; n < iFrames && x < iLength; ++n, ++x) {
+			*pCurve++ = (bFadeIn ? fSin : fCos);
+			const float fCos2 = fCos * fCosStep - fSin * fSinStep;
+			fSin = fSin * fCosStep + fCos * fSinStep;
+			fCos = fCos2;
+		}
+	}
+
+	for (; n < iFrames; ++n)
+		*pCurve++ = fTail;
+}
+
+
+//----------------------------------------------------------------------
+// class qtractorAudioBufferThread::Worker -- Ring-cache worker thread.
+//
+
+class qtractorAudioBufferThread::Worker : public QThread
+{
+public:
+
+	// Constructor.
+	Worker(qtractorAudioBufferThread *pSyncThread)
+		: QThread(), m_pSyncThread(pSyncThread) {}
+
+protected:
+
+	// The main thread executive.
+	void run() { m_pSyncThread->run(); }
+
+private:
+
+	// Instance variables.
+	qtractorAudioBufferThread *m_pSyncThread;
+};
+
+
 //----------------------------------------------------------------------
-// class qtractorAudioBufferThread -- Ring-cache manager thread.
+// class qtractorAudioBufferThread -- Ring-cache manager thread pool.
 //
 
+// Default number of worker threads (0=auto).
+unsigned short qtractorAudioBufferThread::g_iDefaultSyncThreads = 0;
+
+
 // Constructor.
 qtractorAudioBufferThread::qtractorAudioBufferThread (
-	unsigned int iSyncSize ) : QThread()
+	unsigned int iSyncSize, unsigned short iSyncThreads )
 {
 	m_iSyncSize = (4 << 1);
 	while (m_iSyncSize < iSyncSize)
 		m_iSyncSize <<= 1;
 	m_iSyncMask = (m_iSyncSize - 1);
-	m_ppSyncItems = new qtractorAudioBuffer * [m_iSyncSize];
+	m_ppSyncItems = new QAtomicPointer<qtractorAudioBuffer> [m_iSyncSize];
 	m_iSyncRead   = 0;
-	m_iSyncWrite  = 0;
+
+	ATOMIC_SET(&m_iSyncWrite, 0);
+
+	if (iSyncThreads < 1)
+		iSyncThreads = 1;
+
+	m_iSyncThreads = iSyncThreads;
+	m_ppWorkers = new Worker * [m_iSyncThreads];
+	for (unsigned short i = 0; i < m_iSyncThreads; ++i)
+		m_ppWorkers[i] = new Worker(this);
 
 	m_bRunState = false;
 }
@@ -57,15 +295,38 @@ qtractorAudioBufferThread::qtractorAudioBufferThread (
 // Destructor.
 qtractorAudioBufferThread::~qtractorAudioBufferThread (void)
 {
-	if (isRunning()) do {
-		setRunState(false);
-	//	terminate();
-		sync();
-	} while (!wait(100));
+	stop();
+
+	for (unsigned short i = 0; i < m_iSyncThreads; ++i)
+		delete m_ppWorkers[i];
+	delete [] m_ppWorkers;
 
 	delete [] m_ppSyncItems;
 }
 
+
+// Worker threads start/stop.
+void qtractorAudioBufferThread::start ( QThread::Priority priority )
+{
+	setRunState(true);
+
+	for (unsigned short i = 0; i < m_iSyncThreads; ++i)
+		m_ppWorkers[i]->start(priority);
+}
+
+void qtractorAudioBufferThread::stop (void)
+{
+	for (unsigned short i = 0; i < m_iSyncThreads; ++i) {
+		Worker *pWorker = m_ppWorkers[i];
+		if (pWorker->isRunning()) do {
+			setRunState(false);
+		//	pWorker->terminate();
+			sync();
+		} while (!pWorker->wait(100));
+	}
+}
+
+
 // Run state accessor.
 void qtractorAudioBufferThread::setRunState ( bool bRunState )
 {
@@ -80,34 +341,41 @@ bool qtractorAudioBufferThread::runState (void) const
 }
 
 
+// Number of worker threads.
+unsigned short qtractorAudioBufferThread::syncThreads (void) const
+{
+	return m_iSyncThreads;
+}
+
+
 // Wake from executive wait condition (RT-safe).
 void qtractorAudioBufferThread::sync ( qtractorAudioBuffer *pAudioBuffer )
 {
+	// Drop all queued and pending requests (eg. on stop)...
 	if (pAudioBuffer == nullptr) {
-		unsigned int r = m_iSyncRead;
-		unsigned int w = m_iSyncWrite;
-		while (r != w) {
-			m_ppSyncItems[r]->setSyncFlag(qtractorAudioBuffer::WaitSync, false);
-			++r &= m_iSyncMask;
-			w = m_iSyncWrite;
-		}
-		m_iSyncRead = r;
-	} else {
-		// !pAudioBuffer->isSyncFlag(qtractorAudioBuffer::WaitSync)
-		unsigned int n;
-		unsigned int r = m_iSyncRead;
-		unsigned int w = m_iSyncWrite;
-		if (w > r) {
-			n = ((r - w + m_iSyncSize) & m_iSyncMask) - 1;
-		} else if (r > w) {
-			n = (r - w) - 1;
-		} else {
-			n = m_iSyncSize - 1;
+		if (m_mutex.tryLock()) {
+			fetch();
+			QListIterator<qtractorAudioBuffer *> iter(m_pending);
+			while (iter.hasNext())
+				iter.next()->setSyncFlag(qtractorAudioBuffer::WaitSync, false);
+			m_pending.clear();
+			m_cond.wakeAll();
+			m_mutex.unlock();
 		}
-		if (n > 0) {
+		return;
+	}
+
+	// Multiple producers (eg. parallel track rendering) may get here...
+	while (pAudioBuffer) {
+		const unsigned int r = m_iSyncRead;
+		const unsigned int w = ATOMIC_GET(&m_iSyncWrite);
+		const unsigned int w1 = (w + 1) & m_iSyncMask;
+		if (w1 == r)
+			break; // Full, try again later...
+		if (ATOMIC_CAS(&m_iSyncWrite, w, w1)) {
 			pAudioBuffer->setSyncFlag(qtractorAudioBuffer::WaitSync);
-			m_ppSyncItems[w] = pAudioBuffer;
-			m_iSyncWrite = (w + 1) & m_iSyncMask;
+			m_ppSyncItems[w].storeRelease(pAudioBuffer);
+			break;
 		}
 	}
 
@@ -126,24 +394,53 @@ void qtractorAudioBufferThread::syncExport (void)
 {
 	QMutexLocker locker(&m_mutex);
 
-	process();
+	// Do it all here and now, also waiting for the busy ones...
+	fetch();
+
+	while (!m_pending.isEmpty() || !m_busy.isEmpty()) {
+		qtractorAudioBuffer *pAudioBuffer = next();
+		if (pAudioBuffer)
+			process(pAudioBuffer);
+		else
+			m_idle.wait(&m_mutex);
+		fetch();
+	}
 }
 
 
-// Thread run executive.
+// Buffer sync de-registration (non RT-safe).
+void qtractorAudioBufferThread::release ( qtractorAudioBuffer *pAudioBuffer )
+{
+	QMutexLocker locker(&m_mutex);
+
+	fetch();
+
+	m_pending.removeAll(pAudioBuffer);
+
+	while (m_busy.contains(pAudioBuffer))
+		m_idle.wait(&m_mutex);
+}
+
+
+// Worker thread executive.
 void qtractorAudioBufferThread::run (void)
 {
 #ifdef CONFIG_DEBUG_0
 	qDebug("qtractorAudioBufferThread[%p]::run(): started.", this);
 #endif
 
-	m_mutex.lock();
+	qtractorAudioEngine::setFlushDenormals();
 
-	m_bRunState = true;
+	m_mutex.lock();
 
 	while (m_bRunState) {
 		// Do whatever we must, then wait for more...
-		process();
+		fetch();
+		qtractorAudioBuffer *pAudioBuffer = next();
+		if (pAudioBuffer) {
+			process(pAudioBuffer);
+			continue;
+		}
 		// Wait for sync...
 		m_cond.wait(&m_mutex);
 	}
@@ -156,40 +453,81 @@ void qtractorAudioBufferThread::run (void)
 }
 
 
-// Thread run executive.
-void qtractorAudioBufferThread::process (void)
+// Move all queued sync requests into pending (locked).
+void qtractorAudioBufferThread::fetch (void)
 {
 	unsigned int r = m_iSyncRead;
-	unsigned int w = m_iSyncWrite;
 
-	while (r != w) {
-		m_ppSyncItems[r]->sync();
+	while (r != (unsigned int) ATOMIC_GET(&m_iSyncWrite)) {
+		// Slot reserved but not quite stored yet?
+		qtractorAudioBuffer *pAudioBuffer = m_ppSyncItems[r].loadAcquire();
+		if (pAudioBuffer == nullptr)
+			break;
+		m_ppSyncItems[r].storeRelease(nullptr);
+		if (!m_pending.contains(pAudioBuffer))
+			m_pending.append(pAudioBuffer);
 		++r &= m_iSyncMask;
-		w = m_iSyncWrite;
+		m_iSyncRead = r;
 	}
-
-	m_iSyncRead = r;
 }
 
 
-// Conditional resize check.
-void qtractorAudioBufferThread::checkSyncSize ( unsigned int iSyncSize )
+// Most urgent pending buffer, nearest to under-run (locked).
+qtractorAudioBuffer *qtractorAudioBufferThread::next (void)
 {
-	if (iSyncSize > (m_iSyncSize - 4)) {
-		QMutexLocker locker(&m_mutex);
-		unsigned int iNewSyncSize = (m_iSyncSize << 1);
-		while (iNewSyncSize < iSyncSize)
-			iNewSyncSize <<= 1;
-		qtractorAudioBuffer **ppNewSyncItems
-			= new qtractorAudioBuffer * [iNewSyncSize];
-		qtractorAudioBuffer **ppOldSyncItems = m_ppSyncItems;
-		::memcpy(ppNewSyncItems, ppOldSyncItems,
-			m_iSyncSize * sizeof(qtractorAudioBuffer *));
-		m_iSyncSize = iNewSyncSize;
-		m_iSyncMask = (iNewSyncSize - 1);
-		m_ppSyncItems = ppNewSyncItems;
-		delete [] ppOldSyncItems;
+	int iNext = -1;
+	unsigned int iNextPriority = 0;
+
+	// Current play-head, for the deadline of pending hard-syncs...
+	unsigned long iFrame = 0;
+	qtractorSession *pSession = qtractorSession::getInstance();
+	if (pSession)
+		iFrame = pSession->playHead();
+
+	const int iCount = m_pending.count();
+	for (int i = 0; i < iCount; ++i) {
+		qtractorAudioBuffer *pAudioBuffer = m_pending.at(i);
+		if (m_busy.contains(pAudioBuffer))
+			continue;
+		const unsigned int iPriority = pAudioBuffer->syncPriority(iFrame);
+		if (iNext < 0 || iNextPriority > iPriority) {
+			iNextPriority = iPriority;
+			iNext = i;
+		}
 	}
+
+	if (iNext < 0)
+		return nullptr;
+
+	qtractorAudioBuffer *pAudioBuffer = m_pending.takeAt(iNext);
+	m_busy.append(pAudioBuffer);
+	return pAudioBuffer;
+}
+
+
+// Sync the given buffer, out of lock (locked).
+void qtractorAudioBufferThread::process ( qtractorAudioBuffer *pAudioBuffer )
+{
+	m_mutex.unlock();
+
+	pAudioBuffer->sync();
+
+	m_mutex.lock();
+
+	m_busy.removeAll(pAudioBuffer);
+	m_idle.wakeAll();
+}
+
+
+// Default number of worker threads (0=auto).
+void qtractorAudioBufferThread::setDefaultSyncThreads ( unsigned short iSyncThreads )
+{
+	g_iDefaultSyncThreads = iSyncThreads;
+}
+
+unsigned short qtractorAudioBufferThread::defaultSyncThreads (void)
+{
+	return g_iDefaultSyncThreads;
 }
 
 
@@ -229,6 +567,8 @@ qtractorAudioBuffer::qtractorAudioBuffer (
 
 	ATOMIC_SET(&m_seekPending, 0);
 
+	m_iSyncDeadline  = 0;
+
 	m_ppFrames       = nullptr;
 	m_ppBuffer       = nullptr;
 
@@ -248,6 +588,11 @@ qtractorAudioBuffer::qtractorAudioBuffer (
 	m_fNextGain      = 0.0f;
 	m_iRampGain      = 0;
 
+	m_iCrossFade     = 0;
+	m_iCrossFadeStart = 0;
+	m_iCrossFadeLength = 0;
+	m_pfCrossFade    = nullptr;
+
 #ifdef CONFIG_LIBSAMPLERATE
 	m_bResample      = false;
 	m_fResampleRatio = 1.0f;
@@ -259,16 +604,52 @@ qtractorAudioBuffer::qtractorAudioBuffer (
 
 	m_pPeakFile      = nullptr;
 
+	m_bCacheInRam    = false;
+	m_pCacheItem     = nullptr;
+	m_bCacheLoad     = false;
+
+	m_pStretchItem   = nullptr;
+	m_bStretchRender = false;
+	m_bResampleRender = false;
+
+	m_iCaptureHighWater = 0;
+	m_iCaptureRisks  = 0;
+	m_bCaptureRisk   = false;
+
 	// Time-stretch mode local options.
 	m_bWsolaTimeStretch = g_bDefaultWsolaTimeStretch;
 	m_bWsolaQuickSeek   = g_bDefaultWsolaQuickSeek;
 
+#if defined(__SSE__)
+	if (sse_enabled())
+		m_pfnGainRampAdd = sse_gain_ramp_add;
+	else
+#endif
+#if defined(__ARM_NEON__)
+	m_pfnGainRampAdd = neon_gain_ramp_add;
+	if (false)
+#endif
+		m_pfnGainRampAdd = std_gain_ramp_add;
+
+#if defined(__SSE__)
+	if (sse_enabled())
+		m_pfnGainCurveAdd = sse_gain_curve_add;
+	else
+#endif
+#if defined(__ARM_NEON__)
+	m_pfnGainCurveAdd = neon_gain_curve_add;
+	if (false)
+#endif
+		m_pfnGainCurveAdd = std_gain_curve_add;
 }
 
 // Default destructor.
 qtractorAudioBuffer::~qtractorAudioBuffer (void)
 {
 	close();
+
+	if (m_pSyncThread)
+		m_pSyncThread->release(this);
 }
 
 
@@ -323,16 +704,41 @@ bool qtractorAudioBuffer::open ( const QString& sFilename, int iMode )
 
 	const unsigned int iSampleRate = pSession->sampleRate();
 
+	unsigned int iStretchFlags = qtractorTimeStretcher::None;
+	if (m_bWsolaTimeStretch)
+		iStretchFlags |= qtractorTimeStretcher::WsolaTimeStretch;
+	if (m_bWsolaQuickSeek)
+		iStretchFlags |= qtractorTimeStretcher::WsolaQuickSeek;
+
+	// Whether there's a pre-rendered time-stretch/pitch-shift file
+	// ready to play as plain audio (otherwise get it scheduled)...
+	QString sOpenFilename = sFilename;
+	qtractorAudioStretchCache *pStretchCache = pSession->audioStretchCache();
+	if (pStretchCache && (m_bTimeStretch || m_bPitchShift)
+		&& (iMode & qtractorAudioFile::Write) == 0) {
+		m_pStretchItem = pStretchCache->acquire(sFilename, iSampleRate,
+			m_fTimeStretch, m_fPitchShift, iStretchFlags);
+		if (m_pStretchItem && m_pStretchItem->isReady()) {
+			sOpenFilename = m_pStretchItem->renderFile();
+			m_bStretchRender = true;
+		}
+	}
+
 	// Get proper file type class...
 	m_pFile = qtractorAudioFileFactory::createAudioFile(
-		sFilename, m_iChannels, iSampleRate);
+		sOpenFilename, m_iChannels, iSampleRate);
 	if (m_pFile == nullptr)
 		return false;
 
 	// Go open it...
-	if (!m_pFile->open(sFilename, iMode)) {
+	if (!m_pFile->open(sOpenFilename, iMode)) {
 		delete m_pFile;
 		m_pFile = nullptr;
+		// Fallback to live processing, if rendered one is gone...
+		if (m_bStretchRender) {
+			pStretchCache->invalidate(m_pStretchItem);
+			return open(sFilename, iMode);
+		}
 		return false;
 	}
 
@@ -348,6 +754,32 @@ bool qtractorAudioBuffer::open ( const QString& sFilename, int iMode )
 	}
 
 #ifdef CONFIG_LIBSAMPLERATE
+	// Whether there's a pre-converted sample-rate file
+	// ready to play as is (otherwise get it scheduled)...
+	if (pStretchCache && m_pStretchItem == nullptr
+		&& iSampleRate != m_pFile->sampleRate()
+		&& (iMode & qtractorAudioFile::Write) == 0) {
+		m_pStretchItem = pStretchCache->acquire(sFilename, iSampleRate,
+			1.0f, 1.0f, qtractorTimeStretcher::None);
+		if (m_pStretchItem && m_pStretchItem->isReady()) {
+			const QString& sRenderFile = m_pStretchItem->renderFile();
+			qtractorAudioFile *pFile = qtractorAudioFileFactory::createAudioFile(
+				sRenderFile, m_iChannels, iSampleRate);
+			if (pFile && pFile->open(sRenderFile, iMode)
+				&& pFile->channels() == iBuffers) {
+				m_pFile->close();
+				delete m_pFile;
+				m_pFile = pFile;
+				sOpenFilename = sRenderFile;
+				m_bResampleRender = true;
+			} else {
+				if (pFile)
+					delete pFile;
+				pStretchCache->invalidate(m_pStretchItem);
+			}
+		}
+	}
+
 	// Compute sample rate converter stuff.
 	m_iInputPending  = 0;
 	m_fResampleRatio = 1.0f;
@@ -369,16 +801,39 @@ bool qtractorAudioBuffer::open ( const QString& sFilename, int iMode )
 			m_iOffset = 0;
 	}
 
-	// Allocate ring-buffer now.
+	// Allocate ring-buffer now
+	// (recording gets a whole second of headroom).
 	unsigned int iBufferSize = m_iLength;
+	if (m_pFile->mode() & qtractorAudioFile::Write)
+		iBufferSize = iSampleRate;
+	else
 	if (iBufferSize == 0)
 		iBufferSize = (iSampleRate >> 1);
 	else
 	if (iBufferSize > (iSampleRate << 2))
 		iBufferSize = (iSampleRate << 2);
 
-	m_pRingBuffer = new qtractorRingBuffer<float> (iBuffers, iBufferSize);
-	m_iThreshold  = (m_pRingBuffer->bufferSize() >> 2);
+	// Whether it may be (or already is) decoded in the session RAM cache,
+	// then the ring-buffer is the whole (shared) thing, integrally...
+	qtractorAudioCache *pAudioCache = pSession->audioCache();
+	if (pAudioCache && m_iLength > 0
+		&& (m_pFile->mode() & qtractorAudioFile::Read)) {
+		m_pCacheItem = pAudioCache->acquire(cacheKey(sOpenFilename),
+			iBuffers, m_iLength + 2, m_bCacheInRam);
+	}
+
+	if (m_pCacheItem) {
+		m_pRingBuffer = new qtractorRingBuffer<float> (iBuffers,
+			m_pCacheItem->bufferSize(), m_pCacheItem->frames());
+		// Keep I/O block sizes as usual...
+		m_iThreshold = 4096;
+		while (m_iThreshold < iBufferSize)
+			m_iThreshold <<= 1;
+		m_iThreshold >>= 2;
+	} else {
+		m_pRingBuffer = new qtractorRingBuffer<float> (iBuffers, iBufferSize);
+		m_iThreshold  = (m_pRingBuffer->bufferSize() >> 2);
+	}
 	m_iBufferSize = (m_iThreshold >> 2);
 
 #ifdef CONFIG_LIBSAMPLERATE
@@ -397,14 +852,9 @@ bool qtractorAudioBuffer::open ( const QString& sFilename, int iMode )
 		m_ppFrames[i] = new float [m_iBufferSize];
 
 	// Allocate time-stretch engine whether needed...
-	if (m_bTimeStretch || m_bPitchShift) {
-		unsigned int iFlags = qtractorTimeStretcher::None;
-		if (m_bWsolaTimeStretch)
-			iFlags |= qtractorTimeStretcher::WsolaTimeStretch;
-		if (m_bWsolaQuickSeek)
-			iFlags |= qtractorTimeStretcher::WsolaQuickSeek;
+	if ((m_bTimeStretch || m_bPitchShift) && !m_bStretchRender) {
 		m_pTimeStretcher = new qtractorTimeStretcher(iBuffers, iSampleRate,
-			m_fTimeStretch, m_fPitchShift, iFlags, m_iBufferSize);
+			m_fTimeStretch, m_fPitchShift, iStretchFlags, m_iBufferSize);
 	}
 
 #ifdef CONFIG_LIBSAMPLERATE
@@ -421,6 +871,9 @@ bool qtractorAudioBuffer::open ( const QString& sFilename, int iMode )
 
 	// Consider it done when recording...
 	if (m_pFile->mode() & qtractorAudioFile::Write) {
+		m_iCaptureHighWater = 0;
+		m_iCaptureRisks = 0;
+		m_bCaptureRisk = false;
 		setSyncFlag(InitSync);
 	} else {
 		// Get a reasonablebuffer size for readMix()...
@@ -431,6 +884,8 @@ bool qtractorAudioBuffer::open ( const QString& sFilename, int iMode )
 		m_ppBuffer = new float * [iBuffers];
 		for (i = 0; i < iBuffers; ++i)
 			m_ppBuffer[i] = new float [iBufferSize];
+		// And the crossfade gain curve...
+		m_pfCrossFade = new float [iBufferSize];
 	}
 
 	// Rebuild the whole panning-gain array...
@@ -462,6 +917,16 @@ bool qtractorAudioBuffer::open ( const QString& sFilename, int iMode )
 // Operational buffer terminator.
 void qtractorAudioBuffer::close (void)
 {
+	// Release the pre-rendered time-stretch item, if any...
+	if (m_pStretchItem) {
+		qtractorSession *pSession = qtractorSession::getInstance();
+		if (pSession)
+			pSession->audioStretchCache()->release(m_pStretchItem);
+		m_pStretchItem = nullptr;
+		m_bStretchRender = false;
+		m_bResampleRender = false;
+	}
+
 	if (m_pFile == nullptr)
 		return;
 
@@ -508,12 +973,28 @@ void qtractorAudioBuffer::close (void)
 		m_ppBuffer = nullptr;
 	}
 
+	if (m_pfCrossFade) {
+		delete [] m_pfCrossFade;
+		m_pfCrossFade = nullptr;
+	}
+
+	m_iCrossFade = 0;
+
 	if (m_pRingBuffer) {
 		deleteIOBuffers();
 		delete m_pRingBuffer;
 		m_pRingBuffer = nullptr;
 	}
 
+	// Release the session RAM cache item, if any...
+	if (m_pCacheItem) {
+		qtractorSession *pSession = qtractorSession::getInstance();
+		if (pSession)
+			pSession->audioCache()->release(m_pCacheItem);
+		m_pCacheItem = nullptr;
+		m_bCacheLoad = false;
+	}
+
 	// Finally delete what we still own.
 	if (m_pFile) {
 		delete m_pFile;
@@ -555,11 +1036,21 @@ int qtractorAudioBuffer::read ( float **ppFrames, unsigned int iFrames,
 	unsigned long ls = m_iLoopStart;
 	unsigned long le = m_iLoopEnd;
 
+	// Still decoding into the session RAM cache? ring-buffer
+	// indexes are the clip frame positions, as if integral...
+	const bool bIntegral = (m_bIntegral || m_bCacheLoad);
+
 	// Are we off decoded file limits (EoS)?
 	if (ro >= m_iFileLength) {
+		// Not decoded that far yet? force a late seek...
+		if (m_bCacheLoad && ro < m_iOffset + m_iLength) {
+			m_iReadOffset = m_iOffset + m_iLength + 1;
+			setSyncFlag(ReadSync, false);
+			return iFrames;
+		}
 		nread = iFrames;
 		if (ls < le) {
-			if (m_bIntegral) {
+			if (bIntegral) {
 				const unsigned int ri = m_pRingBuffer->readIndex();
 				while (ri < le && ri + nread >= le) {
 					nread -= le - ri;
@@ -583,7 +1074,7 @@ int qtractorAudioBuffer::read ( float **ppFrames, unsigned int iFrames,
 
 	// Are we in the middle of the loop range ?
 	if (ls < le) {
-		if (m_bIntegral) {
+		if (bIntegral) {
 			const unsigned int ri = m_pRingBuffer->readIndex();
 			while (ri < le && ri + iFrames >= le) {
 				nread = m_pRingBuffer->read(ppFrames, le - ri, iOffset);
@@ -613,7 +1104,7 @@ int qtractorAudioBuffer::read ( float **ppFrames, unsigned int iFrames,
 	}
 
 	// Time to sync()?
-	if (!m_bIntegral &&
+	if (!bIntegral &&
 		m_pSyncThread && m_pRingBuffer->writable() > m_iThreshold)
 		m_pSyncThread->sync(this);
 
@@ -658,15 +1149,15 @@ int qtractorAudioBuffer::write ( float **ppFrames, unsigned int iFrames,
 			if (iChannels > iBuffers) {
 				for (i = 0, j = 0; i < iBuffers; ++i, ++j) {
 					for (n = 0; n < n1; ++n)
-						ppBuffer[j][n + w] = ppFrames[i][n] + iOffset;
+						ppBuffer[j][n + w] = ppFrames[i][n + iOffset];
 					for (n = 0; n < n2; ++n)
-						ppBuffer[j][n] = ppFrames[i][n + n1] + iOffset;
+						ppBuffer[j][n] = ppFrames[i][n + n1 + iOffset];
 				}
 				for (j = 0; i < iChannels; ++i) {
 					for (n = 0; n < n1; ++n)
-						ppBuffer[j][n + w] += ppFrames[i][n] + iOffset;
+						ppBuffer[j][n + w] += ppFrames[i][n + iOffset];
 					for (n = 0; n < n2; ++n)
-						ppBuffer[j][n] += ppFrames[i][n + n1] + iOffset;
+						ppBuffer[j][n] += ppFrames[i][n + n1 + iOffset];
 					if (++j >= iBuffers)
 						j = 0;
 				}
@@ -674,9 +1165,9 @@ int qtractorAudioBuffer::write ( float **ppFrames, unsigned int iFrames,
 				i = 0;
 				for (j = 0; j < iBuffers; ++j) {
 					for (n = 0; n < n1; ++n)
-						ppBuffer[j][n + w] = ppFrames[i][n] + iOffset;
+						ppBuffer[j][n + w] = ppFrames[i][n + iOffset];
 					for (n = 0; n < n2; ++n)
-						ppBuffer[j][n] = ppFrames[i][n + n1] + iOffset;
+						ppBuffer[j][n] = ppFrames[i][n + n1 + iOffset];
 					if (++i >= iChannels)
 						i = 0;
 				}
@@ -685,6 +1176,18 @@ int qtractorAudioBuffer::write ( float **ppFrames, unsigned int iFrames,
 		}
 	}
 
+	// Capture statistics: high-water mark and overrun risks...
+	const unsigned int rs = m_pRingBuffer->readable();
+	if (m_iCaptureHighWater < rs)
+		m_iCaptureHighWater = rs;
+	const bool bCaptureRisk = (nwrite < iFrames
+		|| rs > ((m_pRingBuffer->bufferSize() * 3) >> 2));
+	if (bCaptureRisk && !m_bCaptureRisk) {
+		m_captureRisks[m_iCaptureRisks % CaptureRisks] = m_iWriteOffset;
+		++m_iCaptureRisks;
+	}
+	m_bCaptureRisk = bCaptureRisk;
+
 	// Make it statiscally correct...
 	m_iWriteOffset += nwrite;
 
@@ -709,10 +1212,20 @@ int qtractorAudioBuffer::readMix ( float **ppFrames, unsigned int iFrames,
 	unsigned long ls = m_iLoopStart;
 	unsigned long le = m_iLoopEnd;
 
+	// Still decoding into the session RAM cache? ring-buffer
+	// indexes are the clip frame positions, as if integral...
+	const bool bIntegral = (m_bIntegral || m_bCacheLoad);
+
 	// Are we off decoded file limits (EoS)?
 	if (ro >= m_iFileLength) {
+		// Not decoded that far yet? force a late seek...
+		if (m_bCacheLoad && ro < m_iOffset + m_iLength) {
+			m_iReadOffset = m_iOffset + m_iLength + 1;
+			setSyncFlag(ReadSync, false);
+			return iFrames;
+		}
 		if (ls < le) {
-			if (m_bIntegral) {
+			if (bIntegral) {
 				const unsigned int ri = m_pRingBuffer->readIndex();
 				while (ri < le && ri + nread >= le && nread > 0) {
 					nread -= le - ri;
@@ -736,7 +1249,7 @@ int qtractorAudioBuffer::readMix ( float **ppFrames, unsigned int iFrames,
 
 	// Are we in the middle of the loop range ?
 	if (ls < le) {
-		if (m_bIntegral) {
+		if (bIntegral) {
 			const unsigned int ri = m_pRingBuffer->readIndex();
 			while (ri < le && ri + iFrames >= le && nread > 0) {
 				m_iRampGain = -1;
@@ -773,7 +1286,7 @@ int qtractorAudioBuffer::readMix ( float **ppFrames, unsigned int iFrames,
 	}
 
 	// Time to sync()?
-	if (!m_bIntegral &&
+	if (!bIntegral &&
 		m_pSyncThread && m_pRingBuffer->writable() > m_iThreshold)
 		m_pSyncThread->sync(this);
 
@@ -793,7 +1306,7 @@ int qtractorAudioBuffer::readMux ( float **ppFrames, unsigned int iFrames,
 
 	const unsigned short iBuffers = m_pRingBuffer->channels();
 
-	unsigned short i, j; int n;
+	unsigned short i, j;
 	float *pFrames, *pBuffer;
 	float fGainIter;
 
@@ -807,8 +1320,7 @@ int qtractorAudioBuffer::readMux ( float **ppFrames, unsigned int iFrames,
 			pFrames = ppFrames[i] + iOffset;
 			pBuffer = m_ppBuffer[i];
 			fGainIter = fPrevGain * m_pfGains[i];
-			for (n = 0; n < nread; ++n)
-				*pFrames++ += fGainIter * *pBuffer++;
+			(*m_pfnGainRampAdd)(pFrames, pBuffer, nread, fGainIter, 0.0f);
 		}
 	}
 	else if (iChannels > iBuffers) {
@@ -817,8 +1329,7 @@ int qtractorAudioBuffer::readMux ( float **ppFrames, unsigned int iFrames,
 			pFrames = ppFrames[i] + iOffset;
 			pBuffer = m_ppBuffer[j];
 			fGainIter = fPrevGain * m_pfGains[j];
-			for (n = 0; n < nread; ++n)
-				*pFrames++ += fGainIter * *pBuffer++;
+			(*m_pfnGainRampAdd)(pFrames, pBuffer, nread, fGainIter, 0.0f);
 			if (++j >= iBuffers)
 				j = 0;
 		}
@@ -829,8 +1340,7 @@ int qtractorAudioBuffer::readMux ( float **ppFrames, unsigned int iFrames,
 			pFrames = ppFrames[i] + iOffset;
 			pBuffer = m_ppBuffer[j];
 			fGainIter = fPrevGain * m_pfGains[j];
-			for (n = 0; n < nread; ++n)
-				*pFrames++ += fGainIter * *pBuffer++;
+			(*m_pfnGainRampAdd)(pFrames, pBuffer, nread, fGainIter, 0.0f);
 			if (++i >= iChannels)
 				i = 0;
 		}
@@ -840,8 +1350,8 @@ int qtractorAudioBuffer::readMux ( float **ppFrames, unsigned int iFrames,
 }
 
 
-// Buffer data seek.
-bool qtractorAudioBuffer::seek ( unsigned long iFrame )
+// Buffer data seek (hard-seek due by the given session frame).
+bool qtractorAudioBuffer::seek ( unsigned long iFrame, unsigned long iSyncDeadline )
 {
 	if (m_pRingBuffer == nullptr)
 		return false;
@@ -868,8 +1378,15 @@ bool qtractorAudioBuffer::seek ( unsigned long iFrame )
 	setSyncFlag(ReadSync, false);
 	setSyncFlag(WaitSync, false);
 
+	// Still decoding into the session RAM cache, but not there yet?
+	// Stay out-of-sync, till next time around (never a hard-seek)...
+	if (m_bCacheLoad && iFrame >= m_pRingBuffer->writeIndex()) {
+		m_iReadOffset = m_iOffset + m_iLength + 1; // An unlikely offset!
+		return true;
+	}
+
 	// Special case on integral cached files...
-	if (m_bIntegral) {
+	if (m_bIntegral || m_bCacheLoad) {
 		m_pRingBuffer->setReadIndex(iFrame);
 	//	m_iWriteOffset = m_iOffset + iFrame;
 		m_iReadOffset  = m_iOffset + iFrame;
@@ -907,6 +1424,8 @@ bool qtractorAudioBuffer::seek ( unsigned long iFrame )
 	m_iReadOffset = m_iOffset + m_iLength + 1; // An unlikely offset!
 	m_iSeekOffset = iFrame;
 
+	m_iSyncDeadline = iSyncDeadline;
+
 	ATOMIC_INC(&m_seekPending);
 
 	// readSync();
@@ -949,6 +1468,12 @@ void qtractorAudioBuffer::initSync (void)
 	if (isSyncFlag(CloseSync))
 		return;
 #endif
+	// Still decoding into the session RAM cache?
+	if (m_pCacheItem && m_bCacheLoad) {
+		cacheSync();
+		return;
+	}
+
 	// Reset all relevant state variables.
 	setSyncFlag(ReadSync, false);
 
@@ -965,6 +1490,35 @@ void qtractorAudioBuffer::initSync (void)
 	m_fNextGain = 0.0f;
 	m_iRampGain = (m_iOffset == 0 ? 0 : 1);
 
+	// Already decoded in the session RAM cache?
+	if (m_pCacheItem) {
+		m_pCacheItem->lock();
+		const bool bLoaded = m_pCacheItem->isLoaded();
+		const unsigned int iFrames = m_pCacheItem->loadedFrames();
+		m_pCacheItem->unlock();
+		if (bLoaded) {
+			m_pRingBuffer->setReadIndex(0);
+			m_pRingBuffer->setWriteIndex(iFrames);
+			m_iReadOffset  = m_iOffset;
+			m_iWriteOffset = m_iOffset + iFrames;
+			m_iFileLength  = m_iWriteOffset;
+			m_bIntegral = true;
+			deleteIOBuffers();
+			setSyncFlag(InitSync);
+			setSyncFlag(CloseSync, false);
+			return;
+		}
+		// We're the (exclusive) owner, decode it block by block...
+		if (seekSync(m_iOffset)) {
+			m_pRingBuffer->reset();
+			m_iWriteOffset = m_iOffset;
+			m_iReadOffset  = m_iOffset;
+			m_bCacheLoad = true;
+			cacheSync();
+			return;
+		}
+	}
+
 	// Set to initial offset...
 	m_iSeekOffset = m_iOffset;
 
@@ -1009,13 +1563,18 @@ void qtractorAudioBuffer::sync (void)
 		return;
 
 	if (!isSyncFlag(InitSync)) {
-		initSync();
+		// Initial sync might get re-queued (eg. cache decoding)...
 		setSyncFlag(WaitSync, false);
+		initSync();
 	} else {
 		setSyncFlag(WaitSync, false);
 		const int mode = m_pFile->mode();
-		if (mode & qtractorAudioFile::Read)
-			readSync();
+		if (mode & qtractorAudioFile::Read) {
+			if (m_bCacheLoad)
+				cacheSync();
+			else
+				readSync();
+		}
 		else
 		if (mode & qtractorAudioFile::Write)
 			writeSync();
@@ -1045,6 +1604,8 @@ bool qtractorAudioBuffer::inSync (
 
 	if (m_iReadOffset == iFrameStart + m_iOffset) {
 		setSyncFlag(ReadSync);
+		if (m_pCacheItem)
+			m_pCacheItem->touch();
 		return true;
 	}
 
@@ -1053,6 +1614,34 @@ bool qtractorAudioBuffer::inSync (
 }
 
 
+// Sync urgency (the lower, the nearer to under-run).
+unsigned int qtractorAudioBuffer::syncPriority ( unsigned long iFrame ) const
+{
+	if (m_pFile == nullptr || m_pRingBuffer == nullptr)
+		return 0;
+
+	if (isSyncFlag(CloseSync))
+		return 0;
+
+	// Initial or hard-seek: frames left until its deadline...
+	if (!isSyncFlag(InitSync) || ATOMIC_GET(&m_seekPending) > 0) {
+		const unsigned long iSyncDeadline = m_iSyncDeadline;
+		if (iSyncDeadline <= iFrame)
+			return 0;
+		if (iSyncDeadline - iFrame > 0x7fffffffUL)
+			return 0x7fffffff;
+		return (iSyncDeadline - iFrame);
+	}
+
+	// Recording: the less writable, the more urgent...
+	if (m_pFile->mode() & qtractorAudioFile::Write)
+		return m_pRingBuffer->writable();
+
+	// Playback: the less readable, the more urgent...
+	return m_pRingBuffer->readable();
+}
+
+
 // Export-mode sync executive.
 void qtractorAudioBuffer::syncExport (void)
 {
@@ -1081,10 +1670,14 @@ void qtractorAudioBuffer::readSync (void)
 		m_iReadOffset  = m_iSeekOffset;
 	}
 
-	const unsigned int ws = m_pRingBuffer->writable();
+	unsigned int ws = m_pRingBuffer->writable();
 	if (ws == 0)
 		return;
 
+	// Decoding into the session RAM cache goes in slices...
+	if (m_bCacheLoad && ws > (m_iThreshold << 2))
+		ws = (m_iThreshold << 2);
+
 	unsigned int nahead = ws;
 	unsigned int ntotal = 0;
 
@@ -1092,8 +1685,8 @@ void qtractorAudioBuffer::readSync (void)
 		// Take looping into account, if any...
 		const unsigned long ls = m_iOffset + m_iLoopStart;
 		const unsigned long le = m_iOffset + m_iLoopEnd;
-		const bool bLooping
-			= (ls < le && m_iWriteOffset < le && isSyncFlag(InitSync));
+		const bool bLooping = (ls < le && m_iWriteOffset < le
+			&& isSyncFlag(InitSync) && !m_bCacheLoad);
 		// Adjust request for sane size...
 		if (nahead > m_iBufferSize)
 			nahead = m_iBufferSize;
@@ -1138,13 +1731,78 @@ void qtractorAudioBuffer::readSync (void)
 }
 
 
+// Incremental session RAM cache decoding (initialized as soon as
+// the first threshold is in, the rest goes on in the background).
+void qtractorAudioBuffer::cacheSync (void)
+{
+	// Closing in the middle of it? Just give up...
+	if (isSyncFlag(CloseSync)) {
+		m_bCacheLoad = false;
+		setSyncFlag(InitSync);
+		setSyncFlag(CloseSync, false);
+		return;
+	}
+
+	// Decode another slice in...
+	const unsigned long iWriteOffset = m_iWriteOffset;
+	readSync();
+
+	// Not at end-of-file yet? Come back later,
+	// leaving room for any other more urgent ones...
+	if (m_iWriteOffset - iWriteOffset >= (m_iThreshold << 2)
+		&& m_iWriteOffset < m_iOffset + m_iLength
+		&& m_pRingBuffer->writable() > 0) {
+		// Good enough to start playing from the clip start?
+		if (!isSyncFlag(InitSync)) {
+			if (m_iWriteOffset >= m_iOffset + m_iThreshold) {
+				setSyncFlag(InitSync);
+			} else {
+				qtractorSession *pSession = qtractorSession::getInstance();
+				if (pSession)
+					m_iSyncDeadline = pSession->playHead() + m_iThreshold;
+			}
+		}
+		if (m_pSyncThread)
+			m_pSyncThread->sync(this);
+		return;
+	}
+
+	// Done decoding into the session RAM cache?
+	if (m_iFileLength < m_iOffset + m_pRingBuffer->bufferSize() - 1) {
+		m_bIntegral = true;
+		m_bCacheLoad = false;
+		setSyncFlag(InitSync);
+		deleteIOBuffers();
+		m_pCacheItem->lock();
+		m_pCacheItem->setLoaded(m_iFileLength - m_iOffset);
+		m_pCacheItem->unlock();
+	} else {
+		m_bCacheLoad = false;
+		setSyncFlag(InitSync);
+		// Re-sync if loop falls short in initial area...
+		if (m_iLoopStart < m_iLoopEnd
+			&& m_iWriteOffset >= m_iOffset + m_iLoopEnd) {
+			m_iSeekOffset = m_iOffset;
+			ATOMIC_INC(&m_seekPending);
+			readSync();
+		}
+	}
+
+	setSyncFlag(CloseSync, false);
+}
+
+
 // Write-mode sync executive.
 void qtractorAudioBuffer::writeSync (void)
 {
 	if (m_pRingBuffer == nullptr)
 		return;
 
-	const unsigned int rs = m_pRingBuffer->readable();
+	unsigned int rs = m_pRingBuffer->readable();
+
+	// Write out in whole (large) blocks only, unless closing...
+	if (!isSyncFlag(CloseSync))
+		rs -= (rs % m_iBufferSize);
 	if (rs == 0)
 		return;
 
@@ -1397,6 +2055,26 @@ int qtractorAudioBuffer::readMixFrames (
 	//	fPrevGain = fGain;
 	}
 
+	// Equal-power crossfade over overlapping clips...
+	if (m_iCrossFade) {
+		xfade_curve(m_pfCrossFade, nread,
+			m_iCrossFadeStart - long(iOffset), m_iCrossFadeLength,
+			(m_iCrossFade > 0));
+		m_fNextGain = m_fGain * fGain;
+		i = j = 0;
+		const unsigned short iMixes
+			= (iChannels > iBuffers ? iChannels : iBuffers);
+		for (unsigned short k = 0; k < iMixes; ++k) {
+			(*m_pfnGainCurveAdd)(ppFrames[i] + iOffset, m_ppBuffer[j],
+				m_pfCrossFade, nread, m_fNextGain * m_pfGains[j]);
+			if (++i >= iChannels)
+				i = 0;
+			if (++j >= iBuffers)
+				j = 0;
+		}
+		return nread;
+	}
+
 	// Reset running gain...
 	const float fNextGain = m_fGain * fGain;
 	const float fPrevGain = (m_fNextGain < 1E-9f ? fNextGain : m_fNextGain);
@@ -1409,8 +2087,8 @@ int qtractorAudioBuffer::readMixFrames (
 			pBuffer = m_ppBuffer[i];
 			fGainIter = fPrevGain * m_pfGains[i];
 			fGainStep2 = fGainStep1 * m_pfGains[i];
-			for (n = 0; n < nread; ++n, fGainIter += fGainStep2)
-				*pFrames++ += fGainIter * *pBuffer++;
+			(*m_pfnGainRampAdd)(pFrames, pBuffer, nread,
+				fGainIter, fGainStep2);
 		}
 	}
 	else if (iChannels > iBuffers) {
@@ -1420,8 +2098,8 @@ int qtractorAudioBuffer::readMixFrames (
 			pBuffer = m_ppBuffer[j];
 			fGainIter = fPrevGain * m_pfGains[j];
 			fGainStep2 = fGainStep1 * m_pfGains[j];
-			for (n = 0; n < nread; ++n, fGainIter += fGainStep2)
-				*pFrames++ += fGainIter * *pBuffer++;
+			(*m_pfnGainRampAdd)(pFrames, pBuffer, nread,
+				fGainIter, fGainStep2);
 			if (++j >= iBuffers)
 				j = 0;
 		}
@@ -1433,8 +2111,8 @@ int qtractorAudioBuffer::readMixFrames (
 			pBuffer = m_ppBuffer[j];
 			fGainIter = fPrevGain * m_pfGains[j];
 			fGainStep2 = fGainStep1 * m_pfGains[j];
-			for (n = 0; n < nread; ++n, fGainIter += fGainStep2)
-				*pFrames++ += fGainIter * *pBuffer++;
+			(*m_pfnGainRampAdd)(pFrames, pBuffer, nread,
+				fGainIter, fGainStep2);
 			if (++i >= iChannels)
 				i = 0;
 		}
@@ -1490,7 +2168,7 @@ void qtractorAudioBuffer::deleteIOBuffers (void)
 
 
 // Reset this buffers state.
-void qtractorAudioBuffer::reset ( bool bLooping )
+void qtractorAudioBuffer::reset ( bool bLooping, unsigned long iSyncDeadline )
 {
 	if (m_pRingBuffer == nullptr)
 		return;
@@ -1507,7 +2185,54 @@ void qtractorAudioBuffer::reset ( bool bLooping )
 			m_iReadOffset = m_iOffset + m_iLength + 1;
 	}
 
-	seek(iFrame);
+	// Due when play-head gets here next time around...
+	seek(iFrame, iSyncDeadline);
+}
+
+
+// Deadline-aware read-ahead (due by the given session frame).
+void qtractorAudioBuffer::preRoll ( unsigned long iSyncDeadline )
+{
+	if (m_pRingBuffer == nullptr)
+		return;
+
+	if (m_pFile == nullptr)
+		return;
+	if (m_pFile->mode() & qtractorAudioFile::Write)
+		return;
+
+	// Initial sync or hard-seek already on its way?
+	if (!isSyncFlag(InitSync) || ATOMIC_GET(&m_seekPending) > 0) {
+		// Just hurry it up...
+		if (m_iSyncDeadline > iSyncDeadline)
+			m_iSyncDeadline = iSyncDeadline;
+		return;
+	}
+
+	// Already sitting at clip start?
+	if (m_iReadOffset == m_iOffset) {
+		// Make sure the first threshold is in...
+		if (!m_bIntegral && m_pSyncThread
+			&& m_pRingBuffer->readable() < m_iThreshold
+			&& !isSyncFlag(WaitSync))
+			m_pSyncThread->sync(this);
+		return;
+	}
+
+	// Rewind to clip start, by deadline...
+	seek(0, iSyncDeadline);
+}
+
+
+// Pending (hard-)sync deadline (in session frames).
+void qtractorAudioBuffer::setSyncDeadline ( unsigned long iSyncDeadline )
+{
+	m_iSyncDeadline = iSyncDeadline;
+}
+
+unsigned long qtractorAudioBuffer::syncDeadline (void) const
+{
+	return m_iSyncDeadline;
 }
 
 
@@ -1519,7 +2244,7 @@ unsigned long qtractorAudioBuffer::framesIn ( unsigned long iFrames ) const
 		iFrames = (unsigned long) (float(iFrames) * m_fResampleRatio);
 #endif
 
-	if (m_bTimeStretch)
+	if (m_bTimeStretch && !m_bStretchRender)
 		iFrames = (unsigned long) (float(iFrames) * m_fTimeStretch);
 
 	return iFrames;
@@ -1532,7 +2257,7 @@ unsigned long qtractorAudioBuffer::framesOut ( unsigned long iFrames ) const
 		iFrames = (unsigned long) (float(iFrames) / m_fResampleRatio);
 #endif
 
-	if (m_bTimeStretch)
+	if (m_bTimeStretch && !m_bStretchRender)
 		iFrames = (unsigned long) (float(iFrames) / m_fTimeStretch);
 
 	return iFrames;
@@ -1695,6 +2420,118 @@ qtractorAudioPeakFile *qtractorAudioBuffer::peakFile (void) const
 }
 
 
+// Whether to keep it in the session RAM cache, regardless of size.
+void qtractorAudioBuffer::setCacheInRam ( bool bCacheInRam )
+{
+	m_bCacheInRam = bCacheInRam;
+}
+
+bool qtractorAudioBuffer::isCacheInRam (void) const
+{
+	return m_bCacheInRam;
+}
+
+
+// Whether it's being played from the session RAM cache.
+bool qtractorAudioBuffer::isCached (void) const
+{
+	return (m_pCacheItem && m_bIntegral);
+}
+
+
+// Whether it's being played from a pre-rendered time-stretch file.
+bool qtractorAudioBuffer::isStretchRender (void) const
+{
+	return m_bStretchRender;
+}
+
+
+// Equal-power crossfade setup for next readMix() call (RT);
+// iCrossFade: +1 fading in, -1 fading out, 0 none; iStart is
+// the span start relative to the first output buffer frame.
+void qtractorAudioBuffer::setCrossFade (
+	int iCrossFade, long iStart, unsigned long iLength )
+{
+	m_iCrossFade = (m_pfCrossFade ? iCrossFade : 0);
+	m_iCrossFadeStart = iStart;
+	m_iCrossFadeLength = iLength;
+}
+
+
+// Capture (record) ring-buffer high-water mark (in frames).
+unsigned int qtractorAudioBuffer::captureHighWater (void) const
+{
+	return m_iCaptureHighWater;
+}
+
+
+// Capture (record) ring-buffer fill ratio high-water mark (0..1).
+float qtractorAudioBuffer::captureHighWaterRatio (void) const
+{
+	if (m_pRingBuffer == nullptr)
+		return 0.0f;
+
+	return float(m_iCaptureHighWater) / float(m_pRingBuffer->bufferSize());
+}
+
+
+// Capture (record) overrun risk moments (in frames from clip start;
+// only the last few are kept, but all are counted).
+unsigned int qtractorAudioBuffer::captureRiskCount (void) const
+{
+	return m_iCaptureRisks;
+}
+
+QList<unsigned long> qtractorAudioBuffer::captureRisks (void) const
+{
+	QList<unsigned long> list;
+
+	const unsigned int iCaptureRisks = m_iCaptureRisks;
+	unsigned int i = 0;
+	if (iCaptureRisks > CaptureRisks)
+		i = iCaptureRisks - CaptureRisks;
+	for ( ; i < iCaptureRisks; ++i)
+		list.append(m_captureRisks[i % CaptureRisks]);
+
+	return list;
+}
+
+
+// Whether it's being played from a pre-converted sample-rate file.
+bool qtractorAudioBuffer::isResampleRender (void) const
+{
+	return m_bResampleRender;
+}
+
+
+// Whether a pre-rendered file got ready meanwhile.
+bool qtractorAudioBuffer::isStretchPending (void) const
+{
+	return (m_pStretchItem && !m_bStretchRender && !m_bResampleRender
+		&& m_pStretchItem->isReady());
+}
+
+
+// Session RAM cache item key: anything that makes a difference
+// to the decoded (resampled and time-stretched) frames.
+QString qtractorAudioBuffer::cacheKey ( const QString& sFilename ) const
+{
+	qtractorSession *pSession = qtractorSession::getInstance();
+	const unsigned int iSampleRate = (pSession ? pSession->sampleRate() : 0);
+
+	return QString("%1|%2|%3|%4|%5|%6|%7|%8|%9")
+		.arg(sFilename)
+		.arg(m_iChannels)
+		.arg(m_iOffset)
+		.arg(m_iLength)
+		.arg(iSampleRate)
+		.arg(g_iDefaultResampleType)
+		.arg(m_bTimeStretch ? m_fTimeStretch : 1.0f)
+		.arg(m_bPitchShift  ? m_fPitchShift  : 1.0f)
+		.arg(int(m_bWsolaTimeStretch) | (int(m_bWsolaQuickSeek) << 1));
+}
+
+
 // WSOLA time-stretch modes (local options).
 void qtractorAudioBuffer::setWsolaTimeStretch ( bool bWsolaTimeStretch )
 {
@@ -34,63 +34,107 @@
 #include <QThread>
 #include <QMutex>
 #include <QWaitCondition>
+#include <QAtomicPointer>
+#include <QList>
 
 
 // Forward declarations.
 class qtractorAudioPeakFile;
 class qtractorAudioBuffer;
 class qtractorTimeStretcher;
+class qtractorAudioCacheItem;
+class qtractorAudioStretchItem;
 
 
 //----------------------------------------------------------------------
-// class qtractorAudioBufferThread -- Ring-cache manager thread.
+// class qtractorAudioBufferThread -- Ring-cache manager thread pool.
 //
 
-class qtractorAudioBufferThread : public QThread
+class qtractorAudioBufferThread
 {
 public:
 
+	// Sync request queue size for a whole session
+	// (fixed, as producers are lock-free and RT).
+	enum { MaxSyncSize = 4096 };
+
 	// Constructor.
-	qtractorAudioBufferThread(unsigned int iSyncSize = 8);
+	qtractorAudioBufferThread(unsigned int iSyncSize = 8,
+		unsigned short iSyncThreads = 1);
 
 	// Destructor.
 	~qtractorAudioBufferThread();
 
+	// Worker threads start/stop.
+	void start(QThread::Priority priority = QThread::HighPriority);
+	void stop();
+
 	// Thread run state accessors.
 	void setRunState(bool bRunState);
 	bool runState() const;
 
-	// Wake from executive wait condition (RT-safe).
+	// Number of worker threads.
+	unsigned short syncThreads() const;
+
+	// Wake from executive wait condition (RT-safe);
+	// nullptr drops all queued and pending requests.
 	void sync(qtractorAudioBuffer *pAudioBuffer = nullptr);
 
 	// Bypass executive wait condition (non RT-safe).
 	void syncExport();
 
-	// Conditional resize check.
-	void checkSyncSize(unsigned int iSyncSize);
+	// Buffer sync de-registration (non RT-safe).
+	void release(qtractorAudioBuffer *pAudioBuffer);
+
+	// Default number of worker threads (0=auto).
+	static void setDefaultSyncThreads(unsigned short iSyncThreads);
+	static unsigned short defaultSyncThreads();
 
 protected:
 
-	// The main thread executives.
+	// Worker thread forward decl.
+	class Worker;
+
+	// The main worker executive.
 	void run();
-	void process();
+
+	// Move all queued sync requests into pending (locked).
+	void fetch();
+
+	// Most urgent pending buffer, nearest to under-run (locked).
+	qtractorAudioBuffer *next();
+
+	// Sync the given buffer, out of lock (locked).
+	void process(qtractorAudioBuffer *pAudioBuffer);
 
 private:
 
 	// Instance variables.
 	unsigned int          m_iSyncSize;
 	unsigned int          m_iSyncMask;
-	qtractorAudioBuffer **m_ppSyncItems;
+	QAtomicPointer<qtractorAudioBuffer> *m_ppSyncItems;
 
 	volatile unsigned int m_iSyncRead;
-	volatile unsigned int m_iSyncWrite;
+	qtractorAtomic        m_iSyncWrite;
+
+	// Pending and currently busy buffers (locked).
+	QList<qtractorAudioBuffer *> m_pending;
+	QList<qtractorAudioBuffer *> m_busy;
 
-	// Whether the thread is logically running.
+	// Worker threads.
+	unsigned short m_iSyncThreads;
+	Worker       **m_ppWorkers;
+
+	// Whether the threads are logically running.
 	volatile bool m_bRunState;
 
 	// Thread synchronization objects.
 	QMutex m_mutex;
 	QWaitCondition m_cond;
+	QWaitCondition m_idle;
+
+	// Default number of worker threads.
+	static unsigned short g_iDefaultSyncThreads;
 };
 
 
@@ -138,11 +182,18 @@ public:
 	int readMux(float **ppFrames, unsigned int iFrames,
 		unsigned short iChannels, unsigned int iOffset, float fGain);
 
-	// Buffer data seek.
-	bool seek(unsigned long iFrame);
+	// Buffer data seek (hard-seek due by the given session frame).
+	bool seek(unsigned long iFrame, unsigned long iSyncDeadline = 0);
+
+	// Reset this buffer's state (due by the given session frame).
+	void reset(bool bLooping, unsigned long iSyncDeadline = 0);
+
+	// Deadline-aware read-ahead (due by the given session frame).
+	void preRoll(unsigned long iSyncDeadline);
 
-	// Reset this buffer's state.
-	void reset(bool bLooping);
+	// Pending (hard-)sync deadline (in session frames).
+	void setSyncDeadline(unsigned long iSyncDeadline);
+	unsigned long syncDeadline() const;
 
 	// Logical clip-offset (in frames from beginning-of-file).
 	void setOffset(unsigned long iOffset);
@@ -195,6 +246,9 @@ public:
 	// Audio frame process synchronization predicate method.
 	bool inSync(unsigned long iFrameStart, unsigned long iFrameEnd);
 
+	// Sync urgency (the lower, the nearer to under-run).
+	unsigned int syncPriority(unsigned long iFrame) const;
+
 	// Export-mode sync executive.
 	void syncExport();
 
@@ -202,6 +256,34 @@ public:
 	void setPeakFile(qtractorAudioPeakFile *pPeakFile);
 	qtractorAudioPeakFile *peakFile() const;
 
+	// Whether to keep it in the session RAM cache, regardless of size.
+	void setCacheInRam(bool bCacheInRam);
+	bool isCacheInRam() const;
+
+	// Whether it's being played from the session RAM cache.
+	bool isCached() const;
+
+	// Whether it's being played from a pre-rendered time-stretch file.
+	bool isStretchRender() const;
+
+	// Whether it's being played from a pre-converted sample-rate file.
+	bool isResampleRender() const;
+
+	// Equal-power crossfade setup for next readMix() call (RT).
+	void setCrossFade(int iCrossFade, long iStart, unsigned long iLength);
+
+	// Capture (record) ring-buffer high-water mark.
+	unsigned int captureHighWater() const;
+	float captureHighWaterRatio() const;
+
+	// Capture (record) overrun risk moments (in frames from clip start;
+	// only the last few are kept, but all are counted).
+	unsigned int captureRiskCount() const;
+	QList<unsigned long> captureRisks() const;
+
+	// Whether a pre-rendered file got ready meanwhile.
+	bool isStretchPending() const;
+
 	// WSOLA time-stretch modes (local options).
 	void setWsolaTimeStretch(bool bWsolaTimeStretch);
 	bool isWsolaTimeStretch() const;
@@ -225,6 +307,9 @@ protected:
 	// Read-sync mode methods (playback).
 	void readSync();
 
+	// Incremental session RAM cache decoding.
+	void cacheSync();
+
 	// Write-sync mode method (recording).
 	void writeSync();
 
@@ -246,6 +331,9 @@ protected:
 	// I/O buffer release.
 	void deleteIOBuffers();
 
+	// Session RAM cache item key.
+	QString cacheKey(const QString& sFilename) const;
+
 	// Frame position converters.
 	unsigned long framesIn(unsigned long iFrames) const;
 	unsigned long framesOut(unsigned long iFrames) const;
@@ -281,6 +369,8 @@ private:
 	unsigned long  m_iSeekOffset;
 	qtractorAtomic m_seekPending;
 
+	volatile unsigned long m_iSyncDeadline;
+
 	float        **m_ppFrames;
 	float        **m_ppBuffer;
 
@@ -300,6 +390,12 @@ private:
 	float          m_fNextGain;
 	int            m_iRampGain;
 
+	// Equal-power crossfade state (overlapping clips).
+	int            m_iCrossFade;
+	long           m_iCrossFadeStart;
+	unsigned long  m_iCrossFadeLength;
+	float         *m_pfCrossFade;
+
 #ifdef CONFIG_LIBSAMPLERATE
 	bool           m_bResample;
 	float          m_fResampleRatio;
@@ -311,10 +407,38 @@ private:
 
 	qtractorAudioPeakFile *m_pPeakFile;
 
+	// Session RAM cache (shared) item.
+	bool           m_bCacheInRam;
+
+	qtractorAudioCacheItem *m_pCacheItem;
+	bool           m_bCacheLoad;
+
+	// Pre-rendered time-stretch/pitch-shift (shared) item.
+	qtractorAudioStretchItem *m_pStretchItem;
+
+	bool           m_bStretchRender;
+	bool           m_bResampleRender;
+
+	// Capture (record) ring-buffer statistics.
+	enum { CaptureRisks = 16 };
+
+	volatile unsigned int m_iCaptureHighWater;
+	volatile unsigned int m_iCaptureRisks;
+	unsigned long  m_captureRisks[CaptureRisks];
+	bool           m_bCaptureRisk;
+
 	// Time-stretch mode local options.
 	bool           m_bWsolaTimeStretch;
 	bool           m_bWsolaQuickSeek;
 
+	// Vectorized gain-ramp mix processor.
+	void (*m_pfnGainRampAdd)(float *, const float *,
+		unsigned int, float, float);
+
+	// Vectorized gain-curve (crossfade) mix processor.
+	void (*m_pfnGainCurveAdd)(float *, const float *,
+		const float *, unsigned int, float);
+
 	// Time-stretch mode global options.
 	static bool    g_bDefaultWsolaTimeStretch;
 	static bool    g_bDefaultWsolaQuickSeek;
@@ -0,0 +1,266 @@
+// qtractorAudioCache.cpp
+//
+/****************************************************************************
+   Copyright (C) 2005-2022, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qtractorAbout.h"
+#include "qtractorAudioCache.h"
+
+#include "qtractorAtomic.h"
+
+
+// Last played time-stamp clock (monotonic tick).
+static qtractorAtomic g_lastPlayed;
+
+
+//----------------------------------------------------------------------
+// class qtractorAudioCacheItem -- Decoded clip data (shared) item.
+//
+
+// Constructor.
+qtractorAudioCacheItem::qtractorAudioCacheItem ( const QString& sKey,
+	unsigned short iChannels, unsigned int iBufferSize )
+	: m_sKey(sKey), m_iChannels(iChannels)
+{
+	// Adjust buffer size of nearest power-of-two (ring-buffer friendly).
+	m_iBufferSize = 4096;
+	while (m_iBufferSize < iBufferSize)
+		m_iBufferSize <<= 1;
+
+	m_ppFrames = new float * [m_iChannels];
+	for (unsigned short i = 0; i < m_iChannels; ++i)
+		m_ppFrames[i] = new float [m_iBufferSize];
+
+	m_bLoaded = false;
+	m_iLoadedFrames = 0;
+
+	m_iRefCount = 0;
+
+	touch();
+}
+
+
+// Destructor.
+qtractorAudioCacheItem::~qtractorAudioCacheItem (void)
+{
+	for (unsigned short i = 0; i < m_iChannels; ++i)
+		delete [] m_ppFrames[i];
+	delete [] m_ppFrames;
+}
+
+
+// Storage size (in bytes).
+unsigned long qtractorAudioCacheItem::size (void) const
+{
+	return (unsigned long) m_iChannels * m_iBufferSize * sizeof(float);
+}
+
+
+// Loaded (decoded) state accessors.
+void qtractorAudioCacheItem::setLoaded ( unsigned int iFrames )
+{
+	m_iLoadedFrames = iFrames;
+	m_bLoaded = true;
+}
+
+
+// Last played time-stamp (RT-safe).
+void qtractorAudioCacheItem::touch (void)
+{
+	m_iLastPlayed = (unsigned int) ATOMIC_INC(&g_lastPlayed);
+}
+
+
+//----------------------------------------------------------------------
+// class qtractorAudioCache -- Session-wide audio clip RAM cache.
+//
+
+// Global defaults.
+unsigned int qtractorAudioCache::g_iDefaultMaxSize   = 0;
+unsigned int qtractorAudioCache::g_iDefaultThreshold = 8;
+
+
+// Constructor.
+qtractorAudioCache::qtractorAudioCache (void) : m_iSize(0)
+{
+}
+
+
+// Destructor.
+qtractorAudioCache::~qtractorAudioCache (void)
+{
+	qDeleteAll(m_items);
+	m_items.clear();
+}
+
+
+// Get a shared item, creating it when eligible
+// and there's still room for it (nullptr otherwise).
+qtractorAudioCacheItem *qtractorAudioCache::acquire ( const QString& sKey,
+	unsigned short iChannels, unsigned int iFrames, bool bForce )
+{
+	QMutexLocker locker(&m_mutex);
+
+	qtractorAudioCacheItem *pItem = m_items.value(sKey, nullptr);
+	if (pItem) {
+		// Still being decoded by its first owner?
+		// Go on with a private ring-buffer instead...
+		pItem->lock();
+		const bool bLoaded = pItem->isLoaded();
+		pItem->unlock();
+		if (!bLoaded)
+			return nullptr;
+		pItem->addRef();
+		return pItem;
+	}
+
+	const unsigned long iMaxSize = (unsigned long) g_iDefaultMaxSize << 20;
+	if (iMaxSize == 0)
+		return nullptr;
+
+	// Estimated storage size, rounded as the item would...
+	unsigned int iBufferSize = 4096;
+	while (iBufferSize < iFrames)
+		iBufferSize <<= 1;
+
+	const unsigned long iSize
+		= (unsigned long) iChannels * iBufferSize * sizeof(float);
+
+	// Clips explicitly marked bypass the size threshold only...
+	if (!bForce && iSize > ((unsigned long) g_iDefaultThreshold << 20))
+		return nullptr;
+
+	if (!evict(iSize, iMaxSize))
+		return nullptr;
+
+	pItem = new qtractorAudioCacheItem(sKey, iChannels, iFrames);
+	pItem->addRef();
+
+	m_items.insert(sKey, pItem);
+	m_iSize += pItem->size();
+
+#ifdef CONFIG_DEBUG
+	qDebug("qtractorAudioCache::acquire(\"%s\") size=%lu/%lu",
+		sKey.toUtf8().constData(), m_iSize, iMaxSize);
+#endif
+
+	return pItem;
+}
+
+
+// Drop an item reference.
+void qtractorAudioCache::release ( qtractorAudioCacheItem *pItem )
+{
+	QMutexLocker locker(&m_mutex);
+
+	// Unreferenced items are kept around for
+	// later reuse, until evicted or cleaned up...
+	pItem->removeRef();
+
+	// ...unless they're not even loaded.
+	if (pItem->refCount() == 0 && !pItem->isLoaded()) {
+		m_items.remove(pItem->key());
+		m_iSize -= pItem->size();
+		delete pItem;
+	}
+}
+
+
+// Free all unreferenced items.
+void qtractorAudioCache::cleanup (void)
+{
+	QMutexLocker locker(&m_mutex);
+
+	QMutableHashIterator<QString, qtractorAudioCacheItem *> iter(m_items);
+	while (iter.hasNext()) {
+		qtractorAudioCacheItem *pItem = iter.next().value();
+		if (pItem->refCount() == 0) {
+			m_iSize -= pItem->size();
+			iter.remove();
+			delete pItem;
+		}
+	}
+}
+
+
+// Current allocated size (in bytes).
+unsigned long qtractorAudioCache::size (void) const
+{
+	return m_iSize;
+}
+
+
+// Evict least recently played unreferenced items,
+// until the given size fits the budget.
+bool qtractorAudioCache::evict ( unsigned long iSize, unsigned long iMaxSize )
+{
+	if (iSize > iMaxSize)
+		return false;
+
+	while (m_iSize + iSize > iMaxSize) {
+		qtractorAudioCacheItem *pLruItem = nullptr;
+		QHash<QString, qtractorAudioCacheItem *>::ConstIterator iter
+			= m_items.constBegin();
+		const QHash<QString, qtractorAudioCacheItem *>::ConstIterator& iter_end
+			= m_items.constEnd();
+		for ( ; iter != iter_end; ++iter) {
+			qtractorAudioCacheItem *pItem = iter.value();
+			if (pItem->refCount() > 0)
+				continue;
+			if (pLruItem == nullptr
+				|| int(pItem->lastPlayed() - pLruItem->lastPlayed()) < 0)
+				pLruItem = pItem;
+		}
+		// All in use: no room for this one...
+		if (pLruItem == nullptr)
+			return false;
+		m_items.remove(pLruItem->key());
+		m_iSize -= pLruItem->size();
+		delete pLruItem;
+	}
+
+	return true;
+}
+
+
+// Global cache size budget (in MB; 0=disabled).
+void qtractorAudioCache::setDefaultMaxSize ( unsigned int iMaxSize )
+{
+	g_iDefaultMaxSize = iMaxSize;
+}
+
+unsigned int qtractorAudioCache::defaultMaxSize (void)
+{
+	return g_iDefaultMaxSize;
+}
+
+
+// Global clip size threshold (in MB).
+void qtractorAudioCache::setDefaultThreshold ( unsigned int iThreshold )
+{
+	g_iDefaultThreshold = iThreshold;
+}
+
+unsigned int qtractorAudioCache::defaultThreshold (void)
+{
+	return g_iDefaultThreshold;
+}
+
+
+// end of qtractorAudioCache.cpp
@@ -0,0 +1,167 @@
+// qtractorAudioCache.h
+//
+/****************************************************************************
+   Copyright (C) 2005-2022, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qtractorAudioCache_h
+#define __qtractorAudioCache_h
+
+#include <QHash>
+#include <QMutex>
+
+
+//----------------------------------------------------------------------
+// class qtractorAudioCacheItem -- Decoded clip data (shared) item.
+//
+
+class qtractorAudioCacheItem
+{
+public:
+
+	// Constructor.
+	qtractorAudioCacheItem(const QString& sKey,
+		unsigned short iChannels, unsigned int iBufferSize);
+
+	// Destructor.
+	~qtractorAudioCacheItem();
+
+	// Key accessor.
+	const QString& key() const
+		{ return m_sKey; }
+
+	// Storage accessors.
+	unsigned short channels() const
+		{ return m_iChannels; }
+	unsigned int bufferSize() const
+		{ return m_iBufferSize; }
+	float **frames() const
+		{ return m_ppFrames; }
+
+	// Storage size (in bytes).
+	unsigned long size() const;
+
+	// Loading (decoding) state guard.
+	void lock()
+		{ m_mutex.lock(); }
+	void unlock()
+		{ m_mutex.unlock(); }
+
+	// Loaded (decoded) state accessors.
+	void setLoaded(unsigned int iFrames);
+	bool isLoaded() const
+		{ return m_bLoaded; }
+	unsigned int loadedFrames() const
+		{ return m_iLoadedFrames; }
+
+	// Last played time-stamp.
+	void touch();
+	unsigned int lastPlayed() const
+		{ return m_iLastPlayed; }
+
+	// Reference count.
+	void addRef()
+		{ ++m_iRefCount; }
+	bool removeRef()
+		{ return (--m_iRefCount == 0); }
+	unsigned int refCount() const
+		{ return m_iRefCount; }
+
+private:
+
+	// Instance variables.
+	QString        m_sKey;
+
+	unsigned short m_iChannels;
+	unsigned int   m_iBufferSize;
+	float        **m_ppFrames;
+
+	QMutex         m_mutex;
+
+	volatile bool  m_bLoaded;
+	unsigned int   m_iLoadedFrames;
+
+	volatile unsigned int m_iLastPlayed;
+
+	unsigned int   m_iRefCount;
+};
+
+
+//----------------------------------------------------------------------
+// class qtractorAudioCache -- Session-wide audio clip RAM cache.
+//
+
+class qtractorAudioCache
+{
+public:
+
+	// Constructor.
+	qtractorAudioCache();
+
+	// Destructor.
+	~qtractorAudioCache();
+
+	// Get a shared item, creating it when eligible
+	// and there's still room for it (nullptr otherwise).
+	qtractorAudioCacheItem *acquire(const QString& sKey,
+		unsigned short iChannels, unsigned int iFrames, bool bForce = false);
+
+	// Drop an item reference.
+	void release(qtractorAudioCacheItem *pItem);
+
+	// Free all unreferenced items.
+	void cleanup();
+
+	// Current allocated size (in bytes).
+	unsigned long size() const;
+
+	// Global cache size budget (in MB; 0=disabled).
+	static void setDefaultMaxSize(unsigned int iMaxSize);
+	static unsigned int defaultMaxSize();
+
+	// Global clip size threshold (in MB).
+	static void setDefaultThreshold(unsigned int iThreshold);
+	static unsigned int defaultThreshold();
+
+protected:
+
+	// Evict least recently played unreferenced items,
+	// until the given size fits the budget.
+	bool evict(unsigned long iSize, unsigned long iMaxSize);
+
+private:
+
+	// Cache mutex.
+	QMutex m_mutex;
+
+	// The cached items.
+	QHash<QString, qtractorAudioCacheItem *> m_items;
+
+	// Current allocated size (in bytes).
+	unsigned long m_iSize;
+
+	// Global defaults.
+	static unsigned int g_iDefaultMaxSize;
+	static unsigned int g_iDefaultThreshold;
+};
+
+
+#endif  // __qtractorAudioCache_h
+
+
+// end of qtractorAudioCache.h
@@ -28,6 +28,7 @@
 
 #include "qtractorSession.h"
 #include "qtractorFileList.h"
+#include "qtractorRtCommand.h"
 
 #include <QFileInfo>
 #include <QPainter>
@@ -128,6 +129,9 @@ uint qHash ( const qtractorAudioClip::Key& key )
 
 qtractorAudioClip::Hash qtractorAudioClip::g_hashTable;
 
+// Equal-power crossfade over overlapping clips (global option).
+bool qtractorAudioClip::g_bDefaultCrossFade = false;
+
 
 //----------------------------------------------------------------------
 // class qtractorAudioClip -- Audio file/buffer clip.
@@ -147,6 +151,8 @@ qtractorAudioClip::qtractorAudioClip ( qtractorTrack *pTrack )
 	m_bWsolaTimeStretch = qtractorAudioBuffer::isDefaultWsolaTimeStretch();
 	m_bWsolaQuickSeek = qtractorAudioBuffer::isDefaultWsolaQuickSeek();
 
+	m_bCacheInRam = false;
+
 	m_iOverlap = 0;
 
 	m_pFractGains = nullptr;
@@ -166,6 +172,8 @@ qtractorAudioClip::qtractorAudioClip ( const qtractorAudioClip& clip )
 	m_bWsolaTimeStretch = clip.isWsolaTimeStretch();
 	m_bWsolaQuickSeek   = clip.isWsolaQuickSeek();
 
+	m_bCacheInRam = clip.isCacheInRam();
+
 	m_iOverlap = clip.overlap();
 
 	m_pFractGains = nullptr;
@@ -299,7 +307,8 @@ bool qtractorAudioClip::openAudioFile ( const QString& sFilename, int iMode )
 	}
 
 	// Initialize audio buffer container...
-	m_pData = new Data(pTrack, iChannels);
+	m_pData = new Data(bWrite
+		? pSession->captureThread() : pTrack->syncThread(), iChannels);
 	m_pData->attach(this);
 
 	qtractorAudioBuffer *pBuff = m_pData->buffer();
@@ -312,6 +321,10 @@ bool qtractorAudioClip::openAudioFile ( const QString& sFilename, int iMode )
 	pBuff->setPitchShift(m_fPitchShift);
 	pBuff->setWsolaTimeStretch(m_bWsolaTimeStretch);
 	pBuff->setWsolaQuickSeek(m_bWsolaQuickSeek);
+	pBuff->setCacheInRam(m_bCacheInRam);
+
+	// Initial read-in due by clip start...
+	pBuff->setSyncDeadline(clipStart());
 
 	if (!pBuff->open(sFilename, iMode)) {
 		delete m_pData;
@@ -417,7 +430,7 @@ void qtractorAudioClip::unlinkHashData (void)
 
 	qtractorAudioBuffer *pBuff = m_pData->buffer();
 
-	Data *pNewData = new Data(track(), pBuff->channels());
+	Data *pNewData = new Data(track()->syncThread(), pBuff->channels());
 
 	qtractorAudioBuffer *pNewBuff = pNewData->buffer();
 
@@ -480,6 +493,135 @@ void qtractorAudioClip::clearHashTable (void)
 }
 
 
+// Pre-rendered file buffer switch-over RT command: the old
+// buffer is deleted by the RT command garbage collector thread.
+class qtractorAudioClipRenderCommand : public qtractorRtCommand
+{
+public:
+
+	// Constructor.
+	qtractorAudioClipRenderCommand(
+		qtractorAudioClip::Data *pData, qtractorAudioBuffer *pBuff)
+		: m_pData(pData), m_pBuff(pBuff) {}
+
+	// Destructor (retires the old buffer).
+	~qtractorAudioClipRenderCommand()
+		{ if (m_pBuff) delete m_pBuff; }
+
+	// Switch over to the new buffer (RT).
+	void process()
+		{ m_pBuff = m_pData->swapBuffer(m_pBuff); }
+
+private:
+
+	// Instance variables.
+	qtractorAudioClip::Data *m_pData;
+	qtractorAudioBuffer     *m_pBuff;
+};
+
+
+// Switch over to pre-rendered time-stretch (or sample-rate
+// converted) files, once ready: a fresh buffer gets opened on the
+// rendered file and seeked to the current play-head position, all
+// off-lock, only then it's swapped in by the RT thread (non-RT).
+bool qtractorAudioClip::updateStretchRenders (void)
+{
+	qtractorSession *pSession = qtractorSession::getInstance();
+	if (pSession == nullptr)
+		return false;
+
+	QList<Data *> list;
+
+	Hash::ConstIterator iter = g_hashTable.constBegin();
+	const Hash::ConstIterator& iter_end = g_hashTable.constEnd();
+	for ( ; iter != iter_end; ++iter) {
+		Data *pData = iter.value();
+		if (pData && !list.contains(pData))
+			list.append(pData);
+	}
+
+	int iPending = 0;
+	int iRtCommands = 0;
+
+	QListIterator<Data *> data_iter(list);
+	while (data_iter.hasNext()) {
+		Data *pData = data_iter.next();
+		if (pData->clips().isEmpty())
+			continue;
+		qtractorAudioClip *pAudioClip = pData->clips().first();
+		qtractorAudioBuffer *pBuff = pData->buffer();
+		qtractorAudioBuffer *pRenderBuff = pData->renderBuffer();
+		// Open a fresh buffer on the rendered file...
+		if (pRenderBuff == nullptr) {
+			if (!pBuff->isStretchPending())
+				continue;
+			pRenderBuff = new qtractorAudioBuffer(
+				pAudioClip->track()->syncThread(), pBuff->channels());
+			pRenderBuff->setOffset(pBuff->offset());
+			pRenderBuff->setLength(pBuff->length());
+			pRenderBuff->setGain(pBuff->gain());
+			pRenderBuff->setPanning(pBuff->panning());
+			pRenderBuff->setTimeStretch(pBuff->timeStretch());
+			pRenderBuff->setPitchShift(pBuff->pitchShift());
+			pRenderBuff->setWsolaTimeStretch(pBuff->isWsolaTimeStretch());
+			pRenderBuff->setWsolaQuickSeek(pBuff->isWsolaQuickSeek());
+			pRenderBuff->setCacheInRam(pBuff->isCacheInRam());
+			pRenderBuff->setLoop(pBuff->loopStart(), pBuff->loopEnd());
+			pRenderBuff->setSyncDeadline(pAudioClip->clipStart());
+			if (!pRenderBuff->open(pAudioClip->filename())
+				|| (!pRenderBuff->isStretchRender()
+					&& !pRenderBuff->isResampleRender())) {
+				delete pRenderBuff;
+				continue;
+			}
+			pData->setRenderBuffer(pRenderBuff);
+			++iPending;
+			continue;
+		}
+		// Not initialized yet?
+		if (!pRenderBuff->isSyncFlag(qtractorAudioBuffer::InitSync)) {
+			++iPending;
+			continue;
+		}
+		// Seek to where the clip is being played, if it is...
+		if (!pData->isRenderSeek()) {
+			pData->setRenderSeek(true);
+			const unsigned long iPlayHead = pSession->playHead();
+			const unsigned long iClipStart = pAudioClip->clipStart();
+			if (iPlayHead > iClipStart
+				&& iPlayHead < iClipStart + pAudioClip->clipLength()) {
+				pRenderBuff->seek(iPlayHead - iClipStart, iPlayHead);
+				++iPending;
+				continue;
+			}
+		}
+		// Ready, switch over...
+		pData->setRenderBuffer(nullptr);
+		pSession->postRtCommand(
+			new qtractorAudioClipRenderCommand(pData, pRenderBuff));
+		++iRtCommands;
+	}
+
+	// Wait for the old buffers to be out of reach...
+	if (iRtCommands > 0)
+		pSession->syncRtCommands();
+
+	return (iPending > 0);
+}
+
+
+// Equal-power crossfade over overlapping clips (global option).
+void qtractorAudioClip::setDefaultCrossFade ( bool bCrossFade )
+{
+	g_bDefaultCrossFade = bCrossFade;
+}
+
+bool qtractorAudioClip::isDefaultCrossFade (void)
+{
+	return g_bDefaultCrossFade;
+}
+
+
 // Gain/panning fractionalizer(tm)...
 void qtractorAudioClip::updateFractGains ( qtractorAudioBuffer *pBuff )
 {
@@ -522,7 +664,41 @@ void qtractorAudioClip::seek ( unsigned long iFrame )
 // Reset clip state.
 void qtractorAudioClip::reset ( bool bLooping )
 {
-	if (m_pData) m_pData->reset(bLooping);
+	if (m_pData == nullptr)
+		return;
+
+	// Due when the play-head gets here next (time around)...
+	unsigned long iSyncDeadline = clipStart();
+	qtractorSession *pSession = track()->session();
+	if (bLooping && pSession && pSession->isLooping()) {
+		const unsigned long iLoopStart = pSession->loopStart();
+		iSyncDeadline = pSession->loopEnd();
+		if (clipStart() > iLoopStart)
+			iSyncDeadline += clipStart() - iLoopStart;
+	}
+
+	m_pData->reset(bLooping, iSyncDeadline);
+}
+
+
+// Deadline-aware read-ahead (clip start due ahead of play-head).
+void qtractorAudioClip::preRoll (
+	unsigned long iFrame, unsigned long iSyncDeadline )
+{
+	if (m_pData == nullptr)
+		return;
+
+	// Never rewind a (shared) buffer while still in use...
+	QListIterator<qtractorAudioClip *> iter(m_pData->clips());
+	while (iter.hasNext()) {
+		qtractorAudioClip *pAudioClip = iter.next();
+		const unsigned long iClipStart = pAudioClip->clipStart();
+		if (iFrame >= iClipStart
+			&& iFrame < iClipStart + pAudioClip->clipLength())
+			return;
+	}
+
+	m_pData->preRoll(iSyncDeadline);
 }
 
 
@@ -619,25 +795,44 @@ void qtractorAudioClip::process (
 	const unsigned long iOffset
 		= (iFrameEnd < iClipEnd ? iFrameEnd : iClipEnd) - iClipStart;
 
+	// Overlapping clips get an equal-power crossfade instead...
+	int iCrossFade = 0;
+	float fGain = 1.0f;
+	if (g_bDefaultCrossFade) {
+		const qtractorClipIndex::Span *pSpan
+			= track()->clipIndex().seekSpan(this, iFrameStart, iFrameEnd);
+		if (pSpan) {
+			iCrossFade = (pSpan->clip2 == this ? +1 : -1);
+			pBuff->setCrossFade(iCrossFade,
+				long(pSpan->start) - long(iFrameStart),
+				pSpan->end - pSpan->start);
+		}
+	}
+	if (iCrossFade == 0)
+		fGain = fadeInOutGain(iOffset);
+
 	if (iClipStart > iFrameStart) {
 		if (pBuff->inSync(0, iOffset)) {
 			pBuff->readMix(
-				pAudioBus->buffer(),
+				track()->audioBuffer(),
 				iOffset,
 				pAudioBus->channels(),
 				iClipStart - iFrameStart,
-				fadeInOutGain(iOffset));
+				fGain);
 		}
 	} else {
 		if (pBuff->inSync(iFrameStart - iClipStart, iOffset)) {
 			pBuff->readMix(
-				pAudioBus->buffer(),
+				track()->audioBuffer(),
 				(iFrameEnd < iClipEnd ? iFrameEnd : iClipEnd) - iFrameStart,
 				pAudioBus->channels(),
 				0,
-				fadeInOutGain(iOffset));
+				fGain);
 		}
 	}
+
+	if (iCrossFade)
+		pBuff->setCrossFade(0, 0, 0);
 }
 
 
@@ -793,6 +988,9 @@ bool qtractorAudioClip::loadClipElement (
 		else if (eChild.tagName() == "wsola-quick-seek")
 			qtractorAudioClip::setWsolaQuickSeek(
 				qtractorDocument::boolFromText(eChild.text()));
+		else if (eChild.tagName() == "cache-in-ram")
+			qtractorAudioClip::setCacheInRam(
+				qtractorDocument::boolFromText(eChild.text()));
 
 	}
 
@@ -816,6 +1014,10 @@ bool qtractorAudioClip::saveClipElement (
 	pDocument->saveTextElement("wsola-quick-seek",
 		qtractorDocument::textFromBool(
 			qtractorAudioClip::isWsolaQuickSeek()), &eAudioClip);
+	if (qtractorAudioClip::isCacheInRam()) {
+		pDocument->saveTextElement("cache-in-ram",
+			qtractorDocument::textFromBool(true), &eAudioClip);
+	}
 	pElement->appendChild(eAudioClip);
 
 	return true;
@@ -68,6 +68,12 @@ public:
 	bool isWsolaQuickSeek() const
 		 { return m_bWsolaQuickSeek; }
 
+	// Whether to keep it in the session RAM cache, regardless of size.
+	void setCacheInRam(bool bCacheInRam)
+		 { m_bCacheInRam = bCacheInRam; }
+	bool isCacheInRam() const
+		 { return m_bCacheInRam; }
+
 	// Alternating overlap tag.
 	unsigned int overlap() const
 		 { return m_iOverlap; }
@@ -93,6 +99,9 @@ public:
 	// Reset clip state.
 	void reset(bool bLooping);
 
+	// Deadline-aware read-ahead (clip start due ahead of play-head).
+	void preRoll(unsigned long iFrame, unsigned long iSyncDeadline);
+
 	// Loop positioning.
 	void setLoop(unsigned long iLoopStart, unsigned long iLoopEnd);
 
@@ -128,17 +137,32 @@ public:
 	public:
 
 		// Constructor.
-		Data(qtractorTrack *pTrack, unsigned short iChannels)
-			: m_pBuff(new qtractorAudioBuffer(
-				pTrack->syncThread(), iChannels)) {}
+		Data(qtractorAudioBufferThread *pSyncThread, unsigned short iChannels)
+			: m_pBuff(new qtractorAudioBuffer(pSyncThread, iChannels)),
+				m_pRenderBuff(nullptr), m_bRenderSeek(false) {}
 
 		// Destructor.
-		~Data() { clear(); delete m_pBuff; }
+		~Data() { clear(); delete m_pBuff; if (m_pRenderBuff) delete m_pRenderBuff; }
 
 		// Buffer accessor.
 		qtractorAudioBuffer *buffer() const
 			{ return m_pBuff; }
 
+		// Buffer switch-over, returns the old one (RT).
+		qtractorAudioBuffer *swapBuffer(qtractorAudioBuffer *pBuff)
+			{ qtractorAudioBuffer *pOldBuff = m_pBuff; m_pBuff = pBuff; return pOldBuff; }
+
+		// Pre-rendered file buffer, getting ready to switch over.
+		void setRenderBuffer(qtractorAudioBuffer *pRenderBuff)
+			{ m_pRenderBuff = pRenderBuff; m_bRenderSeek = false; }
+		qtractorAudioBuffer *renderBuffer() const
+			{ return m_pRenderBuff; }
+
+		void setRenderSeek(bool bRenderSeek)
+			{ m_bRenderSeek = bRenderSeek; }
+		bool isRenderSeek() const
+			{ return m_bRenderSeek; }
+
 		// Direct write method.
 		void write (float **ppBuffer, unsigned int iFrames,
 			unsigned short iChannels, unsigned int iOffset)
@@ -152,9 +176,13 @@ public:
 		void seek(unsigned long iFrame)
 			{ m_pBuff->seek(iFrame); }
 
-		// Reset buffer state.
-		void reset(bool bLooping)
-			{ m_pBuff->reset(bLooping); }
+		// Reset buffer state (due by the given session frame).
+		void reset(bool bLooping, unsigned long iSyncDeadline = 0)
+			{ m_pBuff->reset(bLooping, iSyncDeadline); }
+
+		// Deadline-aware read-ahead.
+		void preRoll(unsigned long iSyncDeadline)
+			{ m_pBuff->preRoll(iSyncDeadline); }
 
 		// Loop positioning.
 		void setLoop(unsigned long iLoopStart, unsigned long iLoopEnd)
@@ -181,6 +209,10 @@ public:
 		// Interesting variables.
 		qtractorAudioBuffer *m_pBuff;
 
+		// Pre-rendered file buffer (not switched over yet).
+		qtractorAudioBuffer *m_pRenderBuff;
+		bool                 m_bRenderSeek;
+
 		// Ref-counting related stuff.
 		QList<qtractorAudioClip *> m_clips;
 	};
@@ -202,6 +234,14 @@ public:
 	// Make sure the clip hash-table gets reset.
 	static void clearHashTable();
 
+	// Switch over to pre-rendered time-stretch files, once ready;
+	// returns whether any is still getting ready (non-RT).
+	static bool updateStretchRenders();
+
+	// Equal-power crossfade over overlapping clips (global option).
+	static void setDefaultCrossFade(bool bCrossFade);
+	static bool isDefaultCrossFade();
+
 protected:
 
 	// Virtual document element methods.
@@ -228,6 +268,8 @@ private:
 	bool  m_bWsolaTimeStretch;
 	bool  m_bWsolaQuickSeek;
 
+	bool  m_bCacheInRam;
+
 	// Alternate overlap tag.
 	unsigned int m_iOverlap;
 
@@ -241,6 +283,9 @@ private:
 	Data *m_pData;
 
 	static Hash g_hashTable;
+
+	// Equal-power crossfade over overlapping clips (global option).
+	static bool g_bDefaultCrossFade;
 };
 
 
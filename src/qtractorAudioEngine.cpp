@@ -23,8 +23,11 @@
 #include "qtractorAudioEngine.h"
 #include "qtractorAudioMonitor.h"
 #include "qtractorAudioBuffer.h"
+#include "qtractorAudioRender.h"
 
 #include "qtractorSession.h"
+#include "qtractorRtCommand.h"
+#include "qtractorBenchmark.h"
 
 #include "qtractorDocument.h"
 
@@ -34,6 +37,7 @@
 #include "qtractorMidiManager.h"
 #include "qtractorPlugin.h"
 #include "qtractorClip.h"
+#include "qtractorAudioClip.h"
 
 #include "qtractorMainForm.h"
 
@@ -59,10 +63,18 @@
 #include <jack/metadata.h>
 #endif
 
+#include "qtractorRingBuffer.h"
+
 #include <QApplication>
 #include <QProgressBar>
 #include <QDomDocument>
 
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+
+#include <stdlib.h>
+
 
 // Sensible defaults.
 #define SAMPLE_RATE 44100
@@ -264,6 +276,155 @@ private:
 };
 
 
+//----------------------------------------------------------------------
+// qtractorAudioExportFile -- audio export mix-down and (pipelined) writer.
+//
+
+class qtractorAudioExportFile : public QThread
+{
+public:
+
+	// Constructor (a null file is a null sink).
+	qtractorAudioExportFile ( qtractorAudioFile *pFile,
+		const QList<qtractorAudioBus *>& buses,
+		unsigned short iChannels, unsigned int iBufferSize,
+		unsigned int iRingSize ) : QThread(),
+			m_pFile(pFile), m_buses(buses), m_buffer(iChannels, iBufferSize),
+			m_pRingBuffer(nullptr), m_ppFrames(nullptr), m_bRunState(false)
+	{
+		if (m_pFile) {
+			m_pRingBuffer = new qtractorRingBuffer<float> (iChannels, iRingSize);
+			m_ppFrames = new float * [iChannels];
+			for (unsigned short i = 0; i < iChannels; ++i)
+				m_ppFrames[i] = new float [iBufferSize];
+		}
+	}
+
+	// Destructor.
+	~qtractorAudioExportFile()
+	{
+		close();
+
+		if (m_ppFrames) {
+			for (unsigned short i = 0; i < m_buffer.channels(); ++i)
+				delete [] m_ppFrames[i];
+			delete [] m_ppFrames;
+		}
+
+		if (m_pRingBuffer)
+			delete m_pRingBuffer;
+		if (m_pFile)
+			delete m_pFile;
+	}
+
+	// Export buses accessor.
+	const QList<qtractorAudioBus *>& buses() const
+		{ return m_buses; }
+
+	// Writer thread start.
+	void open()
+	{
+		if (m_pFile && !isRunning()) {
+			m_bRunState = true;
+			start();
+		}
+	}
+
+	// Writer thread stop, flush and file close.
+	void close()
+	{
+		if (isRunning()) do {
+			m_bRunState = false;
+			sync();
+		} while (!wait(100));
+
+		if (m_pFile)
+			m_pFile->close();
+	}
+
+	// Mix-down and enqueue (freewheeling process thread).
+	void process(unsigned int nframes)
+	{
+		m_buffer.process_prepare(nframes);
+		QListIterator<qtractorAudioBus *> iter(m_buses);
+		while (iter.hasNext())
+			m_buffer.process_add(iter.next(), nframes);
+
+		if (m_pRingBuffer == nullptr)
+			return;
+
+		// Freewheeling has no RT requirements,
+		// so just wait for the writer to catch up...
+		unsigned int offset = 0;
+		while (nframes > 0) {
+			const int nwrite
+				= m_pRingBuffer->write(m_buffer.buffer(), nframes, offset);
+			if (nwrite > 0) {
+				offset  += nwrite;
+				nframes -= nwrite;
+			}
+			sync();
+			if (nframes > 0)
+				QThread::usleep(200);
+		}
+	}
+
+protected:
+
+	// Wake from executive wait condition.
+	void sync()
+	{
+		if (m_mutex.tryLock()) {
+			m_cond.wakeAll();
+			m_mutex.unlock();
+		}
+	}
+
+	// Write all pending frames out to file.
+	void flush()
+	{
+		const unsigned int iBufferSize = m_buffer.bufferSize();
+		int nread = m_pRingBuffer->read(m_ppFrames, iBufferSize);
+		while (nread > 0) {
+			m_pFile->write(m_ppFrames, nread);
+			nread = m_pRingBuffer->read(m_ppFrames, iBufferSize);
+		}
+	}
+
+	// The main thread executive.
+	void run()
+	{
+		m_mutex.lock();
+		while (m_bRunState) {
+			// Wait for sync, or just poll...
+			m_cond.wait(&m_mutex, 100);
+			flush();
+		}
+		// Whatever is left behind...
+		flush();
+		m_mutex.unlock();
+	}
+
+private:
+
+	// Instance variables.
+	qtractorAudioFile *m_pFile;
+
+	QList<qtractorAudioBus *> m_buses;
+
+	qtractorAudioExportBuffer m_buffer;
+
+	qtractorRingBuffer<float> *m_pRingBuffer;
+
+	float **m_ppFrames;
+
+	volatile bool m_bRunState;
+
+	QMutex m_mutex;
+	QWaitCondition m_cond;
+};
+
+
 //----------------------------------------------------------------------
 // qtractorAudioEngine_process -- JACK client process callback.
 //
@@ -277,6 +438,16 @@ static int qtractorAudioEngine_process ( jack_nframes_t nframes, void *pvArg )
 }
 
 
+//----------------------------------------------------------------------
+// qtractorAudioEngine_thread_init -- JACK client thread init callback.
+//
+
+static void qtractorAudioEngine_thread_init ( void * )
+{
+	qtractorAudioEngine::setFlushDenormals();
+}
+
+
 //----------------------------------------------------------------------
 // qtractorAudioEngine_timebase -- JACK timebase master callback.
 //
@@ -510,22 +681,31 @@ qtractorAudioEngine::qtractorAudioEngine ( qtractorSession *pSession )
 
 	m_bMasterAutoConnect = true;
 
+	// Deadline-aware clip read-ahead.
+	m_fPreRollTime  = 2.0f;
+	m_iPreRollFrame = (unsigned long) (-1);
+
 	// Audio-export freewheeling (internal) state.
 	m_bFreewheel = false;
 
 	// Common audio buffer sync thread.
 	m_pSyncThread = nullptr;
 
+	// Audio track render worker pool.
+	m_pAudioRender = nullptr;
+
 	// Audio-export (in)active state.
 	m_bExporting   = false;
-	m_pExportFile  = nullptr;
 	m_pExportBuses = nullptr;
-	m_pExportBuffer = nullptr;
+	m_pExportFiles = nullptr;
 	m_iExportOffset = 0;
 	m_iExportStart = 0;
 	m_iExportEnd   = 0;
 	m_bExportDone  = true;
 
+	// Offline render benchmark (if any).
+	m_pBenchmark = nullptr;
+
 	// Audio metronome stuff.
 	m_bMetronome        = false;
 	m_bMetroBus         = false;
@@ -666,6 +846,18 @@ bool qtractorAudioEngine::isMasterAutoConnect (void) const
 }
 
 
+// Deadline-aware clip read-ahead time (in seconds; 0=off).
+void qtractorAudioEngine::setPreRollTime ( float fPreRollTime )
+{
+	m_fPreRollTime = fPreRollTime;
+}
+
+float qtractorAudioEngine::preRollTime (void) const
+{
+	return m_fPreRollTime;
+}
+
+
 // Device engine initialization method.
 bool qtractorAudioEngine::init (void)
 {
@@ -723,9 +915,19 @@ bool qtractorAudioEngine::init (void)
 	// ATTN: Third is setting session sample rate.
 	pSession->setSampleRate(m_iSampleRate);
 
-	// Our dedicated audio buffer thread...
-	m_pSyncThread = new qtractorAudioBufferThread();
-	m_pSyncThread->start(QThread::HighPriority);
+	// Our shared audio buffer thread pool...
+	m_pSyncThread = pSession->syncThread();
+
+	// Our optional audio track render workers...
+	const unsigned short iRenderThreads
+		= qtractorAudioRender::defaultRenderThreads();
+	if (iRenderThreads > 0) {
+		m_pAudioRender = new qtractorAudioRender(this, iRenderThreads);
+		if (!m_pAudioRender->open()) {
+			delete m_pAudioRender;
+			m_pAudioRender = nullptr;
+		}
+	}
 
 	return true;
 }
@@ -766,6 +968,8 @@ bool qtractorAudioEngine::activate (void)
 	// Set our main engine processor callbacks.
 	jack_set_process_callback(m_pJackClient,
 			qtractorAudioEngine_process, this);
+	jack_set_thread_init_callback(m_pJackClient,
+			qtractorAudioEngine_thread_init, this);
 
 	// Transport timebase callback...
 	resetTimebase();
@@ -925,21 +1129,24 @@ void qtractorAudioEngine::clean (void)
 	deletePlayerBus();
 	deleteMetroBus();
 
-	// Terminate common player/metro sync thread...
-	if (m_pSyncThread) {
-		if (m_pSyncThread->isRunning()) do {
-			m_pSyncThread->setRunState(false);
-		//	m_pSyncThread->terminate();
-			m_pSyncThread->sync();
-		} while (!m_pSyncThread->wait(100));
-		delete m_pSyncThread;
-		m_pSyncThread = nullptr;
+	// Common player/metro sync thread pool is session owned...
+	m_pSyncThread = nullptr;
+
+	// Terminate audio track render workers...
+	if (m_pAudioRender) {
+		delete m_pAudioRender;
+		m_pAudioRender = nullptr;
 	}
 
+	// Clip read-ahead schedules are all stale now...
+	resetPreRoll();
+	reclaimPreRolls();
+
 	// Audio-export stilll around? weird...
-	if (m_pExportBuffer) {
-		delete m_pExportBuffer;
-		m_pExportBuffer = nullptr;
+	if (m_pExportFiles) {
+		qDeleteAll(*m_pExportFiles);
+		delete m_pExportFiles;
+		m_pExportFiles = nullptr;
 	}
 
 	if (m_pExportBuses) {
@@ -947,11 +1154,6 @@ void qtractorAudioEngine::clean (void)
 		m_pExportBuses = nullptr;
 	}
 
-	if (m_pExportFile) {
-		delete m_pExportFile;
-		m_pExportFile = nullptr;
-	}
-
 	// Close the JACK client, finally.
 	if (m_pJackClient) {
 		jack_client_close(m_pJackClient);
@@ -972,6 +1174,42 @@ bool qtractorAudioEngine::isProcessing (void)
 	return g_bProcessing;
 }
 
+void qtractorAudioEngine::setProcessing ( bool bProcessing )
+{
+	g_bProcessing = bProcessing;
+}
+
+
+// Denormal numbers flush-to-zero (FTZ/DAZ) on the calling thread.
+void qtractorAudioEngine::setFlushDenormals (void)
+{
+#if defined(__SSE__)
+	static const bool s_bSSE = sse_enabled();
+	if (s_bSSE) {
+	#if defined(__x86_64__) || defined(__SSE2__)
+		_mm_setcsr(_mm_getcsr() | 0x8040);	// FTZ|DAZ
+	#else
+		_mm_setcsr(_mm_getcsr() | 0x8000);	// FTZ
+	#endif
+	}
+#elif defined(__aarch64__)
+	unsigned long fpcr;
+	__asm__ __volatile__ ("mrs %0, fpcr" : "=r" (fpcr));
+	__asm__ __volatile__ ("msr fpcr, %0" : : "r" (fpcr | (1UL << 24)));
+#elif defined(__ARM_NEON__)
+	unsigned int fpscr;
+	__asm__ __volatile__ ("vmrs %0, fpscr" : "=r" (fpscr));
+	__asm__ __volatile__ ("vmsr fpscr, %0" : : "r" (fpscr | (1U << 24)));
+#endif
+}
+
+
+// Audio track render worker pool (parallel rendering).
+qtractorAudioRender *qtractorAudioEngine::audioRender (void) const
+{
+	return m_pAudioRender;
+}
+
 
 // Process cycle executive.
 int qtractorAudioEngine::process ( unsigned int nframes )
@@ -986,7 +1224,20 @@ int qtractorAudioEngine::process ( unsigned int nframes )
 	// Are we actually freewheeling for export?...
 	// notice that freewheeling has no RT requirements.
 	if (m_bFreewheel) {
+	#ifdef CONFIG_BENCHMARK
+		qtractorBenchmark *pBenchmark = m_pBenchmark;
+		if (pBenchmark)
+			pBenchmark->start();
+		process_export(nframes);
+		if (pBenchmark)
+			pBenchmark->stop(nframes);
+	#else
 		process_export(nframes);
+	#endif
+		// JACK MIDI output ports are left silent meanwhile...
+		qtractorSession *pSession = session();
+		if (pSession && pSession->midiEngine())
+			pSession->midiEngine()->clearJackOutput(nframes);
 		return 0;
 	}
 
@@ -997,16 +1248,24 @@ int qtractorAudioEngine::process ( unsigned int nframes )
 
 	// Make sure we have an actual session cursor...
 	qtractorSessionCursor *pAudioCursor = sessionCursor();
-	if (pAudioCursor == nullptr)
+	if (pAudioCursor == nullptr) {
+		pSession->midiEngine()->clearJackOutput(nframes);
 		return 0;
+	}
 
 	// Session RT-safeness lock...
-	if (!pSession->acquire())
+	if (!pSession->acquire()) {
+		// JACK MIDI output ports must be cleared anyway...
+		pSession->midiEngine()->clearJackOutput(nframes);
 		return 0;
+	}
 
 	// We're in the audio/real-time thread...
 	g_bProcessing = true;
 
+	// Apply any pending engine state changes...
+	pSession->rtCommands()->process();
+
 	// Track whether audio output buses
 	// buses needs monitoring while idle...
 	int iOutputBus = 0;
@@ -1096,10 +1355,16 @@ int qtractorAudioEngine::process ( unsigned int nframes )
 					qtractorAudioBus *pOutputBus
 						= static_cast<qtractorAudioBus *> (pTrack->outputBus());
 					if (pOutputBus) {
+					#ifdef CONFIG_DSP_LOAD
+						pTrack->dspLoad().start();
+					#endif
 						pOutputBus->buffer_prepare(nframes, pInputBus);
 						pPluginList->process(pOutputBus->buffer(), nframes);
 						pAudioMonitor->process(pOutputBus->buffer(), nframes);
 						pOutputBus->buffer_commit(nframes);
+					#ifdef CONFIG_DSP_LOAD
+						pTrack->dspLoad().stop();
+					#endif
 						++iOutputBus;
 					}
 				}
@@ -1114,6 +1379,10 @@ int qtractorAudioEngine::process ( unsigned int nframes )
 			if (pAudioBus && (iOutputBus > 0 || pAudioBus->isMonitor()))
 				pAudioBus->process_commit(nframes);
 		}
+		// JACK MIDI output ports (direct and pending note-offs)...
+		const unsigned long iFrameTime = pAudioCursor->frameTime();
+		pSession->midiEngine()->processJackOutput(
+			iFrameTime, iFrameTime + nframes, nframes);
 		// Done as idle...
 		pAudioCursor->process(nframes);
 		g_bProcessing = false;
@@ -1139,7 +1408,7 @@ int qtractorAudioEngine::process ( unsigned int nframes )
 				nframes, m_pMetroBus->channels(), 0, 1.0f);
 		} else {
 			m_iMetroBeatStart = metro_offset(pNode->frameFromBeat(++m_iMetroBeat));
-			pMetroBuff->reset(false);
+			pMetroBuff->reset(false, m_iMetroBeatStart);
 		}
 		if (m_bMetroBus && m_pMetroBus)
 			m_pMetroBus->process_commit(nframes);
@@ -1183,7 +1452,7 @@ int qtractorAudioEngine::process ( unsigned int nframes )
 				// Loop-length might be shorter than the buffer-period...
 				while (iFrameEnd2 >= iLoopEnd + nframes2) {
 					// Process the remaining until end-of-loop...
-					pSession->process(pAudioCursor, iFrameStart2, iLoopEnd);
+					process_tracks(pAudioCursor, iFrameStart2, iLoopEnd);
 					m_iBufferOffset += (iLoopEnd - iFrameStart2);
 					// Reset to start-of-loop...
 					iFrameStart2 = pSession->loopStart();
@@ -1198,10 +1467,14 @@ int qtractorAudioEngine::process ( unsigned int nframes )
 			}
 		}
 		// Regular range playback...
-		pSession->process(pAudioCursor, iFrameStart2, iFrameEnd2);
+		process_tracks(pAudioCursor, iFrameStart2, iFrameEnd2);
 		m_iBufferOffset += (iFrameEnd2 - iFrameStart2);
 	}
 
+	// JACK MIDI output ports, sample-accurate...
+	pSession->midiEngine()->processJackOutput(
+		iFrameTimeStart, iFrameTimeEnd, nframes);
+
 	// Commit current audio buses...
 	for (pBus = buses().first(); pBus; pBus = pBus->next()) {
 		pAudioBus = static_cast<qtractorAudioBus *> (pBus);
@@ -1232,6 +1505,9 @@ int qtractorAudioEngine::process ( unsigned int nframes )
 	pAudioCursor->seek(iFrameEnd);
 	pAudioCursor->process(nframes);
 
+	// Get upcoming clips ready in time...
+	process_preroll(pAudioCursor);
+
 	// Always sync to MIDI output thread...
 	// (sure we have a MIDI engine, no?)
 	pSession->midiEngine()->sync();
@@ -1245,14 +1521,201 @@ int qtractorAudioEngine::process ( unsigned int nframes )
 }
 
 
+// Regular range playback executive (serial or parallel).
+void qtractorAudioEngine::process_tracks (
+	qtractorSessionCursor *pAudioCursor,
+	unsigned long iFrameStart, unsigned long iFrameEnd )
+{
+	if (m_pAudioRender)
+		m_pAudioRender->process(pAudioCursor, iFrameStart, iFrameEnd);
+	else
+		session()->process(pAudioCursor, iFrameStart, iFrameEnd);
+}
+
+
+// Deadline-aware clip read-ahead schedule: the clips starting
+// within the next few seconds, each one due by its start time.
+struct qtractorAudioEngine::PreRoll
+{
+	struct Item
+	{
+		qtractorAudioClip *clip;
+		unsigned long      deadline;
+	};
+
+	PreRoll     *next;
+	unsigned int count;
+	Item         items[1];
+};
+
+
+// Deadline-aware clip read-ahead executive: just have the
+// schedule pre-built elsewhere applied, if any (RT).
+void qtractorAudioEngine::process_preroll (
+	qtractorSessionCursor *pAudioCursor )
+{
+	PreRoll *pPreRoll = m_pNextPreRoll.fetchAndStoreOrdered(nullptr);
+	if (pPreRoll == nullptr)
+		return;
+
+	// Those not started yet are still due...
+	const unsigned long iFrame = pAudioCursor->frame();
+	for (unsigned int i = 0; i < pPreRoll->count; ++i) {
+		const PreRoll::Item& item = pPreRoll->items[i];
+		if (item.deadline > iFrame)
+			item.clip->preRoll(iFrame, item.deadline);
+	}
+
+	retirePreRoll(pPreRoll);
+}
+
+
+// Deadline-aware clip read-ahead schedule (re)build (non-RT).
+//
+// Only ever called from the GUI thread, the very one that owns
+// and edits the track clip lists: the RT thread just publishes
+// its cursor frame and picks up the resulting schedule.
+void qtractorAudioEngine::updatePreRoll (void)
+{
+	// Get rid of whatever the RT thread is done with...
+	reclaimPreRolls();
+
+	if (!isActivated() || isFreewheel())
+		return;
+
+	qtractorSession *pSession = session();
+	if (pSession == nullptr)
+		return;
+
+	// Start all over when stopped...
+	if (!pSession->isPlaying()) {
+		m_iPreRollFrame = (unsigned long) (-1);
+		return;
+	}
+
+	const unsigned long iPreRollFrames
+		= (unsigned long) (m_fPreRollTime * float(m_iSampleRate));
+	if (iPreRollFrames < m_iBufferSize)
+		return;
+
+	// Don't bother every time, unless we've just jumped back...
+	const unsigned long iFrame = sessionCursor()->frame();
+	if (iFrame >= m_iPreRollFrame
+		&& iFrame < m_iPreRollFrame + (iPreRollFrames >> 3))
+		return;
+
+	m_iPreRollFrame = iFrame;
+
+	// Take care of the loop wrap-around, if any...
+	unsigned long iPreRollEnd = iFrame + iPreRollFrames;
+	unsigned long iLoopStart = 0;
+	unsigned long iLoopEnd = 0;
+	if (pSession->isLooping()
+		&& iFrame < pSession->loopEnd()
+		&& iPreRollEnd > pSession->loopEnd()) {
+		iLoopStart  = pSession->loopStart();
+		iLoopEnd    = pSession->loopEnd();
+		iPreRollEnd = iLoopEnd;
+	}
+
+	QList<PreRoll::Item> items;
+	PreRoll::Item item;
+
+	for (qtractorTrack *pTrack = pSession->tracks().first();
+			pTrack; pTrack = pTrack->next()) {
+		if (pTrack->trackType() != qtractorTrack::Audio)
+			continue;
+		// Upcoming clips, as from the current position...
+		qtractorClip *pClip = pTrack->clipIndex().seekClip(iFrame);
+		if (pClip == nullptr)
+			pClip = pTrack->clips().first();
+		while (pClip && pClip->clipStart() < iPreRollEnd) {
+			const unsigned long iClipStart = pClip->clipStart();
+			if (iClipStart > iFrame) {
+				item.clip = static_cast<qtractorAudioClip *> (pClip);
+				item.deadline = iClipStart;
+				items.append(item);
+			}
+			pClip = pClip->next();
+		}
+		// Upcoming clips, as from the loop-start...
+		if (iLoopStart < iLoopEnd) {
+			const unsigned long iLoopPreRollEnd
+				= iLoopStart + (iFrame + iPreRollFrames - iLoopEnd);
+			pClip = pTrack->clipIndex().seekClip(iLoopStart);
+			if (pClip == nullptr)
+				pClip = pTrack->clips().first();
+			while (pClip && pClip->clipStart() < iLoopPreRollEnd) {
+				const unsigned long iClipStart = pClip->clipStart();
+				if (iClipStart >= iLoopStart) {
+					item.clip = static_cast<qtractorAudioClip *> (pClip);
+					item.deadline = iLoopEnd + (iClipStart - iLoopStart);
+					items.append(item);
+				}
+				pClip = pClip->next();
+			}
+		}
+	}
+
+	if (items.isEmpty())
+		return;
+
+	// Freeze it...
+	const unsigned int iCount = items.count();
+	PreRoll *pPreRoll = static_cast<PreRoll *> (::malloc(
+		sizeof(PreRoll) + (iCount - 1) * sizeof(PreRoll::Item)));
+	pPreRoll->next  = nullptr;
+	pPreRoll->count = iCount;
+	for (unsigned int i = 0; i < iCount; ++i)
+		pPreRoll->items[i] = items.at(i);
+
+	// Replace any pending one that didn't make it in time...
+	pPreRoll = m_pNextPreRoll.fetchAndStoreOrdered(pPreRoll);
+	if (pPreRoll)
+		::free(pPreRoll);
+}
+
+
+// Drop any pending clip read-ahead schedule (RT-safe): must be
+// called whenever clips are about to be closed or unlinked.
+void qtractorAudioEngine::resetPreRoll (void)
+{
+	PreRoll *pPreRoll = m_pNextPreRoll.fetchAndStoreOrdered(nullptr);
+	if (pPreRoll)
+		retirePreRoll(pPreRoll);
+}
+
+
+// Clip read-ahead schedule retirement (RT-safe).
+void qtractorAudioEngine::retirePreRoll ( PreRoll *pPreRoll )
+{
+	PreRoll *pRetired;
+	do {
+		pRetired = m_pRetiredPreRolls.loadAcquire();
+		pPreRoll->next = pRetired;
+	} while (!m_pRetiredPreRolls.testAndSetOrdered(pRetired, pPreRoll));
+}
+
+
+// Clip read-ahead schedules reclamation (non-RT).
+void qtractorAudioEngine::reclaimPreRolls (void)
+{
+	PreRoll *pPreRoll = m_pRetiredPreRolls.fetchAndStoreOrdered(nullptr);
+	while (pPreRoll) {
+		PreRoll *pNext = pPreRoll->next;
+		::free(pPreRoll);
+		pPreRoll = pNext;
+	}
+}
+
+
 // Freewheeling process cycle executive (needed for export).
 void qtractorAudioEngine::process_export ( unsigned int nframes )
 {
 	if (m_bExportDone)
 		return;
-	if (m_pExportBuses  == nullptr ||
-		m_pExportFile   == nullptr ||
-		m_pExportBuffer == nullptr)
+	if (m_pExportBuses == nullptr ||
+		m_pExportFiles == nullptr)
 		return;
 
 	qtractorSession *pSession = session();
@@ -1287,8 +1750,6 @@ void qtractorAudioEngine::process_export ( unsigned int nframes )
 
 	// Write output bus buffers to export audio file...
 	if (iFrameStart < m_iExportEnd) {
-		// Prepare mix-down buffer...
-		m_pExportBuffer->process_prepare(nframes);
 		for (unsigned long iFrameStart2 = iFrameStart;
 				iFrameStart2 < iFrameEnd; iFrameStart2 += nframes2) {
 			// Update time(base) info...
@@ -1304,13 +1765,18 @@ void qtractorAudioEngine::process_export ( unsigned int nframes )
 				pMidiManager->process(iFrameStart2, iFrameEnd2);
 				pMidiManager = pMidiManager->next();
 			}
-			// Perform all tracks processing...
-			int iTrack = 0;
-			for (qtractorTrack *pTrack = pSession->tracks().first();
-					pTrack; pTrack = pTrack->next()) {
-				pTrack->process_export(pAudioCursor->clip(iTrack),
-					iFrameStart2, iFrameEnd2);
-				++iTrack;
+			// Perform all tracks processing (serial or parallel)...
+			if (m_pAudioRender) {
+				m_pAudioRender->process_export(
+					pAudioCursor, iFrameStart2, iFrameEnd2);
+			} else {
+				int iTrack = 0;
+				for (qtractorTrack *pTrack = pSession->tracks().first();
+						pTrack; pTrack = pTrack->next()) {
+					pTrack->process_export(pAudioCursor->clip(iTrack),
+						iFrameStart2, iFrameEnd2);
+					++iTrack;
+				}
 			}
 			m_iBufferOffset += (iFrameEnd2 - iFrameStart2);
 		}
@@ -1321,13 +1787,12 @@ void qtractorAudioEngine::process_export ( unsigned int nframes )
 			nframes -= (iFrameEnd - m_iExportEnd);
 		// Commit the output buses...
 		iter.toFront();
-		while (iter.hasNext()) {
-			qtractorAudioBus *pExportBus = iter.next();
-			pExportBus->process_commit(nframes);
-			m_pExportBuffer->process_add(pExportBus, nframes);
-		}
-		// Write to export file...
-		m_pExportFile->write(m_pExportBuffer->buffer(), nframes);
+		while (iter.hasNext())
+			iter.next()->process_commit(nframes);
+		// Mix-down and hand over to each export file writer...
+		QListIterator<qtractorAudioExportFile *> file_iter(*m_pExportFiles);
+		while (file_iter.hasNext())
+			file_iter.next()->process(nframes);
 		// HACK! Freewheeling observers update (non RT safe!)...
 		qtractorSubject::flushQueue(false);
 	} else {
@@ -1632,10 +2097,46 @@ unsigned long qtractorAudioEngine::exportLength (void) const
 
 
 
+// Offline render benchmark (freewheel cycle timing).
+void qtractorAudioEngine::setBenchmark ( qtractorBenchmark *pBenchmark )
+{
+	m_pBenchmark = pBenchmark;
+}
+
+qtractorBenchmark *qtractorAudioEngine::benchmark (void) const
+{
+	return m_pBenchmark;
+}
+
+
 // Audio-export method.
 bool qtractorAudioEngine::fileExport (
 	const QString& sExportPath, const QList<qtractorAudioBus *>& exportBuses,
 	unsigned long iExportStart, unsigned long iExportEnd, int iExportFormat )
+{
+	return fileExportEx(QStringList(sExportPath), exportBuses, false,
+		iExportStart, iExportEnd, iExportFormat);
+}
+
+
+// Audio-export stems method (one file per bus, in one single pass).
+bool qtractorAudioEngine::fileExportStems (
+	const QStringList& exportPaths, const QList<qtractorAudioBus *>& exportBuses,
+	unsigned long iExportStart, unsigned long iExportEnd, int iExportFormat )
+{
+	if (exportPaths.count() != exportBuses.count())
+		return false;
+
+	return fileExportEx(exportPaths, exportBuses, true,
+		iExportStart, iExportEnd, iExportFormat);
+}
+
+
+// Audio-export executive (either mix-down or stems).
+bool qtractorAudioEngine::fileExportEx (
+	const QStringList& exportPaths, const QList<qtractorAudioBus *>& exportBuses,
+	bool bStems, unsigned long iExportStart, unsigned long iExportEnd,
+	int iExportFormat )
 {
 	// No simultaneous or foul exports...
 	if (!isActivated() || isPlaying() || isExporting())
@@ -1650,14 +2151,11 @@ bool qtractorAudioEngine::fileExport (
 	if (pAudioCursor == nullptr)
 		return false;
 
-	// About to show some progress bar...
+	// About to show some progress bar (none when headless)...
+	QProgressBar *pProgressBar = nullptr;
 	qtractorMainForm *pMainForm = qtractorMainForm::getInstance();
-	if (pMainForm == nullptr)
-		return false;
-
-	QProgressBar *pProgressBar = pMainForm->progressBar();
-	if (pProgressBar == nullptr)
-		return false;
+	if (pMainForm)
+		pProgressBar = pMainForm->progressBar();
 
 	// Cannot have exports longer than current session.
 	if (iExportStart >= iExportEnd)
@@ -1671,20 +2169,55 @@ bool qtractorAudioEngine::fileExport (
 	if (pExportBus == nullptr)
 		return false;
 
-	// Get proper file type class...
-	const unsigned int iChannels = pExportBus->channels();
-	qtractorAudioFile *pExportFile
-		= qtractorAudioFileFactory::createAudioFile(sExportPath,
-			iChannels, sampleRate(), bufferSizeEx(), iExportFormat);
-	// No file ready for export?
-	if (pExportFile == nullptr)
-		return false;
-	// Go open it, for writing of course...
-	if (!pExportFile->open(sExportPath, qtractorAudioFile::Write)) {
-		delete pExportFile;
-		return false;
+	// Writer ring-buffer, about one second worth...
+	const unsigned int iRingSize = sampleRate();
+
+	// Get proper file type class, for each one...
+	QList<qtractorAudioExportFile *> *pExportFiles
+		= new QList<qtractorAudioExportFile *> ();
+	const int iExportPaths = exportPaths.count();
+	for (int i = 0; i < iExportPaths; ++i) {
+		const QString& sExportPath = exportPaths.at(i);
+		// Stems get their own bus channels...
+		QList<qtractorAudioBus *> fileBuses;
+		if (bStems) {
+			pExportBus = exportBuses.at(i);
+			fileBuses.append(pExportBus);
+		} else {
+			fileBuses = exportBuses;
+		}
+		const unsigned int iChannels = pExportBus->channels();
+		qtractorAudioFile *pExportFile = nullptr;
+		// An empty export path is a null sink (eg. benchmarking)...
+		if (!sExportPath.isEmpty()) {
+			pExportFile = qtractorAudioFileFactory::createAudioFile(sExportPath,
+				iChannels, sampleRate(), bufferSizeEx(), iExportFormat);
+			// Go open it, for writing of course...
+			if (pExportFile
+				&& !pExportFile->open(sExportPath, qtractorAudioFile::Write)) {
+				delete pExportFile;
+				pExportFile = nullptr;
+			}
+			// No file ready for export?
+			if (pExportFile == nullptr) {
+				qDeleteAll(*pExportFiles);
+				delete pExportFiles;
+				return false;
+			}
+		}
+		pExportFiles->append(new qtractorAudioExportFile(pExportFile,
+			fileBuses, iChannels, bufferSizeEx(), iRingSize));
 	}
 
+	// Make sure the parallel rendering graph is up-to-date...
+	if (m_pAudioRender && m_pAudioRender->isGraphDirty())
+		m_pAudioRender->updateGraph();
+
+	// Start the (pipelined) file writers...
+	QListIterator<qtractorAudioExportFile *> file_iter(*pExportFiles);
+	while (file_iter.hasNext())
+		file_iter.next()->open();
+
 	// We'll be busy...
 	pSession->lock();
 
@@ -1694,16 +2227,17 @@ bool qtractorAudioEngine::fileExport (
 	// Start with fixing the export range...
 	m_bExporting   = true;
 	m_pExportBuses = new QList<qtractorAudioBus *> (exportBuses);
-	m_pExportFile  = pExportFile;
-	m_pExportBuffer = new qtractorAudioExportBuffer(iChannels, bufferSizeEx());
+	m_pExportFiles = pExportFiles;
 	m_iExportStart = iExportStart;
 	m_iExportEnd   = iExportEnd;
 	m_bExportDone  = false;
 
 	// Prepare and show some progress...
-	pProgressBar->setRange(iExportStart, iExportEnd);
-	pProgressBar->reset();
-	pProgressBar->show();
+	if (pProgressBar) {
+		pProgressBar->setRange(iExportStart, iExportEnd);
+		pProgressBar->reset();
+		pProgressBar->show();
+	}
 
 	// We'll have to save some session parameters...
 	const unsigned long iPlayHead  = pSession->playHead();
@@ -1761,14 +2295,17 @@ bool qtractorAudioEngine::fileExport (
 	#endif
 	#endif
 		::nanosleep(&ts, nullptr); // Ain't that enough?
-		pProgressBar->setValue(pSession->playHead());
+		if (pProgressBar)
+			pProgressBar->setValue(pSession->playHead());
 	}
 
 	// Stop export (freewheeling)...
 	jack_set_freewheel(m_pJackClient, 0);
 
-	// May close the file...
-	m_pExportFile->close();
+	// May flush and close the files...
+	file_iter.toFront();
+	while (file_iter.hasNext())
+		file_iter.next()->close();
 
 	// Restore session at ease...
 	pSession->setLoop(iLoopStart, iLoopEnd);
@@ -1784,17 +2321,17 @@ bool qtractorAudioEngine::fileExport (
 	const bool bResult = m_bExporting;
 
 	// Free up things here.
-	delete m_pExportBuffer;
+	qDeleteAll(*m_pExportFiles);
+	delete m_pExportFiles;
 	delete m_pExportBuses;
-	delete m_pExportFile;
 
 	// Made some progress...
-	pProgressBar->hide();
+	if (pProgressBar)
+		pProgressBar->hide();
 
 	m_bExporting   = false;
 	m_pExportBuses = nullptr;
-	m_pExportFile  = nullptr;
-	m_pExportBuffer = nullptr;
+	m_pExportFiles = nullptr;
 //	m_iExportStart = 0;
 //	m_iExportEnd   = 0;
 	m_bExportDone  = true;
@@ -2902,26 +3439,39 @@ void qtractorAudioBus::process_commit ( unsigned int nframes )
 
 
 // Bus-buffering methods.
-void qtractorAudioBus::buffer_prepare (
+bool qtractorAudioBus::buffer_prepare (
+	unsigned int nframes, qtractorAudioBus *pInputBus )
+{
+	return buffer_prepare(m_ppXBuffer, m_ppYBuffer, nframes, pInputBus);
+}
+
+void qtractorAudioBus::buffer_commit ( unsigned int nframes )
+{
+	buffer_commit(m_ppXBuffer, nframes);
+}
+
+
+// Bus-buffering methods (on external buffers).
+bool qtractorAudioBus::buffer_prepare ( float **ppXBuffer, float **ppYBuffer,
 	unsigned int nframes, qtractorAudioBus *pInputBus )
 {
 	if (!m_bEnabled)
-		return;
+		return false;
 
 	qtractorAudioEngine *pAudioEngine
 		= static_cast<qtractorAudioEngine *> (engine());
 	if (pAudioEngine == nullptr)
-		return;
+		return false;
 
 	const unsigned int offset = pAudioEngine->bufferOffset();
 	const unsigned int nbytes = nframes * sizeof(float);
 
 	if (pInputBus == nullptr) {
 		for (unsigned short i = 0; i < m_iChannels; ++i) {
-			m_ppYBuffer[i] = m_ppXBuffer[i] + offset;
-			::memset(m_ppYBuffer[i], 0, nbytes);
+			ppYBuffer[i] = ppXBuffer[i] + offset;
+			::memset(ppYBuffer[i], 0, nbytes);
 		}
-		return;
+		return true;
 	}
 
 	const unsigned short iBuffers = pInputBus->channels();
@@ -2930,31 +3480,33 @@ void qtractorAudioBus::buffer_prepare (
 	if (m_iChannels == iBuffers) {
 		// Exact buffer copy...
 		for (unsigned short i = 0; i < iBuffers; ++i) {
-			m_ppYBuffer[i] = m_ppXBuffer[i] + offset;
-			::memcpy(m_ppYBuffer[i], ppBuffer[i] + offset, nbytes);
+			ppYBuffer[i] = ppXBuffer[i] + offset;
+			::memcpy(ppYBuffer[i], ppBuffer[i] + offset, nbytes);
 		}
 	} else {
 		// Buffer merge/multiplex...
 		unsigned short i;
 		for (i = 0; i < m_iChannels; ++i) {
-			m_ppYBuffer[i] = m_ppXBuffer[i] + offset;
-			::memset(m_ppYBuffer[i], 0, nbytes);
+			ppYBuffer[i] = ppXBuffer[i] + offset;
+			::memset(ppYBuffer[i], 0, nbytes);
 		}
 		if (m_iChannels > iBuffers) {
 			unsigned short j = 0;
 			for (i = 0; i < m_iChannels; ++i) {
-				::memcpy(m_ppYBuffer[i], ppBuffer[j] + offset, nbytes);
+				::memcpy(ppYBuffer[i], ppBuffer[j] + offset, nbytes);
 				if (++j >= iBuffers)
 					j = 0;
 			}
 		} else { // (m_iChannels < iBuffers)
-			(*m_pfnBufferAdd)(m_ppXBuffer, ppBuffer,
+			(*m_pfnBufferAdd)(ppXBuffer, ppBuffer,
 				nframes, m_iChannels, iBuffers, offset);
 		}
 	}
+
+	return false;
 }
 
-void qtractorAudioBus::buffer_commit ( unsigned int nframes )
+void qtractorAudioBus::buffer_commit ( float **ppXBuffer, unsigned int nframes )
 {
 	if (!m_bEnabled || (busMode() & qtractorBus::Output) == 0)
 		return;
@@ -2964,7 +3516,7 @@ void qtractorAudioBus::buffer_commit ( unsigned int nframes )
 	if (pAudioEngine == nullptr)
 		return;
 
-	(*m_pfnBufferAdd)(m_ppOBuffer, m_ppXBuffer,
+	(*m_pfnBufferAdd)(m_ppOBuffer, ppXBuffer,
 		nframes, m_iChannels, m_iChannels, pAudioEngine->bufferOffset());
 }
 
@@ -28,6 +28,8 @@
 #include <jack/jack.h>
 
 #include <QObject>
+#include <QStringList>
+#include <QAtomicPointer>
 
 
 // Forward declarations.
@@ -35,7 +37,9 @@ class qtractorAudioBus;
 class qtractorAudioBuffer;
 class qtractorAudioMonitor;
 class qtractorAudioFile;
-class qtractorAudioExportBuffer;
+class qtractorAudioExportFile;
+class qtractorAudioRender;
+class qtractorBenchmark;
 class qtractorPluginList;
 class qtractorCurveList;
 
@@ -143,6 +147,16 @@ public:
 	void setMasterAutoConnect(bool bMasterAutoConnect);
 	bool isMasterAutoConnect() const;
 
+	// Deadline-aware clip read-ahead time (in seconds; 0=off).
+	void setPreRollTime(float fPreRollTime);
+	float preRollTime() const;
+
+	// Deadline-aware clip read-ahead schedule (re)build (non-RT).
+	void updatePreRoll();
+
+	// Drop any pending clip read-ahead schedule (RT-safe).
+	void resetPreRoll();
+
 	// Audio-export freewheeling (internal) state.
 	void setFreewheel(bool bFreewheel);
 	bool isFreewheel() const;
@@ -162,6 +176,16 @@ public:
 		unsigned long iExportStart, unsigned long iExportEnd,
 		int iExportFormat = -1);
 
+	// Audio-export stems method (one file per bus, in one single pass).
+	bool fileExportStems(const QStringList& exportPaths,
+		const QList<qtractorAudioBus *>& exportBuses,
+		unsigned long iExportStart, unsigned long iExportEnd,
+		int iExportFormat = -1);
+
+	// Offline render benchmark (freewheel cycle timing).
+	void setBenchmark(qtractorBenchmark *pBenchmark);
+	qtractorBenchmark *benchmark() const;
+
 	// Special track-immediate methods.
 	void trackMute(qtractorTrack *pTrack, bool bMute);
 
@@ -246,6 +270,13 @@ public:
 
 	// Whether we're in the audio/real-time thread...
 	static bool isProcessing();
+	static void setProcessing(bool bProcessing);
+
+	// Denormal numbers flush-to-zero (calling thread).
+	static void setFlushDenormals();
+
+	// Audio track render worker pool (parallel rendering).
+	qtractorAudioRender *audioRender() const;
 
 	// Time(base)/BBT info.
 	struct TimeInfo
@@ -294,6 +325,28 @@ protected:
 	// Freewheeling process cycle executive (needed for export).
 	void process_export(unsigned int nframes);
 
+	// Audio-export executive (either mix-down or stems).
+	bool fileExportEx(const QStringList& exportPaths,
+		const QList<qtractorAudioBus *>& exportBuses, bool bStems,
+		unsigned long iExportStart, unsigned long iExportEnd,
+		int iExportFormat);
+
+	// Regular range playback executive (serial or parallel).
+	void process_tracks(qtractorSessionCursor *pAudioCursor,
+		unsigned long iFrameStart, unsigned long iFrameEnd);
+
+	// Deadline-aware clip read-ahead executive.
+	void process_preroll(qtractorSessionCursor *pAudioCursor);
+
+	// Deadline-aware clip read-ahead schedule (opaque).
+	struct PreRoll;
+
+	// Clip read-ahead schedule retirement (RT-safe).
+	void retirePreRoll(PreRoll *pPreRoll);
+
+	// Clip read-ahead schedules reclamation (non-RT).
+	void reclaimPreRolls();
+
 	// Metronome latency offset compensation.
 	unsigned long metro_offset(unsigned long iFrame) const;
 
@@ -325,22 +378,35 @@ private:
 	// Audio (Master) bus defaults.
 	bool m_bMasterAutoConnect;
 
+	// Deadline-aware clip read-ahead time and last frame (non-RT).
+	float         m_fPreRollTime;
+	unsigned long m_iPreRollFrame;
+
+	// Pending (next) and retired clip read-ahead schedules.
+	QAtomicPointer<PreRoll> m_pNextPreRoll;
+	QAtomicPointer<PreRoll> m_pRetiredPreRolls;
+
 	// Audio-export freewheeling (internal) state.
 	bool m_bFreewheel;
 
-	// Common audio buffer sync thread.
+	// Common audio buffer sync thread pool (session owned).
 	qtractorAudioBufferThread *m_pSyncThread;
 
+	// Audio track render worker pool.
+	qtractorAudioRender *m_pAudioRender;
+
 	// Audio-export (in)active state.
 	volatile bool        m_bExporting;
-	qtractorAudioFile   *m_pExportFile;
 	unsigned long        m_iExportOffset;
 	unsigned long        m_iExportStart;
 	unsigned long        m_iExportEnd;
 	volatile bool        m_bExportDone;
 
-	QList<qtractorAudioBus *> *m_pExportBuses;
-	qtractorAudioExportBuffer *m_pExportBuffer;
+	QList<qtractorAudioBus *>        *m_pExportBuses;
+	QList<qtractorAudioExportFile *> *m_pExportFiles;
+
+	// Offline render benchmark (freewheel cycle timing).
+	qtractorBenchmark *m_pBenchmark;
 
 	// Audio metronome stuff.
 	bool                 m_bMetronome;
@@ -418,11 +484,17 @@ public:
 	void process_monitor(unsigned int nframes);
 	void process_commit(unsigned int nframes);
 
-	// Bus-buffering methods.
-	void buffer_prepare(unsigned int nframes,
+	// Bus-buffering methods
+	// (prepare tells whether the buffer is left silent).
+	bool buffer_prepare(unsigned int nframes,
 		qtractorAudioBus *pInputBus = nullptr);
 	void buffer_commit(unsigned int nframes);
 
+	// Bus-buffering methods (on external buffers).
+	bool buffer_prepare(float **ppXBuffer, float **ppYBuffer,
+		unsigned int nframes, qtractorAudioBus *pInputBus = nullptr);
+	void buffer_commit(float **ppXBuffer, unsigned int nframes);
+
 	// Up-and-running predicate.
 	bool isEnabled() const { return m_bEnabled; }
 
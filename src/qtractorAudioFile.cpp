@@ -25,6 +25,10 @@
 #include "qtractorAudioVorbisFile.h"
 #include "qtractorAudioMadFile.h"
 
+#if !defined(__WIN32__) && !defined(_WIN32) && !defined(WIN32)
+#include "qtractorAudioMmapFile.h"
+#endif
+
 #include <QRegularExpression>
 #include <QFileInfo>
 
@@ -181,6 +185,13 @@ qtractorAudioFile *qtractorAudioFileFactory::newAudioFile (
 		while (iFormat > 0 && // Retry down to PCM Signed 16-Bit...
 			!qtractorAudioSndFile::isValidFormat(pFormat->data, iFormat))
 			--iFormat;
+	#if !defined(__WIN32__) && !defined(_WIN32) && !defined(WIN32)
+		// Plain PCM files may be read straight from memory...
+		if (qtractorAudioMmapFile::isMmapFile(sFilename))
+			return new qtractorAudioMmapFile(
+				iChannels, iSampleRate, iBufferSize,
+				qtractorAudioSndFile::format(pFormat->data, iFormat));
+	#endif
 		return new qtractorAudioSndFile(
 			iChannels, iSampleRate, iBufferSize,
 			qtractorAudioSndFile::format(pFormat->data, iFormat));
@@ -0,0 +1,739 @@
+// qtractorAudioMmapFile.cpp
+//
+/****************************************************************************
+   Copyright (C) 2005-2022, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qtractorAbout.h"
+#include "qtractorAudioMmapFile.h"
+
+#include <QFileInfo>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <signal.h>
+#include <setjmp.h>
+
+#include <stdint.h>
+#include <string.h>
+
+
+// Sensible conversion block size (in frames).
+#define BUFFER_SIZE 1024
+
+
+// Little/big-endian header field helpers.
+static inline unsigned int get_le16 ( const unsigned char *p )
+{
+	return (unsigned int) (p[0] | (p[1] << 8));
+}
+
+static inline unsigned int get_le32 ( const unsigned char *p )
+{
+	return (unsigned int) p[0]
+		| ((unsigned int) p[1] << 8)
+		| ((unsigned int) p[2] << 16)
+		| ((unsigned int) p[3] << 24);
+}
+
+static inline unsigned long long get_le64 ( const unsigned char *p )
+{
+	return (unsigned long long) get_le32(p)
+		| ((unsigned long long) get_le32(p + 4) << 32);
+}
+
+static inline unsigned int get_be32 ( const unsigned char *p )
+{
+	return ((unsigned int) p[0] << 24)
+		| ((unsigned int) p[1] << 16)
+		| ((unsigned int) p[2] << 8)
+		| (unsigned int) p[3];
+}
+
+static inline unsigned long long get_be64 ( const unsigned char *p )
+{
+	return ((unsigned long long) get_be32(p) << 32)
+		| (unsigned long long) get_be32(p + 4);
+}
+
+
+// Standard sample conversion processor versions
+// (same normalization as libsndfile does).
+static inline void std_int16_to_float (
+	float *pFrames, const unsigned char *pData, unsigned int iSamples )
+{
+	const float fScale = 1.0f / float(0x8000);
+	for (unsigned int n = 0; n < iSamples; ++n, pData += 2)
+		*pFrames++ = fScale * float(int16_t(get_le16(pData)));
+}
+
+static inline void std_int24_to_float (
+	float *pFrames, const unsigned char *pData, unsigned int iSamples )
+{
+	const float fScale = 1.0f / float(0x800000);
+	for (unsigned int n = 0; n < iSamples; ++n, pData += 3) {
+		const int32_t v = int32_t(
+			((unsigned int) pData[0] << 8)  |
+			((unsigned int) pData[1] << 16) |
+			((unsigned int) pData[2] << 24)) >> 8;
+		*pFrames++ = fScale * float(v);
+	}
+}
+
+static inline void std_int32_to_float (
+	float *pFrames, const unsigned char *pData, unsigned int iSamples )
+{
+	const float fScale = 1.0f / float(0x80000000U);
+	for (unsigned int n = 0; n < iSamples; ++n, pData += 4)
+		*pFrames++ = fScale * float(int32_t(get_le32(pData)));
+}
+
+static inline void std_float32_to_float (
+	float *pFrames, const unsigned char *pData, unsigned int iSamples )
+{
+	::memcpy(pFrames, pData, iSamples * sizeof(float));
+}
+
+
+#if defined(__SSE2__)
+
+#include <emmintrin.h>
+
+// SSE2 detection.
+static inline bool sse2_enabled (void)
+{
+#if defined(__GNUC__)
+	unsigned int eax, ebx, ecx, edx;
+#if defined(__x86_64__) || (!defined(PIC) && !defined(__PIC__))
+	__asm__ __volatile__ (
+		"cpuid\n\t" \
+		: "=a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx) \
+		: "a" (1) : "cc");
+#else
+	__asm__ __volatile__ (
+		"push %%ebx\n\t" \
+		"cpuid\n\t" \
+		"movl %%ebx,%1\n\t" \
+		"pop %%ebx\n\t" \
+		: "=a" (eax), "=r" (ebx), "=c" (ecx), "=d" (edx) \
+		: "a" (1) : "cc");
+#endif
+	return (edx & (1 << 26));
+#else
+	return false;
+#endif
+}
+
+
+// SSE2 enabled sample conversion processor versions.
+static inline void sse2_int16_to_float (
+	float *pFrames, const unsigned char *pData, unsigned int iSamples )
+{
+	const __m128 vScale = _mm_set1_ps(1.0f / float(0x8000));
+	unsigned int nsamples = iSamples;
+	for (; nsamples >= 8; nsamples -= 8) {
+		const __m128i v = _mm_loadu_si128((const __m128i *) pData);
+		const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+		const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+		_mm_storeu_ps(pFrames + 0, _mm_mul_ps(_mm_cvtepi32_ps(lo), vScale));
+		_mm_storeu_ps(pFrames + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), vScale));
+		pFrames += 8;
+		pData += 16;
+	}
+	std_int16_to_float(pFrames, pData, nsamples);
+}
+
+static inline void sse2_int32_to_float (
+	float *pFrames, const unsigned char *pData, unsigned int iSamples )
+{
+	const __m128 vScale = _mm_set1_ps(1.0f / float(0x80000000U));
+	unsigned int nsamples = iSamples;
+	for (; nsamples >= 4; nsamples -= 4) {
+		const __m128i v = _mm_loadu_si128((const __m128i *) pData);
+		_mm_storeu_ps(pFrames, _mm_mul_ps(_mm_cvtepi32_ps(v), vScale));
+		pFrames += 4;
+		pData += 16;
+	}
+	std_int32_to_float(pFrames, pData, nsamples);
+}
+
+#endif // __SSE2__
+
+
+#if defined(__ARM_NEON__)
+
+#include "arm_neon.h"
+
+// NEON enabled sample conversion processor versions.
+static inline void neon_int16_to_float (
+	float *pFrames, const unsigned char *pData, unsigned int iSamples )
+{
+	const float32x4_t vScale = vdupq_n_f32(1.0f / float(0x8000));
+	unsigned int nsamples = iSamples;
+	for (; nsamples >= 8; nsamples -= 8) {
+		const int16x8_t v = vreinterpretq_s16_u8(vld1q_u8(pData));
+		vst1q_f32(pFrames + 0, vmulq_f32(
+			vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), vScale));
+		vst1q_f32(pFrames + 4, vmulq_f32(
+			vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), vScale));
+		pFrames += 8;
+		pData += 16;
+	}
+	std_int16_to_float(pFrames, pData, nsamples);
+}
+
+static inline void neon_int32_to_float (
+	float *pFrames, const unsigned char *pData, unsigned int iSamples )
+{
+	const float32x4_t vScale = vdupq_n_f32(1.0f / float(0x80000000U));
+	unsigned int nsamples = iSamples;
+	for (; nsamples >= 4; nsamples -= 4) {
+		const int32x4_t v = vreinterpretq_s32_u8(vld1q_u8(pData));
+		vst1q_f32(pFrames, vmulq_f32(vcvtq_f32_s32(v), vScale));
+		pFrames += 4;
+		pData += 16;
+	}
+	std_int32_to_float(pFrames, pData, nsamples);
+}
+
+#endif // __ARM_NEON__
+
+
+// Mapped pages past the end of a file that got truncated meanwhile
+// (eg. rewritten in place by some other process) raise SIGBUS when
+// touched: the reading thread just jumps back out of the copy then.
+static thread_local sigjmp_buf *g_pMmapJmpBuf = nullptr;
+
+static struct sigaction g_sigbusOld;
+
+static void mmap_sigbus_handler ( int signo, siginfo_t *info, void *context )
+{
+	if (g_pMmapJmpBuf)
+		::siglongjmp(*g_pMmapJmpBuf, 1);
+
+	// Not ours: chain to whatever was there before...
+	if (g_sigbusOld.sa_flags & SA_SIGINFO) {
+		(*g_sigbusOld.sa_sigaction)(signo, info, context);
+	}
+	else
+	if (g_sigbusOld.sa_handler != SIG_DFL
+		&& g_sigbusOld.sa_handler != SIG_IGN) {
+		(*g_sigbusOld.sa_handler)(signo);
+	} else {
+		// Fault again, the default way...
+		::sigaction(SIGBUS, &g_sigbusOld, nullptr);
+	}
+}
+
+static bool mmap_sigbus_init (void)
+{
+	struct sigaction sigbus;
+	::memset(&sigbus, 0, sizeof(sigbus));
+	sigbus.sa_sigaction = mmap_sigbus_handler;
+	::sigemptyset(&sigbus.sa_mask);
+	sigbus.sa_flags = SA_SIGINFO;
+
+	return (::sigaction(SIGBUS, &sigbus, &g_sigbusOld) == 0);
+}
+
+// Install the handler once and for all (thread-safe).
+static void mmap_sigbus_install (void)
+{
+	static const bool s_bInstalled = mmap_sigbus_init();
+	(void) s_bInstalled;
+}
+
+
+//----------------------------------------------------------------------
+// class qtractorAudioMmapFile -- Memory-mapped PCM audio file.
+//
+
+// Constructor.
+qtractorAudioMmapFile::qtractorAudioMmapFile ( unsigned short iChannels,
+	unsigned int iSampleRate, unsigned int iBufferSize, int iFormat )
+	: qtractorAudioSndFile(iChannels, iSampleRate, iBufferSize, iFormat)
+{
+	m_fd          = -1;
+	m_pMmap       = nullptr;
+	m_iMmapSize   = 0;
+
+	m_pData       = nullptr;
+
+	m_format      = Unknown;
+	m_iFrameBytes = 0;
+
+	m_iChannels   = 0;
+	m_iSampleRate = 0;
+	m_iFrames     = 0;
+
+	m_iOffset     = 0;
+
+	m_pBuffer     = nullptr;
+	m_iBufferSize = BUFFER_SIZE;
+
+	m_pfnConvert  = nullptr;
+}
+
+// Destructor.
+qtractorAudioMmapFile::~qtractorAudioMmapFile (void)
+{
+	close();
+}
+
+
+// Open method.
+bool qtractorAudioMmapFile::open ( const QString& sFilename, int iMode )
+{
+	close();
+
+	// Fast path is for (little-endian) reading only...
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+	if (iMode == qtractorAudioFile::Read) {
+		const QByteArray aFilename = sFilename.toUtf8();
+		m_fd = ::open(aFilename.constData(), O_RDONLY);
+		if (m_fd >= 0) {
+			struct stat st;
+			if (::fstat(m_fd, &st) == 0 && st.st_size > 44) {
+				m_iMmapSize = st.st_size;
+				void *pMmap = ::mmap(nullptr, m_iMmapSize,
+					PROT_READ, MAP_PRIVATE, m_fd, 0);
+				if (pMmap != MAP_FAILED)
+					m_pMmap = static_cast<unsigned char *> (pMmap);
+			}
+		}
+		if (m_pMmap && (parseWav(m_pMmap, m_iMmapSize)
+			|| parseCaf(m_pMmap, m_iMmapSize))) {
+			mmap_sigbus_install();
+			::madvise(m_pMmap, m_iMmapSize, MADV_SEQUENTIAL);
+			m_sFilename = sFilename;
+			m_pBuffer = new float [m_iChannels * m_iBufferSize];
+			m_iOffset = 0;
+		#ifdef CONFIG_DEBUG_0
+			qDebug("qtractorAudioMmapFile::open(\"%s\") format=%d",
+				aFilename.constData(), int(m_format));
+		#endif
+			return true;
+		}
+		// Not for us...
+		unmap();
+	}
+#endif
+
+	// Fallback to regular libsndfile...
+	return qtractorAudioSndFile::open(sFilename, iMode);
+}
+
+
+// Read method.
+int qtractorAudioMmapFile::read ( float **ppFrames, unsigned int iFrames )
+{
+	if (m_pData == nullptr)
+		return qtractorAudioSndFile::read(ppFrames, iFrames);
+
+	if (m_iOffset >= m_iFrames)
+		return 0;
+
+	if (iFrames > m_iFrames - m_iOffset)
+		iFrames = m_iFrames - m_iOffset;
+
+	// Mapped file got truncated? fallback, from the very same offset...
+	if (!readMmap(ppFrames, iFrames)) {
+		fallback();
+		return qtractorAudioSndFile::read(ppFrames, iFrames);
+	}
+
+	m_iOffset += iFrames;
+
+	return iFrames;
+}
+
+
+// Sample data block copy/conversion, bailing out
+// on any SIGBUS raised while touching the mapping.
+bool qtractorAudioMmapFile::readMmap ( float **ppFrames, unsigned int iFrames )
+{
+	sigjmp_buf jmpbuf;
+	if (::sigsetjmp(jmpbuf, 1)) {
+		g_pMmapJmpBuf = nullptr;
+		return false;
+	}
+
+	g_pMmapJmpBuf = &jmpbuf;
+
+	const unsigned short iChannels = m_iChannels;
+	const unsigned char *pData = m_pData + m_iOffset * m_iFrameBytes;
+
+	// Native (aligned) float data is read straight in place...
+	const bool bInPlace = (m_format == Float32
+		&& (uintptr_t(pData) & (sizeof(float) - 1)) == 0);
+
+	unsigned int nread = 0;
+	while (nread < iFrames) {
+		unsigned int nframes = iFrames - nread;
+		if (nframes > m_iBufferSize)
+			nframes = m_iBufferSize;
+		if (iChannels == 1 && m_format == Float32) {
+			::memcpy(ppFrames[0] + nread, pData, nframes * sizeof(float));
+		} else {
+			const float *pBuffer;
+			if (bInPlace) {
+				pBuffer = reinterpret_cast<const float *> (pData);
+			} else {
+				(*m_pfnConvert)(m_pBuffer, pData, nframes * iChannels);
+				pBuffer = m_pBuffer;
+			}
+			if (iChannels == 1) {
+				::memcpy(ppFrames[0] + nread, pBuffer, nframes * sizeof(float));
+			} else {
+				for (unsigned int n = nread; n < nread + nframes; ++n) {
+					for (unsigned short i = 0; i < iChannels; ++i)
+						ppFrames[i][n] = *pBuffer++;
+				}
+			}
+		}
+		pData += nframes * m_iFrameBytes;
+		nread += nframes;
+	}
+
+	g_pMmapJmpBuf = nullptr;
+
+	return true;
+}
+
+
+// Seek method.
+bool qtractorAudioMmapFile::seek ( unsigned long iOffset )
+{
+	if (m_pData == nullptr)
+		return qtractorAudioSndFile::seek(iOffset);
+
+	if (iOffset > m_iFrames)
+		return false;
+
+	m_iOffset = iOffset;
+
+	// Hint the kernel on what's coming next (about a second ahead)...
+	const unsigned long iPageSize = ::sysconf(_SC_PAGESIZE);
+	const unsigned long iDataStart
+		= (m_pData - m_pMmap) + m_iOffset * m_iFrameBytes;
+	const unsigned long iStart = iDataStart & ~(iPageSize - 1);
+	unsigned long iLength = (iDataStart - iStart)
+		+ m_iSampleRate * m_iFrameBytes;
+	if (iStart + iLength > m_iMmapSize)
+		iLength = m_iMmapSize - iStart;
+	if (iLength > 0)
+		::madvise(m_pMmap + iStart, iLength, MADV_WILLNEED);
+
+	return true;
+}
+
+
+// Close method.
+void qtractorAudioMmapFile::close (void)
+{
+	unmap();
+
+	if (m_pBuffer) {
+		delete [] m_pBuffer;
+		m_pBuffer = nullptr;
+	}
+
+	qtractorAudioSndFile::close();
+}
+
+
+// Open mode accessor.
+int qtractorAudioMmapFile::mode (void) const
+{
+	return (m_pData ? int(qtractorAudioFile::Read)
+		: qtractorAudioSndFile::mode());
+}
+
+
+// Open channel(s) accessor.
+unsigned short qtractorAudioMmapFile::channels (void) const
+{
+	return (m_pData ? m_iChannels : qtractorAudioSndFile::channels());
+}
+
+
+// Total number of frames specialty.
+unsigned long qtractorAudioMmapFile::frames (void) const
+{
+	return (m_pData ? m_iFrames : qtractorAudioSndFile::frames());
+}
+
+
+// Sample rate specialty.
+unsigned int qtractorAudioMmapFile::sampleRate (void) const
+{
+	return (m_pData ? m_iSampleRate : qtractorAudioSndFile::sampleRate());
+}
+
+
+// Whether the file is being read straight from memory.
+bool qtractorAudioMmapFile::isMapped (void) const
+{
+	return (m_pData != nullptr);
+}
+
+
+// Check whether given file (extension) is a candidate. (static)
+bool qtractorAudioMmapFile::isMmapFile ( const QString& sFilename )
+{
+	const QString& sExt = QFileInfo(sFilename).suffix().toLower();
+	return (sExt == "wav" || sExt == "caf");
+}
+
+
+// RIFF/RF64 WAVE header parser (plain PCM or IEEE float only).
+bool qtractorAudioMmapFile::parseWav (
+	const unsigned char *pData, unsigned long iSize )
+{
+	const bool bRF64 = (::memcmp(pData, "RF64", 4) == 0);
+	if (!bRF64 && ::memcmp(pData, "RIFF", 4))
+		return false;
+	if (::memcmp(pData + 8, "WAVE", 4))
+		return false;
+
+	SampleFormat format = Unknown;
+	unsigned int iBytes = 0;
+	unsigned long long iDataSize64 = 0;
+
+	unsigned long iChunk = 12;
+	while (iChunk + 8 <= iSize) {
+		const unsigned char *pChunk = pData + iChunk;
+		const unsigned long iChunkSize = get_le32(pChunk + 4);
+		const unsigned long iChunkData = iChunk + 8;
+		if (::memcmp(pChunk, "ds64", 4) == 0 && iChunkSize >= 24) {
+			if (iChunkData + 24 > iSize)
+				return false;
+			iDataSize64 = get_le64(pChunk + 16);
+		}
+		else
+		if (::memcmp(pChunk, "fmt ", 4) == 0 && iChunkSize >= 16) {
+			if (iChunkData + iChunkSize > iSize)
+				return false;
+			unsigned int iFormatTag = get_le16(pChunk + 8);
+			m_iChannels   = get_le16(pChunk + 10);
+			m_iSampleRate = get_le32(pChunk + 12);
+			const unsigned int iBlockAlign = get_le16(pChunk + 20);
+			const unsigned int iBits = get_le16(pChunk + 22);
+			// WAVE_FORMAT_EXTENSIBLE: sub-format GUID first 16bit...
+			if (iFormatTag == 0xfffe && iChunkSize >= 40)
+				iFormatTag = get_le16(pChunk + 32);
+			if (iFormatTag == 1) {
+				if (iBits == 16)
+					format = Int16;
+				else
+				if (iBits == 24)
+					format = Int24;
+				else
+				if (iBits == 32)
+					format = Int32;
+			}
+			else
+			if (iFormatTag == 3 && iBits == 32)
+				format = Float32;
+			iBytes = (iBits >> 3);
+			if (iBlockAlign != m_iChannels * iBytes)
+				return false;
+		}
+		else
+		if (::memcmp(pChunk, "data", 4) == 0) {
+			unsigned long long iDataSize = iChunkSize;
+			if (bRF64 && iChunkSize == 0xffffffff)
+				iDataSize = iDataSize64;
+			if (iChunkData + iDataSize > iSize)
+				iDataSize = iSize - iChunkData;
+			return setSampleData(format, iBytes, iChunkData, iDataSize);
+		}
+		// Next chunk (word aligned)...
+		iChunk = iChunkData + iChunkSize + (iChunkSize & 1);
+	}
+
+	return false;
+}
+
+
+// CAF header parser (little-endian linear PCM or float only).
+bool qtractorAudioMmapFile::parseCaf (
+	const unsigned char *pData, unsigned long iSize )
+{
+	if (::memcmp(pData, "caff", 4))
+		return false;
+
+	SampleFormat format = Unknown;
+	unsigned int iBytes = 0;
+
+	unsigned long iChunk = 8;
+	while (iChunk + 12 <= iSize) {
+		const unsigned char *pChunk = pData + iChunk;
+		const long long iChunkSize = (long long) get_be64(pChunk + 4);
+		const unsigned long iChunkData = iChunk + 12;
+		if (::memcmp(pChunk, "desc", 4) == 0 && iChunkSize >= 32) {
+			if (iChunkData + 32 > iSize)
+				return false;
+			const unsigned long long iRate = get_be64(pChunk + 12);
+			double fSampleRate;
+			::memcpy(&fSampleRate, &iRate, sizeof(fSampleRate));
+			m_iSampleRate = (unsigned int) fSampleRate;
+			if (::memcmp(pChunk + 20, "lpcm", 4))
+				return false;
+			const unsigned int iFlags = get_be32(pChunk + 24);
+			const unsigned int iBytesPerPacket = get_be32(pChunk + 28);
+			const unsigned int iFramesPerPacket = get_be32(pChunk + 32);
+			m_iChannels = get_be32(pChunk + 36);
+			const unsigned int iBits = get_be32(pChunk + 40);
+			// kCAFLinearPCMFormatFlagIsLittleEndian...
+			if ((iFlags & 2) == 0 || iFramesPerPacket != 1)
+				return false;
+			// kCAFLinearPCMFormatFlagIsFloat...
+			if (iFlags & 1) {
+				if (iBits == 32)
+					format = Float32;
+			} else {
+				if (iBits == 16)
+					format = Int16;
+				else
+				if (iBits == 24)
+					format = Int24;
+				else
+				if (iBits == 32)
+					format = Int32;
+			}
+			iBytes = (iBits >> 3);
+			if (iBytesPerPacket != m_iChannels * iBytes)
+				return false;
+		}
+		else
+		if (::memcmp(pChunk, "data", 4) == 0) {
+			// Skip the edit count; size may be unknown (-1)...
+			const unsigned long iDataOffset = iChunkData + 4;
+			if (iDataOffset > iSize)
+				return false;
+			unsigned long long iDataSize = iSize - iDataOffset;
+			if (iChunkSize > 4 && iDataOffset + (iChunkSize - 4) <= iSize)
+				iDataSize = iChunkSize - 4;
+			return setSampleData(format, iBytes, iDataOffset, iDataSize);
+		}
+		if (iChunkSize < 0)
+			break;
+		// Next chunk...
+		iChunk = iChunkData + iChunkSize;
+	}
+
+	return false;
+}
+
+
+// Set sample format and data chunk.
+bool qtractorAudioMmapFile::setSampleData ( SampleFormat format,
+	unsigned int iBytes, unsigned long iDataOffset, unsigned long iDataSize )
+{
+	if (format == Unknown || m_iChannels < 1 || m_iSampleRate < 1)
+		return false;
+
+	switch (format) {
+	case Int16:
+	#if defined(__SSE2__)
+		if (sse2_enabled())
+			m_pfnConvert = sse2_int16_to_float;
+		else
+	#endif
+	#if defined(__ARM_NEON__)
+		m_pfnConvert = neon_int16_to_float;
+		if (false)
+	#endif
+		m_pfnConvert = std_int16_to_float;
+		break;
+	case Int24:
+		m_pfnConvert = std_int24_to_float;
+		break;
+	case Int32:
+	#if defined(__SSE2__)
+		if (sse2_enabled())
+			m_pfnConvert = sse2_int32_to_float;
+		else
+	#endif
+	#if defined(__ARM_NEON__)
+		m_pfnConvert = neon_int32_to_float;
+		if (false)
+	#endif
+		m_pfnConvert = std_int32_to_float;
+		break;
+	case Float32:
+	default:
+		m_pfnConvert = std_float32_to_float;
+		break;
+	}
+
+	m_format = format;
+	m_iFrameBytes = m_iChannels * iBytes;
+	m_iFrames = iDataSize / m_iFrameBytes;
+	m_pData = m_pMmap + iDataOffset;
+
+	return true;
+}
+
+
+// Fallback to regular libsndfile, from the current read position.
+void qtractorAudioMmapFile::fallback (void)
+{
+#ifdef CONFIG_DEBUG
+	qDebug("qtractorAudioMmapFile::fallback(\"%s\")",
+		m_sFilename.toUtf8().constData());
+#endif
+
+	const unsigned long iOffset = m_iOffset;
+
+	unmap();
+
+	if (qtractorAudioSndFile::open(m_sFilename, qtractorAudioFile::Read))
+		qtractorAudioSndFile::seek(iOffset);
+}
+
+
+// Release the mapping.
+void qtractorAudioMmapFile::unmap (void)
+{
+	if (m_pMmap) {
+		::munmap(m_pMmap, m_iMmapSize);
+		m_pMmap = nullptr;
+	}
+
+	if (m_fd >= 0) {
+		::close(m_fd);
+		m_fd = -1;
+	}
+
+	m_iMmapSize   = 0;
+	m_pData       = nullptr;
+	m_format      = Unknown;
+	m_iFrameBytes = 0;
+	m_iChannels   = 0;
+	m_iSampleRate = 0;
+	m_iFrames     = 0;
+	m_iOffset     = 0;
+}
+
+
+// end of qtractorAudioMmapFile.cpp
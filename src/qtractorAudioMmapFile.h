@@ -0,0 +1,120 @@
+// qtractorAudioMmapFile.h
+//
+/****************************************************************************
+   Copyright (C) 2005-2022, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qtractorAudioMmapFile_h
+#define __qtractorAudioMmapFile_h
+
+#include "qtractorAudioSndFile.h"
+
+
+//----------------------------------------------------------------------
+// class qtractorAudioMmapFile -- Memory-mapped PCM audio file declaration.
+//
+
+class qtractorAudioMmapFile : public qtractorAudioSndFile
+{
+public:
+
+	// Constructor.
+	qtractorAudioMmapFile(unsigned short iChannels = 0,
+		unsigned int iSampleRate = 0, unsigned int iBufferSize = 0,
+		int iFormat = 0);
+
+	// Destructor.
+	virtual ~qtractorAudioMmapFile();
+
+	// Virtual method mockups.
+	bool open  (const QString& sFilename, int iMode = Read);
+	int  read  (float **ppFrames, unsigned int iFrames);
+	bool seek  (unsigned long iOffset);
+	void close ();
+
+	// Virtual accessor mockups.
+	int mode() const;
+	unsigned short channels() const;
+	unsigned long  frames() const;
+
+	// Specialty methods.
+	unsigned int sampleRate() const;
+
+	// Whether the file is being read straight from memory.
+	bool isMapped() const;
+
+	// Check whether given file (extension) is a candidate. (static)
+	static bool isMmapFile(const QString& sFilename);
+
+	// Sample formats supported in the fast path.
+	enum SampleFormat { Unknown = 0, Int16, Int24, Int32, Float32 };
+
+protected:
+
+	// Header parsers (whether it's plain little-endian PCM).
+	bool parseWav(const unsigned char *pData, unsigned long iSize);
+	bool parseCaf(const unsigned char *pData, unsigned long iSize);
+
+	// Set sample format and data chunk.
+	bool setSampleData(SampleFormat format, unsigned int iBytes,
+		unsigned long iDataOffset, unsigned long iDataSize);
+
+	// Sample data block copy/conversion (SIGBUS guarded).
+	bool readMmap(float **ppFrames, unsigned int iFrames);
+
+	// Fallback to regular libsndfile (current position).
+	void fallback();
+
+	// Release the mapping.
+	void unmap();
+
+private:
+
+	// Mapped file stuff.
+	int            m_fd;
+	unsigned char *m_pMmap;
+	unsigned long  m_iMmapSize;
+
+	QString        m_sFilename;
+
+	// Sample data (within mapping).
+	const unsigned char *m_pData;
+
+	SampleFormat   m_format;
+	unsigned int   m_iFrameBytes;
+
+	unsigned short m_iChannels;
+	unsigned int   m_iSampleRate;
+	unsigned long  m_iFrames;
+
+	// Current read position (in frames).
+	unsigned long  m_iOffset;
+
+	// Interleaved conversion buffer.
+	float         *m_pBuffer;
+	unsigned int   m_iBufferSize;
+
+	// Sample conversion (to interleaved float) processor.
+	void (*m_pfnConvert)(float *, const unsigned char *, unsigned int);
+};
+
+
+#endif  // __qtractorAudioMmapFile_h
+
+
+// end of qtractorAudioMmapFile.h
@@ -479,6 +479,22 @@ void qtractorAudioMonitor::process_meter (
 }
 
 
+// Silence-aware batch processor: gain/panning of silence is just
+// silence and meters would only see zeros, so skip it altogether.
+bool qtractorAudioMonitor::process ( float **ppFrames,
+	unsigned int iFrames, unsigned short iChannels, bool bSilent )
+{
+	if (bSilent) {
+		// Any pending gain ramp is moot...
+		m_iProcessRamp = 0;
+		return true;
+	}
+
+	process(ppFrames, iFrames, iChannels);
+	return false;
+}
+
+
 // Rebuild the whole panning-gain array...
 void qtractorAudioMonitor::update (void)
 {
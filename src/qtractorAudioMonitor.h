@@ -54,6 +54,9 @@ public:
 	// Batch processors.
 	void process(float **ppFrames,
 		unsigned int iFrames, unsigned short iChannels = 0);
+	// Silence-aware (returns whether output is still silent).
+	bool process(float **ppFrames,
+		unsigned int iFrames, unsigned short iChannels, bool bSilent);
 	void process_meter(float **ppFrames,
 		unsigned int iFrames, unsigned short iChannels = 0);
 
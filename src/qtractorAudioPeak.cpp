@@ -35,8 +35,10 @@
 #include <QWaitCondition>
 
 #include <QDateTime>
+#include <QElapsedTimer>
 
 #include <cmath>
+#include <cstdio>
 
 #if QT_VERSION < QT_VERSION_CHECK(5, 10, 0)
 #define birthTime  created
@@ -55,9 +57,20 @@ static const unsigned short c_iPeakPeriod = 1024;
 // Default peak filename extension.
 static const QString c_sPeakFileExt = ".peak";
 
+// Peak file (re)creation temporary suffix.
+static const QString c_sPeakTempExt = ".tmp";
+
+// Peak pyramid level decimation ratios (relative to previous level).
+static const unsigned short c_aPeakLevelRatios[]
+	= { 1, 2, 2, 4, 4, 4, 4, 4 };
+
+// Peak pyramid directory (trailer) signature.
+static const char c_szPeakTrailerMagic[] = "QTPK";
+static const unsigned short c_iPeakTrailerVersion = 1;
+
 
 //----------------------------------------------------------------------
-// class qtractorAudioPeakThread -- Audio Peak file thread.
+// class qtractorAudioPeakThread -- Audio Peak file worker thread.
 //
 
 class qtractorAudioPeakThread : public QThread
@@ -65,16 +78,7 @@ class qtractorAudioPeakThread : public QThread
 public:
 
 	// Constructor.
-	qtractorAudioPeakThread(unsigned int iSyncSize = 128);
-	// Destructor.
-	~qtractorAudioPeakThread();
-
-	// Thread run state accessors.
-	void setRunState(bool bRunState);
-	bool runState() const;
-
-	// Wake from executive wait condition.
-	void sync(qtractorAudioPeakFile *pPeakFile = nullptr);
+	qtractorAudioPeakThread(qtractorAudioPeakPool *pPeakPool);
 
 protected:
 
@@ -91,25 +95,13 @@ protected:
 
 private:
 
-	// The peak file queue instance reference.
-	unsigned int            m_iSyncSize;
-	unsigned int            m_iSyncMask;
-	qtractorAudioPeakFile **m_ppSyncItems;
-
-	volatile unsigned int   m_iSyncRead;
-	volatile unsigned int   m_iSyncWrite;
-
-	// Whether the thread is logically running.
-	volatile bool m_bRunState;
-
-	// Thread synchronization objects.
-	QMutex m_mutex;
-	QWaitCondition m_cond;
+	// The owner pool instance reference.
+	qtractorAudioPeakPool *m_pPeakPool;
 
 	// Current audio peak file instance.
 	qtractorAudioPeakFile *m_pPeakFile;
 
-	// Current audio file instance.
+	// Current audio file instance (own decoder).
 	qtractorAudioFile *m_pAudioFile;
 
 	// Current audio file buffer.
@@ -117,88 +109,186 @@ private:
 };
 
 
-// Constructor.
-qtractorAudioPeakThread::qtractorAudioPeakThread ( unsigned int iSyncSize )
+//----------------------------------------------------------------------
+// class qtractorAudioPeakPool -- Audio Peak file worker thread pool.
+//
+
+class qtractorAudioPeakPool
 {
-	m_iSyncSize = (64 << 1);
-	while (m_iSyncSize < iSyncSize)
-		m_iSyncSize <<= 1;
-	m_iSyncMask = (m_iSyncSize - 1);
-	m_ppSyncItems = new qtractorAudioPeakFile * [m_iSyncSize];
-	m_iSyncRead   = 0;
-	m_iSyncWrite  = 0;
+public:
 
-	::memset(m_ppSyncItems, 0, m_iSyncSize * sizeof(qtractorAudioPeakFile *));
+	// Constructor.
+	qtractorAudioPeakPool(unsigned short iThreads);
+	// Destructor.
+	~qtractorAudioPeakPool();
 
-	m_bRunState = false;
+	// Worker threads start/stop.
+	void start();
+	void stop();
 
-	m_pPeakFile  = nullptr;
-	m_pAudioFile = nullptr;
-	m_ppAudioFrames = nullptr;
+	// Pool run state accessor.
+	bool runState() const;
+
+	// Enqueue (or abort all pending) peak file creation.
+	void sync(qtractorAudioPeakFile *pPeakFile = nullptr);
+
+	// Move a pending peak file to the front of the queue.
+	void prioritize(qtractorAudioPeakFile *pPeakFile);
+
+	// Worker side: next pending peak file (or null on time-out).
+	qtractorAudioPeakFile *dequeue();
+	void release(qtractorAudioPeakFile *pPeakFile);
+
+private:
+
+	// Worker threads.
+	QList<qtractorAudioPeakThread *> m_threads;
+
+	// Pending and currently active peak files.
+	QList<qtractorAudioPeakFile *> m_pending;
+	QList<qtractorAudioPeakFile *> m_active;
+
+	// Whether the pool is logically running.
+	volatile bool m_bRunState;
+
+	// Thread synchronization objects.
+	QMutex m_mutex;
+	QWaitCondition m_cond;
+};
+
+
+// Constructor.
+qtractorAudioPeakPool::qtractorAudioPeakPool ( unsigned short iThreads )
+	: m_bRunState(false)
+{
+	for (unsigned short i = 0; i < iThreads; ++i)
+		m_threads.append(new qtractorAudioPeakThread(this));
 }
 
 
 // Destructor.
-qtractorAudioPeakThread::~qtractorAudioPeakThread (void)
+qtractorAudioPeakPool::~qtractorAudioPeakPool (void)
+{
+	stop();
+
+	qDeleteAll(m_threads);
+	m_threads.clear();
+}
+
+
+// Worker threads start/stop.
+void qtractorAudioPeakPool::start (void)
 {
-	delete [] m_ppSyncItems;
+	m_bRunState = true;
+
+	QListIterator<qtractorAudioPeakThread *> iter(m_threads);
+	while (iter.hasNext())
+		iter.next()->start(QThread::LowPriority);
 }
 
 
-// Run state accessor.
-void qtractorAudioPeakThread::setRunState ( bool bRunState )
+void qtractorAudioPeakPool::stop (void)
 {
-//	QMutexLocker locker(&m_mutex);
+	m_mutex.lock();
+	m_bRunState = false;
+	m_cond.wakeAll();
+	m_mutex.unlock();
 
-	m_bRunState = bRunState;
+	QListIterator<qtractorAudioPeakThread *> iter(m_threads);
+	while (iter.hasNext()) {
+		qtractorAudioPeakThread *pPeakThread = iter.next();
+		while (pPeakThread->isRunning() && !pPeakThread->wait(100))
+			m_cond.wakeAll();
+	}
 }
 
-bool qtractorAudioPeakThread::runState (void) const
+
+// Pool run state accessor.
+bool qtractorAudioPeakPool::runState (void) const
 {
 	return m_bRunState;
 }
 
 
-// Wake from executive wait condition.
-void qtractorAudioPeakThread::sync ( qtractorAudioPeakFile *pPeakFile )
+// Enqueue (or abort all pending) peak file creation.
+void qtractorAudioPeakPool::sync ( qtractorAudioPeakFile *pPeakFile )
 {
+	QMutexLocker locker(&m_mutex);
+
 	if (pPeakFile == nullptr) {
-		unsigned int r = m_iSyncRead;
-		unsigned int w = m_iSyncWrite;
-		while (r != w) {
-			qtractorAudioPeakFile *pSyncItem = m_ppSyncItems[r];
-			if (pSyncItem)
-				pSyncItem->setWaitSync(false);
-			++r &= m_iSyncMask;
-			w = m_iSyncWrite;
-		}
-	//	m_iSyncRead = r;
+		QListIterator<qtractorAudioPeakFile *> iter(m_pending);
+		while (iter.hasNext())
+			iter.next()->setWaitSync(false);
+		QListIterator<qtractorAudioPeakFile *> active_iter(m_active);
+		while (active_iter.hasNext())
+			active_iter.next()->setWaitSync(false);
+		m_pending.clear();
 	} else {
-		// !pPeakFile->isWaitSync()
-		unsigned int n;
-		unsigned int r = m_iSyncRead;
-		unsigned int w = m_iSyncWrite;
-		if (w > r) {
-			n = ((r - w + m_iSyncSize) & m_iSyncMask) - 1;
-		} else if (r > w) {
-			n = (r - w) - 1;
-		} else {
-			n = m_iSyncSize - 1;
-		}
-		if (n > 0) {
-			pPeakFile->setWaitSync(true);
-			m_ppSyncItems[w] = pPeakFile;
-			m_iSyncWrite = (w + 1) & m_iSyncMask;
+		pPeakFile->setWaitSync(true);
+		if (!m_pending.contains(pPeakFile))
+			m_pending.append(pPeakFile);
+		m_cond.wakeOne();
+	}
+}
+
+
+// Move a pending peak file to the front of the queue.
+void qtractorAudioPeakPool::prioritize ( qtractorAudioPeakFile *pPeakFile )
+{
+	QMutexLocker locker(&m_mutex);
+
+	const int iIndex = m_pending.indexOf(pPeakFile);
+	if (iIndex > 0)
+		m_pending.move(iIndex, 0);
+}
+
+
+// Worker side: next pending peak file (or null when stopped).
+qtractorAudioPeakFile *qtractorAudioPeakPool::dequeue (void)
+{
+	QMutexLocker locker(&m_mutex);
+
+	while (m_bRunState) {
+		// Skip the ones still being worked on elsewhere...
+		QMutableListIterator<qtractorAudioPeakFile *> iter(m_pending);
+		while (iter.hasNext()) {
+			qtractorAudioPeakFile *pPeakFile = iter.next();
+			if (m_active.contains(pPeakFile))
+				continue;
+			iter.remove();
+			m_active.append(pPeakFile);
+			return pPeakFile;
 		}
+		// Nothing we can take: wait for a new or released one...
+		m_cond.wait(&m_mutex);
 	}
 
-	if (m_mutex.tryLock()) {
+	return nullptr;
+}
+
+
+void qtractorAudioPeakPool::release ( qtractorAudioPeakFile *pPeakFile )
+{
+	QMutexLocker locker(&m_mutex);
+
+	m_active.removeOne(pPeakFile);
+
+	// Still done, unless it was asked for again, in which
+	// case it's now up for grabs by any waiting worker...
+	if (!m_pending.contains(pPeakFile))
+		pPeakFile->setWaitSync(false);
+	else
 		m_cond.wakeAll();
-		m_mutex.unlock();
-	}
-#ifdef CONFIG_DEBUG_0
-	else qDebug("qtractorAudioPeakThread[%p]::sync(): tryLock() failed.", this);
-#endif
+}
+
+
+// Constructor.
+qtractorAudioPeakThread::qtractorAudioPeakThread (
+	qtractorAudioPeakPool *pPeakPool ) : QThread(), m_pPeakPool(pPeakPool)
+{
+	m_pPeakFile  = nullptr;
+	m_pAudioFile = nullptr;
+	m_ppAudioFrames = nullptr;
 }
 
 
@@ -209,42 +299,30 @@ void qtractorAudioPeakThread::run (void)
 	qDebug("qtractorAudioPeakThread[%p]::run(): started...", this);
 #endif
 
-	m_mutex.lock();
-
-	m_bRunState = true;
-
-	while (m_bRunState) {
-		// Do whatever we must, then wait for more...
-		unsigned int r = m_iSyncRead;
-		unsigned int w = m_iSyncWrite;
-		while (m_bRunState && r != w) {
-			m_pPeakFile = m_ppSyncItems[r];
-			if (m_pPeakFile && m_pPeakFile->isWaitSync()) {
-				if (openPeakFile()) {
-					// Go ahead with the whole bunch...
-					while (writePeakFile());
-					// We're done.
-					closePeakFile();
+	QElapsedTimer timer;
+
+	while (m_pPeakPool->runState()) {
+		// Wait for, and do whatever we must...
+		m_pPeakFile = m_pPeakPool->dequeue();
+		if (m_pPeakFile == nullptr)
+			continue;
+		if (m_pPeakFile->isWaitSync() && openPeakFile()) {
+			// Go ahead with the whole bunch,
+			// showing progress every now and then...
+			timer.start();
+			while (writePeakFile()) {
+				if (timer.elapsed() > 200) {
+					notifyPeakEvent();
+					timer.start();
 				}
-				m_pPeakFile->setWaitSync(false);
-				m_pPeakFile = nullptr;
 			}
-			m_ppSyncItems[r] = nullptr;
-			++r &= m_iSyncMask;
-			w = m_iSyncWrite;
-		}
-		m_iSyncRead = r;
-		// Are we still in the game?
-		if (m_bRunState) {
-			// Send notification event, anyway...
-			notifyPeakEvent();
-			// Wait for sync...
-			m_cond.wait(&m_mutex);
+			// We're done.
+			closePeakFile();
 		}
+		m_pPeakPool->release(m_pPeakFile);
+		m_pPeakFile = nullptr;
 	}
 
-	m_mutex.unlock();
-
 #ifdef CONFIG_DEBUG_0
 	qDebug("qtractorAudioPeakThread[%p]::run(): stopped.\n", this);
 #endif
@@ -294,7 +372,7 @@ bool qtractorAudioPeakThread::openPeakFile (void)
 // Create the peak file chunk.
 bool qtractorAudioPeakThread::writePeakFile (void)
 {
-	if (!m_bRunState)
+	if (!m_pPeakPool->runState())
 		return false;
 
 	if (m_ppAudioFrames == nullptr)
@@ -346,7 +424,7 @@ void qtractorAudioPeakThread::closePeakFile (void)
 // Send notification event, someway...
 void qtractorAudioPeakThread::notifyPeakEvent (void) const
 {
-	if (!m_bRunState)
+	if (!m_pPeakPool->runState())
 		return;
 
 	qtractorAudioPeakFactory *pPeakFactory
@@ -373,10 +451,22 @@ qtractorAudioPeakFile::qtractorAudioPeakFile (
 	m_peakHeader.period   = 0;
 	m_peakHeader.channels = 0;
 
+	m_iLevels = 0;
+	for (unsigned short i = 0; i < MaxLevels; ++i) {
+		m_iLevelOffset[i] = 0;
+		m_iLevelLength[i] = 0;
+	}
+
+	m_pMapData = nullptr;
+	m_iSerial  = 0;
+
+	m_bReopen = false;
+
 	m_pBuffer      = nullptr;
 	m_iBuffSize    = 0;
 	m_iBuffLength  = 0;
 	m_iBuffOffset  = 0;
+	m_iBuffLevel   = 0;
 
 	m_bWaitSync = false;
 
@@ -399,6 +489,7 @@ qtractorAudioPeakFile::qtractorAudioPeakFile (
 		+ c_sPeakFileExt);
 
 	m_peakFile.setFileName(peakInfo.absoluteFilePath());
+	m_writeFile.setFileName(peakInfo.absoluteFilePath() + c_sPeakTempExt);
 }
 
 
@@ -409,16 +500,35 @@ qtractorAudioPeakFile::~qtractorAudioPeakFile (void)
 }
 
 
-// Open an existing peak file cache.
+// Open an existing peak file cache (GUI thread).
 bool qtractorAudioPeakFile::openRead (void)
 {
+	// Make things critical...
+	QMutexLocker locker(&m_mutex);
+
+	// Was it replaced by a brand new one meanwhile? Drop the old
+	// mapping right here, as any frames still cached elsewhere
+	// are never handed out again once the serial changes...
+	if (m_bReopen) {
+		m_bReopen = false;
+		if (m_openMode == Read)
+			closeReadEx();
+	}
+
 	// If it's already open, just tell the news.
 	if (m_openMode != None)
 		return true;
 
 	// Are we still waiting for its creation?
-	if (m_bWaitSync)
+	// (must be visible, so try and get it done first)
+	if (m_bWaitSync) {
+		locker.unlock();
+		qtractorAudioPeakFactory *pPeakFactory
+			= qtractorAudioPeakFactory::getInstance();
+		if (pPeakFactory)
+			pPeakFactory->prioritize(this);
 		return false;
+	}
 
 	// Need some preliminary file information...
 	QFileInfo fileInfo(m_sFilename);
@@ -427,6 +537,7 @@ bool qtractorAudioPeakFile::openRead (void)
 	// or must the peak file be (re)created?
 	if (!peakInfo.exists() || peakInfo.birthTime() < fileInfo.birthTime()) {
 	//	|| peakInfo.lastModified() < fileInfo.lastModified()) {
+		locker.unlock();
 		qtractorAudioPeakFactory *pPeakFactory
 			= qtractorAudioPeakFactory::getInstance();
 		if (pPeakFactory)
@@ -435,9 +546,6 @@ bool qtractorAudioPeakFile::openRead (void)
 		return false;
 	}
 
-	// Make things critical...
-	QMutexLocker locker(&m_mutex);
-
 	// Just open and go ahead with first bunch...
 	if (!m_peakFile.open(QIODevice::ReadOnly))
 		return false;
@@ -448,6 +556,21 @@ bool qtractorAudioPeakFile::openRead (void)
 		return false;
 	}
 
+	// Older (single level) peak files must be recreated...
+	if (!readTrailer()) {
+		m_peakFile.close();
+		locker.unlock();
+		qtractorAudioPeakFactory *pPeakFactory
+			= qtractorAudioPeakFactory::getInstance();
+		if (pPeakFactory)
+			pPeakFactory->sync(this);
+		return false;
+	}
+
+	// Complete peak files are read-only, so map'em whole...
+	m_pMapData = m_peakFile.map(0, m_peakFile.size());
+	++m_iSerial;
+
 	// Set open mode...
 	m_openMode = Read;
 
@@ -460,6 +583,7 @@ bool qtractorAudioPeakFile::openRead (void)
 	qDebug("frame       = %lu", sizeof(Frame));
 	qDebug("period      = %d", m_peakHeader.period);
 	qDebug("channels    = %d", m_peakHeader.channels);
+	qDebug("levels      = %d", m_iLevels);
 	qDebug("---");
 #endif
 
@@ -468,14 +592,25 @@ bool qtractorAudioPeakFile::openRead (void)
 }
 
 
-// Free all attended resources for this peak file.
+// Free all attended resources for this peak file (GUI thread).
 void qtractorAudioPeakFile::closeRead (void)
 {
 	// Make things critical...
 	QMutexLocker locker(&m_mutex);
 
+	closeReadEx();
+}
+
+
+// Internal read-close method (unlocked).
+void qtractorAudioPeakFile::closeReadEx (void)
+{
 	// Close file.
 	if (m_openMode == Read) {
+		if (m_pMapData) {
+			m_peakFile.unmap(m_pMapData);
+			m_pMapData = nullptr;
+		}
 		m_peakFile.close();
 		m_openMode = None;
 	}
@@ -487,6 +622,9 @@ void qtractorAudioPeakFile::closeRead (void)
 	m_iBuffSize   = 0;
 	m_iBuffLength = 0;
 	m_iBuffOffset = 0;
+	m_iBuffLevel  = 0;
+
+	m_iLevels = 0;
 }
 
 
@@ -525,16 +663,59 @@ unsigned short qtractorAudioPeakFile::channels (void)
 }
 
 
+// Peak pyramid properties accessors.
+unsigned short qtractorAudioPeakFile::levels (void)
+{
+	// Only the base level is around while being created...
+	return (m_openMode == Write ? 1 : m_iLevels);
+}
+
+unsigned long qtractorAudioPeakFile::length ( unsigned short iLevel )
+{
+	return (iLevel < levels() ? m_iLevelLength[iLevel] : 0);
+}
+
+
+// Peak pyramid level decimation (relative to base period).
+unsigned int qtractorAudioPeakFile::levelRatio ( unsigned short iLevel )
+{
+	unsigned int iRatio = 1;
+	for (unsigned short i = 1; i <= iLevel && i < MaxLevels; ++i)
+		iRatio *= c_aPeakLevelRatios[i];
+	return iRatio;
+}
+
+
 // Read frames from peak file.
 qtractorAudioPeakFile::Frame *qtractorAudioPeakFile::read (
-	unsigned long iPeakOffset, unsigned int iPeakLength )
+	unsigned long iPeakOffset, unsigned int iPeakLength, unsigned short iLevel )
 {
+	// Make things critical...
+	QMutexLocker locker(&m_mutex);
+
 	// Must be open for something...
 	if (m_openMode == None)
 		return nullptr;
 
-	// Make things critical...
-	QMutexLocker locker(&m_mutex);
+	// Still being created? grab whatever is already there...
+	if (m_openMode == Write) {
+		if (iLevel > 0 || m_pWriter == nullptr)
+			return nullptr;
+		const unsigned int nsize = m_peakHeader.channels * sizeof(Frame);
+		m_iLevelOffset[0] = 0;
+		m_iLevelLength[0] = (nsize > 0 ? m_pWriter->offset / nsize : 0);
+	}
+	else
+	// Must be a valid pyramid level...
+	if (iLevel >= m_iLevels)
+		return nullptr;
+
+	// Level switch invalidates the cache...
+	if (m_iBuffLevel != iLevel) {
+		m_iBuffLevel  = iLevel;
+		m_iBuffLength = 0;
+		m_iBuffOffset = 0;
+	}
 
 #ifdef CONFIG_DEBUG_0
 	qDebug("qtractorAudioPeakFile[%p]::read(%lu, %u) [%lu, %u, %u]", this,
@@ -564,6 +745,38 @@ qtractorAudioPeakFile::Frame *qtractorAudioPeakFile::read (
 }
 
 
+// Direct (zero-copy) memory-mapped peak frames (GUI thread only).
+//
+// No locking here, as the peak writer may hold the mutex for a
+// whole chunk: the read mode, mapping and pyramid directory are
+// only ever changed on the GUI thread (openRead/closeRead), while
+// the writer thread only switches between non-read modes.
+qtractorAudioPeakFile::Frame *qtractorAudioPeakFile::mapped (
+	unsigned long iPeakOffset, unsigned int iPeakLength,
+	unsigned short iLevel )
+{
+	// Must be a complete and mapped peak file...
+	if (m_openMode != Read || m_pMapData == nullptr)
+		return nullptr;
+
+	// Must be all within the requested level...
+	if (iLevel >= m_iLevels
+		|| iPeakOffset + iPeakLength > m_iLevelLength[iLevel])
+		return nullptr;
+
+	Frame *pFrames = (Frame *) (m_pMapData + sizeof(Header));
+	return pFrames + m_peakHeader.channels
+		* (m_iLevelOffset[iLevel] + iPeakOffset);
+}
+
+
+// Read-open serial number (changes on each re-open).
+unsigned int qtractorAudioPeakFile::serial (void) const
+{
+	return m_iSerial;
+}
+
+
 // Read frames from peak file into local buffer cache.
 unsigned int qtractorAudioPeakFile::readBuffer (
 	unsigned int iBuffOffset, unsigned long iPeakOffset, unsigned int iPeakLength )
@@ -587,14 +800,27 @@ unsigned int qtractorAudioPeakFile::readBuffer (
 		m_iBuffOffset, m_iBuffLength, m_iBuffSize);
 #endif
 
-	// Grab new contents from peak file...
+	// Never read past current level extent...
+	const unsigned long iLevelLength = m_iLevelLength[m_iBuffLevel];
+	unsigned int iPeakRead = 0;
+	if (iPeakOffset < iLevelLength) {
+		iPeakRead = iPeakLength;
+		if (iPeakOffset + iPeakRead > iLevelLength)
+			iPeakRead = iLevelLength - iPeakOffset;
+	}
+
+	// Grab new contents from peak file (or the one being created)...
+	QFile& file = (m_openMode == Write ? m_writeFile : m_peakFile);
 	char *pBuffer = (char *) (m_pBuffer + m_peakHeader.channels * iBuffOffset);
-	const unsigned long iOffset	= iPeakOffset * nsize;
-	const unsigned int iLength  = iPeakLength * nsize;
+	const unsigned long iOffset
+		= (m_iLevelOffset[m_iBuffLevel] + iPeakOffset) * nsize;
+	const unsigned int iLength = iPeakLength * nsize;
 
 	int nread = 0;
-	if (m_peakFile.seek(sizeof(Header) + iOffset))
-		nread = int(m_peakFile.read(&pBuffer[0], iLength));
+	if (iPeakRead > 0 && file.seek(sizeof(Header) + iOffset))
+		nread = int(file.read(&pBuffer[0], iPeakRead * nsize));
+	if (nread < 0)
+		nread = 0;
 
 	// Zero the remaining...
 	if (nread < int(iLength))
@@ -604,7 +830,8 @@ unsigned int qtractorAudioPeakFile::readBuffer (
 }
 
 
-// Open an new peak file for writing.
+// Open an new peak file for writing (into a temporary file,
+// so that any current one may still be read meanwhile).
 bool qtractorAudioPeakFile::openWrite (
 	unsigned short iChannels, unsigned int iSampleRate )
 {
@@ -614,77 +841,94 @@ bool qtractorAudioPeakFile::openWrite (
 	if (pPeakFactory == nullptr)
 		return false;
 
-	// If it's already open, just tell the news.
-	if (m_openMode == Write)
-		return true;
-
 	// Make things critical...
 	QMutexLocker locker(&m_mutex);
 
-	// We'll force (re)open if already reading (duh?)
-	if (m_openMode == Read) {
-		m_peakFile.close();
-		m_openMode = None;
-	}
+	// If it's already open, just tell the news.
+	if (m_pWriter)
+		return true;
 
 	// Just open and go ahead with it...
-	if (!m_peakFile.open(QIODevice::ReadWrite | QIODevice::Truncate))
+	if (!m_writeFile.open(QIODevice::ReadWrite | QIODevice::Truncate))
 		return false;
 
-	// Set open mode...
-	m_openMode = Write;
-
 	// Initialize header...
-	m_peakHeader.period   = pPeakFactory->peakPeriod();
-	m_peakHeader.channels = iChannels;
+	Header header;
+	header.period   = pPeakFactory->peakPeriod();
+	header.channels = iChannels;
 
 	// Write peak file header.
-	if (m_peakFile.write((const char *) &m_peakHeader, sizeof(Header))
+	if (m_writeFile.write((const char *) &header, sizeof(Header))
 			!= qint64(sizeof(Header))) {
-		m_peakFile.close();
+		m_writeFile.close();
+		m_writeFile.remove();
 		return false;
 	}
 
+	// Nothing being read? then show it while being created...
+	if (m_openMode == None) {
+		m_peakHeader = header;
+		m_iBuffLength = 0;
+		m_iBuffOffset = 0;
+		m_iBuffLevel  = 0;
+		m_openMode = Write;
+	}
+
 #ifdef CONFIG_DEBUG_0
 	qDebug("qtractorAudioPeakFile[%p]::openWrite() ---", this);
-	qDebug("name        = %s", m_peakFile.fileName().toUtf8().constData());
+	qDebug("name        = %s", m_writeFile.fileName().toUtf8().constData());
 	qDebug("filename    = %s", m_sFilename.toUtf8().constData());
 	qDebug("timeStretch = %g", m_fTimeStretch);
 	qDebug("header      = %u", sizeof(Header));
 	qDebug("frame       = %u", sizeof(Frame));
-	qDebug("period      = %d", m_peakHeader.period);
-	qDebug("channels    = %d", m_peakHeader.channels);
+	qDebug("period      = %d", header.period);
+	qDebug("channels    = %d", header.channels);
 	qDebug("---");
 #endif
 
 	//	Go ahead, it's already open.
 	m_pWriter = new Writer();
 
+	m_pWriter->header = header;
 	m_pWriter->offset = 0;
 
-	m_pWriter->amax = new float [m_peakHeader.channels];
-	m_pWriter->amin = new float [m_peakHeader.channels];
-	m_pWriter->arms = new float [m_peakHeader.channels];
-	for (unsigned short i = 0; i < m_peakHeader.channels; ++i)
+	m_pWriter->amax = new float [iChannels];
+	m_pWriter->amin = new float [iChannels];
+	m_pWriter->arms = new float [iChannels];
+	for (unsigned short i = 0; i < iChannels; ++i)
 		m_pWriter->amax[i] = m_pWriter->amin[i] = m_pWriter->arms[i] = 0.0f;
 
+	m_pWriter->frames = new Frame [iChannels];
+
+	// Pyramid level accumulators, built in the very same pass...
+	const unsigned int nlevels = MaxLevels * iChannels;
+	m_pWriter->lmax = new unsigned char [nlevels];
+	m_pWriter->lmin = new unsigned char [nlevels];
+	m_pWriter->lrms = new float [nlevels];
+	for (unsigned int i = 0; i < nlevels; ++i) {
+		m_pWriter->lmax[i] = m_pWriter->lmin[i] = 0;
+		m_pWriter->lrms[i] = 0.0f;
+	}
+	for (unsigned short i = 0; i < MaxLevels; ++i)
+		m_pWriter->lpeak[i] = 0;
+
 	// Get resample/timestretch-aware internal peak period ratio...
 	m_pWriter->period_p = iSampleRate;
 	qtractorAudioEngine *pAudioEngine = nullptr;
 	qtractorSession *pSession = qtractorSession::getInstance();
 	if (pSession) pAudioEngine = pSession->audioEngine();
 	if (pAudioEngine) {
-		const unsigned int num = (iSampleRate * m_peakHeader.period);
+		const unsigned int num = (iSampleRate * header.period);
 		const unsigned int den = (unsigned int)
 			::rintf(float(pAudioEngine->sampleRate() * m_fTimeStretch));
 		m_pWriter->period_q = (num / den);
 		m_pWriter->period_r = (num % den);
 		if (m_pWriter->period_r > 0) {
-			m_pWriter->period_r += m_peakHeader.period;
-			m_pWriter->period_r /= m_peakHeader.period;
+			m_pWriter->period_r += header.period;
+			m_pWriter->period_r /= header.period;
 		}
 	} else {
-		m_pWriter->period_q = m_peakHeader.period;
+		m_pWriter->period_q = header.period;
 		m_pWriter->period_r = 0;
 	}
 
@@ -705,21 +949,45 @@ void qtractorAudioPeakFile::closeWrite (void)
 	// Make things critical...
 	QMutexLocker locker(&m_mutex);
 
+	if (m_pWriter == nullptr)
+		return;
+
 	// Flush and close...
-	if (m_openMode == Write) {
-		if (m_pWriter && m_pWriter->npeak > 0)
-			writeFrame();
-		m_peakFile.close();
-		m_openMode = None;
+	if (m_pWriter->npeak > 0)
+		writeFrame();
+	for (unsigned short i = 1; i < MaxLevels; ++i) {
+		if (m_pWriter->lpeak[i] > 0)
+			flushLevel(i);
 	}
+	writeTrailer();
+	m_writeFile.close();
+
+	// Replace the old peak file, in one go...
+	const QString& sPeakName = m_peakFile.fileName();
+#if defined(Q_OS_WINDOWS)
+	QFile::remove(sPeakName);
+	QFile::rename(m_writeFile.fileName(), sPeakName);
+#else
+	::rename(QFile::encodeName(m_writeFile.fileName()).constData(),
+		QFile::encodeName(sPeakName).constData());
+#endif
 
-	if (m_pWriter) {
-		delete [] m_pWriter->amax;
-		delete [] m_pWriter->amin;
-		delete [] m_pWriter->arms;
-		delete m_pWriter;
-		m_pWriter = nullptr;
-	}
+	// Any reader (GUI) will pick the new one on next (re)open...
+	if (m_openMode == Write)
+		m_openMode = None;
+	else
+	if (m_openMode == Read)
+		m_bReopen = true;
+
+	delete [] m_pWriter->amax;
+	delete [] m_pWriter->amin;
+	delete [] m_pWriter->arms;
+	delete [] m_pWriter->frames;
+	delete [] m_pWriter->lmax;
+	delete [] m_pWriter->lmin;
+	delete [] m_pWriter->lrms;
+	delete m_pWriter;
+	m_pWriter = nullptr;
 }
 
 
@@ -731,12 +999,12 @@ int qtractorAudioPeakFile::write (
 	QMutexLocker locker(&m_mutex);
 
 	// We should be actually open for writing...
-	if (m_openMode != Write || m_pWriter == nullptr)
+	if (m_pWriter == nullptr)
 		return 0;
 
 	for (unsigned int n = 0; n < iAudioFrames; ++n) {
 		// Accumulate for this sample frame...
-		for (unsigned short k = 0; k < m_peakHeader.channels; ++k) {
+		for (unsigned short k = 0; k < m_pWriter->header.channels; ++k) {
 			const float fSample = ppAudioFrames[k][n];
 			if (m_pWriter->amax[k] < fSample || m_pWriter->npeak == 0)
 				m_pWriter->amax[k] = fSample;
@@ -781,23 +1049,161 @@ void qtractorAudioPeakFile::writeFrame (void)
 	if (m_pWriter == nullptr)
 		return;
 
-	if (!m_peakFile.seek(sizeof(Header) + m_pWriter->offset))
+	if (!m_writeFile.seek(sizeof(Header) + m_pWriter->offset))
 		return;
 
-	Frame frame;
-	for (unsigned short k = 0; k < m_peakHeader.channels; ++k) {
+	Frame *pFrames = m_pWriter->frames;
+	for (unsigned short k = 0; k < m_pWriter->header.channels; ++k) {
 		// Write the denormalized peak values...
 		float& fmax = m_pWriter->amax[k];
 		float& fmin = m_pWriter->amin[k];
 		float& frms = m_pWriter->arms[k];
+		Frame& frame = pFrames[k];
 		frame.max = unormf(::fabsf(fmax));
 		frame.min = unormf(::fabsf(fmin));
 		frame.rms = unormf(::sqrtf(frms / float(m_pWriter->npeak)));
 		// Reset peak period accumulators...
 		fmax = fmin = frms = 0.0f;
-		// Bail out?...
-		m_pWriter->offset += m_peakFile.write((const char *) &frame, sizeof(Frame));
 	}
+
+	// Bail out?...
+	const qint64 nwrite = m_writeFile.write((const char *) pFrames,
+		m_pWriter->header.channels * sizeof(Frame));
+	if (nwrite > 0)
+		m_pWriter->offset += nwrite;
+
+	// Next pyramid level...
+	writeLevel(1, pFrames);
+}
+
+
+// Pyramid level accumulation (cascading decimation).
+void qtractorAudioPeakFile::writeLevel (
+	unsigned short iLevel, const Frame *pFrames )
+{
+	if (iLevel >= MaxLevels)
+		return;
+
+	const unsigned short iChannels = m_pWriter->header.channels;
+	const unsigned int i0 = iLevel * iChannels;
+	for (unsigned short k = 0; k < iChannels; ++k) {
+		const Frame& frame = pFrames[k];
+		const unsigned int i = i0 + k;
+		if (m_pWriter->lmax[i] < frame.max)
+			m_pWriter->lmax[i] = frame.max;
+		if (m_pWriter->lmin[i] < frame.min)
+			m_pWriter->lmin[i] = frame.min;
+		m_pWriter->lrms[i] += float(frame.rms) * float(frame.rms);
+	}
+
+	if (++m_pWriter->lpeak[iLevel] >= c_aPeakLevelRatios[iLevel])
+		flushLevel(iLevel);
+}
+
+
+// Pyramid level decimated frame output.
+void qtractorAudioPeakFile::flushLevel ( unsigned short iLevel )
+{
+	const unsigned short iChannels = m_pWriter->header.channels;
+	const float fPeak = float(m_pWriter->lpeak[iLevel]);
+
+	Frame *pFrames = m_pWriter->frames;
+	const unsigned int i0 = iLevel * iChannels;
+	for (unsigned short k = 0; k < iChannels; ++k) {
+		const unsigned int i = i0 + k;
+		Frame& frame = pFrames[k];
+		frame.max = m_pWriter->lmax[i];
+		frame.min = m_pWriter->lmin[i];
+		frame.rms = (unsigned char) ::rintf(::sqrtf(m_pWriter->lrms[i] / fPeak));
+		m_pWriter->lmax[i] = m_pWriter->lmin[i] = 0;
+		m_pWriter->lrms[i] = 0.0f;
+	}
+
+	m_pWriter->ldata[iLevel].append(
+		(const char *) pFrames, iChannels * sizeof(Frame));
+	m_pWriter->lpeak[iLevel] = 0;
+
+	writeLevel(iLevel + 1, pFrames);
+}
+
+
+// Pyramid directory (trailer) write, after all levels data.
+bool qtractorAudioPeakFile::writeTrailer (void)
+{
+	const unsigned int nsize = m_pWriter->header.channels * sizeof(Frame);
+	if (nsize < 1)
+		return false;
+
+	Trailer trailer;
+	::memset(&trailer, 0, sizeof(Trailer));
+	::memcpy(trailer.magic, c_szPeakTrailerMagic, sizeof(trailer.magic));
+	trailer.version = c_iPeakTrailerVersion;
+
+	// Base level...
+	unsigned short iLevels = 1;
+	trailer.length[0] = (m_pWriter->offset / nsize);
+	qint64 iOffset = sizeof(Header) + qint64(trailer.length[0]) * nsize;
+
+	// Decimated levels, as far as they go...
+	for ( ; iLevels < MaxLevels; ++iLevels) {
+		const QByteArray& data = m_pWriter->ldata[iLevels];
+		if (data.isEmpty())
+			break;
+		if (!m_writeFile.seek(iOffset)
+			|| m_writeFile.write(data) != qint64(data.size()))
+			return false;
+		trailer.length[iLevels] = (data.size() / nsize);
+		iOffset += data.size();
+	}
+
+	trailer.levels = iLevels;
+
+	if (!m_writeFile.seek(iOffset))
+		return false;
+
+	return (m_writeFile.write((const char *) &trailer, sizeof(Trailer))
+		== qint64(sizeof(Trailer)));
+}
+
+
+// Pyramid directory (trailer) read, validating whole file extent.
+bool qtractorAudioPeakFile::readTrailer (void)
+{
+	m_iLevels = 0;
+
+	const unsigned int nsize = m_peakHeader.channels * sizeof(Frame);
+	if (nsize < 1)
+		return false;
+
+	const qint64 iFileSize = m_peakFile.size();
+	if (iFileSize < qint64(sizeof(Header) + sizeof(Trailer)))
+		return false;
+
+	Trailer trailer;
+	if (!m_peakFile.seek(iFileSize - sizeof(Trailer))
+		|| m_peakFile.read((char *) &trailer, sizeof(Trailer))
+			!= qint64(sizeof(Trailer)))
+		return false;
+
+	if (::memcmp(trailer.magic, c_szPeakTrailerMagic, sizeof(trailer.magic))
+		|| trailer.version != c_iPeakTrailerVersion
+		|| trailer.levels < 1 || trailer.levels > MaxLevels)
+		return false;
+
+	unsigned long iOffset = 0;
+	for (unsigned short i = 0; i < trailer.levels; ++i) {
+		m_iLevelOffset[i] = iOffset;
+		m_iLevelLength[i] = trailer.length[i];
+		iOffset += trailer.length[i];
+	}
+
+	if (qint64(sizeof(Header) + sizeof(Trailer)) + qint64(iOffset) * nsize
+			!= iFileSize)
+		return false;
+
+	m_iLevels = trailer.levels;
+
+	return true;
 }
 
 
@@ -818,6 +1224,7 @@ void qtractorAudioPeakFile::removeRef (void)
 void qtractorAudioPeakFile::remove (void)
 {
 	m_peakFile.remove();
+	m_writeFile.remove();
 }
 
 
@@ -864,7 +1271,7 @@ QString qtractorAudioPeakFile::peakName (
 
 // Constructor.
 qtractorAudioPeak::qtractorAudioPeak ( qtractorAudioPeakFile *pPeakFile )
-	: m_pPeakFile(pPeakFile), m_pPeakFrames(nullptr),
+	: m_pPeakFile(pPeakFile), m_pPeakFrames(nullptr), m_pPeakBuffer(nullptr),
 		m_iPeakLength(0), m_iPeakHash(0)
 {
 	m_pPeakFile->addRef();
@@ -874,7 +1281,7 @@ qtractorAudioPeak::qtractorAudioPeak ( qtractorAudioPeakFile *pPeakFile )
 // Copy contructor.
 qtractorAudioPeak::qtractorAudioPeak ( const qtractorAudioPeak& peak )
 	: m_pPeakFile(peak.m_pPeakFile), m_pPeakFrames(nullptr),
-		m_iPeakLength(0), m_iPeakHash(0)
+		m_pPeakBuffer(nullptr), m_iPeakLength(0), m_iPeakHash(0)
 {
 	m_pPeakFile->addRef();
 }
@@ -885,8 +1292,8 @@ qtractorAudioPeak::~qtractorAudioPeak (void)
 {
 	m_pPeakFile->removeRef();
 
-	if (m_pPeakFrames)
-		delete [] m_pPeakFrames;
+	if (m_pPeakBuffer)
+		delete [] m_pPeakBuffer;
 }
 
 
@@ -908,10 +1315,24 @@ qtractorAudioPeakFile::Frame *qtractorAudioPeak::peakFrames (
 		return nullptr;
 
 	// Peak frames length estimation...
-	const unsigned int iPeakLength = (iFrameLength / iPeakPeriod);
-	if (iPeakLength < 1)
+	if (iFrameLength < iPeakPeriod)
 		return nullptr;
 
+	// Pick the coarsest pyramid level still covering the width...
+	const unsigned short iLevels = m_pPeakFile->levels();
+	unsigned short iLevel = 0;
+	unsigned long iLevelPeriod = iPeakPeriod;
+	while (iLevel + 1 < iLevels) {
+		const unsigned long iNextPeriod = iPeakPeriod
+			* qtractorAudioPeakFile::levelRatio(iLevel + 1);
+		if (iFrameLength / iNextPeriod < (unsigned long) width)
+			break;
+		iLevelPeriod = iNextPeriod;
+		++iLevel;
+	}
+
+	const unsigned int iPeakLength = (iFrameLength / iLevelPeriod);
+
 	// We'll get a brand new peak frames alright...
 	const unsigned short iChannels = m_pPeakFile->channels();
 	if (iChannels < 1)
@@ -925,21 +1346,28 @@ qtractorAudioPeakFile::Frame *qtractorAudioPeak::peakFrames (
 				= qHash(iPeakPeriod)
 				^ qHash(iFrameOffset)
 				^ qHash(iFrameLength)
-				^ qHash(width);
+				^ qHash(width)
+				^ qHash(m_pPeakFile->serial());
 			if (m_iPeakHash == iPeakHash)
 				return m_pPeakFrames;
 			m_iPeakHash = iPeakHash;
 		}
 		// Clenup previous frame-buffers...
-		delete [] m_pPeakFrames;
+		if (m_pPeakBuffer) {
+			delete [] m_pPeakBuffer;
+			m_pPeakBuffer = nullptr;
+		}
 		m_pPeakFrames = nullptr;
 		m_iPeakLength = 0;
 	}
 
-	// Grab them in...
-	const unsigned long iPeakOffset = (iFrameOffset / iPeakPeriod);
+	// Grab them in, straight from the mapping if possible...
+	const unsigned long iPeakOffset = (iFrameOffset / iLevelPeriod);
 	qtractorAudioPeakFile::Frame *pPeakFrames
-		= m_pPeakFile->read(iPeakOffset, iPeakLength);
+		= m_pPeakFile->mapped(iPeakOffset, iPeakLength, iLevel);
+	const bool bMapped = (pPeakFrames != nullptr);
+	if (!bMapped)
+		pPeakFrames = m_pPeakFile->read(iPeakOffset, iPeakLength, iLevel);
 	if (pPeakFrames == nullptr)
 		return nullptr;
 
@@ -950,7 +1378,8 @@ qtractorAudioPeakFile::Frame *qtractorAudioPeak::peakFrames (
 	if (width < p1 && width > 1) {
 		const int w2 = (width >> 1) + 1;
 		const int n2 = iChannels * w2;
-		m_pPeakFrames = new qtractorAudioPeakFile::Frame [n2];
+		m_pPeakBuffer = new qtractorAudioPeakFile::Frame [n2];
+		m_pPeakFrames = m_pPeakBuffer;
 		int n = 0; int i = 0;
 		while (n < n2) {
 			const int i2 = (n * p1) / w2;
@@ -975,11 +1404,18 @@ qtractorAudioPeakFile::Frame *qtractorAudioPeak::peakFrames (
 		// New-indirect frame buffer length...
 		m_iPeakLength = n / iChannels;
 		// Done-indirect.
+	} else if (bMapped) {
+		// Direct-mapped frame-buffer (zero-copy)...
+		m_pPeakFrames = pPeakFrames;
+		// New-direct frame buffer length...
+		m_iPeakLength = iPeakLength;
+		// Done-direct.
 	} else {
 		// Direct-copy frame-buffer...
-		m_pPeakFrames = new qtractorAudioPeakFile::Frame [n1];
-		::memcpy(m_pPeakFrames, pPeakFrames,
+		m_pPeakBuffer = new qtractorAudioPeakFile::Frame [n1];
+		::memcpy(m_pPeakBuffer, pPeakFrames,
 			n1 * sizeof(qtractorAudioPeakFile::Frame));
+		m_pPeakFrames = m_pPeakBuffer;
 		// New-direct frame buffer length...
 		m_iPeakLength = iPeakLength;
 		// Done-direct.
@@ -1003,10 +1439,14 @@ qtractorAudioPeakFactory *qtractorAudioPeakFactory::getInstance (void)
 }
 
 
+// Default number of peak file worker threads (0=auto).
+unsigned short qtractorAudioPeakFactory::g_iDefaultPeakThreads = 0;
+
+
 // Constructor.
 qtractorAudioPeakFactory::qtractorAudioPeakFactory ( QObject *pParent )
 	: QObject(pParent), m_bAutoRemove(false),
-		m_pPeakThread(nullptr), m_iPeakPeriod(c_iPeakPeriod)
+		m_pPeakPool(nullptr), m_iPeakPeriod(c_iPeakPeriod)
 {
 	// Pseudo-singleton reference setup.
 	g_pPeakFactory = this;
@@ -1016,14 +1456,10 @@ qtractorAudioPeakFactory::qtractorAudioPeakFactory ( QObject *pParent )
 // Default destructor.
 qtractorAudioPeakFactory::~qtractorAudioPeakFactory (void)
 {
-	if (m_pPeakThread) {
-		if (m_pPeakThread->isRunning()) do {
-			m_pPeakThread->setRunState(false);
-		//	m_pPeakThread->terminate();
-			m_pPeakThread->sync();
-		} while (!m_pPeakThread->wait(100));
-		delete m_pPeakThread;
-		m_pPeakThread = nullptr;
+	if (m_pPeakPool) {
+		m_pPeakPool->stop();
+		delete m_pPeakPool;
+		m_pPeakPool = nullptr;
 	}
 
 	cleanup();
@@ -1068,9 +1504,16 @@ qtractorAudioPeak* qtractorAudioPeakFactory::createPeak (
 {
 	QMutexLocker locker(&m_mutex);
 
-	if (m_pPeakThread == nullptr) {
-		m_pPeakThread = new qtractorAudioPeakThread();
-		m_pPeakThread->start();
+	if (m_pPeakPool == nullptr) {
+		unsigned short iPeakThreads = g_iDefaultPeakThreads;
+		if (iPeakThreads < 1) {
+			const int iIdealThreads = QThread::idealThreadCount() >> 1;
+			iPeakThreads = (iIdealThreads > 4 ? 4 : iIdealThreads);
+			if (iPeakThreads < 1)
+				iPeakThreads = 1;
+		}
+		m_pPeakPool = new qtractorAudioPeakPool(iPeakThreads);
+		m_pPeakPool->start();
 	}
 
 	const QString& sPeakName
@@ -1107,7 +1550,26 @@ void qtractorAudioPeakFactory::notifyPeakEvent (void)
 // Base sync method.
 void qtractorAudioPeakFactory::sync ( qtractorAudioPeakFile *pPeakFile )
 {
-	if (m_pPeakThread) m_pPeakThread->sync(pPeakFile);
+	if (m_pPeakPool) m_pPeakPool->sync(pPeakFile);
+}
+
+
+// Visible peak file creation priority.
+void qtractorAudioPeakFactory::prioritize ( qtractorAudioPeakFile *pPeakFile )
+{
+	if (m_pPeakPool) m_pPeakPool->prioritize(pPeakFile);
+}
+
+
+// Default number of peak file worker threads (0=auto).
+void qtractorAudioPeakFactory::setDefaultPeakThreads ( unsigned short iPeakThreads )
+{
+	g_iDefaultPeakThreads = iPeakThreads;
+}
+
+unsigned short qtractorAudioPeakFactory::defaultPeakThreads (void)
+{
+	return g_iDefaultPeakThreads;
 }
 
 
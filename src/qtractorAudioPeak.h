@@ -29,10 +29,11 @@
 #include <QMutex>
 
 #include <QStringList>
+#include <QByteArray>
 
 
 // Forward declarations.
-class qtractorAudioPeakThread;
+class qtractorAudioPeakPool;
 
 
 //----------------------------------------------------------------------
@@ -60,6 +61,16 @@ public:
 	unsigned short period();
 	unsigned short channels();
 
+	// Peak pyramid properties accessors.
+	unsigned short levels();
+	unsigned long length(unsigned short iLevel = 0);
+
+	// Peak pyramid maximum number of levels.
+	enum { MaxLevels = 8 };
+
+	// Peak pyramid level decimation (relative to base period).
+	static unsigned int levelRatio(unsigned short iLevel);
+
 	// Audio peak file header.
 	struct Header
 	{
@@ -75,9 +86,26 @@ public:
 		unsigned char rms;
 	};
 
+	// Audio peak file pyramid directory (trailer).
+	struct Trailer
+	{
+		char           magic[4];
+		unsigned short version;
+		unsigned short levels;
+		unsigned int   length[MaxLevels];
+	};
+
 	// Peak cache file methods.
 	bool openRead();
-	Frame *read(unsigned long iPeakOffset, unsigned int iPeakLength);
+	Frame *read(unsigned long iPeakOffset, unsigned int iPeakLength,
+		unsigned short iLevel = 0);
+
+	// Direct (zero-copy) memory-mapped peak frames (GUI thread only).
+	Frame *mapped(unsigned long iPeakOffset, unsigned int iPeakLength,
+		unsigned short iLevel = 0);
+
+	// Read-open serial number (changes on each re-open).
+	unsigned int serial() const;
 	void closeRead();
 
 	// Write peak from audio frame methods.
@@ -104,9 +132,20 @@ public:
 
 protected:
 
+	// Internal read-close method (unlocked).
+	void closeReadEx();
+
 	// Internal creational methods.
 	void writeFrame();
 
+	// Pyramid level accumulation and decimation.
+	void writeLevel(unsigned short iLevel, const Frame *pFrames);
+	void flushLevel(unsigned short iLevel);
+
+	// Pyramid directory (trailer) write and read.
+	bool writeTrailer();
+	bool readTrailer();
+
 	// Read frames from peak file into local buffer cache.
 	unsigned int readBuffer(unsigned int iBuffOffset,
 		unsigned long iPeakOffset, unsigned int iPeakFrames);
@@ -119,14 +158,31 @@ private:
 
 	QFile          m_peakFile;
 
+	// Peak file being (re)created, renamed into place when complete.
+	QFile          m_writeFile;
+
 	enum { None = 0, Read = 1, Write = 2 } m_openMode;
 
 	Header         m_peakHeader;
 
+	// Peak pyramid levels (in peak frames).
+	unsigned short m_iLevels;
+	unsigned long  m_iLevelOffset[MaxLevels];
+	unsigned long  m_iLevelLength[MaxLevels];
+
+	// Read-only memory mapping (complete peak files only);
+	// only ever (un)mapped on the GUI thread, on (re)open.
+	uchar         *m_pMapData;
+	unsigned int   m_iSerial;
+
+	// Set when a new peak file replaced the one being read.
+	volatile bool  m_bReopen;
+
 	Frame         *m_pBuffer;
 	unsigned int   m_iBuffSize;
 	unsigned int   m_iBuffLength;
 	unsigned long  m_iBuffOffset;
+	unsigned short m_iBuffLevel;
 
 	QMutex         m_mutex;
 
@@ -138,6 +194,7 @@ private:
 	// Peak-writer context state.
 	struct Writer
 	{
+		Header         header;
 		unsigned long  offset;
 		float         *amax;
 		float         *amin;
@@ -149,6 +206,13 @@ private:
 		unsigned short npeak;
 		unsigned long  nread;
 		unsigned long  nwrite;
+		Frame         *frames;
+		// Pyramid level accumulators.
+		unsigned char *lmax;
+		unsigned char *lmin;
+		float         *lrms;
+		unsigned short lpeak[MaxLevels];
+		QByteArray     ldata[MaxLevels];
 
 	} *m_pWriter;
 };
@@ -197,9 +261,12 @@ private:
 	// Instance variable (ref'counted).
 	qtractorAudioPeakFile *m_pPeakFile;
 
-	// Interim scaling buffer and hash.
+	// Current peak frames (either mapped or interim buffer).
 	qtractorAudioPeakFile::Frame *m_pPeakFrames;
 
+	// Interim scaling buffer and hash.
+	qtractorAudioPeakFile::Frame *m_pPeakBuffer;
+
 	unsigned int m_iPeakLength;
 	unsigned int m_iPeakHash;
 };
@@ -238,6 +305,13 @@ public:
 	// Base sync method.
 	void sync(qtractorAudioPeakFile *pPeakFile = nullptr);
 
+	// Visible peak file creation priority.
+	void prioritize(qtractorAudioPeakFile *pPeakFile);
+
+	// Default number of peak file worker threads (0=auto).
+	static void setDefaultPeakThreads(unsigned short iPeakThreads);
+	static unsigned short defaultPeakThreads();
+
 	// Cleanup method.
 	void cleanup();
 
@@ -262,14 +336,17 @@ private:
 	// Auto-delete property.
 	bool m_bAutoRemove;
 
-	// The peak file creation detached thread.
-	qtractorAudioPeakThread *m_pPeakThread;
+	// The peak file creation worker thread pool.
+	qtractorAudioPeakPool *m_pPeakPool;
 
 	// The current running peak-period.
 	unsigned short m_iPeakPeriod;
 
 	// The pseudo-singleton instance.
 	static qtractorAudioPeakFactory *g_pPeakFactory;
+
+	// Default number of peak file worker threads.
+	static unsigned short g_iDefaultPeakThreads;
 };
 
 
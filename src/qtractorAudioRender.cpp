@@ -0,0 +1,743 @@
+// qtractorAudioRender.cpp
+//
+/****************************************************************************
+   Copyright (C) 2005-2022, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qtractorAbout.h"
+#include "qtractorAudioRender.h"
+
+#include "qtractorAudioEngine.h"
+
+#include "qtractorSession.h"
+#include "qtractorSessionCursor.h"
+
+#include "qtractorTrack.h"
+#include "qtractorCurve.h"
+
+#include "qtractorInsertPlugin.h"
+
+#include <QList>
+#include <QHash>
+
+#include <errno.h>
+
+
+// Maximum number of render worker threads.
+#define MAX_RENDER_THREADS 32
+
+// Ready node busy-wait limit, before parking on a semaphore.
+#define MAX_RENDER_SPINS 256
+
+
+//----------------------------------------------------------------------
+// class qtractorAudioRender::Graph -- Audio track processing graph.
+//
+// Each audio track gets either a (parallel) render node followed by
+// a commit node, or a single (serial) process node when it has active
+// aux-sends. All nodes writing into the same output bus are chained
+// in track order, so that the final mix-down stays deterministic.
+//
+
+class qtractorAudioRender::Graph
+{
+public:
+
+	// Node types.
+	enum Type { Render, Commit, Process };
+
+	// Node item.
+	struct Node
+	{
+		Type           type;
+		qtractorTrack *track;
+		int            index;	// Track index (session cursor clip).
+		int            nrefs;	// Number of predecessors.
+		int            nsuccs;	// Number of successors.
+		int           *succs;	// Successor node indexes.
+		qtractorAtomic refs;	// Predecessors still pending (RT).
+	};
+
+	// Session track entry (graph validity check).
+	struct Entry
+	{
+		qtractorTrack *track;
+		qtractorBus   *bus;
+		bool           async;
+	};
+
+	// Constructor.
+	Graph(int iSerial) : m_iSerial(iSerial),
+		m_pNodes(nullptr), m_iNodes(0), m_pSuccs(nullptr),
+		m_pEntries(nullptr), m_iEntries(0), m_pReady(nullptr),
+		m_pWaits(nullptr), m_pSemWaits(nullptr)
+	{
+		ATOMIC_SET(&m_iReadyWrite, 0);
+		ATOMIC_SET(&m_iReadyRead, 0);
+	}
+
+	// Destructor.
+	~Graph()
+	{
+		if (m_pWaits)
+			delete [] m_pWaits;
+		if (m_pReady)
+			delete [] m_pReady;
+		if (m_pEntries)
+			delete [] m_pEntries;
+		if (m_pSuccs)
+			delete [] m_pSuccs;
+		if (m_pNodes)
+			delete [] m_pNodes;
+	}
+
+	// Topology serial number accessor.
+	int serial() const { return m_iSerial; }
+
+	// Graph (re)build (non-RT).
+	void build(qtractorSession *pSession);
+
+	// Graph validity check (RT).
+	bool check(qtractorSession *pSession) const;
+
+	// Graph per-cycle reset (RT).
+	void reset(sem_t *pSemWaits);
+
+	// Ready node queue (RT).
+	void push(Node *pNode);
+	Node *pop(unsigned short iWorker);
+
+	// Node completion (RT).
+	void done(Node *pNode);
+
+	// Number of nodes accessor.
+	int nodes() const { return m_iNodes; }
+
+private:
+
+	// Instance variables.
+	int    m_iSerial;
+
+	Node  *m_pNodes;
+	int    m_iNodes;
+	int   *m_pSuccs;
+
+	Entry *m_pEntries;
+	int    m_iEntries;
+
+	// Ready node queue (each node gets in exactly once per cycle).
+	QAtomicPointer<Node> *m_pReady;
+
+	qtractorAtomic m_iReadyWrite;
+	qtractorAtomic m_iReadyRead;
+
+	// Ready slot waiters (0=none, -1=filled, else worker index + 1)
+	// and their own per-worker wake-up semaphores.
+	qtractorAtomic *m_pWaits;
+	sem_t *m_pSemWaits;
+};
+
+
+// Active audio aux-sends target buses.
+static void qtractorAudioRender_auxSendBuses (
+	qtractorTrack *pTrack, QList<qtractorBus *>& buses )
+{
+	qtractorPluginList *pPluginList = pTrack->pluginList();
+	if (pPluginList == nullptr || !pPluginList->isAudioAuxSendActivated())
+		return;
+
+	for (qtractorPlugin *pPlugin = pPluginList->first();
+			pPlugin; pPlugin = pPlugin->next()) {
+		qtractorPluginType *pType = pPlugin->type();
+		if (pType->typeHint() == qtractorPluginType::AuxSend
+			&& pType->index() > 0 && pPlugin->isActivated()) {
+			qtractorAudioAuxSendPlugin *pAudioAuxSendPlugin
+				= static_cast<qtractorAudioAuxSendPlugin *> (pPlugin);
+			qtractorBus *pBus = pAudioAuxSendPlugin->audioBus();
+			if (pBus && !buses.contains(pBus))
+				buses.append(pBus);
+		}
+	}
+}
+
+
+// Graph (re)build (non-RT).
+void qtractorAudioRender::Graph::build ( qtractorSession *pSession )
+{
+	struct Item
+	{
+		Type           type;
+		qtractorTrack *track;
+		int            index;
+		QList<int>     preds;
+	};
+
+	QList<Item>  items;
+	QList<Entry> entries;
+
+	// Last writer node, per bus.
+	QHash<qtractorBus *, int> writers;
+
+	int iTrack = 0;
+	for (qtractorTrack *pTrack = pSession->tracks().first();
+			pTrack; pTrack = pTrack->next(), ++iTrack) {
+		Entry entry;
+		entry.track = pTrack;
+		entry.bus   = pTrack->outputBus();
+		entry.async = pTrack->isRenderAsync();
+		entries.append(entry);
+		if (pTrack->trackType() != qtractorTrack::Audio)
+			continue;
+		Item item;
+		item.track = pTrack;
+		item.index = iTrack;
+		QList<qtractorBus *> buses;
+		if (entry.bus)
+			buses.append(entry.bus);
+		if (entry.async) {
+			item.type = Render;
+			items.append(item);
+			item.type = Commit;
+			item.preds.append(items.count() - 1);
+		} else {
+			item.type = Process;
+			qtractorAudioRender_auxSendBuses(pTrack, buses);
+		}
+		const int iNode = items.count();
+		QListIterator<qtractorBus *> iter(buses);
+		while (iter.hasNext()) {
+			qtractorBus *pBus = iter.next();
+			QHash<qtractorBus *, int>::ConstIterator it = writers.constFind(pBus);
+			if (it != writers.constEnd() && !item.preds.contains(it.value()))
+				item.preds.append(it.value());
+			writers.insert(pBus, iNode);
+		}
+		items.append(item);
+	}
+
+	// Freeze it all...
+	m_iNodes = items.count();
+	m_pNodes = new Node [m_iNodes > 0 ? m_iNodes : 1];
+	m_pReady = new QAtomicPointer<Node> [m_iNodes > 0 ? m_iNodes : 1];
+	m_pWaits = new qtractorAtomic [m_iNodes > 0 ? m_iNodes : 1];
+
+	int iSuccs = 0;
+	int i;
+	for (i = 0; i < m_iNodes; ++i) {
+		const Item& item = items.at(i);
+		Node *pNode = &m_pNodes[i];
+		pNode->type   = item.type;
+		pNode->track  = item.track;
+		pNode->index  = item.index;
+		pNode->nrefs  = item.preds.count();
+		pNode->nsuccs = 0;
+		pNode->succs  = nullptr;
+		ATOMIC_SET(&pNode->refs, pNode->nrefs);
+		iSuccs += pNode->nrefs;
+	}
+
+	m_pSuccs = new int [iSuccs > 0 ? iSuccs : 1];
+
+	for (i = 0; i < m_iNodes; ++i) {
+		QListIterator<int> iter(items.at(i).preds);
+		while (iter.hasNext())
+			++(m_pNodes[iter.next()].nsuccs);
+	}
+
+	int *pSuccs = m_pSuccs;
+	for (i = 0; i < m_iNodes; ++i) {
+		Node *pNode = &m_pNodes[i];
+		pNode->succs = pSuccs;
+		pSuccs += pNode->nsuccs;
+		pNode->nsuccs = 0;
+	}
+
+	for (i = 0; i < m_iNodes; ++i) {
+		QListIterator<int> iter(items.at(i).preds);
+		while (iter.hasNext()) {
+			Node *pNode = &m_pNodes[iter.next()];
+			pNode->succs[pNode->nsuccs++] = i;
+		}
+	}
+
+	m_iEntries = entries.count();
+	m_pEntries = new Entry [m_iEntries > 0 ? m_iEntries : 1];
+	for (i = 0; i < m_iEntries; ++i)
+		m_pEntries[i] = entries.at(i);
+}
+
+
+// Graph validity check (RT).
+bool qtractorAudioRender::Graph::check ( qtractorSession *pSession ) const
+{
+	int iEntry = 0;
+	for (qtractorTrack *pTrack = pSession->tracks().first();
+			pTrack; pTrack = pTrack->next()) {
+		if (iEntry >= m_iEntries)
+			return false;
+		const Entry& entry = m_pEntries[iEntry++];
+		if (entry.track != pTrack
+			|| entry.bus != pTrack->outputBus()
+			|| entry.async != pTrack->isRenderAsync())
+			return false;
+	}
+
+	return (iEntry == m_iEntries);
+}
+
+
+// Graph per-cycle reset (RT).
+void qtractorAudioRender::Graph::reset ( sem_t *pSemWaits )
+{
+	m_pSemWaits = pSemWaits;
+
+	ATOMIC_SET(&m_iReadyWrite, 0);
+	ATOMIC_SET(&m_iReadyRead, 0);
+
+	int i;
+	for (i = 0; i < m_iNodes; ++i) {
+		Node *pNode = &m_pNodes[i];
+		ATOMIC_SET(&pNode->refs, pNode->nrefs);
+		ATOMIC_SET(&m_pWaits[i], 0);
+		m_pReady[i].storeRelease(nullptr);
+	}
+
+	for (i = 0; i < m_iNodes; ++i) {
+		Node *pNode = &m_pNodes[i];
+		if (pNode->nrefs == 0)
+			push(pNode);
+	}
+}
+
+
+// Ready node queue (RT).
+void qtractorAudioRender::Graph::push ( Node *pNode )
+{
+	const int i = ATOMIC_INC(&m_iReadyWrite) - 1;
+	m_pReady[i].storeRelease(pNode);
+
+	// Mark the slot filled, waking up whoever is parked on it...
+	qtractorAtomic *pWait = &m_pWaits[i];
+	int iWait;
+	do {
+		iWait = ATOMIC_GET(pWait);
+	} while (!ATOMIC_CAS(pWait, iWait, -1));
+
+	if (iWait > 0)
+		::sem_post(&m_pSemWaits[iWait - 1]);
+}
+
+
+qtractorAudioRender::Graph::Node *qtractorAudioRender::Graph::pop (
+	unsigned short iWorker )
+{
+	const int i = ATOMIC_INC(&m_iReadyRead) - 1;
+	if (i >= m_iNodes)
+		return nullptr;
+
+	// Claimed slot is bound to get filled, sooner or later:
+	// busy-wait for a little while, then get parked...
+	Node *pNode = m_pReady[i].loadAcquire();
+	for (int iSpin = 0; pNode == nullptr && iSpin < MAX_RENDER_SPINS; ++iSpin)
+		pNode = m_pReady[i].loadAcquire();
+
+	if (pNode == nullptr) {
+		// Still empty? register as its waiter, unless filled meanwhile...
+		if (ATOMIC_CAS(&m_pWaits[i], 0, iWorker + 1)) {
+			sem_t *pSem = &m_pSemWaits[iWorker];
+			while (::sem_wait(pSem) != 0 && errno == EINTR)
+				;
+		}
+		pNode = m_pReady[i].loadAcquire();
+	}
+
+	return pNode;
+}
+
+
+// Node completion (RT).
+void qtractorAudioRender::Graph::done ( Node *pNode )
+{
+	for (int i = 0; i < pNode->nsuccs; ++i) {
+		Node *pSucc = &m_pNodes[pNode->succs[i]];
+		if (ATOMIC_DEC(&pSucc->refs) == 0)
+			push(pSucc);
+	}
+}
+
+
+//----------------------------------------------------------------------
+// class qtractorAudioRender -- Audio track render worker pool.
+//
+
+// Default number of worker threads (0=serial).
+unsigned short qtractorAudioRender::g_iDefaultRenderThreads = 0;
+
+
+// Constructor.
+qtractorAudioRender::qtractorAudioRender (
+	qtractorAudioEngine *pAudioEngine, unsigned short iThreads )
+{
+	m_pAudioEngine = pAudioEngine;
+
+	if (iThreads > MAX_RENDER_THREADS)
+		iThreads = MAX_RENDER_THREADS;
+
+	m_iThreads  = iThreads;
+	m_pThreads  = new pthread_t [m_iThreads];
+	m_iRunning  = 0;
+	m_bRunState = false;
+
+	m_pGraph = nullptr;
+
+	ATOMIC_SET(&m_serial, 0);
+	m_iGraphSerial = -1;
+
+	m_pAudioCursor = nullptr;
+
+	m_iFrameStart = 0;
+	m_iFrameEnd = 0;
+
+	m_bExport = false;
+
+	ATOMIC_SET(&m_pending, 0);
+	ATOMIC_SET(&m_workers, 0);
+
+	::sem_init(&m_semRun, 0, 0);
+	::sem_init(&m_semDone, 0, 0);
+
+	// One parking semaphore per worker, plus the process thread's.
+	m_pSemWaits = new sem_t [m_iThreads + 1];
+	for (unsigned short i = 0; i <= m_iThreads; ++i)
+		::sem_init(&m_pSemWaits[i], 0, 0);
+}
+
+
+// Destructor.
+qtractorAudioRender::~qtractorAudioRender (void)
+{
+	close();
+
+	for (unsigned short i = 0; i <= m_iThreads; ++i)
+		::sem_destroy(&m_pSemWaits[i]);
+	delete [] m_pSemWaits;
+
+	::sem_destroy(&m_semDone);
+	::sem_destroy(&m_semRun);
+
+	Graph *pGraph = m_nextGraph.fetchAndStoreOrdered(nullptr);
+	if (pGraph)
+		delete pGraph;
+
+	pGraph = m_oldGraph.fetchAndStoreOrdered(nullptr);
+	if (pGraph)
+		delete pGraph;
+
+	if (m_pGraph)
+		delete m_pGraph;
+
+	delete [] m_pThreads;
+}
+
+
+// Worker threads (re)start.
+bool qtractorAudioRender::open (void)
+{
+	close();
+
+	jack_client_t *pJackClient = m_pAudioEngine->jackClient();
+	if (pJackClient == nullptr)
+		return false;
+
+	// Workers run at the very same priority as the JACK process thread...
+	const int iPriority = jack_client_real_time_priority(pJackClient);
+	const int iRealtime = (jack_is_realtime(pJackClient) && iPriority > 0);
+
+	m_bRunState = true;
+
+	// Worker indexes start past the process thread's (0)...
+	ATOMIC_SET(&m_workers, 0);
+
+	for (unsigned short i = 0; i < m_iThreads; ++i) {
+		if (jack_client_create_thread(pJackClient, &m_pThreads[i],
+				iPriority, iRealtime, worker_thread, this) != 0)
+			break;
+		++m_iRunning;
+	}
+
+	return (m_iRunning > 0);
+}
+
+
+// Worker threads stop.
+void qtractorAudioRender::close (void)
+{
+	if (m_iRunning < 1)
+		return;
+
+	m_bRunState = false;
+
+	unsigned short i;
+	for (i = 0; i < m_iRunning; ++i)
+		::sem_post(&m_semRun);
+	for (i = 0; i < m_iRunning; ++i)
+		::pthread_join(m_pThreads[i], nullptr);
+
+	m_iRunning = 0;
+}
+
+
+// Number of worker threads accessor.
+unsigned short qtractorAudioRender::threads (void) const
+{
+	return m_iRunning;
+}
+
+
+// Processing graph topology change notifier (any thread).
+void qtractorAudioRender::resetGraph (void)
+{
+	ATOMIC_INC(&m_serial);
+}
+
+
+// Processing graph (re)build (non-RT, GUI thread).
+bool qtractorAudioRender::isGraphDirty (void) const
+{
+	return (ATOMIC_GET(&m_serial) != m_iGraphSerial);
+}
+
+
+void qtractorAudioRender::updateGraph (void)
+{
+	// Get rid of any stale graph first...
+	Graph *pOldGraph = m_oldGraph.fetchAndStoreOrdered(nullptr);
+	if (pOldGraph)
+		delete pOldGraph;
+
+	qtractorSession *pSession = m_pAudioEngine->session();
+	if (pSession == nullptr)
+		return;
+
+	const int iSerial = ATOMIC_GET(&m_serial);
+
+	Graph *pGraph = new Graph(iSerial);
+	pGraph->build(pSession);
+
+	// Replace any pending one that didn't make it in time...
+	pOldGraph = m_nextGraph.fetchAndStoreOrdered(pGraph);
+	if (pOldGraph)
+		delete pOldGraph;
+
+	m_iGraphSerial = iSerial;
+}
+
+
+// Whether the current graph still matches the session (RT).
+bool qtractorAudioRender::checkGraph ( qtractorSession *pSession ) const
+{
+	if (m_pGraph == nullptr)
+		return false;
+
+	if (m_pGraph->serial() != ATOMIC_GET(&m_serial))
+		return false;
+
+	return m_pGraph->check(pSession);
+}
+
+
+// Process cycle executive (RT).
+void qtractorAudioRender::process ( qtractorSessionCursor *pAudioCursor,
+	unsigned long iFrameStart, unsigned long iFrameEnd )
+{
+	process_cycle(pAudioCursor, iFrameStart, iFrameEnd, false);
+}
+
+
+// Freewheeling process executive (parallel export).
+void qtractorAudioRender::process_export ( qtractorSessionCursor *pAudioCursor,
+	unsigned long iFrameStart, unsigned long iFrameEnd )
+{
+	process_cycle(pAudioCursor, iFrameStart, iFrameEnd, true);
+}
+
+
+// Common process cycle executive (RT).
+void qtractorAudioRender::process_cycle ( qtractorSessionCursor *pAudioCursor,
+	unsigned long iFrameStart, unsigned long iFrameEnd, bool bExport )
+{
+	qtractorSession *pSession = m_pAudioEngine->session();
+	if (pSession == nullptr)
+		return;
+
+	// Pick up the next graph, if any and stale one is gone...
+	if (m_oldGraph.loadAcquire() == nullptr) {
+		Graph *pGraph = m_nextGraph.fetchAndStoreOrdered(nullptr);
+		if (pGraph) {
+			m_oldGraph.storeRelease(m_pGraph);
+			m_pGraph = pGraph;
+		}
+	}
+
+	// Fallback to plain serial processing, while out-of-date...
+	if (!checkGraph(pSession)) {
+		if (m_pGraph && m_pGraph->serial() == ATOMIC_GET(&m_serial))
+			resetGraph();
+		if (bExport) {
+			int iTrack = 0;
+			for (qtractorTrack *pTrack = pSession->tracks().first();
+					pTrack; pTrack = pTrack->next(), ++iTrack) {
+				pTrack->process_export(pAudioCursor->clip(iTrack),
+					iFrameStart, iFrameEnd);
+			}
+		} else {
+			pSession->process(pAudioCursor, iFrameStart, iFrameEnd);
+		}
+		return;
+	}
+
+	// Track automation processing (serial)...
+	int iTrack = 0;
+	for (qtractorTrack *pTrack = pSession->tracks().first();
+			pTrack; pTrack = pTrack->next(), ++iTrack) {
+		qtractorCurveList *pCurveList = pTrack->curveList();
+		if (pCurveList && pCurveList->isProcess())
+			pCurveList->process(iFrameStart);
+		// Freewheeling MIDI tracks are not in the graph...
+		if (bExport && pTrack->trackType() != qtractorTrack::Audio) {
+			pTrack->process_export_render(pAudioCursor->clip(iTrack),
+				iFrameStart, iFrameEnd);
+		}
+	}
+
+	const int iNodes = m_pGraph->nodes();
+	if (iNodes < 1)
+		return;
+
+	m_pAudioCursor = pAudioCursor;
+	m_iFrameStart = iFrameStart;
+	m_iFrameEnd = iFrameEnd;
+	m_bExport = bExport;
+
+	m_pGraph->reset(m_pSemWaits);
+
+	unsigned int iWake = iNodes - 1;
+	if (iWake > m_iRunning)
+		iWake = m_iRunning;
+
+	ATOMIC_SET(&m_pending, iWake + 1);
+	for (unsigned int i = 0; i < iWake; ++i)
+		::sem_post(&m_semRun);
+
+	// We get our share of work too...
+	process_graph(0);
+
+	// Wait for the stragglers, if any...
+	if (ATOMIC_DEC(&m_pending) > 0) {
+		while (::sem_wait(&m_semDone) != 0 && errno == EINTR)
+			;
+	}
+}
+
+
+// Run graph nodes as they get ready.
+void qtractorAudioRender::process_graph ( unsigned short iWorker )
+{
+	Graph::Node *pNode = m_pGraph->pop(iWorker);
+	while (pNode) {
+		qtractorTrack *pTrack = pNode->track;
+		switch (pNode->type) {
+		case Graph::Render:
+			if (m_bExport) {
+				pTrack->process_export_render(
+					m_pAudioCursor->clip(pNode->index),
+					m_iFrameStart, m_iFrameEnd);
+			} else {
+				pTrack->process_render(
+					m_pAudioCursor->clip(pNode->index),
+					m_iFrameStart, m_iFrameEnd);
+			}
+			break;
+		case Graph::Commit:
+			pTrack->process_commit(m_iFrameEnd - m_iFrameStart);
+			break;
+		case Graph::Process:
+			if (m_bExport) {
+				pTrack->process_export_render(
+					m_pAudioCursor->clip(pNode->index),
+					m_iFrameStart, m_iFrameEnd);
+			} else {
+				pTrack->process_render(
+					m_pAudioCursor->clip(pNode->index),
+					m_iFrameStart, m_iFrameEnd);
+			}
+			pTrack->process_commit(m_iFrameEnd - m_iFrameStart);
+			break;
+		}
+		m_pGraph->done(pNode);
+		pNode = m_pGraph->pop(iWorker);
+	}
+}
+
+
+// Worker thread executive.
+void *qtractorAudioRender::worker_thread ( void *pvArg )
+{
+	qtractorAudioRender *pAudioRender
+		= static_cast<qtractorAudioRender *> (pvArg);
+
+	pAudioRender->worker_run();
+
+	return nullptr;
+}
+
+void qtractorAudioRender::worker_run (void)
+{
+	// We're in a audio/real-time thread too...
+	qtractorAudioEngine::setProcessing(true);
+	qtractorAudioEngine::setFlushDenormals();
+
+	const unsigned short iWorker = ATOMIC_INC(&m_workers);
+
+	for (;;) {
+		while (::sem_wait(&m_semRun) != 0 && errno == EINTR)
+			;
+		if (!m_bRunState)
+			break;
+		process_graph(iWorker);
+		if (ATOMIC_DEC(&m_pending) == 0)
+			::sem_post(&m_semDone);
+	}
+
+	qtractorAudioEngine::setProcessing(false);
+}
+
+
+// Default number of worker threads (0=serial).
+void qtractorAudioRender::setDefaultRenderThreads ( unsigned short iRenderThreads )
+{
+	g_iDefaultRenderThreads = iRenderThreads;
+}
+
+unsigned short qtractorAudioRender::defaultRenderThreads (void)
+{
+	return g_iDefaultRenderThreads;
+}
+
+
+// end of qtractorAudioRender.cpp
@@ -0,0 +1,155 @@
+// qtractorAudioRender.h
+//
+/****************************************************************************
+   Copyright (C) 2005-2022, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qtractorAudioRender_h
+#define __qtractorAudioRender_h
+
+#include "qtractorAtomic.h"
+
+#include <jack/jack.h>
+
+#include <QAtomicPointer>
+
+#include <pthread.h>
+#include <semaphore.h>
+
+
+// Forward declarations.
+class qtractorAudioEngine;
+class qtractorSessionCursor;
+class qtractorSession;
+class qtractorTrack;
+class qtractorBus;
+
+
+//----------------------------------------------------------------------
+// class qtractorAudioRender -- Audio track render worker pool.
+//
+
+class qtractorAudioRender
+{
+public:
+
+	// Constructor.
+	qtractorAudioRender(qtractorAudioEngine *pAudioEngine,
+		unsigned short iThreads);
+
+	// Destructor.
+	~qtractorAudioRender();
+
+	// Worker threads (re)start/stop.
+	bool open();
+	void close();
+
+	// Number of worker threads accessor.
+	unsigned short threads() const;
+
+	// Processing graph topology change notifier (any thread).
+	void resetGraph();
+
+	// Processing graph (re)build (non-RT, GUI thread).
+	bool isGraphDirty() const;
+	void updateGraph();
+
+	// Process cycle executive (RT).
+	void process(qtractorSessionCursor *pAudioCursor,
+		unsigned long iFrameStart, unsigned long iFrameEnd);
+
+	// Freewheeling process executive (parallel export).
+	void process_export(qtractorSessionCursor *pAudioCursor,
+		unsigned long iFrameStart, unsigned long iFrameEnd);
+
+	// Default number of worker threads (0=serial).
+	static void setDefaultRenderThreads(unsigned short iRenderThreads);
+	static unsigned short defaultRenderThreads();
+
+protected:
+
+	// Processing graph forward decl.
+	class Graph;
+
+	// Whether the current graph still matches the session (RT).
+	bool checkGraph(qtractorSession *pSession) const;
+
+	// Worker thread executive.
+	static void *worker_thread(void *pvArg);
+
+	void worker_run();
+
+	// Common process cycle executive (RT).
+	void process_cycle(qtractorSessionCursor *pAudioCursor,
+		unsigned long iFrameStart, unsigned long iFrameEnd, bool bExport);
+
+	// Run graph nodes as they get ready.
+	void process_graph(unsigned short iWorker);
+
+private:
+
+	// Instance variables.
+	qtractorAudioEngine *m_pAudioEngine;
+
+	unsigned short m_iThreads;
+	pthread_t     *m_pThreads;
+	unsigned short m_iRunning;
+
+	// Whether the workers are logically running.
+	volatile bool m_bRunState;
+
+	// Processing graph: current (RT owned), next and stale ones.
+	Graph *m_pGraph;
+
+	QAtomicPointer<Graph> m_nextGraph;
+	QAtomicPointer<Graph> m_oldGraph;
+
+	// Topology serial number (last requested vs. last built).
+	qtractorAtomic m_serial;
+	int            m_iGraphSerial;
+
+	// Current process cycle frame range.
+	qtractorSessionCursor *m_pAudioCursor;
+
+	unsigned long m_iFrameStart;
+	unsigned long m_iFrameEnd;
+
+	// Whether current cycle is freewheeling (export).
+	bool m_bExport;
+
+	// Pending participants.
+	qtractorAtomic m_pending;
+
+	// Worker wake-up and completion semaphores.
+	sem_t m_semRun;
+	sem_t m_semDone;
+
+	// Worker index allocator and per-worker parking semaphores
+	// (index 0 is for the process thread itself).
+	qtractorAtomic m_workers;
+	sem_t *m_pSemWaits;
+
+	// Default number of worker threads.
+	static unsigned short g_iDefaultRenderThreads;
+};
+
+
+#endif  // __qtractorAudioRender_h
+
+
+// end of qtractorAudioRender.h
@@ -22,11 +22,21 @@
 #include "qtractorAbout.h"
 #include "qtractorAudioSndFile.h"
 
+#if defined(__linux__)
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 
 //----------------------------------------------------------------------
 // class qtractorAudioSndFile -- Buffered audio file implementation.
 //
 
+// Write mode file extents pre-allocation step (in MB; 0=off).
+unsigned int qtractorAudioSndFile::g_iDefaultPreallocSize = 0;
+
+
 // Constructor.
 qtractorAudioSndFile::qtractorAudioSndFile ( unsigned short iChannels,
 	unsigned int iSampleRate, unsigned int iBufferSize, int iFormat )
@@ -43,6 +53,10 @@ qtractorAudioSndFile::qtractorAudioSndFile ( unsigned short iChannels,
 	m_pBuffer     = nullptr;
 	m_iBufferSize = 1024;
 
+	m_iPreallocFd   = -1;
+	m_iPreallocSize = 0;
+	m_iWriteSize    = 0;
+
 	// Adjust size the next nearest power-of-two.
 	while (m_iBufferSize < iBufferSize)
 		m_iBufferSize <<= 1;
@@ -87,10 +101,31 @@ bool qtractorAudioSndFile::open ( const QString& sFilename, int iMode )
 
 	// Now open it.
 	QByteArray aFilename = sFilename.toUtf8();
+#if defined(__linux__)
+	// Recording files may have their extents reserved ahead,
+	// hence we'll need to get hold of the file descriptor...
+	if ((sfmode & SFM_WRITE) && g_iDefaultPreallocSize > 0) {
+		m_iPreallocFd = ::open(aFilename.constData(),
+			O_RDWR | O_CREAT | O_TRUNC, 0644);
+		if (m_iPreallocFd >= 0) {
+			m_pSndFile = ::sf_open_fd(m_iPreallocFd, sfmode, &m_sfinfo, SF_FALSE);
+			if (m_pSndFile == nullptr) {
+				::close(m_iPreallocFd);
+				m_iPreallocFd = -1;
+			}
+		}
+	}
+	if (m_pSndFile == nullptr)
+#endif
 	m_pSndFile = ::sf_open(aFilename.constData(), sfmode, &m_sfinfo);
 	if (m_pSndFile == nullptr)
 		return false;
 
+	m_iPreallocSize = 0;
+	m_iWriteSize = 0;
+
+	preallocCheck(0);
+
 	// Set open mode (deterministically).
 	m_iMode = iMode;
 
@@ -134,6 +169,7 @@ int qtractorAudioSndFile::write ( float **ppFrames, unsigned int iFrames )
 		for (i = 0; i < (unsigned short) m_sfinfo.channels; ++i)
 			m_pBuffer[k++] = ppFrames[i][n];
 	}
+	preallocCheck(iFrames);
 	return ::sf_writef_float(m_pSndFile, m_pBuffer, iFrames);
 }
 
@@ -165,6 +201,21 @@ void qtractorAudioSndFile::close (void)
 		delete [] m_pBuffer;
 		m_pBuffer = nullptr;
 	}
+
+#if defined(__linux__)
+	// Give back whatever was reserved beyond the actual end...
+	if (m_iPreallocFd >= 0) {
+		struct stat st;
+		if (::fstat(m_iPreallocFd, &st) == 0
+			&& ::ftruncate(m_iPreallocFd, st.st_size) != 0) {
+		#ifdef CONFIG_DEBUG
+			qDebug("qtractorAudioSndFile::close(): ftruncate() failed.");
+		#endif
+		}
+		::close(m_iPreallocFd);
+		m_iPreallocFd = -1;
+	}
+#endif
 }
 
 
@@ -213,6 +264,47 @@ void qtractorAudioSndFile::allocBufferCheck ( unsigned int iBufferSize )
 }
 
 
+// Write mode file extents pre-allocation check: keep at least
+// half a step reserved ahead of the (estimated) current size.
+void qtractorAudioSndFile::preallocCheck ( unsigned int iFrames )
+{
+#if defined(__linux__)
+	if (m_iPreallocFd < 0)
+		return;
+
+	m_iWriteSize += (unsigned long long) iFrames
+		* m_sfinfo.channels * sizeof(float);
+
+	const unsigned long long iStepSize
+		= (unsigned long long) g_iDefaultPreallocSize << 20;
+	if (m_iWriteSize + (iStepSize >> 1) < m_iPreallocSize)
+		return;
+
+	if (::fallocate(m_iPreallocFd, FALLOC_FL_KEEP_SIZE,
+			m_iPreallocSize, iStepSize) == 0) {
+		m_iPreallocSize += iStepSize;
+	} else {
+		// Not supported by the filesystem, just give up...
+		m_iPreallocSize = (unsigned long long) (-1);
+	}
+#else
+	(void) iFrames;
+#endif
+}
+
+
+// Write mode file extents pre-allocation step (in MB; 0=off).
+void qtractorAudioSndFile::setDefaultPreallocSize ( unsigned int iPreallocSize )
+{
+	g_iDefaultPreallocSize = iPreallocSize;
+}
+
+unsigned int qtractorAudioSndFile::defaultPreallocSize (void)
+{
+	return g_iDefaultPreallocSize;
+}
+
+
 // Check whether given file type/format is valid. (static)
 bool qtractorAudioSndFile::isValidFormat ( int iType, int iFormat )
 {
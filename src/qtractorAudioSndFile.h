@@ -65,11 +65,18 @@ public:
 	// Translate format index into libsndfile specific. (static)
 	static int format(int iType, int iFormat);
 
+	// Write mode file extents pre-allocation step (in MB; 0=off).
+	static void setDefaultPreallocSize(unsigned int iPreallocSize);
+	static unsigned int defaultPreallocSize();
+
 protected:
 
 	// De/interleaving buffer (re)allocation check.
 	void allocBufferCheck(unsigned int iBufferSize);
 
+	// Write mode file extents pre-allocation check.
+	void preallocCheck(unsigned int iFrames);
+
 private:
 
 	int           m_iMode;          // open mode (Read|Write).
@@ -79,6 +86,13 @@ private:
 	// De/interleaving buffer stuff.
 	float        *m_pBuffer;
 	unsigned int  m_iBufferSize;
+
+	// Write mode file extents pre-allocation stuff.
+	int           m_iPreallocFd;
+	unsigned long long m_iPreallocSize;
+	unsigned long long m_iWriteSize;
+
+	static unsigned int g_iDefaultPreallocSize;
 };
 
 
@@ -0,0 +1,600 @@
+// qtractorAudioStretch.cpp
+//
+/****************************************************************************
+   Copyright (C) 2005-2022, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qtractorAbout.h"
+#include "qtractorAudioStretch.h"
+
+#include "qtractorAudioBuffer.h"
+#include "qtractorTimeStretcher.h"
+
+#include "qtractorSession.h"
+#include "qtractorAudioEngine.h"
+
+#include <QThread>
+#include <QWaitCondition>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QFile>
+#include <QDir>
+
+
+// Rendered file name suffix.
+static const char *c_sStretchFileExt = ".stretch.wav";
+static const char *c_sStretchPartExt = ".stretch.part.wav";
+
+// Render block size (in frames).
+static const unsigned int c_iStretchBufferSize = 4096;
+
+
+//----------------------------------------------------------------------
+// class qtractorAudioStretchThread -- Background render thread.
+//
+
+class qtractorAudioStretchThread : public QThread
+{
+public:
+
+	// Constructor.
+	qtractorAudioStretchThread(qtractorAudioStretchCache *pCache)
+		: QThread(), m_pCache(pCache), m_bRunState(false) {}
+
+	// Run state accessor.
+	void setRunState(bool bRunState)
+		{ m_bRunState = bRunState; }
+
+	// Wake from executive wait condition.
+	void sync()
+	{
+		if (m_mutex.tryLock()) {
+			m_cond.wakeAll();
+			m_mutex.unlock();
+		}
+	}
+
+protected:
+
+	// The main thread executive.
+	void run();
+
+	// Actual render procedure.
+	bool render(qtractorAudioStretchItem *pItem);
+
+private:
+
+	// Instance variables.
+	qtractorAudioStretchCache *m_pCache;
+
+	volatile bool m_bRunState;
+
+	QMutex m_mutex;
+	QWaitCondition m_cond;
+};
+
+
+// The main thread executive.
+void qtractorAudioStretchThread::run (void)
+{
+	qtractorAudioEngine::setFlushDenormals();
+
+	m_mutex.lock();
+	m_bRunState = true;
+	while (m_bRunState) {
+		// Wait for sync, or just poll...
+		m_cond.wait(&m_mutex, 1000);
+		qtractorAudioStretchItem *pItem = m_pCache->dequeue();
+		while (pItem && m_bRunState) {
+			m_pCache->rendered(pItem, render(pItem));
+			pItem = m_pCache->dequeue();
+		}
+	}
+	m_mutex.unlock();
+}
+
+
+// Actual render procedure: source file decode (resample),
+// time-stretch/pitch-shift (if any) and write to a float file.
+bool qtractorAudioStretchThread::render ( qtractorAudioStretchItem *pItem )
+{
+	const QString& sFilename = pItem->filename();
+	const unsigned int iSampleRate = pItem->sampleRate();
+
+	qtractorAudioFile *pInFile
+		= qtractorAudioFileFactory::createAudioFile(sFilename);
+	if (pInFile == nullptr)
+		return false;
+
+	if (!pInFile->open(sFilename)) {
+		delete pInFile;
+		return false;
+	}
+
+	const unsigned short iChannels = pInFile->channels();
+	if (iChannels < 1 || pInFile->sampleRate() < 1) {
+		pInFile->close();
+		delete pInFile;
+		return false;
+	}
+
+	// Always 32bit float (format 3), ready to memory-map...
+	QString sPartFile = pItem->renderFile();
+	sPartFile.replace(c_sStretchFileExt, c_sStretchPartExt);
+
+	qtractorAudioFile *pOutFile
+		= qtractorAudioFileFactory::createAudioFile(sPartFile,
+			iChannels, iSampleRate, c_iStretchBufferSize, 3);
+	if (pOutFile == nullptr) {
+		pInFile->close();
+		delete pInFile;
+		return false;
+	}
+
+	if (!pOutFile->open(sPartFile, qtractorAudioFile::Write)) {
+		delete pOutFile;
+		pInFile->close();
+		delete pInFile;
+		return false;
+	}
+
+	unsigned int iBufferSize = c_iStretchBufferSize;
+
+#ifdef CONFIG_LIBSAMPLERATE
+	// Sample rate converter stuff, whether needed...
+	const bool bResample = (iSampleRate != pInFile->sampleRate());
+	const float fResampleRatio
+		= float(iSampleRate) / float(pInFile->sampleRate());
+	SRC_STATE **ppSrcState = nullptr;
+	float **ppSrcFrames = nullptr;
+	if (bResample) {
+		while (iBufferSize < fResampleRatio * c_iStretchBufferSize + 16)
+			iBufferSize <<= 1;
+		ppSrcState  = new SRC_STATE * [iChannels];
+		ppSrcFrames = new float * [iChannels];
+		int err = 0;
+		for (unsigned short i = 0; i < iChannels; ++i) {
+			ppSrcState[i] = src_new(
+				qtractorAudioBuffer::defaultResampleType(), 1, &err);
+			ppSrcFrames[i] = new float [iBufferSize];
+		}
+	}
+#endif
+
+	float **ppInFrames  = new float * [iChannels];
+	float **ppOutFrames = new float * [iChannels];
+	for (unsigned short i = 0; i < iChannels; ++i) {
+		ppInFrames[i]  = new float [c_iStretchBufferSize];
+		ppOutFrames[i] = new float [iBufferSize];
+	}
+
+	float **ppFrames = ppInFrames;
+
+	// Plain sample-rate conversion needs no time-stretching...
+	qtractorTimeStretcher *pTimeStretcher = nullptr;
+	if (pItem->timeStretch() != 1.0f || pItem->pitchShift() != 1.0f) {
+		pTimeStretcher = new qtractorTimeStretcher(iChannels, iSampleRate,
+			pItem->timeStretch(), pItem->pitchShift(),
+			pItem->flags(), iBufferSize);
+	}
+
+	bool bEndOfInput = false;
+	bool bResult = true;
+
+	while (m_bRunState && bResult) {
+		int nread = 0;
+		if (!bEndOfInput) {
+			nread = pInFile->read(ppInFrames, c_iStretchBufferSize);
+			bEndOfInput = (nread < 1);
+			if (nread < 0)
+				nread = 0;
+		}
+	#ifdef CONFIG_LIBSAMPLERATE
+		if (bResample) {
+			int ngen = 0;
+			SRC_DATA src_data;
+			for (unsigned short i = 0; i < iChannels; ++i) {
+				src_data.data_in       = ppInFrames[i];
+				src_data.data_out      = ppSrcFrames[i];
+				src_data.input_frames  = nread;
+				src_data.output_frames = iBufferSize;
+				src_data.end_of_input  = bEndOfInput;
+				src_data.src_ratio     = fResampleRatio;
+				src_data.input_frames_used = 0;
+				src_data.output_frames_gen = 0;
+				if (src_process(ppSrcState[i], &src_data) == 0)
+					ngen = src_data.output_frames_gen;
+			}
+			ppFrames = ppSrcFrames;
+			nread = ngen;
+		}
+	#endif
+		if (pTimeStretcher == nullptr) {
+			if (nread > 0)
+				bResult = (pOutFile->write(ppFrames, nread) > 0);
+			if (bEndOfInput && nread < 1)
+				break;
+			continue;
+		}
+		if (nread > 0)
+			pTimeStretcher->process(ppFrames, nread);
+		else
+		if (bEndOfInput)
+			pTimeStretcher->flush();
+		unsigned int nahead = pTimeStretcher->available();
+		while (nahead > 0 && bResult) {
+			if (nahead > iBufferSize)
+				nahead = iBufferSize;
+			nahead = pTimeStretcher->retrieve(ppOutFrames, nahead);
+			if (nahead > 0)
+				bResult = (pOutFile->write(ppOutFrames, nahead) > 0);
+			nahead = pTimeStretcher->available();
+		}
+		// Done with it?
+		if (bEndOfInput && nread < 1)
+			break;
+	}
+
+	// Interrupted?
+	if (!m_bRunState)
+		bResult = false;
+
+	if (pTimeStretcher)
+		delete pTimeStretcher;
+
+	for (unsigned short i = 0; i < iChannels; ++i) {
+		delete [] ppOutFrames[i];
+		delete [] ppInFrames[i];
+	}
+	delete [] ppOutFrames;
+	delete [] ppInFrames;
+
+#ifdef CONFIG_LIBSAMPLERATE
+	if (bResample) {
+		for (unsigned short i = 0; i < iChannels; ++i) {
+			delete [] ppSrcFrames[i];
+			src_delete(ppSrcState[i]);
+		}
+		delete [] ppSrcFrames;
+		delete [] ppSrcState;
+	}
+#endif
+
+	pOutFile->close();
+	delete pOutFile;
+
+	pInFile->close();
+	delete pInFile;
+
+	// Only complete files get to the real thing...
+	const QString& sRenderFile = pItem->renderFile();
+	QFile::remove(sRenderFile);
+	if (bResult)
+		bResult = QFile::rename(sPartFile, sRenderFile);
+	if (!bResult)
+		QFile::remove(sPartFile);
+
+#ifdef CONFIG_DEBUG
+	qDebug("qtractorAudioStretchThread::render(\"%s\") result=%d",
+		sRenderFile.toUtf8().constData(), int(bResult));
+#endif
+
+	return bResult;
+}
+
+
+//----------------------------------------------------------------------
+// class qtractorAudioStretchItem -- Pre-rendered time-stretch item.
+//
+
+// Constructor.
+qtractorAudioStretchItem::qtractorAudioStretchItem (
+	const QString& sKey, const QString& sFilename,
+	const QString& sRenderFile, unsigned int iSampleRate,
+	float fTimeStretch, float fPitchShift, unsigned int iFlags )
+	: m_sKey(sKey), m_sFilename(sFilename), m_sRenderFile(sRenderFile),
+		m_iSampleRate(iSampleRate), m_fTimeStretch(fTimeStretch),
+		m_fPitchShift(fPitchShift), m_iFlags(iFlags),
+		m_iReady(0), m_iRefCount(0)
+{
+}
+
+
+//----------------------------------------------------------------------
+// class qtractorAudioStretchCache -- Time-stretch/pitch-shift and
+// sample-rate conversion render cache.
+//
+
+// Global enablement.
+bool qtractorAudioStretchCache::g_bDefaultEnabled = false;
+bool qtractorAudioStretchCache::g_bDefaultResampleEnabled = false;
+
+
+// Constructor.
+qtractorAudioStretchCache::qtractorAudioStretchCache ( QObject *pParent )
+	: QObject(pParent), m_pRenderItem(nullptr), m_pRenderThread(nullptr)
+{
+}
+
+
+// Destructor.
+qtractorAudioStretchCache::~qtractorAudioStretchCache (void)
+{
+	if (m_pRenderThread) {
+		if (m_pRenderThread->isRunning()) do {
+			m_pRenderThread->setRunState(false);
+		//	m_pRenderThread->terminate();
+			m_pRenderThread->sync();
+		} while (!m_pRenderThread->wait(100));
+		delete m_pRenderThread;
+		m_pRenderThread = nullptr;
+	}
+
+	m_pending.clear();
+
+	qDeleteAll(m_items);
+	m_items.clear();
+}
+
+
+// Get a shared item, scheduling its background
+// render when not complete yet (nullptr if disabled).
+qtractorAudioStretchItem *qtractorAudioStretchCache::acquire (
+	const QString& sFilename, unsigned int iSampleRate,
+	float fTimeStretch, float fPitchShift, unsigned int iFlags )
+{
+	if (fTimeStretch != 1.0f || fPitchShift != 1.0f) {
+		if (!g_bDefaultEnabled)
+			return nullptr;
+	}
+	else if (!g_bDefaultResampleEnabled)
+		return nullptr;
+
+	QMutexLocker locker(&m_mutex);
+
+	// Full (round-trip) precision, lest distinct ratios collide...
+	const QString& sKey = QString("%1_%2_%3_%4_%5_%6")
+		.arg(sFilename).arg(iSampleRate)
+		.arg(qtractorAudioBuffer::defaultResampleType())
+		.arg(double(fTimeStretch), 0, 'g', 9)
+		.arg(double(fPitchShift), 0, 'g', 9).arg(iFlags);
+
+	// Any other renders of the same source
+	// are now surely stale (if not in use)...
+	removeStale(sFilename, sKey);
+
+	qtractorAudioStretchItem *pItem = m_items.value(sKey, nullptr);
+	if (pItem) {
+		pItem->addRef();
+		// Dropped from the queue or invalidated meanwhile?
+		if (!pItem->isReady() && pItem != m_pRenderItem
+			&& !m_pending.contains(pItem))
+			schedule(pItem);
+		return pItem;
+	}
+
+	// Superseded but still being rendered? just take it back...
+	if (m_pRenderItem && m_pRenderItem->key() == sKey) {
+		pItem = m_pRenderItem;
+		pItem->addRef();
+		m_items.insert(sKey, pItem);
+		return pItem;
+	}
+
+	// Set (unique) rendered filename, alongside peak files...
+	QDir dir;
+	qtractorSession *pSession = qtractorSession::getInstance();
+	if (pSession)
+		dir.setPath(pSession->sessionDir());
+
+	const QFileInfo fileInfo(sFilename);
+	const QFileInfo renderInfo(dir, fileInfo.fileName() + '_'
+		+ QString::number(qHash(sKey), 16) + c_sStretchFileExt);
+
+	pItem = new qtractorAudioStretchItem(sKey, sFilename,
+		renderInfo.absoluteFilePath(), iSampleRate,
+		fTimeStretch, fPitchShift, iFlags);
+	pItem->addRef();
+
+	m_items.insert(sKey, pItem);
+
+	// Maybe it was rendered before (and still up-to-date)...
+	if (renderInfo.exists()
+		&& renderInfo.lastModified() >= fileInfo.lastModified()) {
+		pItem->setReady(true);
+		return pItem;
+	}
+
+	// Schedule it for background render...
+	schedule(pItem);
+
+	return pItem;
+}
+
+
+// Discard a rendered item that can't be opened anymore,
+// getting it scheduled for background render again.
+void qtractorAudioStretchCache::invalidate ( qtractorAudioStretchItem *pItem )
+{
+	QMutexLocker locker(&m_mutex);
+
+	pItem->setReady(false);
+
+	// Already on its way?
+	if (pItem == m_pRenderItem || m_pending.contains(pItem))
+		return;
+
+	// Superseded meanwhile?
+	if (m_items.value(pItem->key(), nullptr) != pItem)
+		return;
+
+	QFile::remove(pItem->renderFile());
+
+	schedule(pItem);
+}
+
+
+// Drop an item reference.
+void qtractorAudioStretchCache::release ( qtractorAudioStretchItem *pItem )
+{
+	QMutexLocker locker(&m_mutex);
+
+	// Unreferenced items are kept around (rendered files too)
+	// until superseded by different parameters or cleaned up...
+	if (pItem->removeRef() && !pItem->isReady())
+		m_pending.removeAll(pItem);
+}
+
+
+// Render thread executive (non-RT).
+qtractorAudioStretchItem *qtractorAudioStretchCache::dequeue (void)
+{
+	QMutexLocker locker(&m_mutex);
+
+	m_pRenderItem = nullptr;
+	if (!m_pending.isEmpty())
+		m_pRenderItem = m_pending.takeFirst();
+
+	return m_pRenderItem;
+}
+
+
+void qtractorAudioStretchCache::rendered (
+	qtractorAudioStretchItem *pItem, bool bReady )
+{
+	QMutexLocker locker(&m_mutex);
+
+	m_pRenderItem = nullptr;
+
+	// Superseded while rendering? (mind it might be
+	// a brand new item by the very same key already)...
+	if (m_items.value(pItem->key(), nullptr) != pItem) {
+		QFile::remove(pItem->renderFile());
+		delete pItem;
+		return;
+	}
+
+	pItem->setReady(bReady);
+
+	if (bReady)
+		emit renderEvent();
+}
+
+
+// Forget all unreferenced items, their rendered files and pending renders.
+void qtractorAudioStretchCache::cleanup (void)
+{
+	QMutexLocker locker(&m_mutex);
+
+	m_pending.clear();
+
+	QList<qtractorAudioStretchItem *> items;
+
+	QHash<QString, qtractorAudioStretchItem *>::ConstIterator iter
+		= m_items.constBegin();
+	const QHash<QString, qtractorAudioStretchItem *>::ConstIterator& iter_end
+		= m_items.constEnd();
+	for ( ; iter != iter_end; ++iter) {
+		qtractorAudioStretchItem *pItem = iter.value();
+		if (pItem->refCount() == 0)
+			items.append(pItem);
+	}
+
+	QListIterator<qtractorAudioStretchItem *> item_iter(items);
+	while (item_iter.hasNext())
+		removeItem(item_iter.next());
+}
+
+
+// Schedule an item for background render (mutex held).
+void qtractorAudioStretchCache::schedule ( qtractorAudioStretchItem *pItem )
+{
+	m_pending.append(pItem);
+
+	if (m_pRenderThread == nullptr) {
+		m_pRenderThread = new qtractorAudioStretchThread(this);
+		m_pRenderThread->start(QThread::LowPriority);
+	}
+
+	m_pRenderThread->sync();
+}
+
+
+// Remove stale renders of the same source file.
+void qtractorAudioStretchCache::removeStale (
+	const QString& sFilename, const QString& sKey )
+{
+	QList<qtractorAudioStretchItem *> items;
+
+	QHash<QString, qtractorAudioStretchItem *>::ConstIterator iter
+		= m_items.constBegin();
+	const QHash<QString, qtractorAudioStretchItem *>::ConstIterator& iter_end
+		= m_items.constEnd();
+	for ( ; iter != iter_end; ++iter) {
+		qtractorAudioStretchItem *pItem = iter.value();
+		if (pItem->refCount() == 0
+			&& pItem->filename() == sFilename && pItem->key() != sKey)
+			items.append(pItem);
+	}
+
+	QListIterator<qtractorAudioStretchItem *> item_iter(items);
+	while (item_iter.hasNext())
+		removeItem(item_iter.next());
+}
+
+
+// Remove an item and its rendered file.
+void qtractorAudioStretchCache::removeItem ( qtractorAudioStretchItem *pItem )
+{
+	m_items.remove(pItem->key());
+	m_pending.removeAll(pItem);
+
+	// Still being rendered: leave it to the render thread...
+	if (pItem == m_pRenderItem)
+		return;
+
+	QFile::remove(pItem->renderFile());
+	delete pItem;
+}
+
+
+// Global enablement (default off).
+void qtractorAudioStretchCache::setDefaultEnabled ( bool bEnabled )
+{
+	g_bDefaultEnabled = bEnabled;
+}
+
+bool qtractorAudioStretchCache::isDefaultEnabled (void)
+{
+	return g_bDefaultEnabled;
+}
+
+
+// Global sample-rate conversion enablement (default off).
+void qtractorAudioStretchCache::setDefaultResampleEnabled ( bool bEnabled )
+{
+	g_bDefaultResampleEnabled = bEnabled;
+}
+
+bool qtractorAudioStretchCache::isDefaultResampleEnabled (void)
+{
+	return g_bDefaultResampleEnabled;
+}
+
+
+// end of qtractorAudioStretch.cpp
@@ -0,0 +1,188 @@
+// qtractorAudioStretch.h
+//
+/****************************************************************************
+   Copyright (C) 2005-2022, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qtractorAudioStretch_h
+#define __qtractorAudioStretch_h
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QAtomicInt>
+
+
+// Forward declarations.
+class qtractorAudioStretchThread;
+
+
+//----------------------------------------------------------------------
+// class qtractorAudioStretchItem -- Pre-rendered time-stretch item.
+//
+
+class qtractorAudioStretchItem
+{
+public:
+
+	// Constructor.
+	qtractorAudioStretchItem(const QString& sKey, const QString& sFilename,
+		const QString& sRenderFile, unsigned int iSampleRate,
+		float fTimeStretch, float fPitchShift, unsigned int iFlags);
+
+	// Key accessor.
+	const QString& key() const
+		{ return m_sKey; }
+
+	// Source file and render parameters.
+	const QString& filename() const
+		{ return m_sFilename; }
+	unsigned int sampleRate() const
+		{ return m_iSampleRate; }
+	float timeStretch() const
+		{ return m_fTimeStretch; }
+	float pitchShift() const
+		{ return m_fPitchShift; }
+	unsigned int flags() const
+		{ return m_iFlags; }
+
+	// Rendered file path.
+	const QString& renderFile() const
+		{ return m_sRenderFile; }
+
+	// Rendered (complete) state accessors (thread-safe).
+	void setReady(bool bReady)
+		{ m_iReady.storeRelease(bReady ? 1 : 0); }
+	bool isReady() const
+		{ return (m_iReady.loadAcquire() != 0); }
+
+	// Reference count.
+	void addRef()
+		{ ++m_iRefCount; }
+	bool removeRef()
+		{ return (--m_iRefCount == 0); }
+	unsigned int refCount() const
+		{ return m_iRefCount; }
+
+private:
+
+	// Instance variables.
+	QString       m_sKey;
+	QString       m_sFilename;
+	QString       m_sRenderFile;
+
+	unsigned int  m_iSampleRate;
+	float         m_fTimeStretch;
+	float         m_fPitchShift;
+	unsigned int  m_iFlags;
+
+	QAtomicInt    m_iReady;
+
+	unsigned int  m_iRefCount;
+};
+
+
+//----------------------------------------------------------------------
+// class qtractorAudioStretchCache -- Time-stretch/pitch-shift and
+// sample-rate conversion render cache.
+//
+
+class qtractorAudioStretchCache : public QObject
+{
+	Q_OBJECT
+
+public:
+
+	// Constructor.
+	qtractorAudioStretchCache(QObject *pParent = nullptr);
+
+	// Destructor.
+	~qtractorAudioStretchCache();
+
+	// Get a shared item, scheduling its background
+	// render when not complete yet (nullptr if disabled).
+	qtractorAudioStretchItem *acquire(const QString& sFilename,
+		unsigned int iSampleRate, float fTimeStretch, float fPitchShift,
+		unsigned int iFlags);
+
+	// Drop an item reference.
+	void release(qtractorAudioStretchItem *pItem);
+
+	// Discard a rendered item that can't be opened anymore,
+	// getting it scheduled for background render again.
+	void invalidate(qtractorAudioStretchItem *pItem);
+
+	// Render thread executive (non-RT).
+	qtractorAudioStretchItem *dequeue();
+	void rendered(qtractorAudioStretchItem *pItem, bool bReady);
+
+	// Forget all unreferenced items, their rendered files and pending renders.
+	void cleanup();
+
+	// Global enablement (default off).
+	static void setDefaultEnabled(bool bEnabled);
+	static bool isDefaultEnabled();
+
+	// Global sample-rate conversion enablement (default off).
+	static void setDefaultResampleEnabled(bool bEnabled);
+	static bool isDefaultResampleEnabled();
+
+signals:
+
+	// Render complete signal.
+	void renderEvent();
+
+protected:
+
+	// Schedule an item for background render (mutex held).
+	void schedule(qtractorAudioStretchItem *pItem);
+
+	// Remove stale renders of the same source file.
+	void removeStale(const QString& sFilename, const QString& sKey);
+
+	// Remove an item and its rendered file.
+	void removeItem(qtractorAudioStretchItem *pItem);
+
+private:
+
+	// Cache mutex.
+	QMutex m_mutex;
+
+	// The cached items.
+	QHash<QString, qtractorAudioStretchItem *> m_items;
+
+	// The pending renders queue.
+	QList<qtractorAudioStretchItem *> m_pending;
+
+	// The one being rendered right now.
+	qtractorAudioStretchItem *m_pRenderItem;
+
+	// The (lazy) render thread.
+	qtractorAudioStretchThread *m_pRenderThread;
+
+	// Global enablement.
+	static bool g_bDefaultEnabled;
+	static bool g_bDefaultResampleEnabled;
+};
+
+
+#endif  // __qtractorAudioStretch_h
+
+
+// end of qtractorAudioStretch.h
@@ -0,0 +1,626 @@
+// qtractorBenchmark.cpp
+//
+/****************************************************************************
+   Copyright (C) 2005-2022, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qtractorAbout.h"
+#include "qtractorBenchmark.h"
+
+#ifdef CONFIG_BENCHMARK
+
+#include "qtractorSession.h"
+#include "qtractorAudioEngine.h"
+#include "qtractorAudioClip.h"
+#include "qtractorAudioFile.h"
+#include "qtractorTrack.h"
+#include "qtractorPlugin.h"
+#include "qtractorAtomic.h"
+
+#include "qtractorWsolaTimeStretcher.h"
+
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include <QTextStream>
+#include <QDir>
+
+#include <string.h>
+#include <time.h>
+#include <math.h>
+
+
+//----------------------------------------------------------------------
+// Heap allocations counter -- fed by the benchmark tool operator new.
+//
+// Process-wide, so that the render workers, disk-sync pool and MIDI
+// threads allocations are all counted within the measured window.
+//
+
+static qtractorAtomic g_bAllocCount;
+static qtractorAtomic g_iAllocCount;
+
+
+//----------------------------------------------------------------------
+// class qtractorBenchmarkGainPluginType -- Stress gain pseudo-plugin type.
+//
+
+class qtractorBenchmarkGainPluginType : public qtractorPluginType
+{
+public:
+
+	// Constructor.
+	qtractorBenchmarkGainPluginType(unsigned short iChannels)
+		: qtractorPluginType(nullptr, iChannels, qtractorPluginType::Any) {}
+
+	// Derived methods.
+	bool open()
+	{
+		const unsigned short iChannels = index();
+		if (iChannels < 1)
+			return false;
+
+		m_sName  = "Benchmark Gain";
+		m_sLabel = "BenchmarkGain";
+
+		m_iUniqueID = qHash(m_sLabel) ^ qHash(iChannels);
+
+		m_iAudioIns  = iChannels;
+		m_iAudioOuts = iChannels;
+
+		m_bRealtime = true;
+
+		return true;
+	}
+
+	void close() {}
+
+	// Compute the number of instances needed
+	// for the given input/output audio channels.
+	unsigned short instances(unsigned short iChannels, bool /*bMidi*/) const
+		{ return (iChannels > 0 && iChannels == audioOuts() ? 1 : 0); }
+};
+
+
+//----------------------------------------------------------------------
+// class qtractorBenchmarkGainPlugin -- Stress gain pseudo-plugin.
+//
+// A plain insert, so that the parallel renderer is not forced
+// into serial mode as with aux-sends.
+//
+
+class qtractorBenchmarkGainPlugin : public qtractorPlugin
+{
+public:
+
+	// Constructor.
+	qtractorBenchmarkGainPlugin(qtractorPluginList *pList,
+		qtractorPluginType *pType) : qtractorPlugin(pList, pType) {}
+
+	// Destructor.
+	~qtractorBenchmarkGainPlugin() { setChannels(0); }
+
+	// Channel/instance number accessors.
+	void setChannels(unsigned short iChannels)
+	{
+		qtractorPluginType *pType = type();
+		if (pType == nullptr)
+			return;
+
+		const unsigned short iInstances
+			= pType->instances(iChannels, list()->isMidi());
+		if (iInstances == instances() && iChannels == channels())
+			return;
+
+		const bool bActivated = isActivated();
+		setChannelsActivated(iChannels, false);
+
+		setInstances(iInstances);
+		if (iInstances < 1)
+			return;
+
+		setChannelsActivated(iChannels, bActivated);
+	}
+
+	// Do the actual (de)activation.
+	void activate() {}
+	void deactivate() {}
+
+	// The main plugin processing procedure.
+	void process(float **ppIBuffer, float **ppOBuffer, unsigned int nframes)
+	{
+		const unsigned short iChannels = channels();
+		for (unsigned short i = 0; i < iChannels; ++i) {
+			const float *pIn = ppIBuffer[i];
+			float *pOut = ppOBuffer[i];
+			for (unsigned int n = 0; n < nframes; ++n)
+				pOut[n] = 0.9f * pIn[n];
+		}
+	}
+};
+
+
+//----------------------------------------------------------------------
+// class qtractorBenchmark -- Offline render benchmark harness.
+//
+
+// Constructor.
+qtractorBenchmark::qtractorBenchmark (void) : m_pTempDir(nullptr)
+{
+	m_iSampleRate = 0;
+	m_iBufferSize = 0;
+
+	reset();
+}
+
+
+// Destructor.
+qtractorBenchmark::~qtractorBenchmark (void)
+{
+	if (m_pTempDir)
+		delete m_pTempDir;
+}
+
+
+// Reset all accumulated statistics.
+void qtractorBenchmark::reset (void)
+{
+	m_iStart = 0;
+
+	m_iCycles = 0;
+	m_iFrames = 0;
+	m_iOverruns = 0;
+	m_iAllocs = 0;
+	m_iAllocCycles = 0;
+	m_iAllocMax = 0;
+
+	m_iTimeSum = 0;
+	m_iTimeMin = 0;
+	m_iTimeMax = 0;
+
+	for (int i = 0; i < Buckets; ++i)
+		m_histogram[i] = 0;
+
+	m_iPeriod = 0;
+	m_iElapsed = 0;
+}
+
+
+// Monotonic clock (in nanoseconds).
+unsigned long long qtractorBenchmark::nsecs (void)
+{
+	struct timespec ts;
+	::clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+
+// Freewheel process cycle timing (RT).
+void qtractorBenchmark::start (void)
+{
+	setAllocCount(true);
+
+	m_iStart = nsecs();
+}
+
+
+void qtractorBenchmark::stop ( unsigned int nframes )
+{
+	const unsigned long long iTime = nsecs() - m_iStart;
+
+	setAllocCount(false);
+
+	if (m_iCycles == 0 || m_iTimeMin > iTime)
+		m_iTimeMin = iTime;
+	if (m_iTimeMax < iTime)
+		m_iTimeMax = iTime;
+
+	m_iTimeSum += iTime;
+	m_iFrames += nframes;
+	++m_iCycles;
+
+	if (m_iPeriod > 0 && iTime > m_iPeriod)
+		++m_iOverruns;
+
+	// Bucket i holds [2^i, 2^(i+1)) microseconds...
+	unsigned long long iUsecs = iTime / 1000;
+	int iBucket = 0;
+	while (iUsecs > 1 && iBucket < Buckets - 1) {
+		iUsecs >>= 1;
+		++iBucket;
+	}
+	++m_histogram[iBucket];
+
+	const unsigned long iAllocs = allocCount();
+	if (iAllocs > 0) {
+		m_iAllocs += iAllocs;
+		++m_iAllocCycles;
+		if (m_iAllocMax < iAllocs)
+			m_iAllocMax = iAllocs;
+	}
+}
+
+
+// Parse a "<tracks>x<clips>x<plugins>" specification.
+bool qtractorBenchmark::parseSpec ( const QString& sSpec, Spec& spec )
+{
+	const QRegularExpression rx("^(\\d+)x(\\d+)(?:x(\\d+))?$",
+		QRegularExpression::CaseInsensitiveOption);
+	const QRegularExpressionMatch& match = rx.match(sSpec.trimmed());
+	if (!match.hasMatch())
+		return false;
+
+	spec.tracks  = match.captured(1).toInt();
+	spec.clips   = match.captured(2).toInt();
+	spec.plugins = match.captured(3).toInt();
+
+	return (spec.tracks > 0 && spec.clips > 0 && spec.plugins >= 0);
+}
+
+
+// Stock synthetic stress sessions.
+QStringList qtractorBenchmark::presets (void)
+{
+	QStringList specs;
+
+	specs.append("8x16x2");		// Light.
+	specs.append("32x32x4");	// Typical mix.
+	specs.append("64x64x8");	// Heavy.
+
+	return specs;
+}
+
+
+// Populate current (open) session with a synthetic stress load:
+// each track gets its own generated stereo file, split in
+// back-to-back clips, plus a chain of insert gain plugins.
+bool qtractorBenchmark::generate ( qtractorSession *pSession, const Spec& spec )
+{
+	qtractorAudioEngine *pAudioEngine = pSession->audioEngine();
+	if (pAudioEngine == nullptr || !pAudioEngine->isActivated())
+		return false;
+
+	if (m_pTempDir)
+		delete m_pTempDir;
+
+	m_pTempDir = new QTemporaryDir(QDir::tempPath()
+		+ QDir::separator() + QTRACTOR_TITLE "-benchmark.");
+	if (!m_pTempDir->isValid())
+		return false;
+
+	const unsigned int iSampleRate = pSession->sampleRate();
+	const unsigned short iChannels = 2;
+	const unsigned long iClipLength = 2 * iSampleRate;
+	const unsigned long iFileLength = spec.clips * iClipLength;
+
+	const unsigned int iBufferSize = 4096;
+	float **ppFrames = new float * [iChannels];
+	for (unsigned short i = 0; i < iChannels; ++i)
+		ppFrames[i] = new float [iBufferSize];
+
+	bool bResult = true;
+
+	for (int iTrack = 0; bResult && iTrack < spec.tracks; ++iTrack) {
+		// Render a slightly detuned sine wave per track...
+		const QString& sFilename = QDir(m_pTempDir->path())
+			.absoluteFilePath(QString("stress%1.wav").arg(iTrack + 1));
+		qtractorAudioFile *pFile
+			= qtractorAudioFileFactory::createAudioFile(
+				sFilename, iChannels, iSampleRate);
+		if (pFile == nullptr
+			|| !pFile->open(sFilename, qtractorAudioFile::Write)) {
+			if (pFile)
+				delete pFile;
+			bResult = false;
+			break;
+		}
+		const float fOmega = 2.0f * float(M_PI)
+			* (220.0f + 10.0f * float(iTrack)) / float(iSampleRate);
+		unsigned long iFrame = 0;
+		while (iFrame < iFileLength) {
+			unsigned int nframes = iBufferSize;
+			if (nframes > iFileLength - iFrame)
+				nframes = iFileLength - iFrame;
+			for (unsigned int n = 0; n < nframes; ++n) {
+				const float fValue = 0.1f * ::sinf(fOmega * float(iFrame + n));
+				for (unsigned short i = 0; i < iChannels; ++i)
+					ppFrames[i][n] = fValue;
+			}
+			pFile->write(ppFrames, nframes);
+			iFrame += nframes;
+		}
+		pFile->close();
+		delete pFile;
+		// Create the track (linked and opened on the master buses)...
+		const QColor& color = qtractorTrack::trackColor(iTrack + 1);
+		qtractorTrack *pTrack = new qtractorTrack(pSession, qtractorTrack::Audio);
+		pTrack->setTrackName(QString("Stress %1").arg(iTrack + 1));
+		pTrack->setBackground(color);
+		pTrack->setForeground(color.darker());
+		pSession->addTrack(pTrack);
+		// And its clips...
+		for (int iClip = 0; iClip < spec.clips; ++iClip) {
+			qtractorAudioClip *pAudioClip = new qtractorAudioClip(pTrack);
+			pAudioClip->setFilename(sFilename);
+			pAudioClip->setClipStart(iClip * iClipLength);
+			pAudioClip->setClipOffset(iClip * iClipLength);
+			pAudioClip->setClipLength(iClipLength);
+			pTrack->addClip(pAudioClip);
+		}
+		// Now for the plugin chain...
+		qtractorPluginList *pPluginList = pTrack->pluginList();
+		for (int iPlugin = 0; iPlugin < spec.plugins; ++iPlugin) {
+			qtractorPluginType *pType
+				= new qtractorBenchmarkGainPluginType(pPluginList->channels());
+			if (!pType->open()) {
+				delete pType;
+				bResult = false;
+				break;
+			}
+			qtractorPlugin *pPlugin
+				= new qtractorBenchmarkGainPlugin(pPluginList, pType);
+			pPluginList->addPlugin(pPlugin);
+			pPlugin->setActivated(true);
+		}
+	}
+
+	for (unsigned short i = 0; i < iChannels; ++i)
+		delete [] ppFrames[i];
+	delete [] ppFrames;
+
+	pSession->updateSession();
+
+	return bResult;
+}
+
+
+// Offline (freewheel) render of the whole session.
+bool qtractorBenchmark::run ( qtractorSession *pSession )
+{
+	qtractorAudioEngine *pAudioEngine = pSession->audioEngine();
+	if (pAudioEngine == nullptr || !pAudioEngine->isActivated())
+		return false;
+
+	// Render all audio output buses, into a null sink...
+	QList<qtractorAudioBus *> buses;
+	for (qtractorBus *pBus = pAudioEngine->buses().first();
+			pBus; pBus = pBus->next()) {
+		if (pBus->busMode() & qtractorBus::Output)
+			buses.append(static_cast<qtractorAudioBus *> (pBus));
+	}
+
+	if (buses.isEmpty())
+		return false;
+
+	reset();
+
+	m_iSampleRate = pAudioEngine->sampleRate();
+	m_iBufferSize = pAudioEngine->bufferSize();
+	if (m_iSampleRate > 0) {
+		m_iPeriod = (unsigned long long) m_iBufferSize
+			* 1000000000ULL / m_iSampleRate;
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+
+	pAudioEngine->setBenchmark(this);
+	const bool bResult = pAudioEngine->fileExport(QString(), buses,
+		pSession->sessionStart(), pSession->sessionEnd());
+	pAudioEngine->setBenchmark(nullptr);
+
+	m_iElapsed = timer.nsecsElapsed();
+
+	return bResult;
+}
+
+
+// Plain text report.
+QString qtractorBenchmark::report (void) const
+{
+	QString sReport;
+	QTextStream ts(&sReport);
+
+	ts << QTRACTOR_TITLE " benchmark:\n";
+	ts << "  sample rate: " << m_iSampleRate << " Hz, buffer size: "
+		<< m_iBufferSize << " frames, period: "
+		<< double(m_iPeriod) / 1000.0 << " us\n";
+
+	if (m_iCycles < 1 || m_iSampleRate < 1) {
+		ts << "  no process cycles.\n";
+		return sReport;
+	}
+
+	const double fAudioSecs = double(m_iFrames) / double(m_iSampleRate);
+	const double fElapsedSecs = double(m_iElapsed) / 1e9;
+	const double fProcessSecs = double(m_iTimeSum) / 1e9;
+
+	ts << "  cycles: " << m_iCycles << ", frames: " << m_iFrames
+		<< " (" << fAudioSecs << " s)\n";
+	ts << "  elapsed: " << fElapsedSecs << " s, realtime factor: "
+		<< (fElapsedSecs > 0.0 ? fAudioSecs / fElapsedSecs : 0.0)
+		<< "x (process only: "
+		<< (fProcessSecs > 0.0 ? fAudioSecs / fProcessSecs : 0.0) << "x)\n";
+
+	// Percentile estimate, from the histogram upper bounds...
+	const unsigned long k = (m_iCycles * 99) / 100;
+	unsigned long iCount = 0;
+	int iBucket = 0;
+	for ( ; iBucket < Buckets - 1; ++iBucket) {
+		iCount += m_histogram[iBucket];
+		if (iCount > k)
+			break;
+	}
+
+	ts << "  cycle latency (us): min " << double(m_iTimeMin) / 1000.0
+		<< ", mean " << double(m_iTimeSum) / double(m_iCycles) / 1000.0
+		<< ", p99 < " << (2ULL << iBucket)
+		<< ", max " << double(m_iTimeMax) / 1000.0 << '\n';
+	ts << "  overruns (cycle > period): " << m_iOverruns
+		<< " (" << 100.0 * double(m_iOverruns) / double(m_iCycles) << "%)\n";
+	ts << "  heap allocations: " << m_iAllocs << " total, "
+		<< double(m_iAllocs) / double(m_iCycles) << " per cycle, "
+		<< m_iAllocMax << " max, in " << m_iAllocCycles << " cycles\n";
+
+	ts << "  cycle latency histogram:\n";
+	for (int i = 0; i < Buckets; ++i) {
+		if (m_histogram[i] < 1)
+			continue;
+		const unsigned long long iLower = (i > 0 ? 1ULL << i : 0);
+		ts << "    " << qSetFieldWidth(8) << iLower << qSetFieldWidth(0)
+			<< " - " << qSetFieldWidth(8) << (2ULL << i) << qSetFieldWidth(0)
+			<< " us: " << m_histogram[i] << " ("
+			<< 100.0 * double(m_histogram[i]) / double(m_iCycles) << "%)\n";
+	}
+
+	return sReport;
+}
+
+
+// DSP kernels microbenchmark (plain text report).
+QString qtractorBenchmark::kernels (void)
+{
+	QString sReport;
+	QTextStream ts(&sReport);
+
+	ts << QTRACTOR_TITLE " kernels:\n";
+
+	// Typical WSOLA overlap (8 ms at 48 kHz) and seek window...
+	const unsigned int iOverlapLength = 384;
+	const unsigned int iSeekLength = 1024;
+	const unsigned int iPasses = 64;
+
+	// Aligned buffers (reference one must be)...
+	const unsigned int iInputSize = iSeekLength + iOverlapLength;
+	float *pInputUnaligned = new float [iInputSize + 8];
+	float *pRefUnaligned = new float [iOverlapLength + 8];
+	float *pMidUnaligned = new float [iOverlapLength + 8];
+	float *pOut0Unaligned = new float [iOverlapLength + 8];
+	float *pOutUnaligned = new float [iOverlapLength + 8];
+	float *pInput = (float *) ((((unsigned long) pInputUnaligned) + 31) & -32);
+	float *pRef = (float *) ((((unsigned long) pRefUnaligned) + 31) & -32);
+	float *pMid = (float *) ((((unsigned long) pMidUnaligned) + 31) & -32);
+	float *pOut0 = (float *) ((((unsigned long) pOut0Unaligned) + 31) & -32);
+	float *pOut = (float *) ((((unsigned long) pOutUnaligned) + 31) & -32);
+
+	// Some deterministic pseudo-random noise...
+	unsigned int iSeed = 12345;
+	for (unsigned int i = 0; i < iInputSize; ++i) {
+		iSeed = iSeed * 1103515245 + 12345;
+		pInput[i] = float(int(iSeed >> 8) & 0xffff) / 32768.0f - 1.0f;
+	}
+	for (unsigned int j = 0; j < iOverlapLength; ++j) {
+		const float fSlope = float(j) * float(iOverlapLength - j);
+		pRef[j] = pInput[j + (iSeekLength >> 1)] * fSlope;
+		pMid[j] = pInput[iInputSize - j - 1];
+	}
+
+	const qtractorWsolaTimeStretcher::Kernel *pKernels
+		= qtractorWsolaTimeStretcher::kernels();
+
+	// Reference results (standard kernels)...
+	float *pfCorr0 = new float [iSeekLength];
+	for (unsigned int i = 0; i < iSeekLength; ++i)
+		pfCorr0[i] = (*pKernels->crossCorr)(pInput + i, pRef, iOverlapLength);
+	(*pKernels->overlap)(pOut0, pInput + 1, pMid, iOverlapLength);
+
+	double fCorrTime0 = 0.0;
+	double fOverlapTime0 = 0.0;
+
+	for (const qtractorWsolaTimeStretcher::Kernel *pKernel = pKernels;
+			pKernel->name; ++pKernel) {
+		// Cross-correlation, full linear seek...
+		float fCorrErr = 0.0f;
+		volatile float fSink = 0.0f;
+		unsigned long long t0 = nsecs();
+		for (unsigned int n = 0; n < iPasses; ++n) {
+			for (unsigned int i = 0; i < iSeekLength; ++i)
+				fSink = fSink + (*pKernel->crossCorr)(pInput + i, pRef, iOverlapLength);
+		}
+		const double fCorrTime = double(nsecs() - t0)
+			/ double(iPasses * iSeekLength);
+		for (unsigned int i = 0; i < iSeekLength; ++i) {
+			const float fCorr
+				= (*pKernel->crossCorr)(pInput + i, pRef, iOverlapLength);
+			float fErr = ::fabsf(fCorr - pfCorr0[i]);
+			if (::fabsf(pfCorr0[i]) > 1e-6f)
+				fErr /= ::fabsf(pfCorr0[i]);
+			if (fCorrErr < fErr)
+				fCorrErr = fErr;
+		}
+		// Overlap-add (unaligned input, as in real life)...
+		t0 = nsecs();
+		for (unsigned int n = 0; n < iPasses * 16; ++n)
+			(*pKernel->overlap)(pOut, pInput + 1 + (n & 7), pMid, iOverlapLength);
+		const double fOverlapTime = double(nsecs() - t0) / double(iPasses * 16);
+		(*pKernel->overlap)(pOut, pInput + 1, pMid, iOverlapLength);
+		const bool bExact
+			= (::memcmp(pOut, pOut0, iOverlapLength * sizeof(float)) == 0);
+		// Standard kernels are the baseline...
+		if (pKernel == pKernels) {
+			fCorrTime0 = fCorrTime;
+			fOverlapTime0 = fOverlapTime;
+		}
+		ts << "  wsola " << pKernel->name << ": cross-corr "
+			<< fCorrTime << " ns ("
+			<< (fCorrTime > 0.0 ? fCorrTime0 / fCorrTime : 0.0)
+			<< "x, max rel. error " << fCorrErr << "), overlap-add "
+			<< fOverlapTime << " ns ("
+			<< (fOverlapTime > 0.0 ? fOverlapTime0 / fOverlapTime : 0.0)
+			<< "x, " << (bExact ? "bit-exact" : "NOT bit-exact") << ")\n";
+	}
+
+	delete [] pfCorr0;
+
+	delete [] pOutUnaligned;
+	delete [] pOut0Unaligned;
+	delete [] pMidUnaligned;
+	delete [] pRefUnaligned;
+	delete [] pInputUnaligned;
+
+	return sReport;
+}
+
+
+// Heap allocations counter (process-wide).
+void qtractorBenchmark::setAllocCount ( bool bAllocCount )
+{
+	if (bAllocCount)
+		ATOMIC_SET(&g_iAllocCount, 0);
+
+	ATOMIC_SET(&g_bAllocCount, bAllocCount ? 1 : 0);
+}
+
+unsigned long qtractorBenchmark::allocCount (void)
+{
+	return (unsigned long) ATOMIC_GET(&g_iAllocCount);
+}
+
+
+// Heap allocation hook (operator new, any thread).
+void qtractorBenchmark::allocNotify (void)
+{
+	if (ATOMIC_GET(&g_bAllocCount))
+		ATOMIC_INC(&g_iAllocCount);
+}
+
+
+#endif  // CONFIG_BENCHMARK
+
+
+// end of qtractorBenchmark.cpp
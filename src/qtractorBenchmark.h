@@ -0,0 +1,134 @@
+// qtractorBenchmark.h
+//
+/****************************************************************************
+   Copyright (C) 2005-2022, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qtractorBenchmark_h
+#define __qtractorBenchmark_h
+
+#include "config.h"
+
+#ifdef CONFIG_BENCHMARK
+
+#include <QStringList>
+
+
+// Forward declarations.
+class qtractorSession;
+class QTemporaryDir;
+
+
+//----------------------------------------------------------------------
+// class qtractorBenchmark -- Offline render benchmark harness.
+//
+// Only driven by the headless qtractor_benchmark tool, which also
+// routes its heap allocations through allocNotify().
+//
+
+class qtractorBenchmark
+{
+public:
+
+	// Constructor.
+	qtractorBenchmark();
+
+	// Destructor.
+	~qtractorBenchmark();
+
+	// Reset all accumulated statistics.
+	void reset();
+
+	// Freewheel process cycle timing (RT).
+	void start();
+	void stop(unsigned int nframes);
+
+	// Synthetic stress session specification.
+	struct Spec
+	{
+		int tracks;
+		int clips;
+		int plugins;
+	};
+
+	// Parse a "<tracks>x<clips>x<plugins>" specification.
+	static bool parseSpec(const QString& sSpec, Spec& spec);
+
+	// Stock synthetic stress sessions.
+	static QStringList presets();
+
+	// Populate current session with a synthetic stress load.
+	bool generate(qtractorSession *pSession, const Spec& spec);
+
+	// Offline (freewheel) render of the whole session.
+	bool run(qtractorSession *pSession);
+
+	// Plain text report.
+	QString report() const;
+
+	// DSP kernels microbenchmark (plain text report).
+	static QString kernels();
+
+	// Heap allocations counter (process-wide).
+	static void setAllocCount(bool bAllocCount);
+	static unsigned long allocCount();
+
+	// Heap allocation hook (operator new, any thread).
+	static void allocNotify();
+
+private:
+
+	// Monotonic clock (in nanoseconds).
+	static unsigned long long nsecs();
+
+	// Cycle latency histogram (log2 microsecond buckets).
+	enum { Buckets = 24 };
+
+	// Instance variables.
+	unsigned long long m_iStart;
+
+	unsigned long m_iCycles;
+	unsigned long m_iFrames;
+	unsigned long m_iOverruns;
+	unsigned long m_iAllocs;
+	unsigned long m_iAllocCycles;
+	unsigned long m_iAllocMax;
+
+	unsigned long long m_iTimeSum;
+	unsigned long long m_iTimeMin;
+	unsigned long long m_iTimeMax;
+
+	unsigned long m_histogram[Buckets];
+
+	unsigned int m_iSampleRate;
+	unsigned int m_iBufferSize;
+	unsigned long long m_iPeriod;
+
+	unsigned long long m_iElapsed;
+
+	// Synthetic session media files.
+	QTemporaryDir *m_pTempDir;
+};
+
+
+#endif  // CONFIG_BENCHMARK
+
+#endif  // __qtractorBenchmark_h
+
+
+// end of qtractorBenchmark.h
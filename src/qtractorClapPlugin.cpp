@@ -640,6 +640,9 @@ public:
 	// Plugin current latency (in frames);
 	unsigned long latency () const;
 
+	// Plugin declared tail length (in frames; -1=unknown/infinite).
+	long tailLength () const;
+
 	// Total parameter count.
 	unsigned long getParameterCount() const
 		{ return m_param_infos.count(); }
@@ -1695,6 +1698,24 @@ unsigned long qtractorClapPlugin::Impl::latency (void) const
 }
 
 
+// Plugin declared tail length (in frames; -1=unknown/infinite).
+long qtractorClapPlugin::Impl::tailLength (void) const
+{
+	if (m_plugin) {
+		const clap_plugin_tail *tail
+			= static_cast<const clap_plugin_tail *> (
+				m_plugin->get_extension(m_plugin, CLAP_EXT_TAIL));
+		if (tail && tail->get) {
+			const uint32_t iTailLength = tail->get(m_plugin);
+			if (iTailLength < uint32_t(INT32_MAX))
+				return long(iTailLength);
+		}
+	}
+
+	return -1;
+}
+
+
 // Set/add a parameter value/point.
 void qtractorClapPlugin::Impl::setParameter (
 	clap_id id, double value )
@@ -3465,6 +3486,13 @@ unsigned long qtractorClapPlugin::latency (void) const
 }
 
 
+// Plugin declared tail length (in frames; -1=unknown/infinite).
+long qtractorClapPlugin::tailLength (void) const
+{
+	return m_pImpl->tailLength();
+}
+
+
 // Plugin preset i/o (configuration from/to state files).
 bool qtractorClapPlugin::loadPresetFile ( const QString& sFilename )
 {
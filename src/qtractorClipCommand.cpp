@@ -38,6 +38,101 @@
 #include "qtractorSessionCommand.h"
 #include "qtractorCurveCommand.h"
 
+#include "qtractorRtCommand.h"
+
+
+//----------------------------------------------------------------------
+// class qtractorClipRtCommand - Track clips (un)link RT command.
+//
+
+class qtractorClipRtCommand : public qtractorRtCommand
+{
+public:
+
+	// Constructor.
+	qtractorClipRtCommand(qtractorTrack *pTrack)
+		: m_pTrack(pTrack), m_pClipIndex(nullptr) {}
+
+	// Destructor.
+	~qtractorClipRtCommand()
+		{ qtractorClipIndex::deleteMap(m_pClipIndex); }
+
+	// Track accessor.
+	qtractorTrack *track() const
+		{ return m_pTrack; }
+
+	// Clip (un)link items (non-RT).
+	void addClip(qtractorClip *pClip, bool bInsert)
+		{ m_items.append(Item(pClip, bInsert)); }
+
+	// Pre-build the resulting clip index snapshot (non-RT),
+	// provided the track clip list is not to change meanwhile.
+	void prepare()
+	{
+		QList<qtractorClip *> clips;
+		qtractorClip *pClip = m_pTrack->clips().first();
+		for ( ; pClip; pClip = pClip->next())
+			clips.append(pClip);
+		QListIterator<Item> iter(m_items);
+		while (iter.hasNext()) {
+			const Item& item = iter.next();
+			if (item.insert) {
+				int i = 0;
+				const int iCount = clips.count();
+				while (i < iCount
+					&& clips.at(i)->clipStart() < item.clip->clipStart())
+					++i;
+				clips.insert(i, item.clip);
+			}
+			else clips.removeAll(item.clip);
+		}
+		const QVector<qtractorClip *> list = clips.toVector();
+		qtractorClipIndex::deleteMap(m_pClipIndex);
+		m_pClipIndex = qtractorClipIndex::createMap(
+			list.constData(), list.count());
+	}
+
+	// Apply the change (RT): list (un)link, clip index
+	// snapshot swap and session cursors, all in one go.
+	void process()
+	{
+		QListIterator<Item> iter(m_items);
+		while (iter.hasNext()) {
+			const Item& item = iter.next();
+			if (item.insert)
+				m_pTrack->linkClipRt(item.clip);
+			else
+				m_pTrack->unlinkClipRt(item.clip);
+		}
+		if (m_pClipIndex) {
+			m_pTrack->swapClipIndex(m_pClipIndex);
+			m_pClipIndex = nullptr;
+		}
+		qtractorSession *pSession = m_pTrack->session();
+		pSession->updateTrackCursors(m_pTrack);
+		// Any pending read-ahead schedule is stale now...
+		pSession->audioEngine()->resetPreRoll();
+	}
+
+private:
+
+	// Clip (un)link item.
+	struct Item
+	{
+		Item(qtractorClip *pClip = nullptr, bool bInsert = false)
+			: clip(pClip), insert(bInsert) {}
+
+		qtractorClip *clip;
+		bool          insert;
+	};
+
+	// Instance variables.
+	qtractorTrack *m_pTrack;
+	QList<Item>    m_items;
+
+	qtractorClipIndex::Map *m_pClipIndex;
+};
+
 
 //----------------------------------------------------------------------
 // class qtractorClipCommand - declaration.
@@ -341,6 +436,16 @@ void qtractorClipCommand::wsolaClip ( qtractorClip *pClip,
 }
 
 
+void qtractorClipCommand::cacheInRamClip ( qtractorClip *pClip, bool bCacheInRam )
+{
+	Item *pItem = new Item(CacheInRamClip, pClip, pClip->track());
+	pItem->cacheInRam = bCacheInRam;
+	m_items.append(pItem);
+
+	reopenClip(pClip, true);
+}
+
+
 void qtractorClipCommand::reopenClip ( qtractorClip *pClip, bool bClose )
 {
 	QHash<qtractorClip *, bool>::ConstIterator iter
@@ -407,6 +512,31 @@ bool qtractorClipCommand::addClipRecord (
 		return true;
 	}
 
+	// Report audio capture ring-buffer statistics...
+	if (trackType == qtractorTrack::Audio) {
+		qtractorAudioClip *pAudioClip
+			= static_cast<qtractorAudioClip *> (pClip);
+		qtractorAudioBuffer *pBuff = pAudioClip->buffer();
+		qtractorMainForm *pMainForm = qtractorMainForm::getInstance();
+		if (pBuff && pMainForm) {
+			QString sText = QObject::tr("Capture: %1: high-water %2%")
+				.arg(pTrack->trackName())
+				.arg(100.0f * pBuff->captureHighWaterRatio(), 0, 'f', 1);
+			const unsigned int iCaptureRisks = pBuff->captureRiskCount();
+			if (iCaptureRisks > 0) {
+				qtractorTimeScale *pTimeScale = pSession->timeScale();
+				QStringList times;
+				foreach (unsigned long iOffset, pBuff->captureRisks())
+					times.append(pTimeScale->textFromFrame(iClipStart + iOffset));
+				sText += QObject::tr(", %1 overrun risk(s) at %2")
+					.arg(iCaptureRisks).arg(times.join(", "));
+				pMainForm->appendMessagesColor(sText, Qt::darkYellow);
+			} else {
+				pMainForm->appendMessages(sText);
+			}
+		}
+	}
+
 	// Time to close the clip...
 	pClip->close();
 
@@ -609,6 +739,10 @@ bool qtractorClipCommand::execute ( bool bRedo )
 	if (pSession == nullptr)
 		return false;
 
+	// Plain clip insertions and removals go lock-free...
+	if (isRtExecute())
+		return executeRt(bRedo);
+
 	pSession->lock();
 
 	QListIterator<qtractorTrackCommand *> track(m_trackCommands);
@@ -852,6 +986,17 @@ bool qtractorClipCommand::execute ( bool bRedo )
 			}
 			break;
 		}
+		case CacheInRamClip: {
+			qtractorAudioClip *pAudioClip = nullptr;
+			if (pTrack->trackType() == qtractorTrack::Audio)
+				pAudioClip = static_cast<qtractorAudioClip *> (pClip);
+			if (pAudioClip) {
+				const bool bOldCacheInRam = pAudioClip->isCacheInRam();
+				pAudioClip->setCacheInRam(pItem->cacheInRam);
+				pItem->cacheInRam = bOldCacheInRam;
+			}
+			break;
+		}
 		default:
 			break;
 		}
@@ -867,6 +1012,165 @@ bool qtractorClipCommand::execute ( bool bRedo )
 }
 
 
+// Whether it's just about clip insertions and removals,
+// thus doable without ever holding the session lock.
+bool qtractorClipCommand::isRtExecute (void) const
+{
+	if (!m_trackCommands.isEmpty() || !m_clips.isEmpty())
+		return false;
+
+	QListIterator<Item *> iter(m_items);
+	while (iter.hasNext()) {
+		const CommandType command = iter.next()->command;
+		if (command != AddClip
+			&& command != RemoveClip
+			&& command != MoveClip)
+			return false;
+	}
+
+	return !m_items.isEmpty();
+}
+
+
+// Lock-free executive method: clips are only ever (un)linked
+// from their tracks in the RT thread, while any (re)opening is
+// done here, once those are out of the RT thread reach.
+bool qtractorClipCommand::executeRt ( bool bRedo )
+{
+	qtractorSession *pSession = qtractorSession::getInstance();
+	if (pSession == nullptr)
+		return false;
+
+	// First, get the outgoing clips unlinked...
+	QList<qtractorClipRtCommand *> commands;
+	QListIterator<Item *> iter(m_items);
+	while (iter.hasNext()) {
+		Item *pItem = iter.next();
+		qtractorClip *pClip = pItem->clip;
+		const bool bUnlink
+			= (pItem->command == MoveClip)
+			|| (pItem->command == AddClip && !bRedo)
+			|| (pItem->command == RemoveClip && bRedo);
+		if (bUnlink)
+			clipRtCommand(commands, pClip->track())->addClip(pClip, false);
+	}
+
+	// Wait for the RT thread to let go of them...
+	postRtCommands(commands);
+
+	// Now close, change and (re)open as needed...
+	QList<Item *> inserts;
+	iter.toFront();
+	while (iter.hasNext()) {
+		Item *pItem = iter.next();
+		qtractorClip  *pClip  = pItem->clip;
+		qtractorTrack *pTrack = pItem->track;
+		switch (pItem->command) {
+		case AddClip:
+			if (bRedo) {
+				pTrack->openClip(pClip);
+				inserts.append(pItem);
+			}
+			else pClip->close();
+			pItem->autoDelete = !bRedo;
+			setClearSelectReset(!bRedo);
+			break;
+		case RemoveClip:
+			if (bRedo)
+				pClip->close();
+			else {
+				pTrack->openClip(pClip);
+				inserts.append(pItem);
+			}
+			pItem->autoDelete = bRedo;
+			setClearSelectReset(bRedo);
+			break;
+		case MoveClip: {
+			qtractorTrack *pOldTrack = pClip->track();
+			const unsigned long iOldStart = pClip->clipStart();
+			const unsigned long iOldOffset = pClip->clipOffset();
+			const unsigned long iOldLength = pClip->clipLength();
+			const unsigned long iOldFadeIn = pClip->fadeInLength();
+			const unsigned long iOldFadeOut = pClip->fadeOutLength();
+			pClip->close();
+			pClip->setClipStart(pItem->clipStart);
+			pClip->setClipOffset(pItem->clipOffset);
+			pClip->setClipLength(pItem->clipLength);
+			pClip->setFadeInLength(pItem->fadeInLength);
+			pClip->setFadeOutLength(pItem->fadeOutLength);
+			pTrack->openClip(pClip);
+			inserts.append(pItem);
+			pItem->track = pOldTrack;
+			pItem->clipStart = iOldStart;
+			pItem->clipOffset = iOldOffset;
+			pItem->clipLength = iOldLength;
+			pItem->fadeInLength = iOldFadeIn;
+			pItem->fadeOutLength = iOldFadeOut;
+			setClearSelect(true);
+			break;
+		}
+		default:
+			break;
+		}
+	}
+
+	// Finally, get the incoming clips linked, with their
+	// clip-loops set while still out of the RT thread reach...
+	QListIterator<Item *> insert(inserts);
+	while (insert.hasNext()) {
+		qtractorClip *pClip = insert.next()->clip;
+		qtractorTrack *pTrack = pClip->track();
+		pTrack->setClipLoop(pClip, pSession->loopStart(), pSession->loopEnd());
+		clipRtCommand(commands, pTrack)->addClip(pClip, true);
+	}
+
+	// Wait for the RT thread to get hold of them...
+	postRtCommands(commands);
+
+	return true;
+}
+
+
+// Lock-free clip (un)linking, one RT command per track.
+qtractorClipRtCommand *qtractorClipCommand::clipRtCommand (
+	QList<qtractorClipRtCommand *>& commands, qtractorTrack *pTrack )
+{
+	QListIterator<qtractorClipRtCommand *> iter(commands);
+	while (iter.hasNext()) {
+		qtractorClipRtCommand *pCommand = iter.next();
+		if (pCommand->track() == pTrack)
+			return pCommand;
+	}
+
+	qtractorClipRtCommand *pCommand = new qtractorClipRtCommand(pTrack);
+	commands.append(pCommand);
+	return pCommand;
+}
+
+
+// Post all track clips (un)linking RT commands, with their
+// clip index snapshots pre-built, and wait for them to be
+// applied: session cursors are refreshed by then (non-RT).
+void qtractorClipCommand::postRtCommands (
+	QList<qtractorClipRtCommand *>& commands )
+{
+	qtractorSession *pSession = qtractorSession::getInstance();
+	if (pSession == nullptr)
+		return;
+
+	QListIterator<qtractorClipRtCommand *> iter(commands);
+	while (iter.hasNext()) {
+		qtractorClipRtCommand *pCommand = iter.next();
+		pCommand->prepare();
+		pSession->postRtCommand(pCommand);
+	}
+
+	commands.clear();
+
+	pSession->syncRtCommands();
+}
+
+
 // Virtual command methods.
 bool qtractorClipCommand::redo (void)
 {
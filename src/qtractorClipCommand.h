@@ -36,6 +36,7 @@ class qtractorTimeScaleNodeCommand;
 class qtractorTimeScaleMarkerCommand;
 class qtractorMidiEditCommand;
 class qtractorMidiClip;
+class qtractorClipRtCommand;
 
 
 //----------------------------------------------------------------------
@@ -77,6 +78,7 @@ public:
 	void resetClip(qtractorClip *pClip);
 	void wsolaClip(qtractorClip *pClip,
 		bool bWsolaTimeStretch, bool bWsolaQuickSeek);
+	void cacheInRamClip(qtractorClip *pClip, bool bCacheInRam);
 
 	void reopenClip(qtractorClip *pClip, bool bClose = false);
 
@@ -105,6 +107,21 @@ protected:
 	// Common executive method.
 	virtual bool execute(bool bRedo);
 
+	// Whether it's just about clip insertions and removals,
+	// thus doable without holding the session lock while
+	// (re)opening or closing any of those clips.
+	bool isRtExecute() const;
+
+	// Lock-free executive method.
+	bool executeRt(bool bRedo);
+
+	// Lock-free clip (un)linking, one RT command per track.
+	static qtractorClipRtCommand *clipRtCommand(
+		QList<qtractorClipRtCommand *>& commands, qtractorTrack *pTrack);
+
+	// Post all pending clip (un)linking RT commands and wait.
+	static void postRtCommands(QList<qtractorClipRtCommand *>& commands);
+
 private:
 
 	// Primitive command types.
@@ -113,7 +130,7 @@ private:
 		RenameClip, MoveClip, ResizeClip,
 		GainClip, PanningClip, FadeInClip, FadeOutClip,
 		TimeStretchClip, PitchShiftClip,
-		TakeInfoClip, ResetClip, WsolaClip
+		TakeInfoClip, ResetClip, WsolaClip, CacheInRamClip
 	};
 
 	// Clip item struct.
@@ -129,7 +146,7 @@ private:
 				fadeOutLength(0), fadeOutType(qtractorClip::OutQuad),
 				timeStretch(0.0f), pitchShift(0.0f),
 				wsolaTimeStretch(false), wsolaQuickSeek(false),
-				editCommand(nullptr), takeInfo(nullptr) {}
+				cacheInRam(false), editCommand(nullptr), takeInfo(nullptr) {}
 		// Item members.
 		CommandType    command;
 		qtractorClip  *clip;
@@ -151,6 +168,7 @@ private:
 		float          pitchShift;
 		bool           wsolaTimeStretch;
 		bool           wsolaQuickSeek;
+		bool           cacheInRam;
 		// When MIDI clips are time-stretched...
 		qtractorMidiEditCommand *editCommand;
 		// When clips have take(record) descriptors...
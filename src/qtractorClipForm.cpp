@@ -195,6 +195,9 @@ qtractorClipForm::qtractorClipForm ( QWidget *pParent )
 	QObject::connect(m_ui.WsolaQuickSeekCheckBox,
 		SIGNAL(stateChanged(int)),
 		SLOT(changed()));
+	QObject::connect(m_ui.CacheInRamCheckBox,
+		SIGNAL(stateChanged(int)),
+		SLOT(changed()));
 	QObject::connect(m_ui.DialogButtonBox,
 		SIGNAL(accepted()),
 		SLOT(accept()));
@@ -295,6 +298,7 @@ void qtractorClipForm::setClip ( qtractorClip *pClip, bool bClipNew )
 		m_ui.WsolaTimeStretchCheckBox->setChecked(true);
 	#endif
 		m_ui.WsolaQuickSeekCheckBox->setChecked(pAudioClip->isWsolaQuickSeek());
+		m_ui.CacheInRamCheckBox->setChecked(pAudioClip->isCacheInRam());
 		break;
 	}
 	case qtractorTrack::Midi: {
@@ -377,6 +381,7 @@ void qtractorClipForm::accept (void)
 		float fPitchShift = 0.0f;
 		bool bWsolaTimeStretch = qtractorAudioBuffer::isDefaultWsolaTimeStretch();
 		bool bWsolaQuickSeek = qtractorAudioBuffer::isDefaultWsolaQuickSeek();
+		bool bCacheInRam = false;
 		switch (clipType) {
 		case qtractorTrack::Audio:
 			fClipGain = pow10f2(m_ui.ClipGainSpinBox->value());
@@ -385,6 +390,7 @@ void qtractorClipForm::accept (void)
 			fPitchShift = ::powf(2.0f, m_ui.PitchShiftSpinBox->value() / 12.0f);
 			bWsolaTimeStretch = m_ui.WsolaTimeStretchCheckBox->isChecked();
 			bWsolaQuickSeek = m_ui.WsolaQuickSeekCheckBox->isChecked();
+			bCacheInRam = m_ui.CacheInRamCheckBox->isChecked();
 			break;
 		case qtractorTrack::Midi:
 			fClipGain = 0.01f * m_ui.ClipGainSpinBox->value();
@@ -403,6 +409,7 @@ void qtractorClipForm::accept (void)
 			= fadeTypeFromIndex(m_ui.FadeOutTypeComboBox->currentIndex());
 		int iFileChange = 0;
 		int iWsolaChange = 0;
+		int iCacheChange = 0;
 		// It depends whether we're adding a new clip or not...
 		if (m_bClipNew) {
 			// Just set new clip properties...
@@ -420,6 +427,7 @@ void qtractorClipForm::accept (void)
 					pAudioClip->setPitchShift(fPitchShift);
 					pAudioClip->setWsolaTimeStretch(bWsolaTimeStretch);
 					pAudioClip->setWsolaQuickSeek(bWsolaQuickSeek);
+					pAudioClip->setCacheInRam(bCacheInRam);
 					++iFileChange;
 				}
 				break;
@@ -478,6 +486,10 @@ void qtractorClipForm::accept (void)
 					if (( bOldWsolaQuickSeek   && !bWsolaQuickSeek  ) ||
 						(!bOldWsolaQuickSeek   &&  bWsolaQuickSeek  ))
 						++iWsolaChange;
+					const bool bOldCacheInRam = pAudioClip->isCacheInRam();
+					if (( bOldCacheInRam && !bCacheInRam) ||
+						(!bOldCacheInRam &&  bCacheInRam))
+						++iCacheChange;
 				}
 				break;
 			}
@@ -522,6 +534,9 @@ void qtractorClipForm::accept (void)
 			// WSOLA audio clip options...
 			if (iWsolaChange > 0)
 				pClipCommand->wsolaClip(m_pClip, bWsolaTimeStretch, bWsolaQuickSeek);
+			// Session RAM cache audio clip option...
+			if (iCacheChange > 0)
+				pClipCommand->cacheInRamClip(m_pClip, bCacheInRam);
 			// Ready edit.
 		}
 		// Do it (by making it undoable)...
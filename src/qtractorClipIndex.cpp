@@ -0,0 +1,243 @@
+// qtractorClipIndex.cpp
+//
+/****************************************************************************
+   Copyright (C) 2005-2022, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+
+#include "qtractorAbout.h"
+#include "qtractorClipIndex.h"
+#include "qtractorClip.h"
+
+#include <QVector>
+
+#include <stdlib.h>
+
+
+//----------------------------------------------------------------------
+// struct qtractorClipIndex::Map -- Immutable index snapshot.
+//
+
+struct qtractorClipIndex::Map
+{
+	// Clip item (running maximum of clip ends).
+	struct Item
+	{
+		unsigned long reach;
+		qtractorClip *clip;
+	};
+
+	// Instance members (variable sized).
+	Map          *next;		// Retired chain.
+	unsigned int  iItems;
+	unsigned int  iSpans;
+	Item         *items;
+	Span         *spans;
+};
+
+
+//----------------------------------------------------------------------
+// class qtractorClipIndex -- Track clip interval index.
+//
+
+// Constructor.
+qtractorClipIndex::qtractorClipIndex (void)
+	: m_pMap(nullptr), m_pRetiredMaps(nullptr)
+{
+}
+
+
+// Destructor.
+qtractorClipIndex::~qtractorClipIndex (void)
+{
+	Map *pMap = m_pMap.fetchAndStoreOrdered(nullptr);
+	if (pMap)
+		::free(pMap);
+
+	reclaimMaps();
+}
+
+
+// Build a new snapshot from (start ordered) clips (non-RT).
+qtractorClipIndex::Map *qtractorClipIndex::createMap (
+	qtractorClip *const *ppClips, unsigned int iClips )
+{
+	// One single block: header, items and (at most) spans...
+	const size_t nbytes = sizeof(Map)
+		+ iClips * sizeof(Map::Item) + iClips * sizeof(Span);
+	Map *pMap = static_cast<Map *> (::malloc(nbytes));
+
+	pMap->next  = nullptr;
+	pMap->items = reinterpret_cast<Map::Item *> (pMap + 1);
+	pMap->spans = reinterpret_cast<Span *> (pMap->items + iClips);
+
+	unsigned int iSpans = 0;
+	unsigned long iReach = 0;
+	unsigned long iSpanReach = 0;
+
+	qtractorClip *pPrevClip = nullptr;
+	for (unsigned int i = 0; i < iClips; ++i) {
+		qtractorClip *pClip = ppClips[i];
+		const unsigned long iClipStart = pClip->clipStart();
+		const unsigned long iClipEnd = iClipStart + pClip->clipLength();
+		if (iReach < iClipEnd)
+			iReach = iClipEnd;
+		Map::Item& item = pMap->items[i];
+		item.reach = iReach;
+		item.clip  = pClip;
+		// Only partial overlaps make for a crossfade,
+		// as fully nested clips are meant to be layered...
+		if (pPrevClip) {
+			const unsigned long iPrevEnd
+				= pPrevClip->clipStart() + pPrevClip->clipLength();
+			if (iClipStart < iPrevEnd && iPrevEnd < iClipEnd) {
+				if (iSpanReach < iPrevEnd)
+					iSpanReach = iPrevEnd;
+				Span& span = pMap->spans[iSpans++];
+				span.start = iClipStart;
+				span.end   = iPrevEnd;
+				span.reach = iSpanReach;
+				span.clip1 = pPrevClip;
+				span.clip2 = pClip;
+			}
+		}
+		pPrevClip = pClip;
+	}
+
+	pMap->iItems = iClips;
+	pMap->iSpans = iSpans;
+
+	return pMap;
+}
+
+
+qtractorClipIndex::Map *qtractorClipIndex::createMap (
+	const qtractorList<qtractorClip>& clips )
+{
+	QVector<qtractorClip *> list;
+	list.reserve(clips.count());
+	for (qtractorClip *pClip = clips.first(); pClip; pClip = pClip->next())
+		list.append(pClip);
+
+	return createMap(list.constData(), list.count());
+}
+
+
+// Dispose of a snapshot never swapped in (non-RT).
+void qtractorClipIndex::deleteMap ( Map *pMap )
+{
+	if (pMap)
+		::free(pMap);
+}
+
+
+// Swap in a new snapshot (RT-safe): the old one is retired, as
+// some other thread might still be seeking through it right now,
+// until some known-quiescent point...
+void qtractorClipIndex::swapMap ( Map *pMap )
+{
+	Map *pOldMap = m_pMap.fetchAndStoreOrdered(pMap);
+	if (pOldMap == nullptr)
+		return;
+
+	Map *pNextMap;
+	do {
+		pNextMap = m_pRetiredMaps.loadAcquire();
+		pOldMap->next = pNextMap;
+	}
+	while (!m_pRetiredMaps.testAndSetOrdered(pNextMap, pOldMap));
+}
+
+
+// Retired snapshots reclamation (non-RT; only
+// at a known-quiescent point, or the destructor).
+void qtractorClipIndex::reclaimMaps (void)
+{
+	Map *pOldMap = m_pRetiredMaps.fetchAndStoreOrdered(nullptr);
+	while (pOldMap) {
+		Map *pNextMap = pOldMap->next;
+		::free(pOldMap);
+		pOldMap = pNextMap;
+	}
+}
+
+
+// First clip not past the given frame (binary search);
+// the same as walking the list from the start, as
+// it gets the first clip that ends at or after it.
+qtractorClip *qtractorClipIndex::seekClip ( unsigned long iFrame ) const
+{
+	const Map *pMap = m_pMap.loadAcquire();
+	if (pMap == nullptr || pMap->iItems < 1)
+		return nullptr;
+
+	const Map::Item *pItems = pMap->items;
+	const unsigned int iItems = pMap->iItems;
+
+	unsigned int lo = 0;
+	unsigned int hi = iItems;
+	while (lo < hi) {
+		const unsigned int mid = (lo + hi) >> 1;
+		if (pItems[mid].reach < iFrame)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	if (lo >= iItems)
+		lo = iItems - 1;
+
+	return pItems[lo].clip;
+}
+
+
+// Overlap span of a clip intersecting a frame range (binary search).
+const qtractorClipIndex::Span *qtractorClipIndex::seekSpan (
+	qtractorClip *pClip, unsigned long iFrameStart, unsigned long iFrameEnd ) const
+{
+	const Map *pMap = m_pMap.loadAcquire();
+	if (pMap == nullptr)
+		return nullptr;
+
+	const Span *pSpans = pMap->spans;
+	const unsigned int iSpans = pMap->iSpans;
+
+	unsigned int lo = 0;
+	unsigned int hi = iSpans;
+	while (lo < hi) {
+		const unsigned int mid = (lo + hi) >> 1;
+		if (pSpans[mid].reach <= iFrameStart)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	for ( ; lo < iSpans; ++lo) {
+		const Span *pSpan = &pSpans[lo];
+		if (pSpan->start >= iFrameEnd)
+			break;
+		if (pSpan->end > iFrameStart
+			&& (pSpan->clip1 == pClip || pSpan->clip2 == pClip))
+			return pSpan;
+	}
+
+	return nullptr;
+}
+
+
+// end of qtractorClipIndex.cpp
@@ -0,0 +1,102 @@
+// qtractorClipIndex.h
+//
+/****************************************************************************
+   Copyright (C) 2005-2022, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+
+#ifndef __qtractorClipIndex_h
+#define __qtractorClipIndex_h
+
+#include "qtractorList.h"
+
+#include <QAtomicPointer>
+
+
+// Forward declarations.
+class qtractorClip;
+
+
+//----------------------------------------------------------------------
+// class qtractorClipIndex -- Track clip interval index.
+//
+
+class qtractorClipIndex
+{
+public:
+
+	// Constructor.
+	qtractorClipIndex();
+
+	// Destructor.
+	~qtractorClipIndex();
+
+	// Overlap span (first clip fading out, second fading in).
+	struct Span
+	{
+		unsigned long start;
+		unsigned long end;
+		unsigned long reach;	// running maximum of span ends.
+		qtractorClip *clip1;
+		qtractorClip *clip2;
+	};
+
+	// Immutable index snapshot (opaque).
+	struct Map;
+
+	// Build a new snapshot from (start ordered) clips (non-RT).
+	static Map *createMap(qtractorClip *const *ppClips, unsigned int iClips);
+	static Map *createMap(const qtractorList<qtractorClip>& clips);
+
+	// Dispose of a snapshot never swapped in (non-RT).
+	static void deleteMap(Map *pMap);
+
+	// Swap in a new snapshot, the old one gets retired (RT-safe).
+	void swapMap(Map *pMap);
+
+	// Rebuild from a (start ordered) clip list (non-RT).
+	void update(const qtractorList<qtractorClip>& clips)
+		{ swapMap(createMap(clips)); }
+
+	// Retired snapshots reclamation (non-RT; only
+	// at a known-quiescent point, or the destructor).
+	void reclaimMaps();
+
+	// Whether there's a current snapshot at all.
+	bool isValid() const
+		{ return (m_pMap.loadAcquire() != nullptr); }
+
+	// First clip not past the given frame (binary search).
+	qtractorClip *seekClip(unsigned long iFrame) const;
+
+	// Overlap span of a clip intersecting a frame range (binary search).
+	const Span *seekSpan(qtractorClip *pClip,
+		unsigned long iFrameStart, unsigned long iFrameEnd) const;
+
+private:
+
+	// Current and retired snapshots.
+	QAtomicPointer<Map> m_pMap;
+	QAtomicPointer<Map> m_pRetiredMaps;
+};
+
+
+#endif  // __qtractorClipIndex_h
+
+
+// end of qtractorClipIndex.h
@@ -0,0 +1,230 @@
+// qtractorDspLoad.cpp
+//
+/****************************************************************************
+   Copyright (C) 2005-2022, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qtractorAbout.h"
+#include "qtractorDspLoad.h"
+
+#ifdef CONFIG_DSP_LOAD
+
+#include "qtractorSession.h"
+#include "qtractorAudioEngine.h"
+#include "qtractorMidiEngine.h"
+#include "qtractorPlugin.h"
+
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QFile>
+
+#include <algorithm>
+
+
+//----------------------------------------------------------------------
+// class qtractorDspLoad -- Process cycle timing statistics.
+//
+
+// Reset all accumulated samples.
+void qtractorDspLoad::reset (void)
+{
+	m_iStart = 0;
+	m_iWrite = 0;
+
+	for (unsigned int i = 0; i < WindowSize; ++i)
+		m_samples[i] = 0;
+}
+
+
+// Sliding window statistics (in microseconds).
+qtractorDspLoad::Stats qtractorDspLoad::stats (void) const
+{
+	Stats stats = { 0, 0.0f, 0.0f, 0.0f };
+
+	// Take a snapshot (samples may get torn, never mind)...
+	const unsigned int w = m_iWrite;
+	const unsigned int n = (w < WindowSize ? w : WindowSize);
+	if (n < 1)
+		return stats;
+
+	unsigned int samples[WindowSize];
+	unsigned long long sum = 0;
+	for (unsigned int i = 0; i < n; ++i) {
+		samples[i] = m_samples[(w - 1 - i) & WindowMask];
+		sum += samples[i];
+	}
+
+	// 99th percentile, the lazy way...
+	const unsigned int k = (n * 99) / 100;
+	std::nth_element(samples, samples + k, samples + n);
+	const unsigned int p99 = samples[k];
+	const unsigned int max = *std::max_element(samples + k, samples + n);
+
+	const double fTicksPerUsec = ticksPerUsec();
+	stats.count = n;
+	stats.mean  = float(double(sum) / double(n) / fTicksPerUsec);
+	stats.max   = float(double(max) / fTicksPerUsec);
+	stats.p99   = float(double(p99) / fTicksPerUsec);
+
+	return stats;
+}
+
+
+// Human readable summary (relative to current cycle period).
+QString qtractorDspLoad::text (void) const
+{
+	const Stats& s = stats();
+	if (s.count < 1)
+		return QString();
+
+	const float fPeriod = periodUsec();
+	if (fPeriod < 1.0f)
+		return QString();
+
+	return QObject::tr("DSP: %1% mean, %2% p99, %3% max")
+		.arg(100.0f * s.mean / fPeriod, 0, 'f', 1)
+		.arg(100.0f * s.p99  / fPeriod, 0, 'f', 1)
+		.arg(100.0f * s.max  / fPeriod, 0, 'f', 1);
+}
+
+
+// Cycle counter rate (calibrated once, non-RT).
+double qtractorDspLoad::ticksPerUsec (void)
+{
+	static double s_fTicksPerUsec = 0.0;
+
+	if (s_fTicksPerUsec > 0.0)
+		return s_fTicksPerUsec;
+
+#if defined(__x86_64__) || defined(__i386__)
+	// Assume an invariant TSC, as any modern CPU has...
+	QElapsedTimer timer;
+	timer.start();
+	const unsigned long long t0 = ticks();
+	while (timer.nsecsElapsed() < 10000000)
+		;
+	const unsigned long long t1 = ticks();
+	s_fTicksPerUsec = double(t1 - t0) * 1000.0 / double(timer.nsecsElapsed());
+#else
+	s_fTicksPerUsec = 1000.0;	// nanoseconds.
+#endif
+
+	if (s_fTicksPerUsec < 1.0)
+		s_fTicksPerUsec = 1.0;
+
+	return s_fTicksPerUsec;
+}
+
+
+// Current audio process cycle period (in microseconds).
+float qtractorDspLoad::periodUsec (void)
+{
+	qtractorSession *pSession = qtractorSession::getInstance();
+	if (pSession == nullptr)
+		return 0.0f;
+
+	qtractorAudioEngine *pAudioEngine = pSession->audioEngine();
+	if (pAudioEngine == nullptr || pAudioEngine->sampleRate() < 1)
+		return 0.0f;
+
+	return 1000000.0f * float(pAudioEngine->bufferSize())
+		/ float(pAudioEngine->sampleRate());
+}
+
+
+// Write all session tracks and plugins statistics as CSV.
+static void exportCsvLine ( QTextStream& ts, const QString& sType,
+	const QString& sName, const qtractorDspLoad& dspLoad, float fPeriod )
+{
+	const qtractorDspLoad::Stats& s = dspLoad.stats();
+
+	QString sText = sName;
+	sText.replace('"', "\"\"");
+
+	ts << sType << ",\"" << sText << "\"," << s.count
+		<< ',' << s.mean << ',' << s.p99 << ',' << s.max;
+	if (fPeriod > 0.0f) {
+		ts << ',' << (100.0f * s.mean / fPeriod)
+			<< ',' << (100.0f * s.p99  / fPeriod)
+			<< ',' << (100.0f * s.max  / fPeriod);
+	} else {
+		ts << ",,,";
+	}
+	ts << '\n';
+}
+
+static void exportCsvPlugins ( QTextStream& ts, const QString& sPrefix,
+	qtractorPluginList *pPluginList, float fPeriod )
+{
+	if (pPluginList == nullptr)
+		return;
+
+	for (qtractorPlugin *pPlugin = pPluginList->first();
+			pPlugin; pPlugin = pPlugin->next()) {
+		exportCsvLine(ts, "plugin",
+			sPrefix + '/' + (pPlugin->type())->name(),
+			pPlugin->dspLoad(), fPeriod);
+	}
+}
+
+bool qtractorDspLoad::exportCsv ( const QString& sFilename )
+{
+	qtractorSession *pSession = qtractorSession::getInstance();
+	if (pSession == nullptr)
+		return false;
+
+	QFile file(sFilename);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate))
+		return false;
+
+	const float fPeriod = periodUsec();
+
+	QTextStream ts(&file);
+	ts << "type,name,count,mean_us,p99_us,max_us,"
+		"mean_pct,p99_pct,max_pct\n";
+
+	for (qtractorTrack *pTrack = pSession->tracks().first();
+			pTrack; pTrack = pTrack->next()) {
+		exportCsvLine(ts, "track", pTrack->trackName(),
+			pTrack->dspLoad(), fPeriod);
+		exportCsvPlugins(ts, pTrack->trackName(),
+			pTrack->pluginList(), fPeriod);
+	}
+
+	qtractorEngine *apEngines[] = {
+		pSession->audioEngine(), pSession->midiEngine() };
+	for (qtractorEngine *pEngine : apEngines) {
+		for (qtractorBus *pBus = pEngine->buses().first();
+				pBus; pBus = pBus->next()) {
+			exportCsvPlugins(ts, pBus->busName() + " In",
+				pBus->pluginList_in(), fPeriod);
+			exportCsvPlugins(ts, pBus->busName() + " Out",
+				pBus->pluginList_out(), fPeriod);
+		}
+	}
+
+	file.close();
+
+	return true;
+}
+
+
+#endif  // CONFIG_DSP_LOAD
+
+
+// end of qtractorDspLoad.cpp
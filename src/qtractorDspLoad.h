@@ -0,0 +1,115 @@
+// qtractorDspLoad.h
+//
+/****************************************************************************
+   Copyright (C) 2005-2022, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qtractorDspLoad_h
+#define __qtractorDspLoad_h
+
+#include "config.h"
+
+#ifdef CONFIG_DSP_LOAD
+
+#include <QString>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+
+
+//----------------------------------------------------------------------
+// class qtractorDspLoad -- Process cycle timing statistics.
+//
+
+class qtractorDspLoad
+{
+public:
+
+	// Constructor.
+	qtractorDspLoad() { reset(); }
+
+	// Reset all accumulated samples.
+	void reset();
+
+	// Process cycle timing (RT).
+	void start()
+		{ m_iStart = ticks(); }
+	void stop()
+	{
+		const unsigned int w = m_iWrite;
+		m_samples[w & WindowMask] = (unsigned int) (ticks() - m_iStart);
+		m_iWrite = w + 1;
+	}
+
+	// Sliding window statistics (in microseconds).
+	struct Stats
+	{
+		unsigned int count;
+		float mean;
+		float max;
+		float p99;
+	};
+
+	Stats stats() const;
+
+	// Human readable summary (relative to current cycle period).
+	QString text() const;
+
+	// Cycle counter.
+	static unsigned long long ticks()
+	{
+	#if defined(__x86_64__) || defined(__i386__)
+		return __rdtsc();
+	#else
+		struct timespec ts;
+		::clock_gettime(CLOCK_MONOTONIC, &ts);
+		return (unsigned long long) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+	#endif
+	}
+
+	// Cycle counter rate (calibrated once, non-RT).
+	static double ticksPerUsec();
+
+	// Current audio process cycle period (in microseconds).
+	static float periodUsec();
+
+	// Write all session tracks and plugins statistics as CSV.
+	static bool exportCsv(const QString& sFilename);
+
+private:
+
+	// Sliding window size (power-of-two).
+	enum { WindowSize = 256, WindowMask = WindowSize - 1 };
+
+	// Instance variables.
+	unsigned long long m_iStart;
+
+	volatile unsigned int m_iWrite;
+	volatile unsigned int m_samples[WindowSize];
+};
+
+
+#endif  // CONFIG_DSP_LOAD
+
+#endif  // __qtractorDspLoad_h
+
+
+// end of qtractorDspLoad.h
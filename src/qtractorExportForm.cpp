@@ -117,6 +117,9 @@ qtractorExportForm::qtractorExportForm ( QWidget *pParent )
 	QObject::connect(m_ui.AddTrackCheckBox,
 		SIGNAL(toggled(bool)),
 		SLOT(stabilizeForm()));
+	QObject::connect(m_ui.StemsCheckBox,
+		SIGNAL(toggled(bool)),
+		SLOT(stabilizeForm()));
 	QObject::connect(m_ui.DialogButtonBox,
 		SIGNAL(accepted()),
 		SLOT(accept()));
@@ -176,6 +179,8 @@ void qtractorExportForm::setExportType ( qtractorTrack::TrackType exportType )
 			m_sExportType = tr("MIDI");
 			m_sExportExt  = "mid";
 			m_ui.ExportTypeWidget->removeWidget(m_ui.AudioExportTypePage);
+			m_ui.StemsCheckBox->setEnabled(false);
+			m_ui.StemsCheckBox->setVisible(false);
 			break;
 		case qtractorTrack::None:
 		default:
@@ -192,6 +197,7 @@ void qtractorExportForm::setExportType ( qtractorTrack::TrackType exportType )
 	if (pOptions) {
 		pOptions->loadComboBoxHistory(m_ui.ExportPathComboBox);
 		m_ui.AddTrackCheckBox->setChecked(pOptions->bExportAddTrack);
+		m_ui.StemsCheckBox->setChecked(pOptions->bExportStems);
 		switch (m_exportType) {
 		case qtractorTrack::Audio: {
 			// Audio options...
@@ -617,6 +623,7 @@ void qtractorExportForm::saveExportOptions (void)
 
 	pOptions->saveComboBoxHistory(m_ui.ExportPathComboBox);
 	pOptions->bExportAddTrack = m_ui.AddTrackCheckBox->isChecked();
+	pOptions->bExportStems = m_ui.StemsCheckBox->isChecked();
 	switch (m_exportType) {
 	case qtractorTrack::Audio: {
 		// Audio options...
@@ -710,6 +717,30 @@ void qtractorExportTrackForm::stabilizeForm (void)
 }
 
 
+// Stem file name suffix, from its bus name (filesystem safe).
+static QString qtractorExportTrackForm_stemName ( const QString& sBusName )
+{
+	static const QString s_sInvalid("/\\:*?\"<>|");
+
+	QString sStemName = sBusName.simplified();
+	const int iLength = sStemName.length();
+	for (int i = 0; i < iLength; ++i) {
+		const QChar ch = sStemName.at(i);
+		if (ch.category() == QChar::Other_Control || s_sInvalid.contains(ch))
+			sStemName[i] = '_';
+	}
+
+	// No hidden files, please...
+	while (sStemName.startsWith('.'))
+		sStemName.remove(0, 1);
+
+	if (sStemName.isEmpty())
+		sStemName = "bus";
+
+	return sStemName;
+}
+
+
 // Executive slots -- accept settings (OK button slot).
 void qtractorExportTrackForm::accept (void)
 {
@@ -725,14 +756,43 @@ void qtractorExportTrackForm::accept (void)
 	if (QFileInfo(sExportPath).suffix().isEmpty())
 		sExportPath += '.' + m_sExportExt;
 
-	// Check (again) wether the file already exists...
-	if (QFileInfo(sExportPath).exists()) {
+	// Audio stems get one (unique) file per bus...
+	const bool bStems = (m_exportType == qtractorTrack::Audio
+		&& m_ui.StemsCheckBox->isChecked());
+	QStringList exportPaths;
+	if (bStems) {
+		const QFileInfo info(sExportPath);
+		QListIterator<QListWidgetItem *> iter(exportBusNameItems);
+		while (iter.hasNext()) {
+			const QString& sStemBase = info.completeBaseName() + '-'
+				+ qtractorExportTrackForm_stemName(iter.next()->text());
+			QString sStemPath = info.dir().filePath(
+				sStemBase + '.' + info.suffix());
+			for (int i = 2; exportPaths.contains(sStemPath); ++i) {
+				sStemPath = info.dir().filePath(
+					sStemBase + '-' + QString::number(i) + '.' + info.suffix());
+			}
+			exportPaths.append(sStemPath);
+		}
+	} else {
+		exportPaths.append(sExportPath);
+	}
+
+	// Check (again) wether any of the files already exists...
+	QStringList existingPaths;
+	QStringListIterator file_iter(exportPaths);
+	while (file_iter.hasNext()) {
+		const QString& sPath = file_iter.next();
+		if (QFileInfo(sPath).exists())
+			existingPaths.append(sPath);
+	}
+	if (!existingPaths.isEmpty()) {
 		if (QMessageBox::warning(this,
 			tr("Warning"),
 			tr("The file already exists:\n\n"
 			"\"%1\"\n\n"
 			"Do you want to replace it?")
-			.arg(sExportPath),
+			.arg(existingPaths.join("\"\n\"")),
 			QMessageBox::Ok | QMessageBox::Cancel) == QMessageBox::Cancel) {
 			m_ui.ExportPathComboBox->setFocus();
 			return;
@@ -765,26 +825,43 @@ void qtractorExportTrackForm::accept (void)
 		if (pAudioEngine) {
 			// Get the export buses by name...
 			QList<qtractorAudioBus *> exportBuses;
-			QListIterator<QListWidgetItem *> iter(exportBusNameItems);
-			while (iter.hasNext()) {
+			QStringList stemPaths;
+			const int iExportBuses = exportBusNameItems.count();
+			for (int i = 0; i < iExportBuses; ++i) {
 				qtractorAudioBus *pExportBus
 					= static_cast<qtractorAudioBus *> (
-						pAudioEngine->findOutputBus(iter.next()->text()));
-				if (pExportBus)
+						pAudioEngine->findOutputBus(
+							exportBusNameItems.at(i)->text()));
+				if (pExportBus) {
 					exportBuses.append(pExportBus);
+					// One file per bus (stems)...
+					if (bStems)
+						stemPaths.append(exportPaths.at(i));
+				}
 			}
+			if (bStems)
+				exportPaths = stemPaths;
 			// Log this event...
 			pMainForm->appendMessages(
 				tr("Audio file export: \"%1\" started...")
-				.arg(sExportPath));
+				.arg(exportPaths.join("\", \"")));
 			// Do the export as commanded...
 			QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
 			// Go...
-			const bool bResult = pAudioEngine->fileExport(
-				sExportPath, exportBuses,
-				m_ui.ExportStartSpinBox->value(),
-				m_ui.ExportEndSpinBox->value(),
-				audioExportFormat());
+			bool bResult = false;
+			if (bStems) {
+				bResult = pAudioEngine->fileExportStems(
+					exportPaths, exportBuses,
+					m_ui.ExportStartSpinBox->value(),
+					m_ui.ExportEndSpinBox->value(),
+					audioExportFormat());
+			} else {
+				bResult = pAudioEngine->fileExport(
+					sExportPath, exportBuses,
+					m_ui.ExportStartSpinBox->value(),
+					m_ui.ExportEndSpinBox->value(),
+					audioExportFormat());
+			}
 			// Done.
 			QApplication::restoreOverrideCursor();
 			if (bResult) {
@@ -792,22 +869,25 @@ void qtractorExportTrackForm::accept (void)
 				qtractorTracks *pTracks = pMainForm->tracks();
 				if (pTracks && m_ui.AddTrackCheckBox->isChecked()) {
 					pTracks->addAudioTracks(
-						QStringList(sExportPath),
+						exportPaths,
 						pAudioEngine->exportStart(),
 						pAudioEngine->exportOffset(),
 						pAudioEngine->exportLength(),
 						pTracks->currentTrack());
+				} else {
+					QStringListIterator path_iter(exportPaths);
+					while (path_iter.hasNext())
+						pMainForm->addAudioFile(path_iter.next());
 				}
-				else pMainForm->addAudioFile(sExportPath);
 				// Log the success...
 				pMainForm->appendMessages(
 					tr("Audio file export: \"%1\" complete.")
-					.arg(sExportPath));
+					.arg(exportPaths.join("\", \"")));
 			} else {
 				// Log the failure...
 				pMainForm->appendMessagesError(
 					tr("Audio file export:\n\n\"%1\"\n\nfailed.")
-					.arg(sExportPath));
+					.arg(exportPaths.join("\", \"")));
 			}
 			// HACK: Reset all (internal) MIDI controllers...
 			qtractorMidiEngine *pMidiEngine = pSession->midiEngine();
@@ -926,6 +1006,9 @@ qtractorExportClipForm::qtractorExportClipForm ( QWidget *pParent )
 	m_ui.AddTrackCheckBox->setEnabled(false);
 	m_ui.AddTrackCheckBox->setVisible(false);
 
+	m_ui.StemsCheckBox->setEnabled(false);
+	m_ui.StemsCheckBox->setVisible(false);
+
 	adjustSize();
 }
 
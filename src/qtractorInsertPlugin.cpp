@@ -27,6 +27,7 @@
 #include "qtractorSession.h"
 #include "qtractorSessionCursor.h"
 #include "qtractorAudioEngine.h"
+#include "qtractorAudioRender.h"
 #include "qtractorMidiEngine.h"
 #include "qtractorMidiManager.h"
 
@@ -1200,6 +1201,23 @@ const QString& qtractorMidiAuxSendPluginType::aboutText (void)
 // qtractorAudioAuxSendPlugin -- Audio aux-send pseudo-plugin instance.
 //
 
+// Audio track render graph topology change notifier.
+static void qtractorAudioAuxSendPlugin_resetGraph (void)
+{
+	qtractorSession *pSession = qtractorSession::getInstance();
+	if (pSession == nullptr)
+		return;
+
+	qtractorAudioEngine *pAudioEngine = pSession->audioEngine();
+	if (pAudioEngine == nullptr)
+		return;
+
+	qtractorAudioRender *pAudioRender = pAudioEngine->audioRender();
+	if (pAudioRender)
+		pAudioRender->resetGraph();
+}
+
+
 // Constructors.
 qtractorAudioAuxSendPlugin::qtractorAudioAuxSendPlugin (
 	qtractorPluginList *pList, qtractorAuxSendPluginType *pAuxSendType )
@@ -1344,6 +1362,8 @@ void qtractorAudioAuxSendPlugin::setAudioBusName ( const QString& sAudioBusName
 	}
 
 	updateAudioBusName();
+
+	qtractorAudioAuxSendPlugin_resetGraph();
 }
 
 const QString& qtractorAudioAuxSendPlugin::audioBusName (void) const
@@ -1392,12 +1412,18 @@ void qtractorAudioAuxSendPlugin::process (
 // Do the actual activation.
 void qtractorAudioAuxSendPlugin::activate (void)
 {
+	list()->setAudioAuxSendActivated(true);
+
+	qtractorAudioAuxSendPlugin_resetGraph();
 }
 
 
 // Do the actual deactivation.
 void qtractorAudioAuxSendPlugin::deactivate (void)
 {
+	list()->setAudioAuxSendActivated(false);
+
+	qtractorAudioAuxSendPlugin_resetGraph();
 }
 
 
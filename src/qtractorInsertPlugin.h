@@ -348,6 +348,10 @@ public:
 	// The main plugin processing procedure.
 	void process(float **ppIBuffer, float **ppOBuffer, unsigned int nframes);
 
+	// Plugin declared tail length (none).
+	long tailLength() const
+		{ return 0; }
+
 	// Plugin configuration handlers.
 	void configure(const QString& sKey, const QString& sValue);
 
@@ -359,6 +363,9 @@ public:
 	void setAudioBusName(const QString& sAudioBusName);
 	const QString& audioBusName() const;
 
+	qtractorAudioBus *audioBus() const
+		{ return m_pAudioBus; }
+
 	// Audio bus to appear on plugin lists.
 	void updateAudioBusName() const;
 
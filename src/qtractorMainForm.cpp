@@ -40,6 +40,10 @@
 
 #include "qtractorAudioPeak.h"
 #include "qtractorAudioBuffer.h"
+#include "qtractorAudioCache.h"
+#include "qtractorAudioStretch.h"
+#include "qtractorAudioSndFile.h"
+#include "qtractorAudioRender.h"
 #include "qtractorAudioEngine.h"
 #include "qtractorMidiEngine.h"
 
@@ -267,6 +271,7 @@ qtractorMainForm::qtractorMainForm (
 	m_iXrunTimer = 0;
 
 	m_iAudioPeakTimer = 0;
+	m_iAudioStretchTimer = 0;
 
 	m_iAudioRefreshTimer = 0;
 	m_iMidiRefreshTimer  = 0;
@@ -289,6 +294,15 @@ qtractorMainForm::qtractorMainForm (
 			SLOT(audioPeakNotify()));
 	}
 
+	// Configure the audio clip time-stretch render cache...
+	qtractorAudioStretchCache *pAudioStretchCache
+		= m_pSession->audioStretchCache();
+	if (pAudioStretchCache) {
+		QObject::connect(pAudioStretchCache,
+			SIGNAL(renderEvent()),
+			SLOT(audioStretchNotify()));
+	}
+
 	// Configure the audio engine event handling...
 	const qtractorAudioEngineProxy *pAudioEngineProxy = nullptr;
 	qtractorAudioEngine *pAudioEngine = m_pSession->audioEngine();
@@ -1512,6 +1526,30 @@ void qtractorMainForm::setup ( qtractorOptions *pOptions )
 		m_pOptions->bAudioWsolaTimeStretch);
 	qtractorAudioBuffer::setDefaultWsolaQuickSeek(
 		m_pOptions->bAudioWsolaQuickSeek);
+	// Set default audio track rendering threads...
+	qtractorAudioRender::setDefaultRenderThreads(
+		m_pOptions->iAudioRenderThreads);
+	// Set default audio disk-streaming threads...
+	qtractorAudioBufferThread::setDefaultSyncThreads(
+		m_pOptions->iAudioSyncThreads);
+	// Set default audio peak-file generation threads...
+	qtractorAudioPeakFactory::setDefaultPeakThreads(
+		m_pOptions->iPeakThreads);
+	// Set default audio clip RAM cache limits...
+	qtractorAudioCache::setDefaultMaxSize(
+		m_pOptions->iAudioCacheSize);
+	qtractorAudioCache::setDefaultThreshold(
+		m_pOptions->iAudioCacheThreshold);
+	qtractorAudioStretchCache::setDefaultEnabled(
+		m_pOptions->bAudioStretchCache);
+	qtractorAudioStretchCache::setDefaultResampleEnabled(
+		m_pOptions->bAudioResampleCache);
+	qtractorAudioSndFile::setDefaultPreallocSize(
+		m_pOptions->iAudioCapturePrealloc);
+	qtractorAudioClip::setDefaultCrossFade(
+		m_pOptions->bAudioCrossFade);
+	qtractorMidiEngine::setDefaultJackOutput(
+		m_pOptions->bMidiJackOutput);
 	qtractorTrack::setTrackColorSaturation(
 		m_pOptions->iTrackColorSaturation);
 
@@ -1527,8 +1565,10 @@ void qtractorMainForm::setup ( qtractorOptions *pOptions )
 
 	// Some special defaults...
 	qtractorAudioEngine *pAudioEngine = m_pSession->audioEngine();
-	if (pAudioEngine)
+	if (pAudioEngine) {
 		pAudioEngine->setMasterAutoConnect(m_pOptions->bAudioMasterAutoConnect);
+		pAudioEngine->setPreRollTime(m_pOptions->fAudioPreRollTime);
+	}
 	
 	// Final widget slot connections....
 	QObject::connect(m_pFileSystem->toggleViewAction(),
@@ -5140,6 +5180,11 @@ void qtractorMainForm::viewOptions (void)
 	const bool    bOldWsolaQuickSeek     = m_pOptions->bAudioWsolaQuickSeek;
 	const bool    bOldAudioPlayerAutoConnect = m_pOptions->bAudioPlayerAutoConnect;
 	const bool    bOldAudioPlayerBus     = m_pOptions->bAudioPlayerBus;
+	const int     iOldAudioRenderThreads = m_pOptions->iAudioRenderThreads;
+	const int     iOldAudioSyncThreads   = m_pOptions->iAudioSyncThreads;
+	const int     iOldPeakThreads        = m_pOptions->iPeakThreads;
+	const bool    bOldAudioStretchCache  = m_pOptions->bAudioStretchCache;
+	const bool    bOldAudioResampleCache = m_pOptions->bAudioResampleCache;
 	const bool    bOldAudioMetronome     = m_pOptions->bAudioMetronome;
 	const int     iOldTransportMode      = m_pOptions->iTransportMode;
 	const bool    bOldTimebase           = m_pOptions->bTimebase;
@@ -5151,6 +5196,7 @@ void qtractorMainForm::viewOptions (void)
 	const int     iOldMidiCaptureQuantize = m_pOptions->iMidiCaptureQuantize;
 	const int     iOldMidiQueueTimer     = m_pOptions->iMidiQueueTimer;
 	const bool    bOldMidiDriftCorrect   = m_pOptions->bMidiDriftCorrect;
+	const bool    bOldMidiJackOutput     = m_pOptions->bMidiJackOutput;
 	const bool    bOldMidiPlayerBus      = m_pOptions->bMidiPlayerBus;
 	const QString sOldMetroBarFilename   = m_pOptions->sMetroBarFilename;
 	const float   fOldMetroBarGain       = m_pOptions->fMetroBarGain;
@@ -5204,6 +5250,52 @@ void qtractorMainForm::viewOptions (void)
 				m_pOptions->bAudioWsolaQuickSeek);
 			iNeedRestart |= RestartSession;
 		}
+		// Audio performance options...
+		if (iOldAudioRenderThreads != m_pOptions->iAudioRenderThreads) {
+			qtractorAudioRender::setDefaultRenderThreads(
+				m_pOptions->iAudioRenderThreads);
+			iNeedRestart |= RestartProgram;
+		}
+		if (iOldAudioSyncThreads != m_pOptions->iAudioSyncThreads) {
+			qtractorAudioBufferThread::setDefaultSyncThreads(
+				m_pOptions->iAudioSyncThreads);
+			iNeedRestart |= RestartProgram;
+		}
+		if (iOldPeakThreads != m_pOptions->iPeakThreads) {
+			qtractorAudioPeakFactory::setDefaultPeakThreads(
+				m_pOptions->iPeakThreads);
+			iNeedRestart |= RestartProgram;
+		}
+		if (( bOldAudioStretchCache && !m_pOptions->bAudioStretchCache) ||
+			(!bOldAudioStretchCache &&  m_pOptions->bAudioStretchCache)) {
+			qtractorAudioStretchCache::setDefaultEnabled(
+				m_pOptions->bAudioStretchCache);
+			iNeedRestart |= RestartSession;
+		}
+		if (( bOldAudioResampleCache && !m_pOptions->bAudioResampleCache) ||
+			(!bOldAudioResampleCache &&  m_pOptions->bAudioResampleCache)) {
+			qtractorAudioStretchCache::setDefaultResampleEnabled(
+				m_pOptions->bAudioResampleCache);
+			iNeedRestart |= RestartSession;
+		}
+		qtractorAudioCache::setDefaultMaxSize(
+			m_pOptions->iAudioCacheSize);
+		qtractorAudioCache::setDefaultThreshold(
+			m_pOptions->iAudioCacheThreshold);
+		qtractorAudioSndFile::setDefaultPreallocSize(
+			m_pOptions->iAudioCapturePrealloc);
+		qtractorAudioClip::setDefaultCrossFade(
+			m_pOptions->bAudioCrossFade);
+		if (m_pSession->audioEngine())
+			m_pSession->audioEngine()->setPreRollTime(
+				m_pOptions->fAudioPreRollTime);
+		// MIDI engine output mode...
+		if (( bOldMidiJackOutput && !m_pOptions->bMidiJackOutput) ||
+			(!bOldMidiJackOutput &&  m_pOptions->bMidiJackOutput)) {
+			qtractorMidiEngine::setDefaultJackOutput(
+				m_pOptions->bMidiJackOutput);
+			iNeedRestart |= RestartSession;
+		}
 		// Audio engine control modes...
 		if (iOldTransportMode != m_pOptions->iTransportMode) {
 			++m_iDirtyCount; // Fake session properties change.
@@ -6081,6 +6173,11 @@ bool qtractorMainForm::setPlaying ( bool bPlaying )
 		}
 		// Stop transport rolling, immediately...
 		setRolling(0);
+		// MIDI output statistics, for the record...
+		const QString& sMidiOutputStats
+			= m_pSession->midiEngine()->outputStatsText();
+		if (!sMidiOutputStats.isEmpty())
+			appendMessages(sMidiOutputStats);
 		// Session tracks automation recording.
 		qtractorCurveCaptureListCommand *pCurveCommand = nullptr;
 		for (qtractorTrack *pTrack = m_pSession->tracks().first();
@@ -7676,6 +7773,10 @@ void qtractorMainForm::fastTimerSlot (void)
 	qtractorAudioEngine *pAudioEngine = m_pSession->audioEngine();
 	qtractorMidiEngine  *pMidiEngine  = m_pSession->midiEngine();
 
+	// Upcoming clips read-ahead schedule...
+	if (pAudioEngine)
+		pAudioEngine->updatePreRoll();
+
 	// Playhead status...
 	if (iPlayHead != long(m_iPlayHead)) {
 		// Update tracks-view play-head...
@@ -7752,6 +7853,11 @@ void qtractorMainForm::fastTimerSlot (void)
 		// Done with transport tricks.
 	}
 
+	// Audio track render graph, on any topology change...
+	qtractorAudioRender *pAudioRender = pAudioEngine->audioRender();
+	if (pAudioRender && pAudioRender->isGraphDirty())
+		pAudioRender->updateGraph();
+
 	// Always update meter values...
 	qtractorMeterValue::refreshAll();
 
@@ -7930,6 +8036,13 @@ void qtractorMainForm::slowTimerSlot (void)
 		m_pTracks->trackView()->updateContents();
 	}
 
+	// Check if pre-rendered audio clips are ready to switch over...
+	if (m_iAudioStretchTimer > 0) {
+		m_iAudioStretchTimer = 0;
+		if (qtractorAudioClip::updateStretchRenders())
+			m_iAudioStretchTimer = 1;
+	}
+
 	// Check if its time to refresh Audio connections...
 	if (m_iAudioRefreshTimer > 0 && --m_iAudioRefreshTimer < 1) {
 		m_iAudioRefreshTimer = 0;
@@ -8029,6 +8142,16 @@ void qtractorMainForm::audioPeakNotify (void)
 }
 
 
+// Custom audio time-stretch render event handler.
+void qtractorMainForm::audioStretchNotify (void)
+{
+	// A pre-rendered time-stretch or sample-rate converted
+	// file is now ready; switch over any live processing clips...
+	if (qtractorAudioClip::updateStretchRenders())
+		m_iAudioStretchTimer = 1;
+}
+
+
 // Custom audio shutdown event handler.
 void qtractorMainForm::audioShutNotify (void)
 {
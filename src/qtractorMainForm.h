@@ -308,6 +308,7 @@ protected slots:
 	void alsaNotify();
 
 	void audioPeakNotify();
+	void audioStretchNotify();
 	void audioShutNotify();
 	void audioXrunNotify();
 	void audioPortNotify();
@@ -505,6 +506,7 @@ private:
 	int m_iXrunSkip;
 	int m_iXrunTimer;
 	int m_iAudioPeakTimer;
+	int m_iAudioStretchTimer;
 	int m_iAudioRefreshTimer;
 	int m_iMidiRefreshTimer;
 	int m_iPlayerTimer;
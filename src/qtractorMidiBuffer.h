@@ -24,6 +24,8 @@
 
 #include "qtractorList.h"
 
+#include <QAtomicInt>
+
 #include <alsa/asoundlib.h>
 
 
@@ -149,6 +151,23 @@ public:
 		}
 	}
 
+	// Remove events of a given tag (not RT-safe; reader
+	// and writer must both be held off meanwhile).
+	void remove(unsigned char iTag)
+	{
+		unsigned int j = m_iReadIndex;
+		unsigned int i = j;
+		while (i != m_iWriteIndex) {
+			if (m_pBuffer[i].tag != iTag) {
+				if (j != i)
+					m_pBuffer[j] = m_pBuffer[i];
+				++j &= m_iBufferMask;
+			}
+			++i &= m_iBufferMask;
+		}
+		m_iWriteIndex = j;
+	}
+
 private:
 
 	// Instance variables.
@@ -160,6 +179,93 @@ private:
 };
 
 
+//----------------------------------------------------------------------
+// class qtractorMidiQueue -- MIDI event lock-free queue declaration
+// (bounded, multi-producer, single-consumer; cf. D. Vyukov).
+//
+
+class qtractorMidiQueue
+{
+public:
+
+	// Constructor.
+	qtractorMidiQueue(unsigned int iBufferSize = qtractorMidiBuffer::MinBufferSize) :
+		m_pBuffer(nullptr), m_iBufferSize(0), m_iBufferMask(0), m_iReadIndex(0)
+	{
+		// Adjust size to nearest power-of-two, if necessary.
+		m_iBufferSize = qtractorMidiBuffer::MinBufferSize;
+		while (m_iBufferSize < iBufferSize)
+			m_iBufferSize <<= 1;
+		m_iBufferMask = (m_iBufferSize - 1);
+		m_pBuffer = new Slot [m_iBufferSize];
+		for (unsigned int i = 0; i < m_iBufferSize; ++i)
+			m_pBuffer[i].seq.storeRelease(int(i));
+		m_iWriteIndex.storeRelease(0);
+	}
+
+	// Destructor.
+	~qtractorMidiQueue() { if (m_pBuffer) delete [] m_pBuffer; }
+
+	// Implementation properties.
+	unsigned int bufferSize() const { return m_iBufferSize; }
+
+	// Write event to queue (any thread, lock-free).
+	bool push(const snd_seq_event_t *pEvent, unsigned long iTick = 0)
+	{
+		unsigned int iWriteIndex = m_iWriteIndex.loadAcquire();
+		Slot *pSlot;
+		for (;;) {
+			pSlot = &m_pBuffer[iWriteIndex & m_iBufferMask];
+			const int iDiff
+				= int(unsigned(pSlot->seq.loadAcquire()) - iWriteIndex);
+			if (iDiff == 0) {
+				if (m_iWriteIndex.testAndSetOrdered(
+						int(iWriteIndex), int(iWriteIndex + 1)))
+					break;
+			}
+			else
+			if (iDiff < 0)
+				return false;	// Full.
+			iWriteIndex = m_iWriteIndex.loadAcquire();
+		}
+		pSlot->event = *pEvent;
+		pSlot->event.time.tick = iTick;
+		pSlot->seq.storeRelease(int(iWriteIndex + 1));
+		return true;
+	}
+
+	// Read event from queue (single consumer only).
+	bool pop(snd_seq_event_t *pEvent)
+	{
+		Slot *pSlot = &m_pBuffer[m_iReadIndex & m_iBufferMask];
+		const int iDiff
+			= int(unsigned(pSlot->seq.loadAcquire()) - (m_iReadIndex + 1));
+		if (iDiff < 0)
+			return false;	// Empty (or still being written).
+		*pEvent = pSlot->event;
+		pSlot->seq.storeRelease(int(m_iReadIndex + m_iBufferSize));
+		++m_iReadIndex;
+		return true;
+	}
+
+private:
+
+	// Queue slot, sequence tagged.
+	struct Slot
+	{
+		QAtomicInt      seq;
+		snd_seq_event_t event;
+	};
+
+	// Instance variables.
+	Slot        *m_pBuffer;
+	unsigned int m_iBufferSize;
+	unsigned int m_iBufferMask;
+	QAtomicInt   m_iWriteIndex;
+	unsigned int m_iReadIndex;
+};
+
+
 #endif  // __qtractorMidiBuffer_h
 
 // end of qtractorMidiBuffer.h
@@ -946,10 +946,16 @@ void qtractorMidiClip::process (
 	const bool bMute = (pTrack->isMute()
 		|| (pSession->soloTracks() && !pTrack->isSolo()));
 
-	const unsigned long t0 = pSession->tickFromFrame(clipStart());
+	// Tempo-map snapshot, no node seeking...
+	const qtractorTimeScale::Map *pMap = pSession->timeScale()->map();
+
+	const unsigned long iClipStart = clipStart();
+	const unsigned long t0 = pMap->tickFromFrame(iClipStart);
+
+	const unsigned long iTimeStart = pMap->tickFromFrame(iFrameStart);
+	const unsigned long iTimeEnd   = pMap->tickFromFrame(iFrameEnd);
 
-	const unsigned long iTimeStart = pSession->tickFromFrame(iFrameStart);
-	const unsigned long iTimeEnd   = pSession->tickFromFrame(iFrameEnd);
+	unsigned int iMap = pMap->seekTick(iTimeStart);
 
 	// Enqueue the requested events...
 	const float fGain = clipGain();
@@ -962,7 +968,7 @@ void qtractorMidiClip::process (
 		if (t1 >= iTimeStart
 			&& (!bMute || pEvent->type() != qtractorMidiEvent::NOTEON))
 			pMidiEngine->enqueue(pTrack, pEvent, t1, fGain
-				* fadeInOutGain(pSession->frameFromTick(t1) - clipStart()));
+				* fadeInOutGain(pMap->frameFromTick(t1, iMap) - iClipStart));
 		pEvent = pEvent->next();
 	}
 }
@@ -988,10 +994,16 @@ void qtractorMidiClip::process_export (
 	const bool bMute = (pTrack->isMute()
 		|| (pSession->soloTracks() && !pTrack->isSolo()));
 
-	const unsigned long t0 = pSession->tickFromFrame(clipStart());
+	// Tempo-map snapshot, no node seeking...
+	const qtractorTimeScale::Map *pMap = pSession->timeScale()->map();
+
+	const unsigned long iClipStart = clipStart();
+	const unsigned long t0 = pMap->tickFromFrame(iClipStart);
+
+	const unsigned long iTimeStart = pMap->tickFromFrame(iFrameStart);
+	const unsigned long iTimeEnd   = pMap->tickFromFrame(iFrameEnd);
 
-	const unsigned long iTimeStart = pSession->tickFromFrame(iFrameStart);
-	const unsigned long iTimeEnd   = pSession->tickFromFrame(iFrameEnd);
+	unsigned int iMap = pMap->seekTick(iTimeStart);
 
 	// Enqueue the requested events...
 	const float fGain = clipGain();
@@ -1004,7 +1016,7 @@ void qtractorMidiClip::process_export (
 		if (t1 >= iTimeStart
 			&& (!bMute || pEvent->type() != qtractorMidiEvent::NOTEON)) {
 			enqueue_export(pTrack, pEvent, t1, fGain
-				* fadeInOutGain(pSession->frameFromTick(t1) - clipStart()));
+				* fadeInOutGain(pMap->frameFromTick(t1, iMap) - iClipStart));
 		}
 		pEvent = pEvent->next();
 	}
@@ -1454,7 +1466,8 @@ bool qtractorMidiClip::clipExport (
 			pEvent; pEvent = pEvent->next()) {
 		const unsigned long iTime = pEvent->time();
 		if (iTime >= iTimeStart && iTime < iTimeEnd) {
-			qtractorMidiEvent *pNewEvent = new qtractorMidiEvent(*pEvent);
+			qtractorMidiEvent *pNewEvent
+				= new (seq.arena()) qtractorMidiEvent(*pEvent);
 			pNewEvent->setTime(iTime - iTimeStart);
 			if (pNewEvent->type() == qtractorMidiEvent::NOTEON) {
 				pNewEvent->setVelocity((unsigned char)
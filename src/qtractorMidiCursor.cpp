@@ -42,25 +42,22 @@ qtractorMidiEvent *qtractorMidiCursor::seek (
 		m_pEvent = pSeq->events().first();
 	}
 	else
-	if (iTime > m_iTime) {
+	if (iTime != m_iTime) {
+		// Nearest checkpoint, unless current is closer...
+		qtractorMidiEvent *pEvent = pSeq->seekEvent(iTime);
+		if (m_pEvent && iTime > m_iTime
+			&& (pEvent == nullptr || m_pEvent->time() >= pEvent->time()))
+			pEvent = m_pEvent;
+		if (pEvent == nullptr)
+			pEvent = pSeq->events().first();
 		// Seek forward...
-		if (m_pEvent == nullptr)
-			m_pEvent = pSeq->events().first();
-		while (m_pEvent && m_pEvent->next()
-			&& (m_pEvent->next())->time() < iTime)
-			m_pEvent = m_pEvent->next();
-		if (m_pEvent == nullptr)
-			m_pEvent = pSeq->events().last();
-	}
-	else
-	if (iTime < m_iTime) {
+		while (pEvent && pEvent->next()
+			&& (pEvent->next())->time() < iTime)
+			pEvent = pEvent->next();
 		// Seek backward...
-		if (m_pEvent == nullptr)
-			m_pEvent = pSeq->events().last();
-		while (m_pEvent && m_pEvent->time() >= iTime)
-			m_pEvent = m_pEvent->prev();
-		if (m_pEvent == nullptr)
-			m_pEvent = pSeq->events().first();
+		while (pEvent && pEvent->time() >= iTime && pEvent->prev())
+			pEvent = pEvent->prev();
+		m_pEvent = pEvent;
 	}
 	// Done.
 	m_iTime = iTime;
@@ -214,6 +214,9 @@ bool qtractorMidiEditCommand::execute ( bool bRedo )
 	// Adjust edit-command result to prevent event overlapping.
 	if (bRedo && !m_bAdjusted) m_bAdjusted = adjust();
 
+	// Publish the time index amendments, once and for all.
+	pSeq->commitIndex();
+
 	// Or are we changing something more durable?
 	if (pSeq->duration() != iOldDuration) {
 		pSeq->setTimeLength(pSeq->duration());
@@ -53,6 +53,8 @@
 
 #include <QElapsedTimer>
 
+#include <jack/midiport.h>
+
 #include <cmath>
 
 
@@ -74,6 +76,16 @@
 #define DRIFT_CHECK_MIN     (DRIFT_CHECK >> 2)
 #define DRIFT_CHECK_MAX     (DRIFT_CHECK << 1)
 
+// Scheduled output ALSA buffer and pool sizes.
+#define OUTPUT_BUFFER_SIZE  (1 << 16)
+#define OUTPUT_POOL_SIZE    2000
+
+// JACK MIDI output event buffer size (per bus).
+#define JACK_MIDI_BUFFER_SIZE (qtractorMidiBuffer::MinBufferSize << 2)
+
+// Maximum raw MIDI event size (JACK MIDI output).
+#define JACK_MIDI_DATA_SIZE 512
+
 
 //----------------------------------------------------------------------
 // class qtractorMidiInputRpn -- MIDI RPN/NRPN input parser (singleton).
@@ -164,6 +176,15 @@ public:
 	// MIDI output flush/drain (locked).
 	void flushSync();
 
+	// JACK MIDI output pending events drop (locked).
+	void jackMidiResetSync(qtractorMidiBus *pMidiBus, int iTag = -1);
+
+	// MIDI output idle check-point (non-blocking).
+	bool idleSync();
+
+	// Scheduled output event from elsewhere (locked).
+	void outputEventSync(snd_seq_event_t *pEv);
+
 	// Wake from executive wait condition.
 	void sync();
 
@@ -614,7 +635,7 @@ void qtractorMidiOutputThread::process (void)
 	pMidiCursor->process(m_iReadAhead);
 
 	// Flush the MIDI engine output queue...
-	snd_seq_drain_output(m_pMidiEngine->alsaSeq());
+	m_pMidiEngine->drainOutput();
 
 	// Always do the queue drift stats
 	// at the bottom of the pack...
@@ -640,7 +661,41 @@ void qtractorMidiOutputThread::flushSync (void)
 #ifdef CONFIG_DEBUG_0
 	qDebug("qtractorMidiOutputThread[%p]::flushSync()", this);
 #endif
-	snd_seq_drain_output(m_pMidiEngine->alsaSeq());
+	m_pMidiEngine->drainOutput();
+}
+
+
+// JACK MIDI output pending events drop (locked).
+void qtractorMidiOutputThread::jackMidiResetSync (
+	qtractorMidiBus *pMidiBus, int iTag )
+{
+	QMutexLocker locker(&m_mutex);
+#ifdef CONFIG_DEBUG_0
+	qDebug("qtractorMidiOutputThread[%p]::jackMidiResetSync(%p, %d)",
+		this, pMidiBus, iTag);
+#endif
+	pMidiBus->jackMidiReset(iTag);
+}
+
+
+// MIDI output idle check-point: whether there's no output
+// process cycle in flight right now (non-blocking).
+bool qtractorMidiOutputThread::idleSync (void)
+{
+	if (!m_mutex.tryLock())
+		return false;
+
+	m_mutex.unlock();
+	return true;
+}
+
+
+// Scheduled output event from elsewhere (locked).
+void qtractorMidiOutputThread::outputEventSync ( snd_seq_event_t *pEv )
+{
+	QMutexLocker locker(&m_mutex);
+
+	m_pMidiEngine->outputEvent(pEv);
 }
 
 
@@ -684,7 +739,7 @@ void qtractorMidiOutputThread::trackSync (
 	}
 
 	// Surely must realize the output queue...
-	snd_seq_drain_output(m_pMidiEngine->alsaSeq());
+	m_pMidiEngine->drainOutput();
 }
 
 
@@ -710,7 +765,7 @@ void qtractorMidiOutputThread::metroSync ( unsigned long iFrameStart )
 	m_pMidiEngine->processMetro(iFrameStart, iFrameEnd);
 
 	// Surely must realize the output queue...
-	snd_seq_drain_output(m_pMidiEngine->alsaSeq());
+	m_pMidiEngine->drainOutput();
 }
 
 
@@ -1124,15 +1179,14 @@ void qtractorMidiPlayer::enqueue ( unsigned short iMidiChannel,
 		qtractorMidiManager *pMidiManager
 			= (m_pMidiBus->pluginList_out())->midiManager();
 		if (pMidiManager) {
-			qtractorTimeScale::Cursor& cursor = m_pTimeScale->cursor();
-			qtractorTimeScale::Node *pNode = cursor.seekTick(iTime);
-			const unsigned long t1 = pNode->frameFromTick(iTime);
+			const qtractorTimeScale::Map *pMap = m_pTimeScale->map();
+			unsigned int iMap = pMap->seekTick(iTime);
+			const unsigned long t1 = pMap->frameFromTick(iTime, iMap);
 			unsigned long t2 = t1;
 			if (ev.type == SND_SEQ_EVENT_NOTE
 				&& ev.data.note.duration > 0) {
 				iTime += (ev.data.note.duration - 1);
-				pNode = cursor.seekTick(iTime);
-				t2 += (pNode->frameFromTick(iTime) - t1);
+				t2 += (pMap->frameFromTick(iTime, iMap) - t1);
 			}
 			pMidiManager->queued(&ev, t1, t2);
 		}
@@ -1188,6 +1242,10 @@ unsigned long qtractorMidiPlayer::queueFrame (void) const
 // class qtractorMidiEngine -- ALSA sequencer client instance (singleton).
 //
 
+// JACK MIDI output mode global default.
+bool qtractorMidiEngine::g_bDefaultJackOutput = false;
+
+
 // Constructor.
 qtractorMidiEngine::qtractorMidiEngine ( qtractorSession *pSession )
 	: qtractorEngine(pSession, qtractorTrack::Midi)
@@ -1268,6 +1326,17 @@ qtractorMidiEngine::qtractorMidiEngine ( qtractorSession *pSession )
 	// MIDI Clock tempo tracking.
 	m_iClockCount = 0;
 	m_fClockTempo = 120.0f;
+
+	// Scheduled output state.
+	m_bOutputPending = false;
+	m_iOutputWindow = 0;
+
+	resetOutputStats();
+
+	// JACK MIDI output mode.
+	m_bJackOutput = false;
+
+	ATOMIC_SET(&m_jackMidiPortsLock, 0);
 }
 
 
@@ -1326,6 +1395,14 @@ void qtractorMidiEngine::sync (void)
 }
 
 
+// Output thread idle check-point (non-blocking): when true,
+// nothing that was unpublished before may still be in use.
+bool qtractorMidiEngine::outputIdleSync (void)
+{
+	return (m_pOutputThread == nullptr || m_pOutputThread->idleSync());
+}
+
+
 // Read ahead frames configuration.
 void qtractorMidiEngine::setReadAhead ( unsigned int iReadAhead )
 {
@@ -1841,8 +1918,8 @@ void qtractorMidiEngine::capture ( snd_seq_event_t *pEv )
 					}
 					// Yep, maybe we have a new MIDI event on record...
 					if (pSeq) {
-						qtractorMidiEvent *pEvent = new qtractorMidiEvent(
-							tick, type, param, value, duration);
+						qtractorMidiEvent *pEvent = new (pSeq->arena())
+							qtractorMidiEvent(tick, type, param, value, duration);
 						if (pSysex)
 							pEvent->setSysex(pSysex, iSysex);
 						pSeq->addEvent(pEvent);
@@ -2108,8 +2185,24 @@ void qtractorMidiEngine::enqueue ( qtractorTrack *pTrack,
 			break;
 	}
 
-	// Pump it into the queue.
-	snd_seq_event_output(m_pAlsaSeq, &ev);
+	// Frame time, relative to playback start...
+	const qtractorTimeScale::Map *pMap = pSession->timeScale()->map();
+	unsigned int iMap = pMap->seekTick(iTime);
+	const long f0 = m_iFrameStart;
+	const unsigned long t0 = pMap->frameFromTick(iTime, iMap);
+	const unsigned long t1 = (long(t0) < f0 ? t0 : t0 - f0);
+	unsigned long t2 = t1;
+
+	if (ev.type == SND_SEQ_EVENT_NOTE && ev.data.note.duration > 0) {
+		const unsigned long iTimeOff = iTime + (ev.data.note.duration - 1);
+		t2 += (pMap->frameFromTick(iTimeOff, iMap) - t0);
+	}
+
+	// Pump it into the JACK MIDI port or the (scheduled) queue.
+	if (m_bJackOutput && pMidiBus->jackMidiPort())
+		pMidiBus->jackMidiQueued(&ev, t1, t2);
+	else
+		outputEvent(&ev);
 
 	// MIDI track monitoring...
 	qtractorMidiMonitor *pMidiMonitor
@@ -2122,19 +2215,6 @@ void qtractorMidiEngine::enqueue ( qtractorTrack *pTrack,
 			pEvent->type(), pEvent->value(), tick);
 
 	// Do it for the MIDI track plugins too...
-	qtractorTimeScale::Cursor& cursor = pSession->timeScale()->cursor();
-	qtractorTimeScale::Node *pNode = cursor.seekTick(iTime);
-	const long f0 = m_iFrameStart;
-	const unsigned long t0 = pNode->frameFromTick(iTime);
-	const unsigned long t1 = (long(t0) < f0 ? t0 : t0 - f0);
-	unsigned long t2 = t1;
-
-	if (ev.type == SND_SEQ_EVENT_NOTE && ev.data.note.duration > 0) {
-		const unsigned long iTimeOff = iTime + (ev.data.note.duration - 1);
-		pNode = cursor.seekTick(iTimeOff);
-		t2 += (pNode->frameFromTick(iTimeOff) - t0);
-	}
-
 	qtractorMidiManager *pMidiManager
 		= (pTrack->pluginList())->midiManager();
 	if (pMidiManager)
@@ -2178,6 +2258,9 @@ void qtractorMidiEngine::driftCheck (void)
 {
 	if (!m_bDriftCorrect)
 		return;
+	// JACK MIDI output is sample-locked to audio already...
+	if (m_bJackOutput)
+		return;
 	if (++m_iDriftCheck < m_iDriftCount)
 		return;
 
@@ -2260,6 +2343,216 @@ void qtractorMidiEngine::driftCheck (void)
 }
 
 
+// Scheduled output event; controllers are held back, just
+// so that any redundant one right after may be merged.
+void qtractorMidiEngine::outputEvent ( snd_seq_event_t *pEv )
+{
+	// Merge a redundant controller on the very same tick, port,
+	// channel, tag (track) and parameter, only when nothing else
+	// got in between (eg. RPN/NRPN sequences stay intact)...
+	if (m_bOutputPending && pEv->type == SND_SEQ_EVENT_CONTROLLER) {
+		snd_seq_event_t *pPrevEv = &m_outputEvent;
+		if (pPrevEv->time.tick == pEv->time.tick
+			&& pPrevEv->queue == pEv->queue
+			&& pPrevEv->source.port == pEv->source.port
+			&& pPrevEv->tag == pEv->tag
+			&& pPrevEv->data.control.channel == pEv->data.control.channel
+			&& pPrevEv->data.control.param == pEv->data.control.param) {
+			pPrevEv->data.control.value = pEv->data.control.value;
+			++m_outputStats.merged;
+			return;
+		}
+	}
+
+	// Any held back one goes out first, in order...
+	submitOutput();
+
+	if (pEv->type == SND_SEQ_EVENT_CONTROLLER) {
+		m_outputEvent = *pEv;
+		m_bOutputPending = true;
+		return;
+	}
+
+	// Straight into the ALSA client output buffer...
+	snd_seq_event_output(m_pAlsaSeq, pEv);
+
+	m_outputStats.bytes += snd_seq_event_length(pEv);
+	++m_outputStats.events;
+	++m_iOutputWindow;
+}
+
+
+// Scheduled output event from elsewhere (locked).
+void qtractorMidiEngine::outputEventSync ( snd_seq_event_t *pEv )
+{
+	if (m_pOutputThread)
+		m_pOutputThread->outputEventSync(pEv);
+	else
+		outputEvent(pEv);
+}
+
+
+// Held back output event submit (into ALSA output buffer).
+void qtractorMidiEngine::submitOutput (void)
+{
+	if (!m_bOutputPending)
+		return;
+
+	m_bOutputPending = false;
+
+	snd_seq_event_output(m_pAlsaSeq, &m_outputEvent);
+
+	m_outputStats.bytes += snd_seq_event_length(&m_outputEvent);
+	++m_outputStats.events;
+	++m_iOutputWindow;
+}
+
+
+// Scheduled output submit and drain (end of read-ahead window).
+void qtractorMidiEngine::drainOutput (void)
+{
+	if (m_pAlsaSeq == nullptr)
+		return;
+
+	submitOutput();
+
+	QElapsedTimer timer;
+	timer.start();
+
+	snd_seq_drain_output(m_pAlsaSeq);
+
+	const unsigned long iDrainTime = timer.nsecsElapsed() / 1000;
+
+	++m_outputStats.windows;
+	m_outputStats.drainTime += iDrainTime;
+	if (m_outputStats.drainTimeMax < iDrainTime)
+		m_outputStats.drainTimeMax = iDrainTime;
+	if (m_outputStats.eventsMax < m_iOutputWindow)
+		m_outputStats.eventsMax = m_iOutputWindow;
+
+	m_iOutputWindow = 0;
+}
+
+
+// Scheduled output statistics (read-ahead windows).
+const qtractorMidiEngine::OutputStats& qtractorMidiEngine::outputStats (void) const
+{
+	return m_outputStats;
+}
+
+void qtractorMidiEngine::resetOutputStats (void)
+{
+	::memset(&m_outputStats, 0, sizeof(m_outputStats));
+}
+
+
+// Scheduled output statistics summary.
+QString qtractorMidiEngine::outputStatsText (void) const
+{
+	const OutputStats& stats = m_outputStats;
+	if (stats.windows < 1 || stats.events < 1)
+		return QString();
+
+	return QObject::tr("MIDI output: %1 events (%2 merged), %3 bytes "
+		"in %4 windows, %5 events max.; drain %6 us avg., %7 us max.")
+		.arg(stats.events)
+		.arg(stats.merged)
+		.arg(stats.bytes)
+		.arg(stats.windows)
+		.arg(stats.eventsMax)
+		.arg(stats.drainTime / stats.windows)
+		.arg(stats.drainTimeMax);
+}
+
+
+// Frame time relative to playback start.
+unsigned long qtractorMidiEngine::frameFromStart ( unsigned long iFrame ) const
+{
+	return (long(iFrame) > m_iFrameStart ? iFrame - m_iFrameStart : 0);
+}
+
+
+// JACK MIDI output mode (instead of ALSA sequencer queue).
+bool qtractorMidiEngine::isJackOutput (void) const
+{
+	return m_bJackOutput;
+}
+
+
+// JACK MIDI output processing (audio thread).
+void qtractorMidiEngine::processJackOutput (
+	unsigned long iTimeStart, unsigned long iTimeEnd, unsigned int nframes )
+{
+	if (!m_bJackOutput)
+		return;
+
+	qtractorBus *pBus;
+	for (pBus = buses().first(); pBus; pBus = pBus->next()) {
+		qtractorMidiBus *pMidiBus = static_cast<qtractorMidiBus *> (pBus);
+		if (pMidiBus && pMidiBus->jackMidiPort())
+			pMidiBus->jackMidiProcess(iTimeStart, iTimeEnd, nframes);
+	}
+	for (pBus = busesEx().first(); pBus; pBus = pBus->next()) {
+		qtractorMidiBus *pMidiBus = static_cast<qtractorMidiBus *> (pBus);
+		if (pMidiBus && pMidiBus->jackMidiPort())
+			pMidiBus->jackMidiProcess(iTimeStart, iTimeEnd, nframes);
+	}
+}
+
+
+// JACK MIDI output ports registry (non-RT).
+void qtractorMidiEngine::addJackMidiPort ( jack_port_t *pJackMidiPort )
+{
+	while (!ATOMIC_TAS(&m_jackMidiPortsLock))
+		QThread::yieldCurrentThread();
+
+	m_jackMidiPorts.append(pJackMidiPort);
+
+	ATOMIC_SET(&m_jackMidiPortsLock, 0);
+}
+
+void qtractorMidiEngine::removeJackMidiPort ( jack_port_t *pJackMidiPort )
+{
+	while (!ATOMIC_TAS(&m_jackMidiPortsLock))
+		QThread::yieldCurrentThread();
+
+	m_jackMidiPorts.removeAll(pJackMidiPort);
+
+	ATOMIC_SET(&m_jackMidiPortsLock, 0);
+}
+
+
+// JACK MIDI output ports clearing, for cycles that can't
+// be processed otherwise, lest the previous cycle events
+// get sent all over again (audio thread).
+void qtractorMidiEngine::clearJackOutput ( unsigned int nframes )
+{
+	if (!ATOMIC_TAS(&m_jackMidiPortsLock))
+		return;
+
+	QListIterator<jack_port_t *> iter(m_jackMidiPorts);
+	while (iter.hasNext()) {
+		void *pJackBuffer = jack_port_get_buffer(iter.next(), nframes);
+		if (pJackBuffer)
+			jack_midi_clear_buffer(pJackBuffer);
+	}
+
+	ATOMIC_SET(&m_jackMidiPortsLock, 0);
+}
+
+
+// JACK MIDI output mode global default (applied on init).
+void qtractorMidiEngine::setDefaultJackOutput ( bool bJackOutput )
+{
+	g_bDefaultJackOutput = bJackOutput;
+}
+
+bool qtractorMidiEngine::isDefaultJackOutput (void)
+{
+	return g_bDefaultJackOutput;
+}
+
+
 // Flush ouput queue (if necessary)...
 void qtractorMidiEngine::flush (void)
 {
@@ -2291,6 +2584,10 @@ bool qtractorMidiEngine::init (void)
 	m_iAlsaClient = snd_seq_client_id(m_pAlsaSeq);
 	m_iAlsaQueue  = snd_seq_alloc_queue(m_pAlsaSeq);
 
+	// Room enough for whole read-ahead windows of scheduled output...
+	snd_seq_set_output_buffer_size(m_pAlsaSeq, OUTPUT_BUFFER_SIZE);
+	snd_seq_set_client_pool_output(m_pAlsaSeq, OUTPUT_POOL_SIZE);
+
 	// Set sequencer queue timer.
 	if (qtractorMidiTimer().indexOf(m_iAlsaTimer) > 0) {
 		qtractorMidiTimer::Key key(m_iAlsaTimer);
@@ -2334,6 +2631,10 @@ bool qtractorMidiEngine::init (void)
 	// Time-scale cursor (tempo/time-signature map)
 	m_pMetroCursor = new qtractorTimeScale::Cursor(pSession->timeScale());
 
+	// JACK MIDI output mode, if applicable...
+	m_bJackOutput = g_bDefaultJackOutput
+		&& pSession->audioEngine()->jackClient() != nullptr;
+
 	return true;
 }
 
@@ -2426,6 +2727,12 @@ bool qtractorMidiEngine::start (void)
 	m_iLastEventTime = 0;
 	m_iLastEventNote = 0;
 
+	// Reset scheduled output state...
+	m_bOutputPending = false;
+	m_iOutputWindow = 0;
+
+	resetOutputStats();
+
 	// Effectively start sequencer queue timer...
 	snd_seq_start_queue(m_pAlsaSeq, m_iAlsaQueue, nullptr);
 	snd_seq_drain_output(m_pAlsaSeq);
@@ -2447,6 +2754,25 @@ void qtractorMidiEngine::stop (void)
 	snd_seq_drop_input(m_pAlsaSeq);
 	snd_seq_drop_output(m_pAlsaSeq);
 
+	// Drop any held back output...
+	m_bOutputPending = false;
+	m_iOutputWindow = 0;
+
+	// Drop any pending JACK MIDI output...
+	if (m_bJackOutput) {
+		qtractorBus *pBus;
+		for (pBus = buses().first(); pBus; pBus = pBus->next()) {
+			qtractorMidiBus *pMidiBus = static_cast<qtractorMidiBus *> (pBus);
+			if (pMidiBus && pMidiBus->jackMidiPort())
+				m_pOutputThread->jackMidiResetSync(pMidiBus);
+		}
+		for (pBus = busesEx().first(); pBus; pBus = pBus->next()) {
+			qtractorMidiBus *pMidiBus = static_cast<qtractorMidiBus *> (pBus);
+			if (pMidiBus && pMidiBus->jackMidiPort())
+				m_pOutputThread->jackMidiResetSync(pMidiBus);
+		}
+	}
+
 	// Stop queue timer...
 	snd_seq_stop_queue(m_pAlsaSeq, m_iAlsaQueue, nullptr);
 
@@ -2613,6 +2939,8 @@ void qtractorMidiEngine::trackMute ( qtractorTrack *pTrack, bool bMute )
 		// Immediate all current notes off.
 		qtractorMidiBus *pMidiBus
 			= static_cast<qtractorMidiBus *> (pTrack->outputBus());
+		if (pMidiBus && pMidiBus->jackMidiPort())
+			m_pOutputThread->jackMidiResetSync(pMidiBus, pTrack->midiTag() & 0xff);
 		if (pMidiBus)
 			pMidiBus->setController(pTrack, ALL_NOTES_OFF);
 		// Clear/reset track monitor...
@@ -2669,6 +2997,8 @@ void qtractorMidiEngine::metroMute ( bool bMute )
 			| SND_SEQ_REMOVE_DEST_CHANNEL | SND_SEQ_REMOVE_IGNORE_OFF
 			| SND_SEQ_REMOVE_TAG_MATCH);
 		snd_seq_remove_events(m_pAlsaSeq, pre);
+		if (m_pMetroBus && m_pMetroBus->jackMidiPort())
+			m_pOutputThread->jackMidiResetSync(m_pMetroBus, 0xff);
 		// Done metronome mute.
 	} else {
 		// Must redirect to MIDI ouput thread:
@@ -3277,8 +3607,8 @@ void qtractorMidiEngine::processMetro (
 			= (unsigned int) (60000000.0f / pNode->tempo);
 		ev.dest.client = SND_SEQ_CLIENT_SYSTEM;
 		ev.dest.port = SND_SEQ_PORT_SYSTEM_TIMER;
-		// Pump it into the queue.
-		snd_seq_event_output(m_pAlsaSeq, &ev);
+		// Pump it into the (scheduled) queue.
+		outputEvent(&ev);
 		// Save for next change.
 		m_fMetroTempo = pNode->tempo;
 		// Update MIDI monitor slot stuff...
@@ -3336,7 +3666,14 @@ void qtractorMidiEngine::processMetro (
 					const unsigned long tick
 						= (long(iTimeClock) > m_iTimeStart ? iTimeClock - m_iTimeStart : 0);
 					snd_seq_ev_schedule_tick(&ev_clock, m_iAlsaQueue, 0, tick);
-					snd_seq_event_output(m_pAlsaSeq, &ev_clock);
+					if (m_bJackOutput && m_pOControlBus
+						&& m_pOControlBus->jackMidiPort()) {
+						const unsigned long t1
+							= frameFromStart(pNode->frameFromTick(iTimeClock));
+						m_pOControlBus->jackMidiQueued(&ev_clock, t1, t1);
+					}
+					else
+						outputEvent(&ev_clock);
 				}
 				iTimeClock += iTicksPerClock;
 			}
@@ -3359,8 +3696,16 @@ void qtractorMidiEngine::processMetro (
 				ev.data.note.velocity = m_iMetroBeatVelocity;
 				ev.data.note.duration = m_iMetroBeatDuration;
 			}
-			// Pump it into the queue.
-			snd_seq_event_output(m_pAlsaSeq, &ev);
+			// Pump it into the JACK MIDI port or the (scheduled) queue.
+			if (m_bJackOutput && m_pMetroBus && m_pMetroBus->jackMidiPort()) {
+				const unsigned long t1
+					= frameFromStart(pNode->frameFromTick(iTimeOffset));
+				const unsigned long t2 = frameFromStart(pNode->frameFromTick(
+					iTimeOffset + ev.data.note.duration));
+				m_pMetroBus->jackMidiQueued(&ev, t1, t2);
+			}
+			else
+				outputEvent(&ev);
 			// MIDI track monitoring...
 			if (m_pMetroBus && m_pMetroBus->midiMonitor_out()) {
 				m_pMetroBus->midiMonitor_out()->enqueue(
@@ -3643,7 +3988,7 @@ bool qtractorMidiEngine::fileExport (
 					pEvent = pEvent->next();
 				while (pEvent && iTimeClip + pEvent->time() < iTimeEnd) {
 					qtractorMidiEvent *pNewEvent
-						= new qtractorMidiEvent(*pEvent);
+						= new (pSeq->arena()) qtractorMidiEvent(*pEvent);
 					pNewEvent->setTime(iTimeOffset + pEvent->time());
 					if (pNewEvent->type() == qtractorMidiEvent::NOTEON) {
 						const unsigned long iTimeEvent
@@ -3853,6 +4198,13 @@ qtractorMidiBus::qtractorMidiBus ( qtractorMidiEngine *pMidiEngine,
 {
 	m_iAlsaPort = -1;
 
+	m_pJackMidiPort   = nullptr;
+	m_pJackDirect     = nullptr;
+	m_pJackOutput     = nullptr;
+	m_pJackQueued     = nullptr;
+	m_pJackPosted     = nullptr;
+	m_pJackMidiParser = nullptr;
+
 	if ((busMode & qtractorBus::Input) && !(busMode & qtractorBus::Ex)) {
 		m_pIMidiMonitor = new qtractorMidiMonitor();
 		m_pIPluginList  = createPluginList(qtractorPluginList::MidiInBus);
@@ -3945,6 +4297,44 @@ bool qtractorMidiBus::open (void)
 	if (snd_seq_set_port_info(pAlsaSeq, m_iAlsaPort, pinfo) < 0)
 		return false;
 
+	// JACK MIDI output port, when in that mode...
+	qtractorSession *pSession = pMidiEngine->session();
+	if (pMidiEngine->isJackOutput() && pSession
+		&& (busMode & qtractorBus::Output)) {
+		jack_client_t *pJackClient = pSession->audioEngine()->jackClient();
+		jack_port_t *pJackMidiPort = nullptr;
+		if (pJackClient) {
+			const QString sPortName(busName() + "/midi_out");
+			pJackMidiPort = jack_port_register(pJackClient,
+				sPortName.toUtf8().constData(),
+				JACK_DEFAULT_MIDI_TYPE,
+				JackPortIsOutput, 0);
+		}
+		if (pJackMidiPort) {
+			// All ready before the audio thread gets to see the port...
+			qtractorMidiQueue *pJackDirect = new qtractorMidiQueue();
+			qtractorMidiQueue *pJackOutput
+				= new qtractorMidiQueue(JACK_MIDI_BUFFER_SIZE);
+			qtractorMidiBuffer *pJackQueued
+				= new qtractorMidiBuffer(JACK_MIDI_BUFFER_SIZE);
+			qtractorMidiBuffer *pJackPosted
+				= new qtractorMidiBuffer(JACK_MIDI_BUFFER_SIZE);
+			snd_midi_event_t *pJackMidiParser = nullptr;
+			if (snd_midi_event_new(JACK_MIDI_DATA_SIZE, &pJackMidiParser) == 0)
+				snd_midi_event_no_status(pJackMidiParser, 1);
+			// Keep the audio thread off for a while...
+			pSession->lock();
+			m_pJackDirect     = pJackDirect;
+			m_pJackOutput     = pJackOutput;
+			m_pJackQueued     = pJackQueued;
+			m_pJackPosted     = pJackPosted;
+			m_pJackMidiParser = pJackMidiParser;
+			m_pJackMidiPort   = pJackMidiPort;
+			pSession->unlock();
+			pMidiEngine->addJackMidiPort(pJackMidiPort);
+		}
+	}
+
 	// Update monitor subject names...
 	qtractorMidiBus::updateBusName();
 
@@ -3983,6 +4373,205 @@ void qtractorMidiBus::close (void)
 	snd_seq_delete_simple_port(pAlsaSeq, m_iAlsaPort);
 
 	m_iAlsaPort = -1;
+
+	// JACK MIDI output port, if any...
+	if (m_pJackMidiPort == nullptr)
+		return;
+
+	// Keep the audio thread off for a while...
+	qtractorSession *pSession = pMidiEngine->session();
+	if (pSession == nullptr)
+		return;
+
+	pMidiEngine->removeJackMidiPort(m_pJackMidiPort);
+
+	pSession->lock();
+
+	jack_client_t *pJackClient = pSession->audioEngine()->jackClient();
+	if (pJackClient)
+		jack_port_unregister(pJackClient, m_pJackMidiPort);
+	m_pJackMidiPort = nullptr;
+
+	if (m_pJackMidiParser) {
+		snd_midi_event_free(m_pJackMidiParser);
+		m_pJackMidiParser = nullptr;
+	}
+
+	if (m_pJackPosted) {
+		delete m_pJackPosted;
+		m_pJackPosted = nullptr;
+	}
+
+	if (m_pJackQueued) {
+		delete m_pJackQueued;
+		m_pJackQueued = nullptr;
+	}
+
+	if (m_pJackOutput) {
+		delete m_pJackOutput;
+		m_pJackOutput = nullptr;
+	}
+
+	if (m_pJackDirect) {
+		delete m_pJackDirect;
+		m_pJackDirect = nullptr;
+	}
+
+	pSession->unlock();
+}
+
+
+// JACK MIDI output port accessor (JACK MIDI output mode only).
+jack_port_t *qtractorMidiBus::jackMidiPort (void) const
+{
+	return m_pJackMidiPort;
+}
+
+
+// JACK MIDI output event scheduling (MIDI output thread),
+// in frames relative to playback start.
+void qtractorMidiBus::jackMidiQueued ( snd_seq_event_t *pEv,
+	unsigned long iTime, unsigned long iTimeOff )
+{
+	if (m_pJackMidiPort == nullptr)
+		return;
+
+	// Hand it over to the audio thread, which does the sorting;
+	// notes carry their note-off time as duration (in frames)...
+	if (pEv->type == SND_SEQ_EVENT_NOTE) {
+		snd_seq_event_t ev = *pEv;
+		ev.data.note.duration = (iTimeOff > iTime ? iTimeOff - iTime : 0);
+		m_pJackOutput->push(&ev, iTime);
+	}
+	else
+		m_pJackOutput->push(pEv, iTime);
+}
+
+
+// JACK MIDI output scheduled events merge, in time
+// order (audio thread, or else locked).
+void qtractorMidiBus::jackMidiMerge (void)
+{
+	snd_seq_event_t ev;
+	while (m_pJackOutput->pop(&ev)) {
+		const unsigned long iTime = ev.time.tick;
+		// Split notes, as the ALSA sequencer queue would do...
+		if (ev.type == SND_SEQ_EVENT_NOTE) {
+			// Don't let a note-on through without room for its note-off...
+			if (m_pJackPosted->count() + 1 >= m_pJackPosted->bufferSize())
+				continue;
+			const unsigned long iTimeOff = iTime + ev.data.note.duration;
+			ev.type = SND_SEQ_EVENT_NOTEON;
+			if (!m_pJackQueued->insert(&ev, iTime))
+				continue;
+			ev.type = SND_SEQ_EVENT_NOTEOFF;
+			ev.data.note.velocity = 0;
+			ev.data.note.duration = 0;
+			m_pJackPosted->insert(&ev, iTimeOff);
+		}
+		else
+		if (ev.type == SND_SEQ_EVENT_NOTEOFF)
+			m_pJackPosted->insert(&ev, iTime);
+		else
+			m_pJackQueued->insert(&ev, iTime);
+	}
+}
+
+
+// Drop pending JACK MIDI output events,
+// all or those of a given tag (non-RT, locked).
+void qtractorMidiBus::jackMidiReset ( int iTag )
+{
+	if (m_pJackMidiPort == nullptr)
+		return;
+
+	qtractorSession *pSession = engine()->session();
+	if (pSession == nullptr)
+		return;
+
+	pSession->lock();
+
+	// Audio thread is held off, so catch up on its behalf...
+	jackMidiMerge();
+
+	if (iTag < 0) {
+		// Pending note-offs are due right away...
+		m_pJackQueued->clear();
+		m_pJackPosted->reset();
+	} else {
+		// Pending note-offs are left alone...
+		m_pJackQueued->remove((unsigned char) (iTag & 0xff));
+	}
+
+	pSession->unlock();
+}
+
+
+// JACK MIDI output port processing (audio thread).
+void qtractorMidiBus::jackMidiProcess (
+	unsigned long iTimeStart, unsigned long iTimeEnd, unsigned int nframes )
+{
+	void *pJackBuffer = jack_port_get_buffer(m_pJackMidiPort, nframes);
+	if (pJackBuffer == nullptr)
+		return;
+
+	jack_midi_clear_buffer(pJackBuffer);
+
+	if (m_pJackMidiParser == nullptr)
+		return;
+
+	unsigned char midiData[JACK_MIDI_DATA_SIZE];
+	long iMidiData;
+
+	// Direct events, first thing...
+	snd_seq_event_t ev;
+	while (m_pJackDirect->pop(&ev)) {
+		iMidiData = snd_midi_event_decode(m_pJackMidiParser,
+			midiData, sizeof(midiData), &ev);
+		if (iMidiData > 0)
+			jack_midi_event_write(pJackBuffer, 0, midiData, iMidiData);
+	}
+
+	// Newly scheduled events, sorted in...
+	jackMidiMerge();
+
+	// Queued/posted events, sample-accurate...
+	snd_seq_event_t *pEv1 = m_pJackQueued->peek();
+	snd_seq_event_t *pEv2 = m_pJackPosted->peek();
+
+	while ((pEv1 && pEv1->time.tick < iTimeEnd)
+		|| (pEv2 && pEv2->time.tick < iTimeEnd)) {
+		snd_seq_event_t *pEv;
+		if (pEv1 && pEv1->time.tick < iTimeEnd
+			&& (pEv2 == nullptr || pEv2->time.tick >= pEv1->time.tick))
+			pEv = pEv1;
+		else
+			pEv = pEv2;
+		const jack_nframes_t iOffset = (pEv->time.tick > iTimeStart
+			? jack_nframes_t(pEv->time.tick - iTimeStart) : 0);
+		iMidiData = snd_midi_event_decode(m_pJackMidiParser,
+			midiData, sizeof(midiData), pEv);
+		if (iMidiData > 0 && iOffset < nframes)
+			jack_midi_event_write(pJackBuffer, iOffset, midiData, iMidiData);
+		if (pEv == pEv1)
+			pEv1 = m_pJackQueued->next();
+		else
+			pEv2 = m_pJackPosted->next();
+	}
+}
+
+
+// Direct event output (ALSA sequencer and JACK MIDI port, if any).
+void qtractorMidiBus::outputDirect ( snd_seq_event_t *pEv ) const
+{
+	qtractorMidiEngine *pMidiEngine
+		= static_cast<qtractorMidiEngine *> (engine());
+	if (pMidiEngine && pMidiEngine->alsaSeq())
+		snd_seq_event_output_direct(pMidiEngine->alsaSeq(), pEv);
+
+	// Immediate events are due on the next cycle...
+	if (m_pJackMidiPort)
+		m_pJackDirect->push(pEv);
 }
 
 
@@ -4177,7 +4766,7 @@ void qtractorMidiBus::setPatch ( unsigned short iChannel,
 			ev.data.control.value = (iBank & 0x3f80) >> 7;
 		else
 			ev.data.control.value = (iBank & 0x007f);
-		snd_seq_event_output_direct(pAlsaSeq, &ev);
+		outputDirect(&ev);
 		if (pTrackMidiManager)
 			pTrackMidiManager->direct(&ev);
 		if (pBusMidiManager)
@@ -4190,7 +4779,7 @@ void qtractorMidiBus::setPatch ( unsigned short iChannel,
 		ev.data.control.channel = iChannel;
 		ev.data.control.param   = BANK_SELECT_LSB;
 		ev.data.control.value   = (iBank & 0x007f);
-		snd_seq_event_output_direct(pAlsaSeq, &ev);
+		outputDirect(&ev);
 		if (pTrackMidiManager)
 			pTrackMidiManager->direct(&ev);
 		if (pBusMidiManager)
@@ -4202,7 +4791,7 @@ void qtractorMidiBus::setPatch ( unsigned short iChannel,
 		ev.type = SND_SEQ_EVENT_PGMCHANGE;
 		ev.data.control.channel = iChannel;
 		ev.data.control.value   = iProg;
-		snd_seq_event_output_direct(pAlsaSeq, &ev);
+		outputDirect(&ev);
 		if (pTrackMidiManager)
 			pTrackMidiManager->direct(&ev);
 		if (pBusMidiManager)
@@ -4280,7 +4869,7 @@ void qtractorMidiBus::setControllerEx ( unsigned short iChannel,
 	ev.data.control.channel = iChannel;
 	ev.data.control.param   = iController;
 	ev.data.control.value   = iValue;
-	snd_seq_event_output_direct(pAlsaSeq, &ev);
+	outputDirect(&ev);
 
 	// Do it for the MIDI plugins too...
 	if (pTrack && (pTrack->pluginList())->midiManager())
@@ -4389,7 +4978,7 @@ void qtractorMidiBus::sendEvent ( qtractorMidiEvent::EventType etype,
 		break;
 	}
 
-	snd_seq_event_output_direct(pAlsaSeq, &ev);
+	outputDirect(&ev);
 }
 
 
@@ -4432,7 +5021,7 @@ void qtractorMidiBus::sendNote (
 	ev.data.note.channel  = iChannel;
 	ev.data.note.note     = iNote;
 	ev.data.note.velocity = iVelocity;
-	snd_seq_event_output_direct(pAlsaSeq, &ev);
+	outputDirect(&ev);
 
 	// Do it for the MIDI plugins too...
 	if ((pTrack->pluginList())->midiManager())
@@ -26,10 +26,14 @@
 #include "qtractorTimeScale.h"
 #include "qtractorMmcEvent.h"
 #include "qtractorCtlEvent.h"
+#include "qtractorAtomic.h"
 
 #include <alsa/asoundlib.h>
 
+#include <jack/jack.h>
+
 #include <QHash>
+#include <QList>
 #include <QObject>
 
 // Forward declarations.
@@ -42,6 +46,8 @@ class qtractorMidiMonitor;
 class qtractorMidiSysexList;
 class qtractorMidiInputBuffer;
 class qtractorMidiPlayer;
+class qtractorMidiBuffer;
+class qtractorMidiQueue;
 class qtractorPluginList;
 class qtractorCurveList;
 
@@ -111,6 +117,9 @@ public:
 	// Special slave sync method.
 	void sync();
 
+	// Output thread idle check-point (non-blocking).
+	bool outputIdleSync();
+
 	// Read ahead frames configuration.
 	void setReadAhead(unsigned int iReadAhead);
 	unsigned int readAhead() const;
@@ -280,6 +289,52 @@ public:
 	// Reset ouput queue drift stats (audio vs. MIDI)...
 	void resetDrift();
 
+	// Scheduled output event (output thread).
+	void outputEvent(snd_seq_event_t *pEv);
+
+	// Scheduled output event from elsewhere (locked).
+	void outputEventSync(snd_seq_event_t *pEv);
+
+	// Scheduled output submit and drain (end of read-ahead window).
+	void drainOutput();
+
+	// Scheduled output statistics (read-ahead windows).
+	struct OutputStats
+	{
+		unsigned long windows;      // read-ahead windows drained
+		unsigned long events;       // events sent
+		unsigned long merged;       // redundant controllers merged
+		unsigned long bytes;        // bytes sent
+		unsigned long eventsMax;    // most events in a window
+		unsigned long drainTime;    // total drain time (usecs)
+		unsigned long drainTimeMax; // longest drain time (usecs)
+	};
+
+	const OutputStats& outputStats() const;
+	void resetOutputStats();
+
+	// Scheduled output statistics summary.
+	QString outputStatsText() const;
+
+	// JACK MIDI output mode (instead of ALSA sequencer queue).
+	bool isJackOutput() const;
+
+	// JACK MIDI output processing (audio thread).
+	void processJackOutput(unsigned long iTimeStart,
+		unsigned long iTimeEnd, unsigned int nframes);
+
+	// JACK MIDI output ports registry (non-RT).
+	void addJackMidiPort(jack_port_t *pJackMidiPort);
+	void removeJackMidiPort(jack_port_t *pJackMidiPort);
+
+	// JACK MIDI output ports clearing, for cycles
+	// that can't be processed otherwise (audio thread).
+	void clearJackOutput(unsigned int nframes);
+
+	// JACK MIDI output mode global default (applied on init).
+	static void setDefaultJackOutput(bool bJackOutput);
+	static bool isDefaultJackOutput();
+
 protected:
 
 	// Concrete device (de)activation methods.
@@ -407,6 +462,27 @@ private:
 	// Same record time(stamp) note-off tracking.
 	unsigned long  m_iLastEventTime;
 	unsigned short m_iLastEventNote;
+
+	// Held back output event (controller merge).
+	void submitOutput();
+
+	snd_seq_event_t m_outputEvent;
+	bool            m_bOutputPending;
+	unsigned long   m_iOutputWindow;
+
+	OutputStats     m_outputStats;
+
+	// Frame time relative to playback start.
+	unsigned long frameFromStart(unsigned long iFrame) const;
+
+	// JACK MIDI output mode.
+	bool m_bJackOutput;
+
+	// JACK MIDI output ports registry.
+	QList<jack_port_t *> m_jackMidiPorts;
+	qtractorAtomic       m_jackMidiPortsLock;
+
+	static bool g_bDefaultJackOutput;
 };
 
 
@@ -428,6 +504,22 @@ public:
 	// ALSA sequencer port accessor.
 	int alsaPort() const;
 
+	// JACK MIDI output port accessor (JACK MIDI output mode only).
+	jack_port_t *jackMidiPort() const;
+
+	// JACK MIDI output event scheduling (MIDI output thread),
+	// in frames relative to playback start.
+	void jackMidiQueued(snd_seq_event_t *pEv,
+		unsigned long iTime, unsigned long iTimeOff);
+
+	// Drop pending JACK MIDI output events,
+	// all or those of a given tag (non-RT, locked).
+	void jackMidiReset(int iTag = -1);
+
+	// JACK MIDI output port processing (audio thread).
+	void jackMidiProcess(unsigned long iTimeStart,
+		unsigned long iTimeEnd, unsigned int nframes);
+
 	// Activation methods.
 	bool open();
 	void close();
@@ -523,6 +615,13 @@ public:
 
 protected:
 
+	// Direct event output (ALSA sequencer and JACK MIDI port, if any).
+	void outputDirect(snd_seq_event_t *pEv) const;
+
+	// JACK MIDI output scheduled events merge, in time
+	// order (audio thread, or else locked).
+	void jackMidiMerge();
+
 	// Direct MIDI controller common helper.
 	void setControllerEx(unsigned short iChannel, int iController,
 		int iValue = 0, qtractorTrack *pTrack = nullptr) const;
@@ -554,6 +653,16 @@ private:
 	// Instance variables.
 	int m_iAlsaPort;
 
+	// JACK MIDI output port and event buffers; direct and
+	// scheduled events come in through lock-free queues,
+	// only the audio thread sorts them into the rest.
+	jack_port_t        *m_pJackMidiPort;
+	qtractorMidiQueue  *m_pJackDirect;
+	qtractorMidiQueue  *m_pJackOutput;
+	qtractorMidiBuffer *m_pJackQueued;
+	qtractorMidiBuffer *m_pJackPosted;
+	snd_midi_event_t   *m_pJackMidiParser;
+
 	// Specific monitor instances.
 	qtractorMidiMonitor *m_pIMidiMonitor;
 	qtractorMidiMonitor *m_pOMidiMonitor;
@@ -0,0 +1,270 @@
+// qtractorMidiEvent.cpp
+//
+/****************************************************************************
+   Copyright (C) 2005-2022, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qtractorMidiEvent.h"
+
+#include <new>
+
+#include <stddef.h>
+#include <stdlib.h>
+
+
+//----------------------------------------------------------------------
+// class qtractorMidiEventArena -- MIDI event slab allocator.
+//
+// Each sequence owns its own arena, so events read, recorded or
+// copied in time order are carved out of the same contiguous slabs,
+// in allocation order. Every cell carries its slab (and so arena)
+// back-pointer, as events may well outlive their sequence (eg. in
+// undo commands); the arena is then freed with its last event.
+
+// Slab geometry (in events; growing).
+#define ARENA_SLAB_MIN  64
+#define ARENA_SLAB_MAX  4096
+
+
+struct qtractorMidiEventArena::Cell
+{
+	Slab *slab;			// Owner slab; nullptr if on the heap.
+	union {
+		Cell *next;		// Free-list link.
+		alignas(qtractorMidiEvent) char data[sizeof(qtractorMidiEvent)];
+	} u;
+};
+
+
+struct qtractorMidiEventArena::Slab
+{
+	Slab *next;
+	qtractorMidiEventArena *arena;
+	unsigned int size;	// Total cells.
+	unsigned int count;	// Live cells.
+	Cell cells[1];
+};
+
+
+// Constructor.
+qtractorMidiEventArena::qtractorMidiEventArena (void)
+	: m_pFreeList(nullptr), m_pSlabs(nullptr),
+		m_iSlabSize(ARENA_SLAB_MIN), m_iSlabNext(0),
+		m_iCount(0), m_bOwned(true)
+{
+}
+
+
+// Destructor (only through release).
+qtractorMidiEventArena::~qtractorMidiEventArena (void)
+{
+	while (m_pSlabs) {
+		Slab *pSlab = m_pSlabs;
+		m_pSlabs = pSlab->next;
+		::free(pSlab);
+	}
+}
+
+
+// Event allocator methods (null arena means heap).
+void *qtractorMidiEventArena::allocEvent ( qtractorMidiEventArena *pArena )
+{
+	if (pArena)
+		return pArena->alloc();
+
+	Cell *pCell = static_cast<Cell *> (::malloc(sizeof(Cell)));
+	if (pCell == nullptr)
+		throw std::bad_alloc();
+
+	pCell->slab = nullptr;
+	return pCell->u.data;
+}
+
+
+void qtractorMidiEventArena::freeEvent ( void *pv )
+{
+	Cell *pCell = reinterpret_cast<Cell *> (
+		static_cast<char *> (pv) - offsetof(Cell, u));
+
+	if (pCell->slab)
+		pCell->slab->arena->free(pCell);
+	else
+		::free(pCell);
+}
+
+
+// Local allocator methods.
+void *qtractorMidiEventArena::alloc (void)
+{
+	QMutexLocker locker(&m_mutex);
+
+	Cell *pCell = m_pFreeList;
+	if (pCell) {
+		m_pFreeList = pCell->u.next;
+	} else {
+		if (m_pSlabs == nullptr || m_iSlabNext >= m_pSlabs->size) {
+			Slab *pSlab = static_cast<Slab *> (::malloc(
+				offsetof(Slab, cells) + m_iSlabSize * sizeof(Cell)));
+			if (pSlab == nullptr)
+				throw std::bad_alloc();
+			pSlab->next  = m_pSlabs;
+			pSlab->arena = this;
+			pSlab->size  = m_iSlabSize;
+			pSlab->count = 0;
+			m_pSlabs = pSlab;
+			m_iSlabNext = 0;
+			if (m_iSlabSize < ARENA_SLAB_MAX)
+				m_iSlabSize <<= 1;
+		}
+		pCell = &m_pSlabs->cells[m_iSlabNext++];
+		pCell->slab = m_pSlabs;
+	}
+
+	++(pCell->slab->count);
+	++m_iCount;
+
+	return pCell->u.data;
+}
+
+
+void qtractorMidiEventArena::free ( Cell *pCell )
+{
+	bool bDelete = false;
+	{
+		QMutexLocker locker(&m_mutex);
+
+		--(pCell->slab->count);
+		pCell->u.next = m_pFreeList;
+		m_pFreeList = pCell;
+
+		bDelete = (--m_iCount == 0 && !m_bOwned);
+	}
+
+	if (bDelete)
+		delete this;
+}
+
+
+// Owner detach; the arena is gone once its last event is.
+void qtractorMidiEventArena::release (void)
+{
+	bool bDelete = false;
+	{
+		QMutexLocker locker(&m_mutex);
+
+		m_bOwned = false;
+		bDelete = (m_iCount == 0);
+	}
+
+	if (bDelete)
+		delete this;
+}
+
+
+// Give empty slabs back and relink the free-list in address order.
+void qtractorMidiEventArena::compact (void)
+{
+	QMutexLocker locker(&m_mutex);
+
+	// Mark all free cells first...
+	for (Cell *pCell = m_pFreeList; pCell; pCell = pCell->u.next)
+		pCell->slab = nullptr;
+
+	m_pFreeList = nullptr;
+
+	// Give back slabs without any live events...
+	Slab *pHeadSlab = m_pSlabs;
+	Slab *pPrevSlab = nullptr;
+	Slab *pSlab = m_pSlabs;
+	while (pSlab) {
+		Slab *pNextSlab = pSlab->next;
+		if (pSlab->count == 0) {
+			if (pPrevSlab)
+				pPrevSlab->next = pNextSlab;
+			else
+				m_pSlabs = pNextSlab;
+			if (pSlab == pHeadSlab)
+				pHeadSlab = nullptr;
+			::free(pSlab);
+		}
+		else pPrevSlab = pSlab;
+		pSlab = pNextSlab;
+	}
+
+	// Relink the remaining free cells, lowest addresses
+	// (oldest slabs, first cells) coming out first...
+	for (pSlab = m_pSlabs; pSlab; pSlab = pSlab->next) {
+		unsigned int i = (pSlab == pHeadSlab ? m_iSlabNext : pSlab->size);
+		while (i > 0) {
+			Cell *pCell = &pSlab->cells[--i];
+			if (pCell->slab == nullptr) {
+				pCell->slab = pSlab;
+				pCell->u.next = m_pFreeList;
+				m_pFreeList = pCell;
+			}
+		}
+	}
+
+	// Current slab gone? next allocation starts a new one.
+	if (pHeadSlab == nullptr)
+		m_iSlabNext = (m_pSlabs ? m_pSlabs->size : 0);
+}
+
+
+//----------------------------------------------------------------------
+// class qtractorMidiEvent -- The generic MIDI event element.
+//
+
+// Arena (slab) allocation; plain new goes to the heap.
+void *qtractorMidiEvent::operator new ( size_t iSize )
+{
+	if (iSize != sizeof(qtractorMidiEvent))
+		return ::operator new(iSize);
+
+	return qtractorMidiEventArena::allocEvent(nullptr);
+}
+
+void *qtractorMidiEvent::operator new ( size_t iSize,
+	qtractorMidiEventArena *pArena )
+{
+	if (iSize != sizeof(qtractorMidiEvent))
+		return ::operator new(iSize);
+
+	return qtractorMidiEventArena::allocEvent(pArena);
+}
+
+void qtractorMidiEvent::operator delete ( void *pv, size_t iSize )
+{
+	if (pv == nullptr)
+		return;
+
+	if (iSize != sizeof(qtractorMidiEvent))
+		::operator delete(pv);
+	else
+		qtractorMidiEventArena::freeEvent(pv);
+}
+
+void qtractorMidiEvent::operator delete ( void *pv, qtractorMidiEventArena * )
+{
+	// Only on constructor throw, always arena's own size.
+	if (pv)
+		qtractorMidiEventArena::freeEvent(pv);
+}
+
+
+// end of qtractorMidiEvent.cpp
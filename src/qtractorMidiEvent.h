@@ -24,10 +24,16 @@
 
 #include "qtractorList.h"
 
+#include <QMutex>
+
 #include <stdio.h>
 #include <string.h>
 
 
+// Forward declarations.
+class qtractorMidiEventArena;
+
+
 //----------------------------------------------------------------------
 // class qtractorMidiEvent -- The generic MIDI event element.
 //
@@ -151,6 +157,12 @@ public:
 	void setPitchBend(int iPitchBend)
 		{ m_v.value = (unsigned short) (0x2000 + iPitchBend); }
 
+	// Arena (slab) allocation; plain new goes to the heap.
+	static void *operator new(size_t iSize);
+	static void *operator new(size_t iSize, qtractorMidiEventArena *pArena);
+	static void operator delete(void *pv, size_t iSize);
+	static void operator delete(void *pv, qtractorMidiEventArena *pArena);
+
 private:
 
 	// Event instance members.
@@ -174,6 +186,56 @@ private:
 };
 
 
+//----------------------------------------------------------------------
+// class qtractorMidiEventArena -- MIDI event slab allocator.
+//
+
+class qtractorMidiEventArena
+{
+public:
+
+	// Constructor.
+	qtractorMidiEventArena();
+
+	// Event allocator methods (null arena means heap).
+	static void *allocEvent(qtractorMidiEventArena *pArena);
+	static void freeEvent(void *pv);
+
+	// Owner detach; the arena is gone once its last event is.
+	void release();
+
+	// Give empty slabs back and relink the free-list in address order.
+	void compact();
+
+protected:
+
+	// Destructor (only through release).
+	~qtractorMidiEventArena();
+
+	// Cell/slab opaque types.
+	struct Cell;
+	struct Slab;
+
+	// Local allocator methods.
+	void *alloc();
+	void free(Cell *pCell);
+
+private:
+
+	// Instance variables.
+	QMutex m_mutex;
+
+	Cell *m_pFreeList;
+	Slab *m_pSlabs;
+
+	unsigned int  m_iSlabSize;
+	unsigned int  m_iSlabNext;
+	unsigned long m_iCount;
+
+	bool m_bOwned;
+};
+
+
 #endif  // __qtractorMidiEvent_h
 
 
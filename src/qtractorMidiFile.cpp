@@ -97,7 +97,7 @@ public:
 				default:
 					continue;
 				}
-				qtractorMidiEvent *pEvent = new qtractorMidiEvent(
+				qtractorMidiEvent *pEvent = new (pSeq->arena()) qtractorMidiEvent(
 					event.time, type, event.param, event.value);
 				pSeq->addEvent(pEvent);
 				pSeq->setChannel(event.status & 0x0f);
@@ -358,7 +358,7 @@ bool qtractorMidiFile::readTracks ( qtractorMidiSequence **ppSeqs,
 				if (bChannelEvent) {
 					if (data2 == 0 && type == qtractorMidiEvent::NOTEON)
 						type = qtractorMidiEvent::NOTEOFF;
-					pEvent = new qtractorMidiEvent(iTime, type, data1, data2);
+					pEvent = new (pSeq->arena()) qtractorMidiEvent(iTime, type, data1, data2);
 					pSeq->addEvent(pEvent);
 					pSeq->setChannel(iChannel);
 				}
@@ -369,7 +369,7 @@ bool qtractorMidiFile::readTracks ( qtractorMidiSequence **ppSeqs,
 				// Check if its channel filtered...
 				if (bChannelEvent) {
 					// Create the new event...
-					pEvent = new qtractorMidiEvent(iTime, type, data1, data2);
+					pEvent = new (pSeq->arena()) qtractorMidiEvent(iTime, type, data1, data2);
 					pSeq->addEvent(pEvent);
 					pSeq->setChannel(iChannel);
 				}
@@ -386,7 +386,7 @@ bool qtractorMidiFile::readTracks ( qtractorMidiSequence **ppSeqs,
 						break;
 					}
 					// Create the new event...
-					pEvent = new qtractorMidiEvent(iTime, type, data1, data2);
+					pEvent = new (pSeq->arena()) qtractorMidiEvent(iTime, type, data1, data2);
 					pSeq->addEvent(pEvent);
 					pSeq->setChannel(iChannel);
 					// Set the primordial bank patch...
@@ -442,7 +442,7 @@ bool qtractorMidiFile::readTracks ( qtractorMidiSequence **ppSeqs,
 				// Check if its channel filtered...
 				if (bChannelEvent) {
 					// Create the new event...
-					pEvent = new qtractorMidiEvent(iTime, type, data1, data2);
+					pEvent = new (pSeq->arena()) qtractorMidiEvent(iTime, type, data1, data2);
 					pSeq->addEvent(pEvent);
 					pSeq->setChannel(iChannel);
 					// Set the primordial program patch...
@@ -456,7 +456,7 @@ bool qtractorMidiFile::readTracks ( qtractorMidiSequence **ppSeqs,
 				// Check if its channel filtered...
 				if (bChannelEvent) {
 					// Create the new event...
-					pEvent = new qtractorMidiEvent(iTime, type, data1, data2);
+					pEvent = new (pSeq->arena()) qtractorMidiEvent(iTime, type, data1, data2);
 					pSeq->addEvent(pEvent);
 					pSeq->setChannel(iChannel);
 				}
@@ -468,7 +468,7 @@ bool qtractorMidiFile::readTracks ( qtractorMidiSequence **ppSeqs,
 				if (bChannelEvent) {
 					const unsigned short value = (data2 << 7) | data1;
 					// Create the new event...
-					pEvent = new qtractorMidiEvent(iTime, type, 0, value);
+					pEvent = new (pSeq->arena()) qtractorMidiEvent(iTime, type, 0, value);
 					pSeq->addEvent(pEvent);
 					pSeq->setChannel(iChannel);
 				}
@@ -487,7 +487,7 @@ bool qtractorMidiFile::readTracks ( qtractorMidiSequence **ppSeqs,
 				}
 				// Check if its channel filtered...
 				if (bChannelEvent) {
-					pEvent = new qtractorMidiEvent(iTime, type);
+					pEvent = new (pSeq->arena()) qtractorMidiEvent(iTime, type);
 					pEvent->setSysex(data, 1 + len);
 					pSeq->addEvent(pEvent);
 					pSeq->setChannel(iChannel);
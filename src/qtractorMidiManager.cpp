@@ -372,7 +372,7 @@ void qtractorMidiOutputBuffer::processSync (void)
 		snd_seq_ev_set_source(pEv, m_pMidiBus->alsaPort());
 		snd_seq_ev_set_subs(pEv);
 		snd_seq_ev_schedule_tick(pEv, pMidiEngine->alsaQueue(), 0, tick);
-		snd_seq_event_output(pMidiEngine->alsaSeq(), pEv);
+		pMidiEngine->outputEventSync(pEv);
 		if (pMidiManager)
 			pMidiManager->queued(pEv, pEv->time.tick);
 		if (pMidiMonitor)
@@ -21,6 +21,16 @@
 
 #include "qtractorMidiSequence.h"
 
+#include "qtractorSession.h"
+#include "qtractorMidiEngine.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+// Time index checkpoint step (in events).
+#define INDEX_STEP 64
+
 
 //----------------------------------------------------------------------
 // class qtractorMidiSequence -- The generic MIDI event sequence buffer.
@@ -39,9 +49,15 @@ qtractorMidiSequence::qtractorMidiSequence ( const QString& sName,
 
 	m_events.setAutoDelete(true);
 
+	m_pArena = new qtractorMidiEventArena();
+
 	m_noteMax = 0;
 	m_noteMin = 0;
 
+	m_pRetiredIndex = nullptr;
+	m_pEditIndex = nullptr;
+	m_iIndexDirty = 0;
+
 	clear();
 }
 
@@ -49,7 +65,22 @@ qtractorMidiSequence::qtractorMidiSequence ( const QString& sName,
 // Destructor.
 qtractorMidiSequence::~qtractorMidiSequence (void)
 {
-	clear();
+	// No one else should be seeking by now...
+	Index *pIndex = m_pIndex.fetchAndStoreOrdered(nullptr);
+	if (pIndex)
+		::free(pIndex);
+
+	if (m_pEditIndex)
+		::free(m_pEditIndex);
+
+	while (m_pRetiredIndex) {
+		pIndex = m_pRetiredIndex;
+		m_pRetiredIndex = pIndex->next;
+		::free(pIndex);
+	}
+
+	// Events still around will take the arena away...
+	m_pArena->release();
 }
 
 
@@ -68,6 +99,10 @@ void qtractorMidiSequence::clear (void)
 
 	m_events.clear();
 	m_notes.clear();
+
+	m_pArena->compact();
+
+	updateIndex();
 }
 
 
@@ -127,8 +162,19 @@ void qtractorMidiSequence::insertEvent ( qtractorMidiEvent *pEvent )
 {
 	// Find the proper position in time sequence...
 	qtractorMidiEvent *pEventAfter = m_events.last();
-	while (pEventAfter && pEventAfter->time() > pEvent->time())
-		pEventAfter = pEventAfter->prev();
+	if (pEventAfter && pEventAfter->time() > pEvent->time()) {
+		// Not an append: start from nearest checkpoint
+		// (as amended, if there's any pending edit)...
+		pEventAfter = seekIndex(m_pEditIndex
+			? m_pEditIndex : m_pIndex.loadAcquire(), pEvent->time());
+		if (pEventAfter == nullptr)
+			pEventAfter = m_events.first();
+		while (pEventAfter && pEventAfter->next()
+			&& (pEventAfter->next())->time() <= pEvent->time())
+			pEventAfter = pEventAfter->next();
+		while (pEventAfter && pEventAfter->time() > pEvent->time())
+			pEventAfter = pEventAfter->prev();
+	}
 
 	// Insert it...
 	if (pEventAfter)
@@ -148,12 +194,21 @@ void qtractorMidiSequence::insertEvent ( qtractorMidiEvent *pEvent )
 	}
 	if (m_duration < iTime)
 		m_duration = iTime;
+
+	// Too many events in between checkpoints? as new events
+	// are left unindexed until the next rebuild, a seek may
+	// walk as much as one checkpoint gap (INDEX_STEP) plus the
+	// changes since (INDEX_STEP + one per checkpoint)...
+	if (++m_iIndexDirty > (unsigned int) (m_events.count() / INDEX_STEP) + INDEX_STEP)
+		updateIndex();
 }
 
 
 // Unlink event from a channel sequence.
 void qtractorMidiSequence::unlinkEvent ( qtractorMidiEvent *pEvent )
 {
+	unlinkIndex(pEvent);
+
 	m_events.unlink(pEvent);
 }
 
@@ -161,6 +216,8 @@ void qtractorMidiSequence::unlinkEvent ( qtractorMidiEvent *pEvent )
 // Remove event from a channel sequence.
 void qtractorMidiSequence::removeEvent ( qtractorMidiEvent *pEvent )
 {
+	unlinkIndex(pEvent);
+
 	m_events.remove(pEvent);
 }
 
@@ -184,6 +241,12 @@ void qtractorMidiSequence::close (void)
 
 	// Reset all pending notes.
 	m_notes.clear();
+
+	// Compact the event arena.
+	m_pArena->compact();
+
+	// Rebuild the time index.
+	updateIndex();
 }
 
 
@@ -221,13 +284,17 @@ void qtractorMidiSequence::replaceEvents ( qtractorMidiSequence *pSeq,
 
 	// Insert new (cloned and adjusted) ones...
 	for (pEvent = pSeq->events().first(); pEvent; pEvent = pEvent->next()) {
-		qtractorMidiEvent *pNewEvent = new qtractorMidiEvent(*pEvent);
+		qtractorMidiEvent *pNewEvent
+			= new (m_pArena) qtractorMidiEvent(*pEvent);
 		pNewEvent->setTime(timeq(iTimeOffset + pEvent->time(), iTicksPerBeat));
 		if (pEvent->type() == qtractorMidiEvent::NOTEON)
 			pNewEvent->setDuration(timeq(pEvent->duration(), iTicksPerBeat));
 		insertEvent(pNewEvent);
 	}
 
+	// Publish any pending time index amendments.
+	commitIndex();
+
 	// Done.
 }
 
@@ -238,19 +305,191 @@ void qtractorMidiSequence::copyEvents ( qtractorMidiSequence *pSeq )
 	// Remove existing events.
 	m_events.clear();
 
+	m_pArena->compact();
+
 	const unsigned short iTicksPerBeat = pSeq->ticksPerBeat();
 
 	// Clone new ones...
 	qtractorMidiEvent *pEvent = pSeq->events().first();
 	for (; pEvent; pEvent = pEvent->next()) {
-		qtractorMidiEvent *pNewEvent = new qtractorMidiEvent(*pEvent);
+		qtractorMidiEvent *pNewEvent
+			= new (m_pArena) qtractorMidiEvent(*pEvent);
 		pNewEvent->setTime(timeq(pEvent->time(), iTicksPerBeat));
 		if (pEvent->type() == qtractorMidiEvent::NOTEON)
 			pNewEvent->setDuration(timeq(pEvent->duration(), iTicksPerBeat));
 		m_events.append(pNewEvent);
 	}
+
+	// Rebuild the time index.
+	updateIndex();
+
 	// Done.
 }
 
 
+// Time index seek: the last indexed event before given time,
+// nullptr if there's none (RT-safe).
+qtractorMidiEvent *qtractorMidiSequence::seekEvent ( unsigned long iTime ) const
+{
+	return seekIndex(m_pIndex.loadAcquire(), iTime);
+}
+
+
+// Time index seek, on a given index (RT-safe).
+qtractorMidiEvent *qtractorMidiSequence::seekIndex (
+	const Index *pIndex, unsigned long iTime ) const
+{
+	if (pIndex == nullptr)
+		return nullptr;
+
+	// Binary search for the first checkpoint at or after time...
+	unsigned int lo = 0;
+	unsigned int hi = pIndex->count;
+	while (lo < hi) {
+		const unsigned int mid = (lo + hi) >> 1;
+		if (pIndex->items[mid].time < iTime)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return (lo > 0 ? pIndex->items[lo - 1].event : nullptr);
+}
+
+
+// Time index (re)build method (non-RT).
+void qtractorMidiSequence::updateIndex (void)
+{
+	Index *pIndex = nullptr;
+
+	const unsigned int iCount
+		= (m_events.count() + INDEX_STEP - 1) / INDEX_STEP;
+	if (iCount > 0) {
+		pIndex = static_cast<Index *> (::malloc(
+			sizeof(Index) + (iCount - 1) * sizeof(Checkpoint)));
+		unsigned int i = 0;
+		unsigned int n = 0;
+		qtractorMidiEvent *pEvent = m_events.first();
+		for ( ; pEvent && i < iCount; pEvent = pEvent->next()) {
+			if ((n++ % INDEX_STEP) == 0) {
+				pIndex->items[i].time  = pEvent->time();
+				pIndex->items[i].event = pEvent;
+				++i;
+			}
+		}
+		pIndex->next  = nullptr;
+		pIndex->count = i;
+	}
+
+	// Pending amendments are now moot...
+	if (m_pEditIndex) {
+		::free(m_pEditIndex);
+		m_pEditIndex = nullptr;
+	}
+
+	// Swap in the new index...
+	publishIndex(pIndex);
+
+	m_iIndexDirty = 0;
+}
+
+
+// Time index pending amendments publishing (non-RT),
+// once per edit, as many events might have been unlinked.
+void qtractorMidiSequence::commitIndex (void)
+{
+	if (m_pEditIndex == nullptr)
+		return;
+
+	Index *pIndex = m_pEditIndex;
+	m_pEditIndex = nullptr;
+
+	publishIndex(pIndex);
+}
+
+
+// Time index publishing and retirement (non-RT).
+void qtractorMidiSequence::publishIndex ( Index *pIndex )
+{
+	// Swap in the new index; the old one is retired,
+	// as it might still be under a (RT) seek right now...
+	Index *pOldIndex = m_pIndex.fetchAndStoreOrdered(pIndex);
+	if (pOldIndex) {
+		pOldIndex->next = m_pRetiredIndex;
+		m_pRetiredIndex = pOldIndex;
+	}
+
+	if (m_pRetiredIndex == nullptr)
+		return;
+
+	// Retired indexes are only freed when there's no MIDI
+	// output cycle in flight, otherwise on some next time...
+	qtractorMidiEngine *pMidiEngine = nullptr;
+	qtractorSession *pSession = qtractorSession::getInstance();
+	if (pSession)
+		pMidiEngine = pSession->midiEngine();
+	if (pMidiEngine && !pMidiEngine->outputIdleSync())
+		return;
+
+	while (m_pRetiredIndex) {
+		pOldIndex = m_pRetiredIndex;
+		m_pRetiredIndex = pOldIndex->next;
+		::free(pOldIndex);
+	}
+}
+
+
+// Time index checkpoint removal (on event unlink).
+void qtractorMidiSequence::unlinkIndex ( qtractorMidiEvent *pEvent )
+{
+	++m_iIndexDirty;
+
+	// Pending amendments go on a private copy...
+	Index *pIndex = m_pEditIndex;
+	const Index *pCurrIndex = (pIndex ? pIndex : m_pIndex.loadAcquire());
+	if (pCurrIndex == nullptr)
+		return;
+
+	const unsigned long iTime = pEvent->time();
+
+	unsigned int lo = 0;
+	unsigned int hi = pCurrIndex->count;
+	while (lo < hi) {
+		const unsigned int mid = (lo + hi) >> 1;
+		if (pCurrIndex->items[mid].time < iTime)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	// Is it a checkpoint at all?
+	while (lo < pCurrIndex->count && pCurrIndex->items[lo].time == iTime
+		&& pCurrIndex->items[lo].event != pEvent)
+		++lo;
+
+	if (lo >= pCurrIndex->count || pCurrIndex->items[lo].event != pEvent)
+		return;
+
+	// Never touch the published index (RT might be seeking
+	// through it): amend a private copy instead, made only
+	// once per edit and published later on commitIndex()...
+	if (pIndex == nullptr) {
+		const size_t nsize
+			= sizeof(Index) + (pCurrIndex->count - 1) * sizeof(Checkpoint);
+		pIndex = static_cast<Index *> (::malloc(nsize));
+		::memcpy(pIndex, pCurrIndex, nsize);
+		pIndex->next = nullptr;
+		m_pEditIndex = pIndex;
+	}
+
+	// Move the checkpoint over to the previous event,
+	// which is still in time order...
+	Checkpoint& item = pIndex->items[lo];
+	qtractorMidiEvent *pPrevEvent = pEvent->prev();
+	if (pPrevEvent)
+		item.time = pPrevEvent->time();
+	item.event = pPrevEvent;
+}
+
+
 // end of qtractorMidiSequence.cpp
@@ -26,6 +26,7 @@
 
 #include <QString>
 #include <QMultiHash>
+#include <QAtomicPointer>
 
 // typedef unsigned long long uint64_t;
 #include <stdint.h>
@@ -101,6 +102,9 @@ public:
 	// Event list accessor.
 	const qtractorList<qtractorMidiEvent>& events() const { return m_events; }
 
+	// Event allocation arena accessor.
+	qtractorMidiEventArena *arena() const { return m_pArena; }
+
 	// Event list management methods.
 	void addEvent    (qtractorMidiEvent *pEvent);
 	void insertEvent (qtractorMidiEvent *pEvent);
@@ -120,12 +124,48 @@ public:
 	// Clopy all events from another sequence (raw-copy).
 	void copyEvents(qtractorMidiSequence *pSeq);
 
+	// Time index seek: the last indexed event before given time,
+	// nullptr if there's none (RT-safe).
+	qtractorMidiEvent *seekEvent(unsigned long iTime) const;
+
+	// Time index (re)build method (non-RT).
+	void updateIndex();
+
+	// Time index pending amendments publishing (non-RT),
+	// to be called once after unlinking/removing events.
+	void commitIndex();
+
 	// Sequence closure method.
 	void close();
 
 	// Typed hash table to track note-ons.
 	typedef QMultiHash<unsigned char, qtractorMidiEvent *> NoteMap;
 
+protected:
+
+	// Time index checkpoint removal (on event unlink).
+	void unlinkIndex(qtractorMidiEvent *pEvent);
+
+	// Time index checkpoint (every so many events).
+	struct Checkpoint
+	{
+		unsigned long      time;
+		qtractorMidiEvent *event;
+	};
+
+	struct Index
+	{
+		Index       *next;	// Retired chain.
+		unsigned int count;
+		Checkpoint   items[1];
+	};
+
+	// Time index publishing and retirement (non-RT).
+	void publishIndex(Index *pIndex);
+
+	// Time index seek, on a given index (RT-safe).
+	qtractorMidiEvent *seekIndex(const Index *pIndex, unsigned long iTime) const;
+
 private:
 
 	// Sequence/track properties.
@@ -150,8 +190,24 @@ private:
 	// Sequence instance event list (all same MIDI channel).
 	qtractorList<qtractorMidiEvent> m_events;
 
+	// Sequence own event allocation arena.
+	qtractorMidiEventArena *m_pArena;
+
 	// Local hash table to track note-ons.
 	NoteMap m_notes;
+
+	// Sparse time index (current and retired,
+	// the latter freed only once the MIDI output
+	// thread is known to be idle).
+	QAtomicPointer<Index> m_pIndex;
+	Index *m_pRetiredIndex;
+
+	// Pending amendments (unlinked checkpoints), a private
+	// copy of the published index, until commitIndex().
+	Index *m_pEditIndex;
+
+	// Event changes since last time index (re)build.
+	unsigned int m_iIndexDirty;
 };
 
 
@@ -46,6 +46,7 @@
 
 #include "qtractorPlugin.h"
 #include "qtractorCurve.h"
+#include "qtractorDspLoad.h"
 
 #include "qtractorMainForm.h"
 #include "qtractorBusForm.h"
@@ -54,6 +55,12 @@
 #include <QVBoxLayout>
 
 #include <QContextMenuEvent>
+#include <QHelpEvent>
+#include <QToolTip>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QFileInfo>
+#include <QDir>
 #include <QResizeEvent>
 #include <QMouseEvent>
 
@@ -800,6 +807,27 @@ void qtractorMixerStrip::mouseDoubleClickEvent ( QMouseEvent */*pMouseEvent*/ )
 }
 
 
+// Tool-tip event handler (live DSP load).
+bool qtractorMixerStrip::event ( QEvent *pEvent )
+{
+#ifdef CONFIG_DSP_LOAD
+	if (pEvent->type() == QEvent::ToolTip && m_pTrack) {
+		QHelpEvent *pHelpEvent = static_cast<QHelpEvent *> (pEvent);
+		if (pHelpEvent) {
+			QString sToolTip = QFrame::toolTip();
+			const QString& sDspLoad = m_pTrack->dspLoad().text();
+			if (!sDspLoad.isEmpty())
+				sToolTip.append('\n' + sDspLoad);
+			QToolTip::showText(pHelpEvent->globalPos(), sToolTip, this);
+			return true;
+		}
+	}
+#endif
+
+	return QFrame::event(pEvent);
+}
+
+
 // Bus connections dispatcher.
 void qtractorMixerStrip::busConnections ( qtractorBus::BusMode busMode )
 {
@@ -1045,6 +1073,13 @@ void qtractorMixerRackWidget::contextMenuEvent (
 	pAction = menu.addAction(
 		tr("&Buses..."), m_pRack, SLOT(busPropertiesSlot()));
 
+#ifdef CONFIG_DSP_LOAD
+	menu.addSeparator();
+
+	pAction = menu.addAction(
+		tr("Export &DSP Load..."), m_pRack, SLOT(dspLoadExportSlot()));
+#endif
+
 	menu.exec(pContextMenuEvent->globalPos());
 }
 
@@ -1340,6 +1375,45 @@ void qtractorMixerRack::busPropertiesSlot (void)
 }
 
 
+// DSP load statistics export slot.
+void qtractorMixerRack::dspLoadExportSlot (void)
+{
+#ifdef CONFIG_DSP_LOAD
+	qtractorOptions *pOptions = qtractorOptions::getInstance();
+	if (pOptions == nullptr)
+		return;
+
+	const QString& sTitle = tr("Export DSP Load");
+	QStringList filters;
+	filters.append(tr("CSV files (*.%1)").arg("csv"));
+	filters.append(tr("All files (*.*)"));
+	const QString& sFilter = filters.join(";;");
+	QWidget *pParentWidget = nullptr;
+	QFileDialog::Options options;
+	if (pOptions->bDontUseNativeDialogs) {
+		options |= QFileDialog::DontUseNativeDialog;
+		pParentWidget = QWidget::window();
+	}
+
+	// Ask for the filename to save...
+	QString sFilename = QFileDialog::getSaveFileName(pParentWidget, sTitle,
+		QDir(pOptions->sSessionDir).filePath("dspload.csv"), sFilter,
+		nullptr, options);
+	if (sFilename.isEmpty())
+		return;
+
+	if (QFileInfo(sFilename).suffix().isEmpty())
+		sFilename += ".csv";
+
+	if (!qtractorDspLoad::exportCsv(sFilename)) {
+		QMessageBox::warning(this, sTitle,
+			tr("Could not write DSP load statistics:\n\n\"%1\".")
+			.arg(sFilename));
+	}
+#endif
+}
+
+
 // Find a mixer strip, given its MIDI-manager handle.
 qtractorMixerStrip *qtractorMixerRack::findMidiManagerStrip (
 	qtractorMidiManager *pMidiManager ) const
@@ -191,6 +191,9 @@ protected:
 	// Mouse selection event handlers.
 	void mouseDoubleClickEvent(QMouseEvent *);
 
+	// Tool-tip event handler (live DSP load).
+	bool event(QEvent *pEvent);
+
 private:
 
 	// Local instance variables.
@@ -350,6 +353,9 @@ public slots:
 	void busMonitorSlot();
 	void busPropertiesSlot();
 
+	// DSP load statistics export slot.
+	void dspLoadExportSlot();
+
 signals:
 
 	// Selection changed signal.
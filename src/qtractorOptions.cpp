@@ -104,6 +104,7 @@ void qtractorOptions::loadOptions (void)
 	bStdoutCapture  = m_settings.value("/StdoutCapture", true).toBool();
 	bCompletePath   = m_settings.value("/CompletePath", true).toBool();
 	bPeakAutoRemove = m_settings.value("/PeakAutoRemove", true).toBool();
+	iPeakThreads    = m_settings.value("/PeakThreads", 0).toInt();
 	bKeepToolsOnTop = m_settings.value("/KeepToolsOnTop", true).toBool();
 	bKeepEditorsOnTop = m_settings.value("/KeepEditorsOnTop", false).toBool();
 	iDisplayFormat  = m_settings.value("/DisplayFormat", 1).toInt();
@@ -163,6 +164,15 @@ void qtractorOptions::loadOptions (void)
 	bAudioPlayerAutoConnect = m_settings.value("/PlayerAutoConnect", true).toBool();
 	bAudioMetroAutoConnect = m_settings.value("/MetroAutoConnect", true).toBool();
 	iAudioMetroOffset  = (unsigned long) m_settings.value("/MetroOffset", 0).toUInt();
+	iAudioRenderThreads = m_settings.value("/RenderThreads", 0).toInt();
+	iAudioSyncThreads = m_settings.value("/SyncThreads", 0).toInt();
+	fAudioPreRollTime = m_settings.value("/PreRollTime", 2.0f).toFloat();
+	iAudioCacheSize = m_settings.value("/CacheSize", 0).toInt();
+	iAudioCacheThreshold = m_settings.value("/CacheThreshold", 8).toInt();
+	bAudioStretchCache = m_settings.value("/StretchCache", false).toBool();
+	bAudioResampleCache = m_settings.value("/ResampleCache", false).toBool();
+	iAudioCapturePrealloc = m_settings.value("/CapturePrealloc", 0).toInt();
+	bAudioCrossFade = m_settings.value("/CrossFade", false).toBool();
 	m_settings.endGroup();
 
 	// MIDI rendering options group.
@@ -172,6 +182,7 @@ void qtractorOptions::loadOptions (void)
 	iMidiCaptureQuantize = m_settings.value("/CaptureQuantize", 0).toInt();
 	iMidiQueueTimer    = m_settings.value("/QueueTimer", 0).toInt();
 	bMidiDriftCorrect  = m_settings.value("/DriftCorrect", true).toBool();
+	bMidiJackOutput    = m_settings.value("/JackOutput", false).toBool();
 	bMidiPlayerBus     = m_settings.value("/PlayerBus", false).toBool();
 	bMidiControlBus    = m_settings.value("/ControlBus", false).toBool();
 	bMidiMetroBus      = m_settings.value("/MetroBus", false).toBool();
@@ -240,6 +251,7 @@ void qtractorOptions::loadOptions (void)
 	iExportRangeStart = (unsigned long) m_settings.value("/ExportRangeStart", 0).toUInt();
 	iExportRangeEnd = (unsigned long) m_settings.value("/ExportRangeEnd", 0).toUInt();
 	bExportAddTrack = m_settings.value("/ExportAddTrack", false).toBool();
+	bExportStems = m_settings.value("/ExportStems", false).toBool();
 	m_settings.endGroup();
 
 	// Session auto-save group.
@@ -414,6 +426,7 @@ void qtractorOptions::saveOptions (void)
 	m_settings.setValue("/StdoutCapture", bStdoutCapture);
 	m_settings.setValue("/CompletePath", bCompletePath);
 	m_settings.setValue("/PeakAutoRemove", bPeakAutoRemove);
+	m_settings.setValue("/PeakThreads", iPeakThreads);
 	m_settings.setValue("/KeepToolsOnTop", bKeepToolsOnTop);
 	m_settings.setValue("/KeepEditorsOnTop", bKeepEditorsOnTop);
 	m_settings.setValue("/DisplayFormat", iDisplayFormat);
@@ -473,6 +486,15 @@ void qtractorOptions::saveOptions (void)
 	m_settings.setValue("/PlayerAutoConnect", bAudioPlayerAutoConnect);
 	m_settings.setValue("/MetroAutoConnect", bAudioMetroAutoConnect);
 	m_settings.setValue("/MetroOffset", uint(iAudioMetroOffset));
+	m_settings.setValue("/RenderThreads", iAudioRenderThreads);
+	m_settings.setValue("/SyncThreads", iAudioSyncThreads);
+	m_settings.setValue("/PreRollTime", fAudioPreRollTime);
+	m_settings.setValue("/CacheSize", iAudioCacheSize);
+	m_settings.setValue("/CacheThreshold", iAudioCacheThreshold);
+	m_settings.setValue("/StretchCache", bAudioStretchCache);
+	m_settings.setValue("/ResampleCache", bAudioResampleCache);
+	m_settings.setValue("/CapturePrealloc", iAudioCapturePrealloc);
+	m_settings.setValue("/CrossFade", bAudioCrossFade);
 	m_settings.endGroup();
 
 	// MIDI rendering options group.
@@ -482,6 +504,7 @@ void qtractorOptions::saveOptions (void)
 	m_settings.setValue("/CaptureQuantize", iMidiCaptureQuantize);
 	m_settings.setValue("/QueueTimer", iMidiQueueTimer);
 	m_settings.setValue("/DriftCorrect", bMidiDriftCorrect);
+	m_settings.setValue("/JackOutput", bMidiJackOutput);
 	m_settings.setValue("/PlayerBus", bMidiPlayerBus);
 	m_settings.setValue("/ControlBus", bMidiControlBus);
 	m_settings.setValue("/MetroBus", bMidiMetroBus);
@@ -550,6 +573,7 @@ void qtractorOptions::saveOptions (void)
 	m_settings.setValue("/ExportRangeStart", uint(iExportRangeStart));
 	m_settings.setValue("/ExportRangeEnd", uint(iExportRangeEnd));
 	m_settings.setValue("/ExportAddTrack", bExportAddTrack);
+	m_settings.setValue("/ExportStems", bExportStems);
 	m_settings.endGroup();
 
 	// Session auto-save group.
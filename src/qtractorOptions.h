@@ -75,6 +75,7 @@ public:
 	bool    bStdoutCapture;
 	bool    bCompletePath;
 	bool    bPeakAutoRemove;
+	int     iPeakThreads;
 	bool    bKeepToolsOnTop;
 	bool    bKeepEditorsOnTop;
 	int     iDisplayFormat;
@@ -129,6 +130,31 @@ public:
 	// Audio metronome latency offset compensation.
 	unsigned long iAudioMetroOffset;
 
+	// Audio track rendering worker threads (0=serial).
+	int     iAudioRenderThreads;
+
+	// Audio disk-streaming worker threads (0=auto).
+	int     iAudioSyncThreads;
+
+	// Audio clip read-ahead time (in seconds; 0=off).
+	float   fAudioPreRollTime;
+
+	// Audio clip RAM cache budget and clip size threshold (in MB).
+	int     iAudioCacheSize;
+	int     iAudioCacheThreshold;
+
+	// Audio clip time-stretch/pitch-shift background render.
+	bool    bAudioStretchCache;
+
+	// Audio clip sample-rate conversion background render.
+	bool    bAudioResampleCache;
+
+	// Audio capture file preallocation step (MB; 0=none).
+	int     iAudioCapturePrealloc;
+
+	// Audio clip equal-power crossfade over overlaps.
+	bool    bAudioCrossFade;
+
 	// Audio metronome parameters.
 	QString sMetroBarFilename;
 	float   fMetroBarGain;
@@ -141,6 +167,7 @@ public:
 	int  iMidiCaptureQuantize;
 	int  iMidiQueueTimer;
 	bool bMidiDriftCorrect;
+	bool bMidiJackOutput;
 	bool bMidiPlayerBus;
 	bool bMidiControlBus;
 	bool bMidiMetroBus;
@@ -219,6 +246,7 @@ public:
 	unsigned long iExportRangeStart;
 	unsigned long iExportRangeEnd;
 	bool    bExportAddTrack;
+	bool    bExportStems;
 
 	// Session auto-save options.
 	bool    bAutoSaveEnabled;
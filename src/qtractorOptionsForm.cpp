@@ -261,6 +261,33 @@ qtractorOptionsForm::qtractorOptionsForm ( QWidget *pParent )
 	QObject::connect(m_ui.AudioPlayerAutoConnectCheckBox,
 		SIGNAL(stateChanged(int)),
 		SLOT(changed()));
+	QObject::connect(m_ui.AudioRenderThreadsSpinBox,
+		SIGNAL(valueChanged(int)),
+		SLOT(changed()));
+	QObject::connect(m_ui.AudioSyncThreadsSpinBox,
+		SIGNAL(valueChanged(int)),
+		SLOT(changed()));
+	QObject::connect(m_ui.AudioPreRollTimeSpinBox,
+		SIGNAL(valueChanged(double)),
+		SLOT(changed()));
+	QObject::connect(m_ui.AudioCapturePreallocSpinBox,
+		SIGNAL(valueChanged(int)),
+		SLOT(changed()));
+	QObject::connect(m_ui.AudioCacheSizeSpinBox,
+		SIGNAL(valueChanged(int)),
+		SLOT(changed()));
+	QObject::connect(m_ui.AudioCacheThresholdSpinBox,
+		SIGNAL(valueChanged(int)),
+		SLOT(changed()));
+	QObject::connect(m_ui.AudioStretchCacheCheckBox,
+		SIGNAL(stateChanged(int)),
+		SLOT(changed()));
+	QObject::connect(m_ui.AudioResampleCacheCheckBox,
+		SIGNAL(stateChanged(int)),
+		SLOT(changed()));
+	QObject::connect(m_ui.AudioCrossFadeCheckBox,
+		SIGNAL(stateChanged(int)),
+		SLOT(changed()));
 	QObject::connect(m_ui.AudioMetronomeCheckBox,
 		SIGNAL(stateChanged(int)),
 		SLOT(changed()));
@@ -309,6 +336,9 @@ qtractorOptionsForm::qtractorOptionsForm ( QWidget *pParent )
 	QObject::connect(m_ui.MidiResetAllControllersCheckBox,
 		SIGNAL(stateChanged(int)),
 		SLOT(changed()));
+	QObject::connect(m_ui.MidiJackOutputCheckBox,
+		SIGNAL(stateChanged(int)),
+		SLOT(changed()));
 	QObject::connect(m_ui.MidiMmcModeComboBox,
 		SIGNAL(activated(int)),
 		SLOT(changed()));
@@ -393,6 +423,9 @@ qtractorOptionsForm::qtractorOptionsForm ( QWidget *pParent )
 	QObject::connect(m_ui.MaxRecentFilesSpinBox,
 		SIGNAL(valueChanged(int)),
 		SLOT(changed()));
+	QObject::connect(m_ui.PeakThreadsSpinBox,
+		SIGNAL(valueChanged(int)),
+		SLOT(changed()));
 	QObject::connect(m_ui.BaseFontSizeComboBox,
 		SIGNAL(editTextChanged(const QString&)),
 		SLOT(changed()));
@@ -598,6 +631,20 @@ void qtractorOptionsForm::setOptions ( qtractorOptions *pOptions )
 	m_ui.AudioPlayerBusCheckBox->setChecked(m_pOptions->bAudioPlayerBus);
 	m_ui.AudioPlayerAutoConnectCheckBox->setChecked(m_pOptions->bAudioPlayerAutoConnect);
 
+	// Audio performance options.
+	m_ui.AudioRenderThreadsSpinBox->setValue(m_pOptions->iAudioRenderThreads);
+	m_ui.AudioSyncThreadsSpinBox->setValue(m_pOptions->iAudioSyncThreads);
+	m_ui.AudioPreRollTimeSpinBox->setValue(m_pOptions->fAudioPreRollTime);
+	m_ui.AudioCapturePreallocSpinBox->setValue(m_pOptions->iAudioCapturePrealloc);
+	m_ui.AudioCacheSizeSpinBox->setValue(m_pOptions->iAudioCacheSize);
+	m_ui.AudioCacheThresholdSpinBox->setValue(m_pOptions->iAudioCacheThreshold);
+	m_ui.AudioStretchCacheCheckBox->setChecked(m_pOptions->bAudioStretchCache);
+	m_ui.AudioResampleCacheCheckBox->setChecked(m_pOptions->bAudioResampleCache);
+	m_ui.AudioCrossFadeCheckBox->setChecked(m_pOptions->bAudioCrossFade);
+#ifndef CONFIG_LIBSAMPLERATE
+	m_ui.AudioResampleCacheCheckBox->setEnabled(false);
+#endif
+
 #ifndef CONFIG_LIBSAMPLERATE
 	m_ui.AudioResampleTypeTextLabel->setEnabled(false);
 	m_ui.AudioResampleTypeComboBox->setEnabled(false);
@@ -628,6 +675,7 @@ void qtractorOptionsForm::setOptions ( qtractorOptions *pOptions )
 	m_ui.MidiDriftCorrectCheckBox->setChecked(m_pOptions->bMidiDriftCorrect);
 	m_ui.MidiPlayerBusCheckBox->setChecked(m_pOptions->bMidiPlayerBus);
 	m_ui.MidiResetAllControllersCheckBox->setChecked(m_pOptions->bMidiResetAllControllers);
+	m_ui.MidiJackOutputCheckBox->setChecked(m_pOptions->bMidiJackOutput);
 
 	// MIDI control options.
 	m_ui.MidiMmcModeComboBox->setCurrentIndex(m_pOptions->iMidiMmcMode);
@@ -708,6 +756,7 @@ void qtractorOptionsForm::setOptions ( qtractorOptions *pOptions )
 	m_ui.ShiftKeyModifierCheckBox->setChecked(m_pOptions->bShiftKeyModifier);
 	m_ui.MidButtonModifierCheckBox->setChecked(m_pOptions->bMidButtonModifier);
 	m_ui.MaxRecentFilesSpinBox->setValue(m_pOptions->iMaxRecentFiles);
+	m_ui.PeakThreadsSpinBox->setValue(m_pOptions->iPeakThreads);
 	m_ui.LoopRecordingModeComboBox->setCurrentIndex(m_pOptions->iLoopRecordingMode);
 	m_ui.DisplayFormatComboBox->setCurrentIndex(m_pOptions->iDisplayFormat);
 	if (m_pOptions->iBaseFontSize > 0)
@@ -842,6 +891,16 @@ void qtractorOptionsForm::accept (void)
 		m_pOptions->bAudioWsolaQuickSeek = m_ui.AudioWsolaQuickSeekCheckBox->isChecked();
 		m_pOptions->bAudioPlayerBus      = m_ui.AudioPlayerBusCheckBox->isChecked();
 		m_pOptions->bAudioPlayerAutoConnect = m_ui.AudioPlayerAutoConnectCheckBox->isChecked();
+		// Audio performance options.
+		m_pOptions->iAudioRenderThreads  = m_ui.AudioRenderThreadsSpinBox->value();
+		m_pOptions->iAudioSyncThreads    = m_ui.AudioSyncThreadsSpinBox->value();
+		m_pOptions->fAudioPreRollTime    = m_ui.AudioPreRollTimeSpinBox->value();
+		m_pOptions->iAudioCapturePrealloc = m_ui.AudioCapturePreallocSpinBox->value();
+		m_pOptions->iAudioCacheSize      = m_ui.AudioCacheSizeSpinBox->value();
+		m_pOptions->iAudioCacheThreshold = m_ui.AudioCacheThresholdSpinBox->value();
+		m_pOptions->bAudioStretchCache   = m_ui.AudioStretchCacheCheckBox->isChecked();
+		m_pOptions->bAudioResampleCache  = m_ui.AudioResampleCacheCheckBox->isChecked();
+		m_pOptions->bAudioCrossFade      = m_ui.AudioCrossFadeCheckBox->isChecked();
 		// Audio metronome options.
 		m_pOptions->bAudioMetronome      = m_ui.AudioMetronomeCheckBox->isChecked();
 		m_pOptions->sMetroBarFilename    = m_ui.MetroBarFilenameComboBox->currentText();
@@ -859,6 +918,7 @@ void qtractorOptionsForm::accept (void)
 		m_pOptions->bMidiDriftCorrect    = m_ui.MidiDriftCorrectCheckBox->isChecked();
 		m_pOptions->bMidiPlayerBus       = m_ui.MidiPlayerBusCheckBox->isChecked();
 		m_pOptions->bMidiResetAllControllers = m_ui.MidiResetAllControllersCheckBox->isChecked();
+		m_pOptions->bMidiJackOutput      = m_ui.MidiJackOutputCheckBox->isChecked();
 		m_pOptions->iMidiMmcMode         = m_ui.MidiMmcModeComboBox->currentIndex();
 		m_pOptions->iMidiMmcDevice       = m_ui.MidiMmcDeviceComboBox->currentIndex();
 		m_pOptions->iMidiSppMode         = m_ui.MidiSppModeComboBox->currentIndex();
@@ -887,6 +947,7 @@ void qtractorOptionsForm::accept (void)
 		m_pOptions->bShiftKeyModifier    = m_ui.ShiftKeyModifierCheckBox->isChecked();
 		m_pOptions->bMidButtonModifier   = m_ui.MidButtonModifierCheckBox->isChecked();
 		m_pOptions->iMaxRecentFiles      = m_ui.MaxRecentFilesSpinBox->value();
+		m_pOptions->iPeakThreads         = m_ui.PeakThreadsSpinBox->value();
 		m_pOptions->iLoopRecordingMode   = m_ui.LoopRecordingModeComboBox->currentIndex();
 		m_pOptions->iDisplayFormat       = m_ui.DisplayFormatComboBox->currentIndex();
 		m_pOptions->iBaseFontSize        = m_ui.BaseFontSizeComboBox->currentText().toInt();
@@ -1982,6 +2043,10 @@ void qtractorOptionsForm::stabilizeForm (void)
 	m_ui.AudioPlayerAutoConnectCheckBox->setEnabled(
 		m_ui.AudioPlayerBusCheckBox->isChecked());
 
+	const bool bAudioCache = (m_ui.AudioCacheSizeSpinBox->value() > 0);
+	m_ui.AudioCacheThresholdTextLabel->setEnabled(bAudioCache);
+	m_ui.AudioCacheThresholdSpinBox->setEnabled(bAudioCache);
+
 	const bool bAudioMetronome = m_ui.AudioMetronomeCheckBox->isChecked();
 	m_ui.MetroBarFilenameTextLabel->setEnabled(bAudioMetronome);
 	m_ui.MetroBarFilenameComboBox->setEnabled(bAudioMetronome);
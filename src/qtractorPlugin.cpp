@@ -1743,7 +1743,8 @@ void qtractorPlugin::Property::update ( float fValue, bool bUpdate )
 qtractorPluginList::qtractorPluginList (
 	unsigned short iChannels, unsigned int iFlags )
 	: m_iChannels(iChannels), m_iFlags(iFlags),
-		m_iActivated(0), m_pMidiManager(nullptr),
+		m_iActivated(0), m_bSilentTail(false), m_iSilentTail(0),
+		m_pMidiManager(nullptr),
 		m_iMidiBank(-1), m_iMidiProg(-1),
 		m_pMidiProgramSubject(nullptr),
 		m_bAutoDeactivated(false),
@@ -1763,6 +1764,7 @@ qtractorPluginList::qtractorPluginList (
 		= qtractorMidiManager::isDefaultAudioOutputAutoConnect();
 
 	m_iAudioInsertActivated = 0;
+	m_iAudioAuxSendActivated = 0;
 
 	setChannels(iChannels, iFlags);
 }
@@ -2178,7 +2180,13 @@ void qtractorPluginList::process ( float **ppBuffer, unsigned int nframes )
 		float **ppIBuffer = m_pppBuffers[  iBuffer & 1];
 		float **ppOBuffer = m_pppBuffers[++iBuffer & 1];
 		// Time for the real thing...
+	#ifdef CONFIG_DSP_LOAD
+		pPlugin->dspLoad().start();
 		pPlugin->process(ppIBuffer, ppOBuffer, nframes);
+		pPlugin->dspLoad().stop();
+	#else
+		pPlugin->process(ppIBuffer, ppOBuffer, nframes);
+	#endif
 	}
 
 	// Now for the output buffer commitment...
@@ -2191,6 +2199,73 @@ void qtractorPluginList::process ( float **ppBuffer, unsigned int nframes )
 }
 
 
+// Silence-aware plugin-chain procedure (RT).
+bool qtractorPluginList::process (
+	float **ppBuffer, unsigned int nframes, bool bSilent )
+{
+	if (!bSilent) {
+		m_bSilentTail = false;
+		process(ppBuffer, nframes);
+		return false;
+	}
+
+	// Nothing to do, nothing to make noise...
+	if (!isActivated())
+		return true;
+
+	// Instruments may sound anytime...
+	if (m_pMidiManager) {
+		process(ppBuffer, nframes);
+		return false;
+	}
+
+	// Just went silent: how long till it all dies out?
+	if (!m_bSilentTail) {
+		m_bSilentTail = true;
+		m_iSilentTail = tailLength();
+	}
+
+	// Unknown or infinite tail: keep going...
+	if (m_iSilentTail < 0) {
+		process(ppBuffer, nframes);
+		return false;
+	}
+
+	// Finite tail: keep going till it's over...
+	if (m_iSilentTail > 0) {
+		process(ppBuffer, nframes);
+		if (m_iSilentTail > long(nframes))
+			m_iSilentTail -= nframes;
+		else
+			m_iSilentTail = 0;
+		return false;
+	}
+
+	// Dead silent.
+	return true;
+}
+
+
+// Current chain tail length (in frames; -1=unknown/infinite),
+// including the chain latency as the tail gets delayed too.
+long qtractorPluginList::tailLength (void) const
+{
+	long iTailLength = 0;
+
+	for (qtractorPlugin *pPlugin = first();
+			pPlugin; pPlugin = pPlugin->next()) {
+		if (!pPlugin->isActivated())
+			continue;
+		const long iPluginTail = pPlugin->tailLength();
+		if (iPluginTail < 0)
+			return -1;
+		iTailLength += iPluginTail + long(pPlugin->latency());
+	}
+
+	return iTailLength;
+}
+
+
 // Create/load plugin state.
 qtractorPlugin *qtractorPluginList::loadPlugin ( QDomElement *pElement )
 {
@@ -28,6 +28,8 @@
 
 #include "qtractorDocument.h"
 
+#include "qtractorDspLoad.h"
+
 #include <QStringList>
 #include <QPoint>
 #include <QSize>
@@ -239,6 +241,12 @@ public:
 
 	unsigned short instances() const { return m_iInstances; }
 
+#ifdef CONFIG_DSP_LOAD
+	// Process cycle timing statistics.
+	qtractorDspLoad& dspLoad() { return m_dspLoad; }
+	const qtractorDspLoad& dspLoad() const { return m_dspLoad; }
+#endif
+
 	// Chain helper ones.
 	unsigned short channels() const;
 
@@ -384,6 +392,10 @@ public:
 	virtual unsigned long latency() const
 		{ return 0; }
 
+	// Plugin declared tail length (in frames; -1=unknown/infinite).
+	virtual long tailLength() const
+		{ return -1; }
+
 	// GUI Editor stuff.
 	virtual void openEditor(QWidget */*pParent*/= nullptr) {}
 	virtual void closeEditor() {};
@@ -633,6 +645,11 @@ private:
 	// Activate pseudo-parameter port index.
 	unsigned long m_iActivateSubjectIndex;
 
+#ifdef CONFIG_DSP_LOAD
+	// Process cycle timing statistics.
+	qtractorDspLoad m_dspLoad;
+#endif
+
 	// List of input control ports (parameters).
 	Params m_params;
 
@@ -914,6 +931,8 @@ public:
 		else
 		if (m_iActivated > 0)
 			--m_iActivated;
+		// Chain tail must be re-evaluated...
+		m_bSilentTail = false;
 	}
 
 	bool isActivatedAll() const
@@ -941,6 +960,14 @@ public:
 	// The meta-main audio-processing plugin-chain procedure.
 	void process(float **ppBuffer, unsigned int nframes);
 
+	// Silence-aware plugin-chain procedure (RT): skips processing
+	// once the input is silent and all declared tails are over;
+	// returns whether the output buffer is silent.
+	bool process(float **ppBuffer, unsigned int nframes, bool bSilent);
+
+	// Current chain tail length (in frames; -1=unknown/infinite).
+	long tailLength() const;
+
 	// Forward declarations.
 	class Document;
 	class WaitCursor;
@@ -1039,6 +1066,19 @@ public:
 	bool isAudioInsertActivated() const
 		{ return (m_iAudioInsertActivated > 0); }
 
+	// Special audio aux-sends activation state methods.
+	void setAudioAuxSendActivated(bool bAudioAuxSendActivated)
+	{
+		if (bAudioAuxSendActivated)
+			++m_iAudioAuxSendActivated;
+		else
+		if (m_iAudioAuxSendActivated > 0)
+			--m_iAudioAuxSendActivated;
+	}
+
+	bool isAudioAuxSendActivated() const
+		{ return (m_iAudioAuxSendActivated > 0); }
+
 	// Special auto-deactivate methods
 	void autoDeactivatePlugins(bool bDeactivated, bool bForce = false);
 	bool isAutoDeactivated() const;
@@ -1072,6 +1112,10 @@ private:
 	// Activation state.
 	unsigned int   m_iActivated;
 
+	// Silent input tail countdown (in frames).
+	bool           m_bSilentTail;
+	long           m_iSilentTail;
+
 	// Plugin-chain name.
 	QString m_sName;
 
@@ -1096,6 +1140,9 @@ private:
 	// Audio inserts activation state.
 	unsigned int m_iAudioInsertActivated;
 
+	// Audio aux-sends activation state.
+	unsigned int m_iAudioAuxSendActivated;
+
 	// Internal running buffer chain references.
 	float **m_pppBuffers[2];
 
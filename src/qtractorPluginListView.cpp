@@ -1394,6 +1394,11 @@ bool qtractorPluginListView::eventFilter ( QObject *pObject, QEvent *pEvent )
 								.arg(pDirectAccessParam->display()));
 						}
 					}
+				#ifdef CONFIG_DSP_LOAD
+					const QString& sDspLoad = pPlugin->dspLoad().text();
+					if (!sDspLoad.isEmpty())
+						sToolTip.append('\n' + sDspLoad);
+				#endif
 					QToolTip::showText(pHelpEvent->globalPos(),
 						sToolTip, pViewport);
 					return true;
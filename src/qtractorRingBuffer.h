@@ -40,6 +40,9 @@ public:
 
 	// Constructors.
 	qtractorRingBuffer(unsigned short iChannels, unsigned int iBufferSize = 0);
+	// Shared storage constructor (iBufferSize must be a power-of-two).
+	qtractorRingBuffer(unsigned short iChannels, unsigned int iBufferSize,
+		T **ppBuffer);
 	// Default destructor.
 	~qtractorRingBuffer();
 
@@ -79,6 +82,9 @@ private:
 	qtractorAtomic m_iWriteIndex;
 
 	T** m_ppBuffer;
+
+	// Whether we own the buffer storage.
+	bool m_bOwner;
 };
 
 
@@ -107,6 +113,25 @@ qtractorRingBuffer<T>::qtractorRingBuffer ( unsigned short iChannels,
 	for (unsigned short i = 0; i < m_iChannels; ++i)
 		m_ppBuffer[i] = new T [m_iBufferSize];
 
+	m_bOwner = true;
+
+	ATOMIC_SET(&m_iReadIndex,  0);
+	ATOMIC_SET(&m_iWriteIndex, 0);
+}
+
+// Shared storage constructor.
+template<typename T>
+qtractorRingBuffer<T>::qtractorRingBuffer ( unsigned short iChannels,
+	unsigned int iBufferSize, T **ppBuffer )
+{
+	m_iChannels = iChannels;
+
+	m_iBufferSize = iBufferSize;
+	m_iBufferMask = (m_iBufferSize - 1);
+
+	m_ppBuffer = ppBuffer;
+	m_bOwner = false;
+
 	ATOMIC_SET(&m_iReadIndex,  0);
 	ATOMIC_SET(&m_iWriteIndex, 0);
 }
@@ -116,7 +141,7 @@ template<typename T>
 qtractorRingBuffer<T>::~qtractorRingBuffer (void)
 {
 	// Deallocate any buffer stuff...
-	if (m_ppBuffer) {
+	if (m_ppBuffer && m_bOwner) {
 		for (unsigned short i = 0; i < m_iChannels; ++i)
 			delete [] m_ppBuffer[i];
 		delete [] m_ppBuffer;
@@ -0,0 +1,232 @@
+// qtractorRtCommand.cpp
+//
+/****************************************************************************
+   Copyright (C) 2005-2022, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qtractorAbout.h"
+#include "qtractorRtCommand.h"
+
+
+//----------------------------------------------------------------------
+// class qtractorRtCommandQueue::GcThread -- Garbage collector thread.
+//
+
+class qtractorRtCommandQueue::GcThread : public QThread
+{
+public:
+
+	// Constructor.
+	GcThread(qtractorRtCommandQueue *pQueue)
+		: QThread(), m_pQueue(pQueue), m_bRunState(false) {}
+
+	// Run state accessor.
+	void setRunState(bool bRunState)
+		{ m_bRunState = bRunState; }
+
+	// Wake from executive wait condition (RT-safe).
+	void sync()
+	{
+		if (m_mutex.tryLock()) {
+			m_cond.wakeAll();
+			m_mutex.unlock();
+		}
+	}
+
+protected:
+
+	// The main thread executive.
+	void run()
+	{
+		m_mutex.lock();
+		m_bRunState = true;
+		while (m_bRunState) {
+			// Wait for sync, or just poll...
+			m_cond.wait(&m_mutex, 100);
+			m_pQueue->cleanup();
+			m_pQueue->notify();
+		}
+		m_mutex.unlock();
+	}
+
+private:
+
+	// Instance variables.
+	qtractorRtCommandQueue *m_pQueue;
+
+	volatile bool m_bRunState;
+
+	QMutex m_mutex;
+	QWaitCondition m_cond;
+};
+
+
+//----------------------------------------------------------------------
+// class qtractorRtCommandQueue -- Lock-free RT command queue.
+//
+
+// Constructor.
+qtractorRtCommandQueue::qtractorRtCommandQueue ( unsigned int iQueueSize )
+{
+	m_iQueueSize = (64 << 1);
+	while (m_iQueueSize < iQueueSize)
+		m_iQueueSize <<= 1;
+	m_iQueueMask = (m_iQueueSize - 1);
+
+	m_ppQueue = new qtractorRtCommand * [m_iQueueSize];
+	m_iQueueRead.storeRelease(0);
+	m_iQueueWrite.storeRelease(0);
+
+	m_ppTrash = new qtractorRtCommand * [m_iQueueSize];
+	m_iTrashRead.storeRelease(0);
+	m_iTrashWrite.storeRelease(0);
+
+	m_pGcThread = nullptr;
+}
+
+
+// Destructor.
+qtractorRtCommandQueue::~qtractorRtCommandQueue (void)
+{
+	stop();
+
+	// Whatever is still pending is just discarded...
+	const unsigned int w = m_iQueueWrite.loadAcquire();
+	unsigned int r = m_iQueueRead.loadAcquire();
+	while (r != w) {
+		delete m_ppQueue[r];
+		++r &= m_iQueueMask;
+	}
+	m_iQueueRead.storeRelease(r);
+
+	cleanup();
+
+	delete [] m_ppTrash;
+	delete [] m_ppQueue;
+}
+
+
+// Garbage collector thread start/stop.
+void qtractorRtCommandQueue::start (void)
+{
+	if (m_pGcThread)
+		return;
+
+	m_pGcThread = new GcThread(this);
+	m_pGcThread->start(QThread::LowPriority);
+}
+
+
+void qtractorRtCommandQueue::stop (void)
+{
+	if (m_pGcThread == nullptr)
+		return;
+
+	if (m_pGcThread->isRunning()) do {
+		m_pGcThread->setRunState(false);
+	//	m_pGcThread->terminate();
+		m_pGcThread->sync();
+	} while (!m_pGcThread->wait(100));
+
+	delete m_pGcThread;
+	m_pGcThread = nullptr;
+}
+
+
+// Producer side (non-RT): false if queue is full.
+bool qtractorRtCommandQueue::push ( qtractorRtCommand *pCommand )
+{
+	const unsigned int w = m_iQueueWrite.loadAcquire();
+	const unsigned int w1 = (w + 1) & m_iQueueMask;
+	if (w1 == (unsigned int) m_iQueueRead.loadAcquire())
+		return false;
+
+	m_ppQueue[w] = pCommand;
+	m_iQueueWrite.storeRelease(w1);
+
+	return true;
+}
+
+
+// Whether there's still anything not processed.
+bool qtractorRtCommandQueue::isPending (void) const
+{
+	return (m_iQueueRead.loadAcquire() != m_iQueueWrite.loadAcquire());
+}
+
+
+// Wait for all pending commands to be processed (non-RT).
+bool qtractorRtCommandQueue::wait ( unsigned long iTimeout )
+{
+	QMutexLocker locker(&m_waitMutex);
+
+	if (isPending())
+		m_waitCond.wait(&m_waitMutex, iTimeout);
+
+	return !isPending();
+}
+
+
+// Consumer side (RT, session acquired).
+void qtractorRtCommandQueue::process (void)
+{
+	unsigned int r = m_iQueueRead.loadAcquire();
+	const unsigned int w = m_iQueueWrite.loadAcquire();
+	if (r == w)
+		return;
+
+	unsigned int t = m_iTrashWrite.loadAcquire();
+	while (r != w) {
+		// Make sure there's room to trash it later...
+		const unsigned int t1 = (t + 1) & m_iQueueMask;
+		if (t1 == (unsigned int) m_iTrashRead.loadAcquire())
+			break;
+		qtractorRtCommand *pCommand = m_ppQueue[r];
+		pCommand->process();
+		m_ppTrash[t] = pCommand;
+		m_iTrashWrite.storeRelease(t = t1);
+		m_iQueueRead.storeRelease(r = (r + 1) & m_iQueueMask);
+	}
+
+	if (m_pGcThread)
+		m_pGcThread->sync();
+}
+
+
+// Dispose of all processed commands (non-RT).
+void qtractorRtCommandQueue::cleanup (void)
+{
+	unsigned int t = m_iTrashRead.loadAcquire();
+	const unsigned int w = m_iTrashWrite.loadAcquire();
+	while (t != w) {
+		delete m_ppTrash[t];
+		m_iTrashRead.storeRelease(t = (t + 1) & m_iQueueMask);
+	}
+}
+
+
+// Wake up any waiters (garbage collector thread).
+void qtractorRtCommandQueue::notify (void)
+{
+	QMutexLocker locker(&m_waitMutex);
+
+	m_waitCond.wakeAll();
+}
+
+
+// end of qtractorRtCommand.cpp
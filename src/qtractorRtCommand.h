@@ -0,0 +1,123 @@
+// qtractorRtCommand.h
+//
+/****************************************************************************
+   Copyright (C) 2005-2022, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qtractorRtCommand_h
+#define __qtractorRtCommand_h
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInt>
+
+
+//----------------------------------------------------------------------
+// class qtractorRtCommand -- Pre-built engine state change (abstract).
+//
+
+class qtractorRtCommand
+{
+public:
+
+	// Constructor.
+	qtractorRtCommand() {}
+
+	// Virtual destructor (garbage collector thread).
+	virtual ~qtractorRtCommand() {}
+
+	// Apply the change (RT thread, session acquired);
+	// must not allocate, block nor do any I/O whatsoever.
+	virtual void process() = 0;
+};
+
+
+//----------------------------------------------------------------------
+// class qtractorRtCommandQueue -- Lock-free RT command queue.
+//
+
+class qtractorRtCommandQueue
+{
+public:
+
+	// Constructor.
+	qtractorRtCommandQueue(unsigned int iQueueSize = 1024);
+
+	// Destructor.
+	~qtractorRtCommandQueue();
+
+	// Garbage collector thread start/stop.
+	void start();
+	void stop();
+
+	// Producer side (non-RT): false if queue is full.
+	bool push(qtractorRtCommand *pCommand);
+
+	// Whether there's still anything not processed.
+	bool isPending() const;
+
+	// Wait for all pending commands to be processed (non-RT);
+	// false if still pending after the given timeout.
+	bool wait(unsigned long iTimeout);
+
+	// Consumer side (RT, session acquired).
+	void process();
+
+	// Dispose of all processed commands (non-RT).
+	void cleanup();
+
+	// Wake up any waiters (garbage collector thread).
+	void notify();
+
+protected:
+
+	// Garbage collector thread.
+	class GcThread;
+
+private:
+
+	// Queue and trash ring-buffers (single-producer/single-consumer).
+	unsigned int m_iQueueSize;
+	unsigned int m_iQueueMask;
+
+	// Slots are written before their index gets published (release)
+	// and read only after that same index has been seen (acquire).
+	qtractorRtCommand **m_ppQueue;
+
+	QAtomicInt m_iQueueRead;
+	QAtomicInt m_iQueueWrite;
+
+	qtractorRtCommand **m_ppTrash;
+
+	QAtomicInt m_iTrashRead;
+	QAtomicInt m_iTrashWrite;
+
+	// Garbage collector thread instance.
+	GcThread *m_pGcThread;
+
+	// Pending commands waiters.
+	QMutex         m_waitMutex;
+	QWaitCondition m_waitCond;
+};
+
+
+#endif  // __qtractorRtCommand_h
+
+
+// end of qtractorRtCommand.h
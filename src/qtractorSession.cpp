@@ -25,6 +25,9 @@
 
 #include "qtractorAudioEngine.h"
 #include "qtractorAudioPeak.h"
+#include "qtractorAudioCache.h"
+#include "qtractorAudioStretch.h"
+#include "qtractorRtCommand.h"
 #include "qtractorAudioClip.h"
 #include "qtractorAudioBuffer.h"
 
@@ -56,6 +59,10 @@
 #include <stdlib.h>
 
 
+// Pending RT commands wait slice (msecs).
+#define QTRACTOR_RT_COMMANDS_WAIT 100
+
+
 //-------------------------------------------------------------------------
 // qtractorSession::Properties -- Session properties structure.
 
@@ -107,6 +114,9 @@ qtractorSession::qtractorSession (void)
 
 	m_midiManagers.setAutoDelete(false);
 
+	// The tempo-map is shared with the RT threads.
+	m_props.timeScale.setSharedMap(true);
+
 	// Initial comon client name.
 	m_sClientName = QTRACTOR_TITLE;
 
@@ -119,6 +129,16 @@ qtractorSession::qtractorSession (void)
 	m_pMidiEngine       = new qtractorMidiEngine(this);
 	m_pAudioEngine      = new qtractorAudioEngine(this);
 	m_pAudioPeakFactory = new qtractorAudioPeakFactory();
+	m_pAudioCache       = new qtractorAudioCache();
+	m_pAudioStretchCache = new qtractorAudioStretchCache();
+
+	// Shared audio disk-streaming thread pool (lazy).
+	m_pSyncThread = nullptr;
+	m_pCaptureThread = nullptr;
+
+	// Lock-free RT command queue (and its garbage collector).
+	m_pRtCommands = new qtractorRtCommandQueue();
+	m_pRtCommands->start();
 
 	m_bAutoTimeStretch  = false;
 
@@ -136,8 +156,11 @@ qtractorSession::~qtractorSession (void)
 	close();
 	clear();
 
+	delete m_pAudioStretchCache;
+	delete m_pAudioCache;
 	delete m_pAudioPeakFactory;
 	delete m_pAudioEngine;
+	delete m_pRtCommands;
 	delete m_pMidiEngine;
 
 	delete m_pInstruments;
@@ -145,6 +168,12 @@ qtractorSession::~qtractorSession (void)
 
 	delete m_pFiles;
 
+	// Last but not least, all buffers must be gone by now...
+	if (m_pCaptureThread)
+		delete m_pCaptureThread;
+	if (m_pSyncThread)
+		delete m_pSyncThread;
+
 	g_pSession = nullptr;
 }
 
@@ -247,6 +276,9 @@ void qtractorSession::close (void)
 // Reset session.
 void qtractorSession::clear (void)
 {
+	// Flush any pending RT state changes...
+	syncRtCommands();
+
 	ATOMIC_SET(&m_locks, 0);
 	ATOMIC_SET(&m_mutex, 0);
 
@@ -325,6 +357,8 @@ void qtractorSession::clear (void)
 	}
 
 	m_pAudioPeakFactory->cleanup();
+	m_pAudioCache->cleanup();
+	m_pAudioStretchCache->cleanup();
 
 	qtractorMidiControl *pMidiControl = qtractorMidiControl::getInstance();
 	if (pMidiControl)
@@ -662,12 +696,12 @@ unsigned int qtractorSession::beatFromFrame ( unsigned long iFrame )
 // Tick/Frame number conversion.
 unsigned long qtractorSession::frameFromTick ( unsigned long iTick )
 {
-	return m_props.timeScale.frameFromTick(iTick);
+	return m_props.timeScale.map()->frameFromTick(iTick);
 }
 
 unsigned long qtractorSession::tickFromFrame ( unsigned long iFrame )
 {
-	return m_props.timeScale.tickFromFrame(iFrame);
+	return m_props.timeScale.map()->tickFromFrame(iFrame);
 }
 
 
@@ -967,15 +1001,24 @@ void qtractorSession::updateTrack ( qtractorTrack *pTrack )
 {
 //	lock();
 
+	pTrack->updateClipIndex();
 	pTrack->setLoop(m_iLoopStart, m_iLoopEnd);
 
+	updateTrackCursors(pTrack);
+
+//	unlock();
+}
+
+
+// Session cursors refresh, after some track clips
+// have been (un)linked and re-indexed (RT-safe).
+void qtractorSession::updateTrackCursors ( qtractorTrack *pTrack )
+{
 	qtractorSessionCursor *pSessionCursor = m_cursors.first();
 	while (pSessionCursor) {
 		pSessionCursor->updateTrack(pTrack);
 		pSessionCursor = pSessionCursor->next();
 	}
-
-//	unlock();
 }
 
 
@@ -1300,6 +1343,19 @@ void qtractorSession::unlock (void)
 	// Unwind pending locks and force back to business...
 	if (ATOMIC_DEC(&m_locks) < 1) {
 		ATOMIC_SET(&m_locks, 0);
+		// Known-quiescent point: no RT cycle is in business,
+		// so any pending clip read-ahead schedule is stale...
+		if (m_pAudioEngine)
+			m_pAudioEngine->resetPreRoll();
+		// And, if the MIDI output thread is idle, retired
+		// tempo-map and clip index snapshots may be freed...
+		if (m_pMidiEngine == nullptr || m_pMidiEngine->outputIdleSync()) {
+			m_props.timeScale.reclaimMaps();
+			for (qtractorTrack *pTrack = m_tracks.first();
+					pTrack; pTrack = pTrack->next()) {
+				pTrack->reclaimClipIndex();
+			}
+		}
 		release();
 	}
 }
@@ -1312,6 +1368,62 @@ bool qtractorSession::isBusy (void) const
 }
 
 
+// Lock-free RT command queue accessor.
+qtractorRtCommandQueue *qtractorSession::rtCommands (void) const
+{
+	return m_pRtCommands;
+}
+
+
+// Post a pre-built state change to the RT thread (non-RT).
+void qtractorSession::postRtCommand ( qtractorRtCommand *pCommand )
+{
+	// RT thread is there to take it, sooner or later...
+	while (isRtCommandsProcessing()) {
+		if (m_pRtCommands->push(pCommand))
+			return;
+		// Queue is full, let it catch up...
+		m_pRtCommands->wait(QTRACTOR_RT_COMMANDS_WAIT);
+	}
+
+	// Otherwise just do it now, in order...
+	syncRtCommands();
+
+	lock();
+	pCommand->process();
+	unlock();
+
+	delete pCommand;
+}
+
+
+// Wait for all posted state changes to be applied (non-RT).
+void qtractorSession::syncRtCommands (void)
+{
+	while (m_pRtCommands->isPending()) {
+		// The RT thread is not there to take them? do it the hard
+		// way, as we're the only one around anyway...
+		if (!isRtCommandsProcessing()) {
+			lock();
+			m_pRtCommands->process();
+			unlock();
+		}
+		// Wait for the RT thread to catch up...
+		m_pRtCommands->wait(QTRACTOR_RT_COMMANDS_WAIT);
+	}
+}
+
+
+// Whether the RT thread is there to apply posted state changes,
+// ie. the engine is running and it's not being held off (non-RT).
+bool qtractorSession::isRtCommandsProcessing (void) const
+{
+	return m_pAudioEngine->isActivated()
+		&& !m_pAudioEngine->isFreewheel()
+		&& !isBusy();
+}
+
+
 // Playhead positioning.
 void qtractorSession::setPlayHead ( unsigned long iPlayHead )
 {
@@ -1928,6 +2040,55 @@ qtractorAudioPeakFactory *qtractorSession::audioPeakFactory (void) const
 }
 
 
+// Audio clip RAM cache accessor.
+qtractorAudioCache *qtractorSession::audioCache (void) const
+{
+	return m_pAudioCache;
+}
+
+
+// Audio clip time-stretch render cache accessor.
+qtractorAudioStretchCache *qtractorSession::audioStretchCache (void) const
+{
+	return m_pAudioStretchCache;
+}
+
+
+// Shared audio disk-streaming thread pool accessor (lazy).
+qtractorAudioBufferThread *qtractorSession::syncThread (void)
+{
+	if (m_pSyncThread == nullptr) {
+		unsigned short iSyncThreads
+			= qtractorAudioBufferThread::defaultSyncThreads();
+		if (iSyncThreads < 1) {
+			const int iIdealThreads = QThread::idealThreadCount() >> 1;
+			iSyncThreads = (iIdealThreads > 4 ? 4 : iIdealThreads);
+			if (iSyncThreads < 1)
+				iSyncThreads = 1;
+		}
+		m_pSyncThread = new qtractorAudioBufferThread(
+			qtractorAudioBufferThread::MaxSyncSize, iSyncThreads);
+		m_pSyncThread->start(QThread::HighPriority);
+	}
+
+	return m_pSyncThread;
+}
+
+
+// Dedicated audio capture (recording) thread accessor (lazy);
+// kept apart so that playback streaming never delays capture.
+qtractorAudioBufferThread *qtractorSession::captureThread (void)
+{
+	if (m_pCaptureThread == nullptr) {
+		m_pCaptureThread = new qtractorAudioBufferThread(
+			qtractorAudioBufferThread::MaxSyncSize, 1);
+		m_pCaptureThread->start(QThread::HighPriority);
+	}
+
+	return m_pCaptureThread;
+}
+
+
 // MIDI track tagging specifics.
 unsigned short qtractorSession::midiTag (void) const
 {
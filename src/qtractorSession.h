@@ -38,6 +38,11 @@ class qtractorClip;
 class qtractorMidiEngine;
 class qtractorAudioEngine;
 class qtractorAudioPeakFactory;
+class qtractorAudioBufferThread;
+class qtractorAudioCache;
+class qtractorAudioStretchCache;
+class qtractorRtCommandQueue;
+class qtractorRtCommand;
 class qtractorSessionCursor;
 class qtractorMidiManager;
 class qtractorInstrumentList;
@@ -185,6 +190,7 @@ public:
 	void insertTrack(qtractorTrack *pTrack, qtractorTrack *pPrevTrack = nullptr);
 	void moveTrack(qtractorTrack *pTrack, qtractorTrack *pNextTrack);
 	void updateTrack(qtractorTrack *pTrack);
+	void updateTrackCursors(qtractorTrack *pTrack);
 	void unlinkTrack(qtractorTrack *pTrack);
 
 	qtractorTrack *trackAt(int iTrack) const;
@@ -237,6 +243,19 @@ public:
 	// Re-entrancy check.
 	bool isBusy() const;
 
+	// Lock-free RT command queue accessor.
+	qtractorRtCommandQueue *rtCommands() const;
+
+	// Post a pre-built state change to the RT thread (non-RT);
+	// applied straight away, under lock, if the RT thread can't.
+	void postRtCommand(qtractorRtCommand *pCommand);
+
+	// Wait for all posted state changes to be applied (non-RT).
+	void syncRtCommands();
+
+	// Whether the RT thread is there to apply them (non-RT).
+	bool isRtCommandsProcessing() const;
+
 	// Consolidated session engine start status.
 	void setPlaying(bool bPlaying);
 	bool isPlaying() const;
@@ -331,6 +350,18 @@ public:
 	// Audio peak factory accessor.
 	qtractorAudioPeakFactory *audioPeakFactory() const;
 
+	// Shared audio disk-streaming thread pool accessor.
+	qtractorAudioBufferThread *syncThread();
+
+	// Dedicated audio capture (recording) thread accessor.
+	qtractorAudioBufferThread *captureThread();
+
+	// Audio clip RAM cache accessor.
+	qtractorAudioCache *audioCache() const;
+
+	// Audio clip time-stretch render cache accessor.
+	qtractorAudioStretchCache *audioStretchCache() const;
+
 	// MIDI track tagging specifics.
 	unsigned short midiTag() const;
 	void acquireMidiTag(qtractorTrack *pTrack);
@@ -457,6 +488,21 @@ private:
 	// Audio peak factory (singleton) instance.
 	qtractorAudioPeakFactory *m_pAudioPeakFactory;
 
+	// Shared audio disk-streaming thread pool.
+	qtractorAudioBufferThread *m_pSyncThread;
+
+	// Dedicated audio capture (recording) thread.
+	qtractorAudioBufferThread *m_pCaptureThread;
+
+	// Audio clip RAM cache instance.
+	qtractorAudioCache *m_pAudioCache;
+
+	// Audio clip time-stretch render cache instance.
+	qtractorAudioStretchCache *m_pAudioStretchCache;
+
+	// Lock-free RT command queue.
+	qtractorRtCommandQueue *m_pRtCommands;
+
 	// Track recording counts.
 	unsigned short m_iAudioRecord;
 	unsigned short m_iMidiRecord;
@@ -159,8 +159,13 @@ qtractorClip *qtractorSessionCursor::clip ( unsigned int iTrack ) const
 qtractorClip *qtractorSessionCursor::seekClip (
 	qtractorTrack *pTrack, qtractorClip *pClip, unsigned long iFrame ) const
 {
-	if (pClip == nullptr)
+	// Straight to the point, if indexed...
+	if (pClip == nullptr) {
+		const qtractorClipIndex& clipIndex = pTrack->clipIndex();
+		if (clipIndex.isValid())
+			return clipIndex.seekClip(iFrame);
 		pClip = pTrack->clips().first();
+	}
 
 	while (pClip && iFrame > pClip->clipStart() + pClip->clipLength()) {
 	//	if (pTrack->trackType() == m_syncType)
@@ -21,11 +21,25 @@
 
 #include "qtractorTimeScale.h"
 
+#include <stdlib.h>
+
 
 //----------------------------------------------------------------------
 // class qtractorTimeScale -- Time scale conversion helper class.
 //
 
+// Destructor.
+qtractorTimeScale::~qtractorTimeScale (void)
+{
+	Map *pMap = m_pMap.fetchAndStoreOrdered(nullptr);
+	if (pMap)
+		::free(pMap);
+
+	m_bSharedMap = false;
+	reclaimMaps();
+}
+
+
 // Node list cleaner.
 void qtractorTimeScale::reset (void)
 {
@@ -463,6 +477,9 @@ void qtractorTimeScale::updateNode ( qtractorTimeScale::Node *pNode )
 
 	// And update marker/bar positions too...
 	updateMarkers(pNode->prev());
+
+	// Recompile the tempo-map snapshot.
+	updateMap();
 }
 
 
@@ -490,6 +507,9 @@ void qtractorTimeScale::removeNode ( qtractorTimeScale::Node *pNode )
 
 	// Then update marker/bar positions too...
 	updateMarkers(pNodePrev);
+
+	// Recompile the tempo-map snapshot.
+	updateMap();
 }
 
 
@@ -512,6 +532,95 @@ void qtractorTimeScale::updateScale (void)
 
 	// Also update all marker/bar positions too...
 	updateMarkers(m_nodes.first());
+
+	// Recompile the tempo-map snapshot.
+	updateMap();
+}
+
+
+// Tempo-map snapshot (re)builder.
+void qtractorTimeScale::updateMap (void)
+{
+	const unsigned int iCount = (m_nodes.count() > 0 ? m_nodes.count() : 1);
+
+	Map *pMap = static_cast<Map *> (::malloc(
+		sizeof(Map) + (iCount - 1) * sizeof(Map::Item)));
+
+	pMap->m_pNext = nullptr;
+	pMap->m_fFrameRate = m_fFrameRate;
+	pMap->m_iCount = 0;
+
+	for (Node *pNode = m_nodes.first(); pNode; pNode = pNode->next()) {
+		Map::Item& item = pMap->m_items[pMap->m_iCount++];
+		item.frame = pNode->frame;
+		item.tick  = pNode->tick;
+		item.tickRate = pNode->tickRate;
+	}
+
+	// There must always be one segment...
+	if (pMap->m_iCount < 1) {
+		Map::Item& item = pMap->m_items[pMap->m_iCount++];
+		item.frame = 0;
+		item.tick  = 0;
+		item.tickRate = 120.0f * TICKS_PER_BEAT_HRQ;
+	}
+
+	// Swap in the new snapshot; the old one is retired, as
+	// some other thread might still be converting through it
+	// right now, until some known-quiescent point...
+	Map *pOldMap = m_pMap.fetchAndStoreOrdered(pMap);
+	if (pOldMap) {
+		pOldMap->m_pNext = m_pRetiredMap;
+		m_pRetiredMap = pOldMap;
+	}
+
+	// Not shared? nothing to wait for...
+	if (!m_bSharedMap)
+		reclaimMaps();
+}
+
+
+// Retired tempo-map snapshots reclamation (non-RT;
+// shared ones only at a known-quiescent point).
+void qtractorTimeScale::reclaimMaps (void)
+{
+	while (m_pRetiredMap) {
+		Map *pOldMap = m_pRetiredMap;
+		m_pRetiredMap = pOldMap->m_pNext;
+		::free(pOldMap);
+	}
+}
+
+
+// Tempo-map snapshot segment index seekers (binary search).
+unsigned int qtractorTimeScale::Map::seekFrame ( unsigned long iFrame ) const
+{
+	unsigned int lo = 1;
+	unsigned int hi = m_iCount;
+	while (lo < hi) {
+		const unsigned int mid = (lo + hi) >> 1;
+		if (m_items[mid].frame > iFrame)
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+
+	return lo - 1;
+}
+
+unsigned int qtractorTimeScale::Map::seekTick ( unsigned long iTick ) const
+{
+	unsigned int lo = 1;
+	unsigned int hi = m_iCount;
+	while (lo < hi) {
+		const unsigned int mid = (lo + hi) >> 1;
+		if (m_items[mid].tick > iTick)
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+
+	return lo - 1;
 }
 
 
@@ -26,6 +26,7 @@
 
 #include <QStringList>
 #include <QColor>
+#include <QAtomicPointer>
 
 
 // Needed for the translation functions.
@@ -47,11 +48,16 @@ public:
 
 	// Default constructor.
 	qtractorTimeScale() : m_displayFormat(Frames),
-		m_cursor(this), m_markerCursor(this) { clear(); }
+		m_cursor(this), m_markerCursor(this),
+		m_pRetiredMap(nullptr), m_bSharedMap(false) { clear(); }
 
 	// Copy constructor.
 	qtractorTimeScale(const qtractorTimeScale& ts)
-		: m_cursor(this), m_markerCursor(this) { copy(ts); }
+		: m_cursor(this), m_markerCursor(this),
+		m_pRetiredMap(nullptr), m_bSharedMap(false) { copy(ts); }
+
+	// Destructor.
+	~qtractorTimeScale();
 
 	// Assignment operator,
 	qtractorTimeScale& operator=(const qtractorTimeScale& ts)
@@ -252,6 +258,9 @@ public:
 		// Node cached coefficients.
 		float tickRate;
 		float beatRate;
+
+		// Tempo-map snapshot needs these.
+		friend class qtractorTimeScale;
 	};
 
 	// Node list accessor.
@@ -290,6 +299,79 @@ public:
 	// Internal cursor accessor.
 	Cursor& cursor() { return m_cursor; }
 
+	// Compiled tempo-map snapshot: an immutable flat array of
+	// the tempo-map nodes, rebuilt on every tempo-map change,
+	// that may be used from any thread without node seeking.
+	class Map
+	{
+	public:
+
+		// Segment index seekers (binary search).
+		unsigned int seekFrame(unsigned long iFrame) const;
+		unsigned int seekTick(unsigned long iTick) const;
+
+		// Frame/tick convertors.
+		unsigned long tickFromFrame(unsigned long iFrame) const
+			{ return item(seekFrame(iFrame)).tickFromFrame(iFrame, m_fFrameRate); }
+		unsigned long frameFromTick(unsigned long iTick) const
+			{ return item(seekTick(iTick)).frameFromTick(iTick, m_fFrameRate); }
+
+		// Frame/tick span convertors: given a segment index hint,
+		// as from a previous call on a preceding (sorted) position,
+		// which gets advanced as necessary (no seeking at all).
+		unsigned long tickFromFrame(unsigned long iFrame, unsigned int& i) const
+		{
+			while (i + 1 < m_iCount && iFrame >= m_items[i + 1].frame) ++i;
+			return item(i).tickFromFrame(iFrame, m_fFrameRate);
+		}
+		unsigned long frameFromTick(unsigned long iTick, unsigned int& i) const
+		{
+			while (i + 1 < m_iCount && iTick >= m_items[i + 1].tick) ++i;
+			return item(i).frameFromTick(iTick, m_fFrameRate);
+		}
+
+	protected:
+
+		// Map segment (same as node conversion coefficients).
+		struct Item
+		{
+			unsigned long tickFromFrame(unsigned long iFrame, float fFrameRate) const
+				{ return tick + uroundf((tickRate * (iFrame - frame)) / fFrameRate); }
+			unsigned long frameFromTick(unsigned long iTick, float fFrameRate) const
+				{ return frame + uroundf((fFrameRate * (iTick - tick)) / tickRate); }
+
+			unsigned long frame;
+			unsigned long tick;
+			float         tickRate;
+		};
+
+		const Item& item(unsigned int i) const
+			{ return m_items[i]; }
+
+	private:
+
+		// Instance members (variable sized).
+		Map         *m_pNext;	// Retired chain.
+		float        m_fFrameRate;
+		unsigned int m_iCount;
+		Item         m_items[1];
+
+		friend class qtractorTimeScale;
+	};
+
+	// Current tempo-map snapshot accessor.
+	const Map *map() const { return m_pMap.loadAcquire(); }
+
+	// Whether tempo-map snapshots are shared with other (RT)
+	// threads; if so, retired ones are only ever freed on
+	// reclaimMaps(), otherwise right away (default not).
+	void setSharedMap(bool bSharedMap) { m_bSharedMap = bSharedMap; }
+	bool isSharedMap() const { return m_bSharedMap; }
+
+	// Retired tempo-map snapshots reclamation (non-RT;
+	// shared ones only at a known-quiescent point).
+	void reclaimMaps();
+
 	// Node list specifics.
 	Node *addNode(
 		unsigned long iFrame = 0,
@@ -614,6 +696,9 @@ protected:
 	float pixelRate() const { return m_fPixelRate; }
 	float frameRate() const { return m_fFrameRate; }
 
+	// Tempo-map snapshot (re)builder.
+	void updateMap();
+
 	// MIDI time adjust to/from official high resolution queue (64bit).
 	unsigned long timep ( unsigned long time ) const
 		{ return uint64_t(time) * TICKS_PER_BEAT_HRQ / m_iTicksPerBeat; }
@@ -651,6 +736,11 @@ private:
 
 	// Internal node cursor.
 	MarkerCursor m_markerCursor;
+
+	// Tempo-map snapshot (current and retired).
+	QAtomicPointer<Map> m_pMap;
+	Map *m_pRetiredMap;
+	bool m_bSharedMap;
 };
 
 
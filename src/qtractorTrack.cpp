@@ -31,6 +31,7 @@
 #include "qtractorAudioEngine.h"
 #include "qtractorAudioMonitor.h"
 #include "qtractorAudioBuffer.h"
+#include "qtractorAudioRender.h"
 #include "qtractorMidiEngine.h"
 #include "qtractorMidiMonitor.h"
 #include "qtractorMidiManager.h"
@@ -311,7 +312,11 @@ qtractorTrack::qtractorTrack ( qtractorSession *pSession, TrackType trackType )
 
 	m_clips.setAutoDelete(true);
 
-	m_pSyncThread = nullptr;
+	m_iRenderChannels = 0;
+	m_ppRenderXBuffer = nullptr;
+	m_ppRenderYBuffer = nullptr;
+
+	m_bRenderSilent = false;
 
 	m_pMidiVolumeObserver  = nullptr;
 	m_pMidiPanningObserver = nullptr;
@@ -381,6 +386,8 @@ qtractorTrack::~qtractorTrack (void)
 		delete m_pPluginList;
 	if (m_pMonitor)
 		delete m_pMonitor;
+
+	deleteRenderBuffers();
 }
 
 
@@ -391,6 +398,7 @@ void qtractorTrack::clear (void)
 
 	clearTakeInfo();
 	m_clips.clear();
+	m_clipIndex.update(m_clips);
 
 	m_pPluginList->clear();
 	m_pCurveFile->clear();
@@ -413,16 +421,6 @@ void qtractorTrack::clear (void)
 	m_props.solo    = false;
 	m_props.gain    = 1.0f;
 	m_props.panning = 0.0f;
-
-	if (m_pSyncThread) {
-		if (m_pSyncThread->isRunning()) do {
-			m_pSyncThread->setRunState(false);
-		//	m_pSyncThread->terminate();
-			m_pSyncThread->sync();
-		} while (!m_pSyncThread->wait(100));
-		delete m_pSyncThread;
-		m_pSyncThread = nullptr;
-	}
 }
 
 
@@ -505,6 +503,15 @@ bool qtractorTrack::open (void)
 				pAudioBus->channels(), m_props.gain, m_props.panning);
 			m_pPluginList->setChannels(pAudioBus->channels(),
 				qtractorPluginList::AudioTrack);
+			// Own rendering buffers, if in parallel...
+			qtractorAudioRender *pAudioRender = pAudioEngine->audioRender();
+			if (pAudioRender) {
+				pAudioRender->resetGraph();
+				createRenderBuffers(pAudioBus->channels(),
+					pAudioEngine->bufferSizeEx());
+			} else {
+				deleteRenderBuffers();
+			}
 		}
 		break;
 	}
@@ -1218,6 +1225,15 @@ const qtractorList<qtractorClip>& qtractorTrack::clips (void) const
 
 // Insert a new clip in guaranteed sorted fashion.
 void qtractorTrack::addClip ( qtractorClip *pClip )
+{
+	// Preliminary settings...
+	openClip(pClip);
+
+	// Now do insert the clip in proper place in track...
+	insertClip(pClip);
+}
+
+void qtractorTrack::openClip ( qtractorClip *pClip )
 {
 	// Preliminary settings...
 	pClip->setTrack(this);
@@ -1236,12 +1252,27 @@ void qtractorTrack::addClip ( qtractorClip *pClip )
 				setMidiProg(pMidiClip->prog());
 		}
 	}
-
-	// Now do insert the clip in proper place in track...
-	insertClip(pClip);
 }
 
 void qtractorTrack::insertClip ( qtractorClip *pClip )
+{
+	linkClipRt(pClip);
+
+	m_clipIndex.update(m_clips);
+}
+
+
+void qtractorTrack::unlinkClip ( qtractorClip *pClip )
+{
+	unlinkClipRt(pClip);
+
+	m_clipIndex.update(m_clips);
+}
+
+
+// Clip list (un)linking only, the clip index
+// snapshot is to be swapped in later (RT-safe).
+void qtractorTrack::linkClipRt ( qtractorClip *pClip )
 {
 	qtractorClip *pNextClip = m_clips.first();
 	while (pNextClip && pNextClip->clipStart() < pClip->clipStart())
@@ -1253,11 +1284,31 @@ void qtractorTrack::insertClip ( qtractorClip *pClip )
 }
 
 
-void qtractorTrack::unlinkClip ( qtractorClip *pClip )
+void qtractorTrack::unlinkClipRt ( qtractorClip *pClip )
 {
 	m_clips.unlink(pClip);
 }
 
+
+// Clip interval index refresh (non-RT).
+void qtractorTrack::updateClipIndex (void)
+{
+	m_clipIndex.update(m_clips);
+}
+
+// Swap in a pre-built clip index snapshot (RT-safe).
+void qtractorTrack::swapClipIndex ( qtractorClipIndex::Map *pMap )
+{
+	m_clipIndex.swapMap(pMap);
+}
+
+// Clip interval index retired snapshots reclamation
+// (non-RT; only at a known-quiescent point).
+void qtractorTrack::reclaimClipIndex (void)
+{
+	m_clipIndex.reclaimMaps();
+}
+
 void qtractorTrack::removeClip ( qtractorClip *pClip )
 {
 //	pClip->setTrack(nullptr);
@@ -1450,10 +1501,24 @@ void qtractorTrack::resetProperties (void)
 void qtractorTrack::process ( qtractorClip *pClip,
 	unsigned long iFrameStart, unsigned long iFrameEnd )
 {
+	process_render(pClip, iFrameStart, iFrameEnd);
+	process_commit(iFrameEnd - iFrameStart);
+}
+
+
+// Track split process cycle executives (parallel rendering).
+void qtractorTrack::process_render ( qtractorClip *pClip,
+	unsigned long iFrameStart, unsigned long iFrameEnd )
+{
+#ifdef CONFIG_DSP_LOAD
+	m_dspLoad.start();
+#endif
+
 	// Audio-buffers needs some preparation...
 	const unsigned int nframes = iFrameEnd - iFrameStart;
 	qtractorAudioMonitor *pAudioMonitor = nullptr;
 	qtractorAudioBus *pOutputBus = nullptr;
+	bool bSilent = false;
 	if (m_props.trackType == qtractorTrack::Audio) {
 		pAudioMonitor = static_cast<qtractorAudioMonitor *> (m_pMonitor);
 		pOutputBus = static_cast<qtractorAudioBus *> (m_pOutputBus);
@@ -1461,7 +1526,12 @@ void qtractorTrack::process ( qtractorClip *pClip,
 		if (pOutputBus) {
 			qtractorAudioBus *pInputBus = (m_pSession->isTrackMonitor(this)
 				? static_cast<qtractorAudioBus *> (m_pInputBus) : nullptr);
-			pOutputBus->buffer_prepare(nframes, pInputBus);
+			if (m_ppRenderXBuffer) {
+				bSilent = pOutputBus->buffer_prepare(m_ppRenderXBuffer,
+					m_ppRenderYBuffer, nframes, pInputBus);
+			} else {
+				bSilent = pOutputBus->buffer_prepare(nframes, pInputBus);
+			}
 		}
 	}
 
@@ -1472,21 +1542,120 @@ void qtractorTrack::process ( qtractorClip *pClip,
 		const unsigned long iFrameEnd2 = iFrameEnd + iLatency;
 		// Now, for every clip...
 		while (pClip && pClip->clipStart() < iFrameEnd2) {
-			if (iFrameStart2 < pClip->clipStart() + pClip->clipLength())
+			if (iFrameStart2 < pClip->clipStart() + pClip->clipLength()) {
 				pClip->process(iFrameStart2, iFrameEnd2);
+				bSilent = false;
+			}
 			pClip = pClip->next();
 		}
 	}
 
-	// Audio buffers needs monitoring and commitment...
+	// Audio buffers needs monitoring...
 	if (pAudioMonitor && pOutputBus) {
+		float **ppBuffer = audioBuffer();
 		// Plugin chain post-processing...
-		m_pPluginList->process(pOutputBus->buffer(), nframes);
+		bSilent = m_pPluginList->process(ppBuffer, nframes, bSilent);
 		// Monitor passthru...
-		pAudioMonitor->process(pOutputBus->buffer(), nframes);
-		// Actually render it...
+		bSilent = pAudioMonitor->process(ppBuffer, nframes, 0, bSilent);
+	}
+
+	m_bRenderSilent = bSilent;
+
+#ifdef CONFIG_DSP_LOAD
+	m_dspLoad.stop();
+#endif
+}
+
+
+void qtractorTrack::process_commit ( unsigned int nframes )
+{
+	// Audio buffers needs commitment...
+	if (m_props.trackType != qtractorTrack::Audio || m_pMonitor == nullptr)
+		return;
+
+	qtractorAudioBus *pOutputBus
+		= static_cast<qtractorAudioBus *> (m_pOutputBus);
+	if (pOutputBus == nullptr)
+		return;
+
+	// Nothing to add, if known silent...
+	if (m_bRenderSilent)
+		return;
+
+	// Actually render it...
+	if (m_ppRenderXBuffer)
+		pOutputBus->buffer_commit(m_ppRenderXBuffer, nframes);
+	else
 		pOutputBus->buffer_commit(nframes);
+}
+
+
+// Whether this track may be rendered in parallel.
+bool qtractorTrack::isRenderAsync (void) const
+{
+	// Aux-sends mix directly into other buses,
+	// so these must be kept in serial order...
+	return (m_props.trackType == qtractorTrack::Audio
+		&& m_ppRenderXBuffer && m_pMonitor && m_pOutputBus
+		&& !m_pPluginList->isAudioAuxSendActivated());
+}
+
+
+// Current audio rendering buffer (either own or output bus').
+float **qtractorTrack::audioBuffer (void) const
+{
+	if (m_ppRenderXBuffer)
+		return m_ppRenderYBuffer;
+
+	qtractorAudioBus *pAudioBus
+		= static_cast<qtractorAudioBus *> (m_pOutputBus);
+	return (pAudioBus ? pAudioBus->buffer() : nullptr);
+}
+
+
+// Own audio rendering buffers (parallel rendering).
+void qtractorTrack::createRenderBuffers (
+	unsigned short iChannels, unsigned int iBufferSize )
+{
+	deleteRenderBuffers();
+
+	if (iChannels < 1 || iBufferSize < 1)
+		return;
+
+	float **ppXBuffer = new float * [iChannels];
+	float **ppYBuffer = new float * [iChannels];
+	for (unsigned short i = 0; i < iChannels; ++i) {
+		ppXBuffer[i] = new float [iBufferSize];
+		ppYBuffer[i] = nullptr;
 	}
+
+	m_pSession->lock();
+	m_iRenderChannels = iChannels;
+	m_ppRenderXBuffer = ppXBuffer;
+	m_ppRenderYBuffer = ppYBuffer;
+	m_pSession->unlock();
+}
+
+
+void qtractorTrack::deleteRenderBuffers (void)
+{
+	if (m_ppRenderXBuffer == nullptr)
+		return;
+
+	float **ppXBuffer = m_ppRenderXBuffer;
+	float **ppYBuffer = m_ppRenderYBuffer;
+	const unsigned short iChannels = m_iRenderChannels;
+
+	if (m_pSession) m_pSession->lock();
+	m_ppRenderXBuffer = nullptr;
+	m_ppRenderYBuffer = nullptr;
+	m_iRenderChannels = 0;
+	if (m_pSession) m_pSession->unlock();
+
+	for (unsigned short i = 0; i < iChannels; ++i)
+		delete [] ppXBuffer[i];
+	delete [] ppXBuffer;
+	delete [] ppYBuffer;
 }
 
 
@@ -1499,15 +1668,31 @@ void qtractorTrack::process_export ( qtractorClip *pClip,
 	if (pCurveList && pCurveList->isProcess())
 		pCurveList->process(iFrameStart);
 
+	process_export_render(pClip, iFrameStart, iFrameEnd);
+	process_commit(iFrameEnd - iFrameStart);
+}
+
+
+// Track split freewheeling process executive (parallel export).
+void qtractorTrack::process_export_render ( qtractorClip *pClip,
+	unsigned long iFrameStart, unsigned long iFrameEnd )
+{
 	// Audio-buffers needs some preparation...
 	const unsigned int nframes = iFrameEnd - iFrameStart;
 	qtractorAudioMonitor *pAudioMonitor = nullptr;
 	qtractorAudioBus *pOutputBus = nullptr;
+	bool bSilent = false;
 	if (m_props.trackType == qtractorTrack::Audio) {
 		pAudioMonitor = static_cast<qtractorAudioMonitor *> (m_pMonitor);
 		pOutputBus = static_cast<qtractorAudioBus *> (m_pOutputBus);
-		if (pOutputBus)
-			pOutputBus->buffer_prepare(nframes);
+		if (pOutputBus) {
+			if (m_ppRenderXBuffer) {
+				bSilent = pOutputBus->buffer_prepare(m_ppRenderXBuffer,
+					m_ppRenderYBuffer, nframes);
+			} else {
+				bSilent = pOutputBus->buffer_prepare(nframes);
+			}
+		}
 	}
 
 	// Playback...
@@ -1517,21 +1702,24 @@ void qtractorTrack::process_export ( qtractorClip *pClip,
 		const unsigned long iFrameEnd2 = iFrameEnd + iLatency;
 		// Now, for every clip...
 		while (pClip && pClip->clipStart() < iFrameEnd2) {
-			if (iFrameStart2 < pClip->clipStart() + pClip->clipLength())
+			if (iFrameStart2 < pClip->clipStart() + pClip->clipLength()) {
 				pClip->process_export(iFrameStart2, iFrameEnd2);
+				bSilent = false;
+			}
 			pClip = pClip->next();
 		}
 	}
 
-	// Audio buffers needs monitoring and commitment...
+	// Audio buffers needs monitoring...
 	if (pAudioMonitor && pOutputBus) {
+		float **ppBuffer = audioBuffer();
 		// Plugin chain post-processing...
-		m_pPluginList->process(pOutputBus->buffer(), nframes);
+		bSilent = m_pPluginList->process(ppBuffer, nframes, bSilent);
 		// Monitor passthru...
-		pAudioMonitor->process(pOutputBus->buffer(), nframes);
-		// Actually render it...
-		pOutputBus->buffer_commit(nframes);
+		bSilent = pAudioMonitor->process(ppBuffer, nframes, 0, bSilent);
 	}
+
+	m_bRenderSilent = bSilent;
 }
 
 
@@ -1650,23 +1838,30 @@ void qtractorTrack::setLoop (
 {
 	qtractorClip *pClip = m_clips.first();
 	while (pClip) {
-		// Convert loop-points from session to clip...
-		const unsigned long iClipStart = pClip->clipStart();
-		const unsigned long iClipEnd   = iClipStart + pClip->clipLength();
-		if (iLoopStart < iClipEnd && iLoopEnd > iClipStart) {
-			// Set clip inner-loop...
-			pClip->setLoop(
-				(iLoopStart > iClipStart ? iLoopStart - iClipStart : 0),
-				(iLoopEnd < iClipEnd ? iLoopEnd : iClipEnd) - iClipStart);
-		} else {
-			// Clear/reaet clip-loop...
-			pClip->setLoop(0, 0);
-		}
+		setClipLoop(pClip, iLoopStart, iLoopEnd);
 		pClip = pClip->next();
 	}
 }
 
 
+void qtractorTrack::setClipLoop ( qtractorClip *pClip,
+	unsigned long iLoopStart, unsigned long iLoopEnd )
+{
+	// Convert loop-points from session to clip...
+	const unsigned long iClipStart = pClip->clipStart();
+	const unsigned long iClipEnd   = iClipStart + pClip->clipLength();
+	if (iLoopStart < iClipEnd && iLoopEnd > iClipStart) {
+		// Set clip inner-loop...
+		pClip->setLoop(
+			(iLoopStart > iClipStart ? iLoopStart - iClipStart : 0),
+			(iLoopEnd < iClipEnd ? iLoopEnd : iClipEnd) - iClipStart);
+	} else {
+		// Clear/reaet clip-loop...
+		pClip->setLoop(0, 0);
+	}
+}
+
+
 // MIDI track instrument patching.
 void qtractorTrack::setMidiPatch ( qtractorInstrumentList *pInstruments )
 {
@@ -1715,14 +1910,8 @@ void qtractorTrack::updateClipEditors (void)
 // Audio buffer ring-cache (playlist) methods.
 qtractorAudioBufferThread *qtractorTrack::syncThread (void)
 {
-	if (m_pSyncThread == nullptr) {
-		m_pSyncThread = new qtractorAudioBufferThread();
-		m_pSyncThread->start(QThread::HighPriority);
-	} else {
-		m_pSyncThread->checkSyncSize(m_clips.count());
-	}
-
-	return m_pSyncThread;
+	// Now a session-wide shared thread pool...
+	return m_pSession->syncThread();
 }
 
 
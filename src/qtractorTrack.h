@@ -26,6 +26,10 @@
 
 #include "qtractorMidiControl.h"
 
+#include "qtractorDspLoad.h"
+
+#include "qtractorClipIndex.h"
+
 #include <QColor>
 
 
@@ -177,6 +181,12 @@ public:
 	// Track plugin-chain accessor.
 	qtractorPluginList *pluginList() const;
 
+#ifdef CONFIG_DSP_LOAD
+	// Process cycle timing statistics.
+	qtractorDspLoad& dspLoad() { return m_dspLoad; }
+	const qtractorDspLoad& dspLoad() const { return m_dspLoad; }
+#endif
+
 	// Plugin latency compensation accessors.
 	void setPluginListLatency(bool bPluginListLatency);
 	bool isPluginListLatency() const;
@@ -199,10 +209,25 @@ public:
 	const qtractorList<qtractorClip>& clips() const;
 
 	void addClip(qtractorClip *pClip);
+	void openClip(qtractorClip *pClip);
 	void insertClip(qtractorClip *pClip);
 	void unlinkClip(qtractorClip *pClip);
 	void removeClip(qtractorClip *pClip);
 
+	// Clip list (un)linking only, the clip index
+	// snapshot is to be swapped in later (RT-safe).
+	void linkClipRt(qtractorClip *pClip);
+	void unlinkClipRt(qtractorClip *pClip);
+
+	// Clip interval index (overlap spans).
+	const qtractorClipIndex& clipIndex() const
+		{ return m_clipIndex; }
+	void updateClipIndex();
+	void reclaimClipIndex();
+
+	// Swap in a pre-built clip index snapshot (RT-safe).
+	void swapClipIndex(qtractorClipIndex::Map *pMap);
+
 	// Current clip on record (capture).
 	void setClipRecord(qtractorClip *pClipRecord);
 	qtractorClip *clipRecord() const;
@@ -230,10 +255,25 @@ public:
 	void process(qtractorClip *pClip,
 		unsigned long iFrameStart, unsigned long iFrameEnd);
 
+	// Track split process cycle executives (parallel rendering).
+	void process_render(qtractorClip *pClip,
+		unsigned long iFrameStart, unsigned long iFrameEnd);
+	void process_commit(unsigned int nframes);
+
+	// Whether this track may be rendered in parallel.
+	bool isRenderAsync() const;
+
+	// Current audio rendering buffer (either own or output bus').
+	float **audioBuffer() const;
+
 	// Track freewheeling process cycle executive (needed for export).
 	void process_export(qtractorClip *pClip,
 		unsigned long iFrameStart, unsigned long iFrameEnd);
 
+	// Track split freewheeling process executive (parallel export).
+	void process_export_render(qtractorClip *pClip,
+		unsigned long iFrameStart, unsigned long iFrameEnd);
+
 	// Track special process record executive (audio recording only).
 	void process_record(
 		unsigned long iFrameStart, unsigned long iFrameEnd);
@@ -251,6 +291,8 @@ public:
 
 	// Track loop point setler.
 	void setLoop(unsigned long iLoopStart, unsigned long iLoopEnd);
+	void setClipLoop(qtractorClip *pClip,
+		unsigned long iLoopStart, unsigned long iLoopEnd);
 
 	// Update all clips editors.
 	void updateClipEditors();
@@ -400,6 +442,7 @@ private:
 	int              m_iZoomHeight; // View height (zoomed).
 
 	qtractorList<qtractorClip> m_clips; // List of clips.
+	qtractorClipIndex m_clipIndex;      // Clip interval index.
 
 	qtractorClip *m_pClipRecord;        // Current clip on record (capture).
 	unsigned long m_iClipRecordStart;   // Current clip on record start frame.
@@ -408,8 +451,20 @@ private:
 
 	qtractorPluginList *m_pPluginList;	// Plugin chain (audio).
 
-	// Audio buffer ring-cache (playlist).
-	qtractorAudioBufferThread *m_pSyncThread;
+#ifdef CONFIG_DSP_LOAD
+	qtractorDspLoad m_dspLoad;          // Process cycle timing statistics.
+#endif
+
+	// Own audio rendering buffers (parallel rendering).
+	void createRenderBuffers(unsigned short iChannels, unsigned int iBufferSize);
+	void deleteRenderBuffers();
+
+	unsigned short m_iRenderChannels;
+	float        **m_ppRenderXBuffer;
+	float        **m_ppRenderYBuffer;
+
+	// Whether the last rendered buffer is known silent.
+	bool           m_bRenderSilent;
 
 	// MIDI track/channel (volume, panning) observers.
 	class MidiVolumeObserver;
@@ -303,12 +303,13 @@ void qtractorTrackView::updateContentsWidth ( int iContentsWidth )
 			iContentsWidth += qtractorScrollView::width();
 		// HACK: Try and check whether we need to change
 		// current (global) audio-peak period resolution...
+		// (coarser resolutions are served by the peak pyramid levels)
 		qtractorAudioPeakFactory *pPeakFactory = pSession->audioPeakFactory();
 		if (pPeakFactory) {
 			const unsigned short iPeakPeriod = pPeakFactory->peakPeriod();
 			// Should we change resolution?
 			const int p2 = ((iSessionLength / iPeakPeriod) >> 1) + 1;
-			int q2 = (iSessionWidth / p2);
+			const int q2 = (iSessionWidth / p2);
 			if (q2 > 4) {
 				pPeakFactory->setPeakPeriod(iPeakPeriod >> 3);
 			#ifdef CONFIG_DEBUG
@@ -319,20 +320,6 @@ void qtractorTrackView::updateContentsWidth ( int iContentsWidth )
 					pPeakFactory->peakPeriod(), iPeakPeriod, p2, q2);
 			#endif
 			}
-			else
-			if (q2 < 2 && iSessionWidth > 1) {
-				q2 = (p2 / iSessionWidth);
-				if (q2 > 4) {
-					pPeakFactory->setPeakPeriod(iPeakPeriod << 3);
-				#ifdef CONFIG_DEBUG
-					qDebug("qtractorTrackView::updateContentsWidth() "
-						"iSessionLength=%lu iSessionWidth=%d "
-						"-- peakPeriod=%u (%u) p2=%d q2=%d.",
-						iSessionLength, iSessionWidth,
-						pPeakFactory->peakPeriod(), iPeakPeriod, p2, q2);
-				#endif
-				}
-			}
 		}
 	#if 0
 		m_iPlayHeadX = pSession->pixelFromFrame(pSession->playHead());
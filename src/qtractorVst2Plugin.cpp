@@ -106,6 +106,7 @@ const int effGetChunk = 23;
 const int effSetChunk = 24;
 const int effGetProgramNameIndexed = 29;
 const int effFlagsProgramChunks = 32;
+const int effGetTailSize = 52;
 #endif
 
 
@@ -1109,6 +1110,19 @@ void qtractorVst2Plugin::releaseConfigs (void)
 }
 
 
+// Plugin declared tail length (in frames; -1=unknown/infinite).
+long qtractorVst2Plugin::tailLength (void) const
+{
+	// 0=unknown (default), 1=no tail, otherwise the tail length.
+	const int iTailSize
+		= vst2_dispatch(0, effGetTailSize, 0, 0, nullptr, 0.0f);
+	if (iTailSize < 1)
+		return -1;
+
+	return (iTailSize > 1 ? iTailSize : 0);
+}
+
+
 // Plugin current latency (in frames);
 unsigned long qtractorVst2Plugin::latency (void) const
 {
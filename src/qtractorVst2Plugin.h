@@ -152,6 +152,9 @@ public:
 	// Plugin current latency (in frames);
 	unsigned long latency() const;
 
+	// Plugin declared tail length (in frames; -1=unknown/infinite).
+	long tailLength() const;
+
 	// Plugin preset i/o (configuration from/to (fxp/fxb files).
 	bool loadPresetFile(const QString& sFilename);
 	bool savePresetFile(const QString& sFilename);
@@ -1707,6 +1707,9 @@ public:
 	// Plugin current latency (in frames);
 	unsigned long latency () const;
 
+	// Plugin declared tail length (in frames; -1=unknown/infinite).
+	long tailLength () const;
+
 	// Set/add a parameter value/point.
 	void setParameter (
 		Vst::ParamID id, Vst::ParamValue value, uint32 offset);
@@ -2620,6 +2623,20 @@ unsigned long qtractorVst3Plugin::Impl::latency (void) const
 }
 
 
+// Plugin declared tail length (in frames; -1=unknown/infinite).
+long qtractorVst3Plugin::Impl::tailLength (void) const
+{
+	if (m_processor == nullptr)
+		return -1;
+
+	const uint32 iTailSamples = m_processor->getTailSamples();
+	if (iTailSamples >= uint32(Vst::kInfiniteTail) || iTailSamples > 0x7fffffff)
+		return -1;
+
+	return long(iTailSamples);
+}
+
+
 // Set/add a parameter value/point.
 void qtractorVst3Plugin::Impl::setParameter (
 	Vst::ParamID id, Vst::ParamValue value, uint32 offset )
@@ -3532,6 +3549,13 @@ unsigned long qtractorVst3Plugin::latency (void) const
 }
 
 
+// Plugin declared tail length (in frames; -1=unknown/infinite).
+long qtractorVst3Plugin::tailLength (void) const
+{
+	return m_pImpl->tailLength();
+}
+
+
 // Provisional program/patch accessor.
 bool qtractorVst3Plugin::getProgram ( int iIndex, Program& program ) const
 {
@@ -141,6 +141,9 @@ public:
 	// Plugin current latency (in frames);
 	unsigned long latency() const;
 
+	// Plugin declared tail length (in frames; -1=unknown/infinite).
+	long tailLength() const;
+
 	// Provisional program/patch accessor.
 	bool getProgram(int iIndex, Program& program) const;
 
@@ -27,7 +27,7 @@
 #include <cmath>
 
 
-// Cross-correlation value calculation over the overlap period.
+// Cross-correlation and overlap-add kernels over the overlap period.
 //
 
 #if defined(__SSE__)
@@ -61,10 +61,10 @@ static inline bool sse_enabled (void)
 
 
 // SSE enabled version.
-static inline float sse_cross_corr (
+static float sse_cross_corr (
 	const float *pV1, const float *pV2, unsigned int iOverlapLength )
 {
-	__m128 vCorr, vNorm, vTemp, *pVec2;
+	__m128 vCorr, vNorm, vTemp, vRef;
 
 	// Note. It means a major slow-down if the routine needs to tolerate
 	// unaligned __m128 memory accesses. It's way faster if we can skip
@@ -72,58 +72,252 @@ static inline float sse_cross_corr (
 	// This can mean up to ~ 10-fold difference (incl. part of which is
 	// due to skipping every second round for stereo sound though).
 	//
-	// Little cheating allowed, return valid correlation only for
-	// aligned locations, meaning every second round for stereo sound.
-	//if (((unsigned long) pV1) & 15) return -1e38f; // Skip unaligned locations.
 	// No cheating allowed, use unaligned load & take the resulting
 	// performance hit. -- use _mm_loadu_ps() instead of _mm_load_ps();
 
-	// Ensure overlapLength is divisible by 8
-	// assert((m_iOverlapLength % 8) == 0);
-	iOverlapLength >>= 4;
-
 	// Calculates the cross-correlation value between 'pV1' and 'pV2' vectors
 	// Note: pV2 _must_ be aligned to 16-bit boundary, pV1 need not.
-	pVec2 = (__m128 *) pV2;
 	vCorr = _mm_setzero_ps();
 	vNorm = _mm_setzero_ps();
 
 	// Unroll the loop by factor of 4 * 4 operations
-	for (unsigned int i = 0; i < iOverlapLength; ++i) {
+	unsigned int i = 0;
+	for ( ; i + 16 <= iOverlapLength; i += 16) {
 		// vCorr += pV1[0..3] * pV2[0..3]
-		vTemp = _mm_loadu_ps(pV1);
-		vCorr = _mm_add_ps(vCorr, _mm_mul_ps(vTemp, pVec2[0]));
+		vTemp = _mm_loadu_ps(pV1 + i);
+		vCorr = _mm_add_ps(vCorr, _mm_mul_ps(vTemp, _mm_load_ps(pV2 + i)));
 		vNorm = _mm_add_ps(vNorm, _mm_mul_ps(vTemp, vTemp));
 		// vCorr += pV1[4..7] * pV2[4..7]
-		vTemp = _mm_loadu_ps(pV1 + 4);
-		vCorr = _mm_add_ps(vCorr, _mm_mul_ps(vTemp, pVec2[1]));
+		vTemp = _mm_loadu_ps(pV1 + i + 4);
+		vCorr = _mm_add_ps(vCorr, _mm_mul_ps(vTemp, _mm_load_ps(pV2 + i + 4)));
 		vNorm = _mm_add_ps(vNorm, _mm_mul_ps(vTemp, vTemp));
 		// vCorr += pV1[8..11] * pV2[8..11]
-		vTemp = _mm_loadu_ps(pV1 + 8);
-		vCorr = _mm_add_ps(vCorr, _mm_mul_ps(vTemp, pVec2[2]));
+		vTemp = _mm_loadu_ps(pV1 + i + 8);
+		vCorr = _mm_add_ps(vCorr, _mm_mul_ps(vTemp, _mm_load_ps(pV2 + i + 8)));
 		vNorm = _mm_add_ps(vNorm, _mm_mul_ps(vTemp, vTemp));
 		// vCorr += pV1[12..15] * pV2[12..15]
-		vTemp = _mm_loadu_ps(pV1 + 12);
-		vCorr = _mm_add_ps(vCorr, _mm_mul_ps(vTemp, pVec2[3]));
+		vTemp = _mm_loadu_ps(pV1 + i + 12);
+		vCorr = _mm_add_ps(vCorr, _mm_mul_ps(vTemp, _mm_load_ps(pV2 + i + 12)));
 		vNorm = _mm_add_ps(vNorm, _mm_mul_ps(vTemp, vTemp));
-		pV1 += 16;
-		pVec2 += 4;
 	}
 
-	float *pvNorm = (float *) &vNorm;
-	float fNorm = (pvNorm[0] + pvNorm[1] + pvNorm[2] + pvNorm[3]);
+	// Overlap length is only divisible by 8...
+	for ( ; i + 4 <= iOverlapLength; i += 4) {
+		vTemp = _mm_loadu_ps(pV1 + i);
+		vRef  = _mm_loadu_ps(pV2 + i);
+		vCorr = _mm_add_ps(vCorr, _mm_mul_ps(vTemp, vRef));
+		vNorm = _mm_add_ps(vNorm, _mm_mul_ps(vTemp, vTemp));
+	}
+
+	float afCorr[4], afNorm[4];
+	_mm_storeu_ps(afCorr, vCorr);
+	_mm_storeu_ps(afNorm, vNorm);
+
+	float fCorr = (afCorr[0] + afCorr[1] + afCorr[2] + afCorr[3]);
+	float fNorm = (afNorm[0] + afNorm[1] + afNorm[2] + afNorm[3]);
+
+	for ( ; i < iOverlapLength; ++i) {
+		fCorr += pV1[i] * pV2[i];
+		fNorm += pV1[i] * pV1[i];
+	}
 
 	if (fNorm < 1e-9f) fNorm = 1.0f; // avoid div by zero
 
-	float *pvCorr = (float *) &vCorr;
-	return (pvCorr[0] + pvCorr[1] + pvCorr[2] + pvCorr[3]) / ::sqrtf(fNorm);
+	return fCorr / ::sqrtf(fNorm);
 }
 
-#endif
+
+static void sse_overlap (
+	float *pOutput, const float *pInput, const float *pMid,
+	unsigned int iOverlapLength )
+{
+	const __m128 vLength = _mm_set1_ps(float(iOverlapLength));
+	const __m128 vStep = _mm_set1_ps(4.0f);
+
+	__m128 vJ = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+
+	unsigned int j = 0;
+	for ( ; j + 4 <= iOverlapLength; j += 4) {
+		const __m128 vK = _mm_sub_ps(vLength, vJ);
+		const __m128 vOut = _mm_div_ps(_mm_add_ps(
+			_mm_mul_ps(_mm_loadu_ps(pInput + j), vJ),
+			_mm_mul_ps(_mm_loadu_ps(pMid + j), vK)), vLength);
+		_mm_storeu_ps(pOutput + j, vOut);
+		vJ = _mm_add_ps(vJ, vStep);
+	}
+
+	for ( ; j < iOverlapLength; ++j) {
+		const unsigned int k = iOverlapLength - j;
+		pOutput[j] = (pInput[j] * j + pMid[j] * k) / iOverlapLength;
+	}
+}
+
+#endif // __SSE__
+
+
+#if defined(__SSE__) && defined(__GNUC__)
+
+#include <immintrin.h>
+
+#define WSOLA_AVX2
+
+// AVX2 detection.
+static inline bool avx2_enabled (void)
+{
+	return __builtin_cpu_supports("avx2");
+}
+
+
+// AVX2 enabled version (runtime dispatched).
+static float __attribute__ ((target ("avx2"))) avx2_cross_corr (
+	const float *pV1, const float *pV2, unsigned int iOverlapLength )
+{
+	__m256 vCorr = _mm256_setzero_ps();
+	__m256 vNorm = _mm256_setzero_ps();
+	__m256 vTemp;
+
+	unsigned int i = 0;
+	for ( ; i + 16 <= iOverlapLength; i += 16) {
+		vTemp = _mm256_loadu_ps(pV1 + i);
+		vCorr = _mm256_add_ps(vCorr,
+			_mm256_mul_ps(vTemp, _mm256_loadu_ps(pV2 + i)));
+		vNorm = _mm256_add_ps(vNorm, _mm256_mul_ps(vTemp, vTemp));
+		vTemp = _mm256_loadu_ps(pV1 + i + 8);
+		vCorr = _mm256_add_ps(vCorr,
+			_mm256_mul_ps(vTemp, _mm256_loadu_ps(pV2 + i + 8)));
+		vNorm = _mm256_add_ps(vNorm, _mm256_mul_ps(vTemp, vTemp));
+	}
+
+	for ( ; i + 8 <= iOverlapLength; i += 8) {
+		vTemp = _mm256_loadu_ps(pV1 + i);
+		vCorr = _mm256_add_ps(vCorr,
+			_mm256_mul_ps(vTemp, _mm256_loadu_ps(pV2 + i)));
+		vNorm = _mm256_add_ps(vNorm, _mm256_mul_ps(vTemp, vTemp));
+	}
+
+	float afCorr[8], afNorm[8];
+	_mm256_storeu_ps(afCorr, vCorr);
+	_mm256_storeu_ps(afNorm, vNorm);
+
+	float fCorr = 0.0f;
+	float fNorm = 0.0f;
+	for (unsigned int n = 0; n < 8; ++n) {
+		fCorr += afCorr[n];
+		fNorm += afNorm[n];
+	}
+
+	for ( ; i < iOverlapLength; ++i) {
+		fCorr += pV1[i] * pV2[i];
+		fNorm += pV1[i] * pV1[i];
+	}
+
+	if (fNorm < 1e-9f) fNorm = 1.0f; // avoid div by zero
+
+	return fCorr / ::sqrtf(fNorm);
+}
+
+
+static void __attribute__ ((target ("avx2"))) avx2_overlap (
+	float *pOutput, const float *pInput, const float *pMid,
+	unsigned int iOverlapLength )
+{
+	const __m256 vLength = _mm256_set1_ps(float(iOverlapLength));
+	const __m256 vStep = _mm256_set1_ps(8.0f);
+
+	__m256 vJ = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+
+	unsigned int j = 0;
+	for ( ; j + 8 <= iOverlapLength; j += 8) {
+		const __m256 vK = _mm256_sub_ps(vLength, vJ);
+		const __m256 vOut = _mm256_div_ps(_mm256_add_ps(
+			_mm256_mul_ps(_mm256_loadu_ps(pInput + j), vJ),
+			_mm256_mul_ps(_mm256_loadu_ps(pMid + j), vK)), vLength);
+		_mm256_storeu_ps(pOutput + j, vOut);
+		vJ = _mm256_add_ps(vJ, vStep);
+	}
+
+	for ( ; j < iOverlapLength; ++j) {
+		const unsigned int k = iOverlapLength - j;
+		pOutput[j] = (pInput[j] * j + pMid[j] * k) / iOverlapLength;
+	}
+}
+
+#endif // __SSE__ && __GNUC__
+
+
+#if defined(__ARM_NEON__)
+
+#include "arm_neon.h"
+
+// NEON enabled version.
+static float neon_cross_corr (
+	const float *pV1, const float *pV2, unsigned int iOverlapLength )
+{
+	float32x4_t vCorr = vdupq_n_f32(0.0f);
+	float32x4_t vNorm = vdupq_n_f32(0.0f);
+	float32x4_t vTemp;
+
+	unsigned int i = 0;
+	for ( ; i + 4 <= iOverlapLength; i += 4) {
+		vTemp = vld1q_f32(pV1 + i);
+		vCorr = vaddq_f32(vCorr, vmulq_f32(vTemp, vld1q_f32(pV2 + i)));
+		vNorm = vaddq_f32(vNorm, vmulq_f32(vTemp, vTemp));
+	}
+
+	float afCorr[4], afNorm[4];
+	vst1q_f32(afCorr, vCorr);
+	vst1q_f32(afNorm, vNorm);
+
+	float fCorr = (afCorr[0] + afCorr[1] + afCorr[2] + afCorr[3]);
+	float fNorm = (afNorm[0] + afNorm[1] + afNorm[2] + afNorm[3]);
+
+	for ( ; i < iOverlapLength; ++i) {
+		fCorr += pV1[i] * pV2[i];
+		fNorm += pV1[i] * pV1[i];
+	}
+
+	if (fNorm < 1e-9f) fNorm = 1.0f; // avoid div by zero
+
+	return fCorr / ::sqrtf(fNorm);
+}
+
+
+#if defined(__aarch64__)
+
+// NEON enabled overlap-add (true division is AArch64 only).
+static void neon_overlap (
+	float *pOutput, const float *pInput, const float *pMid,
+	unsigned int iOverlapLength )
+{
+	const float32x4_t vLength = vdupq_n_f32(float(iOverlapLength));
+	const float32x4_t vStep = vdupq_n_f32(4.0f);
+
+	const float afJ[4] = { 0.0f, 1.0f, 2.0f, 3.0f };
+	float32x4_t vJ = vld1q_f32(afJ);
+
+	unsigned int j = 0;
+	for ( ; j + 4 <= iOverlapLength; j += 4) {
+		const float32x4_t vK = vsubq_f32(vLength, vJ);
+		const float32x4_t vOut = vdivq_f32(vaddq_f32(
+			vmulq_f32(vld1q_f32(pInput + j), vJ),
+			vmulq_f32(vld1q_f32(pMid + j), vK)), vLength);
+		vst1q_f32(pOutput + j, vOut);
+		vJ = vaddq_f32(vJ, vStep);
+	}
+
+	for ( ; j < iOverlapLength; ++j) {
+		const unsigned int k = iOverlapLength - j;
+		pOutput[j] = (pInput[j] * j + pMid[j] * k) / iOverlapLength;
+	}
+}
+
+#endif // __aarch64__
+
+#endif // __ARM_NEON__
 
 
 // Standard (slow) version.
-static inline float std_cross_corr (
+static float std_cross_corr (
 	const float *pV1, const float *pV2, unsigned int iOverlapLength )
 {
 	float fCorr = 0.0f;
@@ -140,6 +334,58 @@ static inline float std_cross_corr (
 }
 
 
+static void std_overlap (
+	float *pOutput, const float *pInput, const float *pMid,
+	unsigned int iOverlapLength )
+{
+	for (unsigned int j = 0; j < iOverlapLength; ++j) {
+		const unsigned int k = iOverlapLength - j;
+		pOutput[j] = (pInput[j] * j + pMid[j] * k) / iOverlapLength;
+	}
+}
+
+
+// Available kernels, by increasing preference (null terminated).
+struct qtractorWsolaKernels
+{
+	qtractorWsolaKernels() : count(0)
+	{
+		add("std", std_cross_corr, std_overlap);
+	#if defined(__SSE__)
+		if (sse_enabled())
+			add("sse", sse_cross_corr, sse_overlap);
+	#endif
+	#if defined(WSOLA_AVX2)
+		if (avx2_enabled())
+			add("avx2", avx2_cross_corr, avx2_overlap);
+	#endif
+	#if defined(__ARM_NEON__)
+	#if defined(__aarch64__)
+		add("neon", neon_cross_corr, neon_overlap);
+	#else
+		add("neon", neon_cross_corr, std_overlap);
+	#endif
+	#endif
+		kernels[count].name = nullptr;
+		kernels[count].crossCorr = nullptr;
+		kernels[count].overlap = nullptr;
+	}
+
+	void add(const char *name,
+		qtractorWsolaTimeStretcher::CrossCorrFunc crossCorr,
+		qtractorWsolaTimeStretcher::OverlapFunc overlap)
+	{
+		kernels[count].name = name;
+		kernels[count].crossCorr = crossCorr;
+		kernels[count].overlap = overlap;
+		++count;
+	}
+
+	qtractorWsolaTimeStretcher::Kernel kernels[5];
+	unsigned int count;
+};
+
+
 //---------------------------------------------------------------------------
 // qtractorWsolaTimeStretcher - Time-stretch (tempo change) effect for processed sound.
 //
@@ -162,12 +408,12 @@ qtractorWsolaTimeStretcher::qtractorWsolaTimeStretcher (
 
 	m_iOverlapLength = 0;
 
-#if defined(__SSE__)
-	if (sse_enabled())
-		m_pfnCrossCorr = sse_cross_corr;
-	else
-#endif
-	m_pfnCrossCorr = std_cross_corr;
+	// Pick the best kernels around...
+	const Kernel *pKernel = kernels();
+	while ((pKernel + 1)->name)
+		++pKernel;
+	m_pfnCrossCorr = pKernel->crossCorr;
+	m_pfnOverlap = pKernel->overlap;
 
 	setParameters(iSampleRate);
 }
@@ -190,6 +436,15 @@ qtractorWsolaTimeStretcher::~qtractorWsolaTimeStretcher (void)
 
 
 
+// Available kernels, by increasing preference (null terminated).
+const qtractorWsolaTimeStretcher::Kernel *qtractorWsolaTimeStretcher::kernels (void)
+{
+	static const qtractorWsolaKernels s_kernels;
+
+	return s_kernels.kernels;
+}
+
+
 // Sets the number of channels, 1=mono, 2=stereo.
 void qtractorWsolaTimeStretcher::setChannels ( unsigned short iChannels )
 {
@@ -415,7 +670,6 @@ unsigned int qtractorWsolaTimeStretcher::seekBestOverlapPosition (void)
 void qtractorWsolaTimeStretcher::processFrames (void)
 {
 	unsigned short i;
-	unsigned int j, k;
 	float *pInput, *pOutput;
 	unsigned int iSkip, iOffset;
 	int iTemp;
@@ -445,13 +699,10 @@ void qtractorWsolaTimeStretcher::processFrames (void)
 		m_outputBuffer.ensureCapacity(m_iOverlapLength);
 		// Overlap...
 		for (i = 0; i < m_iChannels; ++i) {
-			pInput = m_inputBuffer.ptrBegin(i);
+			pInput = m_inputBuffer.ptrBegin(i) + iOffset;
 			pOutput = m_outputBuffer.ptrEnd(i);
-			for (j = 0; j < m_iOverlapLength ; ++j) {
-				k = m_iOverlapLength - j;
-				pOutput[j] = (pInput[j + iOffset] * j
-					+ m_ppMidBuffer[i][j] * k) / m_iOverlapLength;
-			}
+			(*m_pfnOverlap)(pOutput, pInput,
+				m_ppMidBuffer[i], m_iOverlapLength);
 		}
 		// Commit...
 		m_outputBuffer.putFrames(m_iOverlapLength);
@@ -158,6 +158,22 @@ public:
 	// Clears all buffers.
 	void clear();
 
+	// Cross-correlation and overlap-add kernel prototypes.
+	typedef float (*CrossCorrFunc)(const float *, const float *, unsigned int);
+	typedef void (*OverlapFunc)(float *, const float *, const float *, unsigned int);
+
+	// Kernel implementation descriptor.
+	struct Kernel
+	{
+		const char   *name;
+		CrossCorrFunc crossCorr;
+		OverlapFunc   overlap;
+	};
+
+	// Available kernels, by increasing preference ("std" first,
+	// null name terminated); the last one is the one in use.
+	static const Kernel *kernels();
+
 	//----------------------------------------------------------------------
 	// class qtractorWsolaTimeStretcher::FifoBuffer -- FIFO buffer/cache template declaration.
 	//
@@ -279,7 +295,10 @@ private:
 	bool m_bMidBufferDirty;
 
 	// Calculates the cross-correlation value over the overlap period.
-	float (*m_pfnCrossCorr)(const float *, const float *, unsigned int);
+	CrossCorrFunc m_pfnCrossCorr;
+
+	// Mixes the overlap period with the mid-buffer (sliding).
+	OverlapFunc m_pfnOverlap;
 };
 
 
@@ -0,0 +1,319 @@
+// qtractor_benchmark.cpp
+//
+/****************************************************************************
+   Copyright (C) 2005-2022, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qtractorAbout.h"
+#include "qtractorBenchmark.h"
+
+#include "qtractorSession.h"
+#include "qtractorAudioEngine.h"
+#include "qtractorAudioFile.h"
+#include "qtractorPluginFactory.h"
+
+#ifdef CONFIG_LV2
+#include "qtractorLv2Plugin.h"
+#endif
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDomDocument>
+#include <QTextStream>
+#include <QFileInfo>
+
+#ifdef CONFIG_LIBJACKSERVER
+#include <jack/control.h>
+#endif
+
+#include <new>
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+
+//----------------------------------------------------------------------
+// Heap allocations counter -- this tool's own operator new.
+//
+
+void *operator new ( std::size_t iSize )
+{
+	qtractorBenchmark::allocNotify();
+
+	void *p = ::malloc(iSize > 0 ? iSize : 1);
+	if (p == nullptr)
+		throw std::bad_alloc();
+
+	return p;
+}
+
+void operator delete ( void *p ) noexcept
+{
+	::free(p);
+}
+
+
+#ifdef CONFIG_LIBJACKSERVER
+
+//----------------------------------------------------------------------
+// In-process JACK server, on the dummy driver (no sound card).
+//
+
+static jackctl_server_t *g_pJackServer = nullptr;
+
+static jackctl_parameter_t *qtractor_benchmark_param (
+	const JSList *params, const char *pszName )
+{
+	for (const JSList *node = params; node; node = jack_slist_next(node)) {
+		jackctl_parameter_t *param = (jackctl_parameter_t *) node->data;
+		if (::strcmp(jackctl_parameter_get_name(param), pszName) == 0)
+			return param;
+	}
+
+	return nullptr;
+}
+
+static bool qtractor_benchmark_server_start (
+	unsigned int iSampleRate, unsigned int iBufferSize )
+{
+	g_pJackServer = jackctl_server_create2(nullptr, nullptr, nullptr);
+	if (g_pJackServer == nullptr)
+		return false;
+
+	union jackctl_parameter_value value;
+	jackctl_parameter_t *param;
+
+	// A private server name, not to clash with any running one...
+	const QByteArray aServerName
+		= QString(QTRACTOR_TITLE "-benchmark-%1").arg(::getpid()).toLocal8Bit();
+	param = qtractor_benchmark_param(
+		jackctl_server_get_parameters(g_pJackServer), "name");
+	if (param) {
+		::memset(&value, 0, sizeof(value));
+		::strncpy(value.str, aServerName.constData(), sizeof(value.str) - 1);
+		jackctl_parameter_set_value(param, &value);
+	}
+
+	jackctl_driver_t *driver = nullptr;
+	const JSList *drivers = jackctl_server_get_drivers_list(g_pJackServer);
+	for (const JSList *node = drivers; node; node = jack_slist_next(node)) {
+		jackctl_driver_t *pDriver = (jackctl_driver_t *) node->data;
+		if (::strcmp(jackctl_driver_get_name(pDriver), "dummy") == 0) {
+			driver = pDriver;
+			break;
+		}
+	}
+
+	if (driver) {
+		const JSList *params = jackctl_driver_get_parameters(driver);
+		param = qtractor_benchmark_param(params, "rate");
+		if (param) {
+			value.ui = iSampleRate;
+			jackctl_parameter_set_value(param, &value);
+		}
+		param = qtractor_benchmark_param(params, "period");
+		if (param) {
+			value.ui = iBufferSize;
+			jackctl_parameter_set_value(param, &value);
+		}
+	}
+
+	if (driver == nullptr || !jackctl_server_open(g_pJackServer, driver)) {
+		jackctl_server_destroy(g_pJackServer);
+		g_pJackServer = nullptr;
+		return false;
+	}
+
+	if (!jackctl_server_start(g_pJackServer)) {
+		jackctl_server_close(g_pJackServer);
+		jackctl_server_destroy(g_pJackServer);
+		g_pJackServer = nullptr;
+		return false;
+	}
+
+	// Clients will go for this one from now on...
+	::setenv("JACK_DEFAULT_SERVER", aServerName.constData(), 1);
+
+	return true;
+}
+
+static void qtractor_benchmark_server_stop (void)
+{
+	if (g_pJackServer) {
+		jackctl_server_stop(g_pJackServer);
+		jackctl_server_close(g_pJackServer);
+		jackctl_server_destroy(g_pJackServer);
+		g_pJackServer = nullptr;
+	}
+}
+
+#endif	// CONFIG_LIBJACKSERVER
+
+
+//----------------------------------------------------------------------
+// Benchmark one session file or synthetic spec.
+//
+
+static bool qtractor_benchmark_run (
+	qtractorSession *pSession, const QString& sArg, QTextStream& out )
+{
+	qtractorBenchmark benchmark;
+
+	bool bResult = pSession->init();
+	if (!bResult)
+		out << sArg << ": the audio/MIDI engine could not be started.\n";
+
+#ifdef CONFIG_LV2
+	qtractorLv2PluginType::lv2_open();
+#endif
+
+	qtractorBenchmark::Spec spec;
+	if (bResult && qtractorBenchmark::parseSpec(sArg, spec)) {
+		// Synthetic stress session...
+		bResult = pSession->open() && benchmark.generate(pSession, spec);
+		if (!bResult)
+			out << sArg << ": could not generate the session.\n";
+	}
+	else
+	if (bResult) {
+		// Session file, through the regular document path...
+		int iFlags = qtractorDocument::Default;
+		const QString& sSuffix = QFileInfo(sArg).suffix();
+		if (sSuffix == qtractorDocument::templateExt())
+			iFlags |= qtractorDocument::Template;
+	#ifdef CONFIG_LIBZ
+		if (sSuffix == qtractorDocument::archiveExt()) {
+			iFlags |= qtractorDocument::Archive;
+			iFlags |= qtractorDocument::Temporary;
+		}
+	#endif
+		QDomDocument doc("qtractorSession");
+		bResult = qtractorSession::Document(&doc, pSession, nullptr)
+			.load(sArg, qtractorDocument::Flags(iFlags)) && pSession->open();
+		if (bResult) {
+			const unsigned int iSampleRate
+				= pSession->audioEngine()->sampleRate();
+			if (pSession->sampleRate() != iSampleRate)
+				pSession->updateSampleRate(iSampleRate);
+		} else {
+			out << sArg << ": session could not be loaded.\n";
+		}
+	}
+
+	if (bResult) {
+		bResult = benchmark.run(pSession);
+		out << sArg << ":\n" << benchmark.report() << '\n';
+	}
+
+	out.flush();
+
+	pSession->close();
+	pSession->clear();
+
+#ifdef CONFIG_LIBZ
+	qtractorDocument::clearExtractedArchives(true);
+#endif
+
+#ifdef CONFIG_LV2
+	qtractorLv2PluginType::lv2_close();
+#endif
+
+	return bResult;
+}
+
+
+//----------------------------------------------------------------------
+// main - The benchmark tool trunk.
+//
+
+int main ( int argc, char **argv )
+{
+	// No display whatsoever...
+	::setenv("QT_QPA_PLATFORM", "offscreen", 1);
+
+	QApplication app(argc, argv);
+	app.setApplicationName(QTRACTOR_TITLE "_benchmark");
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription(
+		QTRACTOR_TITLE " - " + QObject::tr("Offline render benchmark"));
+	parser.addOption({{"r", "rate"},
+		QObject::tr("Dummy backend sample rate (default: 48000)"), "rate"});
+	parser.addOption({{"p", "period"},
+		QObject::tr("Dummy backend period size (default: 256)"), "frames"});
+	parser.addOption({{"k", "kernels"},
+		QObject::tr("Also run the DSP kernels microbenchmark")});
+	parser.addHelpOption();
+	parser.addPositionalArgument("session-file|spec",
+		QObject::tr("Session file (.qtr, .qtz) or synthetic stress session "
+		"(<tracks>x<clips>x<plugins>); default: all stock presets"),
+		QObject::tr("[session-file|spec...]"));
+	parser.process(app);
+
+	unsigned int iSampleRate = 48000;
+	if (parser.isSet("rate"))
+		iSampleRate = parser.value("rate").toUInt();
+	unsigned int iBufferSize = 256;
+	if (parser.isSet("period"))
+		iBufferSize = parser.value("period").toUInt();
+
+	QStringList args = parser.positionalArguments();
+	if (args.isEmpty())
+		args = qtractorBenchmark::presets();
+
+	QTextStream out(stdout);
+
+#ifdef CONFIG_LIBJACKSERVER
+	if (!qtractor_benchmark_server_start(iSampleRate, iBufferSize)) {
+		out << QTRACTOR_TITLE "_benchmark: could not start the dummy "
+			"JACK server; using the default one instead.\n";
+	}
+#else
+	out << QTRACTOR_TITLE "_benchmark: no in-process JACK server support; "
+		"using the default one (eg. jackd -d dummy -r "
+		<< iSampleRate << " -p " << iBufferSize << ").\n";
+#endif
+
+	qtractorAudioFileFactory audioFileFactory;
+	qtractorPluginFactory pluginFactory;
+
+	int iFailures = 0;
+	{
+		qtractorSession session;
+		QStringListIterator iter(args);
+		while (iter.hasNext()) {
+			if (!qtractor_benchmark_run(&session, iter.next(), out))
+				++iFailures;
+		}
+	}
+
+	if (parser.isSet("kernels"))
+		out << qtractorBenchmark::kernels();
+
+	out.flush();
+
+#ifdef CONFIG_LIBJACKSERVER
+	qtractor_benchmark_server_stop();
+#endif
+
+	return (iFailures > 0 ? 1 : 0);
+}
+
+
+// end of qtractor_benchmark.cpp